@@ -1,5 +1,7 @@
 #include <iostream>
 #include <PipePublisher.h>
+#include <RingPublisher.h>
+#include <ByteRingPublisher.h>
 #include <util_time.h>
 #include <iomanip>
 #include <sstream>
@@ -10,8 +12,15 @@
 #include <thread>
 #include <condition_variable>
 #include <WorkerThread.h>
+#include <ShmPublisher.h>
+#include <ShmConnection.h>
+#include <LatencyHistogram.h>
+#include <unistd.h>
 #include <map>
 #include <vector>
+#include <atomic>
+#include <algorithm>
+#include <chrono>
 
 struct Msg {
     long   i;
@@ -26,9 +35,22 @@ size_t COUNT = 1000000; // SHORT
 //const size_t COUNT = 1000;
 long baseline_duration = 0;
 
+/**
+ * Latency mode: each message is stamped at publication, and the
+ * publish-to-consume latency recorded by the consumer. The churn scenarios,
+ * which have no consumer, instead record the cost of each Publish call.
+ */
+bool latencyMode = false;
+LatencyHistogram publishLatency;
+
+// Table currently being printed has the latency (rather than timing) columns
+bool latencyTable = false;
+
 
 void Header(size_t n);
 void Footer();
+void LatencyHeader(const std::string& title);
+void ReportLatency(const std::string& name, const LatencyHistogram& latency);
 void DoTimedTest(const std::string& name,
                  size_t n,
                  std::function<void(size_t count)> f);
@@ -40,14 +62,36 @@ void BaselineQueue(size_t count);
 void EmptyPush(size_t count);
 void PassiveClients(size_t count, size_t clients);
 void IgnoringClients(size_t count, size_t clients);
+void ChurningClients(size_t count, size_t clients, bool churn);
 
 void ThreadConsumers(size_t count, size_t clients, size_t threads);
 void ThreadConsumersBatched(size_t count, size_t clients, size_t threads);
+void ThreadConsumersAutoBatched(size_t count, size_t clients, size_t threads);
+void ManyClients(size_t count, size_t clients, size_t threads, size_t helpers);
+
+void IgnoringRingClients(size_t count, size_t clients);
+void PassiveRingClients(size_t count, size_t clients);
+void ThreadRingConsumers(size_t count, size_t clients, size_t threads);
+
+void PassiveStringClients(size_t count, size_t clients);
+void PassiveByteRingClients(size_t count, size_t clients);
 
 void OnNewMessage(size_t count, size_t clients);
 void OnNewMessageBatched(size_t count, size_t clients);
 void OnNewMessageCustom(size_t count, size_t clients);
 
+/*
+ * Hand-off latency
+ */
+typedef std::function<std::vector<long>(size_t count, const WaitStrategy&)> LatencyTest;
+std::vector<long> SubscriberHandOff(size_t count, const WaitStrategy& strategy);
+std::vector<long> WorkerHandOff(size_t count, const WaitStrategy& strategy);
+std::vector<long> ShmHandOff(size_t count, const WaitStrategy& strategy);
+void DoLatencyTest(const std::string& name,
+                   size_t n,
+                   const WaitStrategy& strategy,
+                   LatencyTest f);
+
 CSV<std::string,long> results;
 
 int main(int argc, const char *argv[])
@@ -70,6 +114,7 @@ int main(int argc, const char *argv[])
 
 
     bool threads = (args["noThreads"] != "SET");
+    latencyMode = (args["latency"] == "SET");
 
     if (args["count"] != "") {
         long tmpCount = atol(args["count"].c_str());
@@ -83,33 +128,64 @@ int main(int argc, const char *argv[])
         return 0;
     }
 
-    Header(COUNT);
-    DoTimedTest("Baseline Loop",COUNT, BaselineLoop);
-    DoTimedTest("Baseline Queue",COUNT, BaselineQueue);
+    if (latencyMode) {
+        // Only scenarios which consume their messages have a latency to report
+        LatencyHeader("Publish to consume latency");
+    } else {
+        Header(COUNT);
+        DoTimedTest("Baseline Loop",COUNT, BaselineLoop);
+        DoTimedTest("Baseline Queue",COUNT, BaselineQueue);
 
-    /**
-     * Pushing when there are no clients...
-     */
-    Footer();
-    DoTimedTest("Pushing with no clients",COUNT, EmptyPush);
+        /**
+         * Pushing when there are no clients...
+         */
+        Footer();
+        DoTimedTest("Pushing with no clients",COUNT, EmptyPush);
 
-    /**
-     * Pushing to clients who are not consuming data (the queue is just getting bigger...)
-     */
-    Footer();
-    DoTimedTest("Pushing to 1 client, no reads",COUNT, [] (size_t count) -> void { IgnoringClients(count,1);});
-    DoTimedTest("Pushing to 2 clients, no reads",COUNT, [] (size_t count) -> void { IgnoringClients(count,2);});
-    DoTimedTest("Pushing to 3 clients, no reads",COUNT, [] (size_t count) -> void { IgnoringClients(count,3);});
-    DoTimedTest("Pushing to 5 clients, no reads",COUNT, [] (size_t count) -> void { IgnoringClients(count,5);});
-    DoTimedTest("Pushing to 10 clients, no reads",COUNT, [] (size_t count) -> void { IgnoringClients(count,10);});
+        /**
+         * Pushing to clients who are not consuming data (the queue is just getting bigger...)
+         */
+        Footer();
+        DoTimedTest("Pushing to 1 client, no reads",COUNT, [] (size_t count) -> void { IgnoringClients(count,1);});
+        DoTimedTest("Pushing to 2 clients, no reads",COUNT, [] (size_t count) -> void { IgnoringClients(count,2);});
+        DoTimedTest("Pushing to 3 clients, no reads",COUNT, [] (size_t count) -> void { IgnoringClients(count,3);});
+        DoTimedTest("Pushing to 5 clients, no reads",COUNT, [] (size_t count) -> void { IgnoringClients(count,5);});
+        DoTimedTest("Pushing to 10 clients, no reads",COUNT, [] (size_t count) -> void { IgnoringClients(count,10);});
+
+        Footer();
+        DoTimedTest("Pushing to 1 client, no reads, churning",COUNT, [] (size_t count) -> void { ChurningClients(count,1,true);});
+        DoTimedTest("Pushing to 2 clients, no reads, churning",COUNT, [] (size_t count) -> void { ChurningClients(count,2,true);});
+        DoTimedTest("Pushing to 3 clients, no reads, churning",COUNT, [] (size_t count) -> void { ChurningClients(count,3,true);});
+        DoTimedTest("Pushing to 5 clients, no reads, churning",COUNT, [] (size_t count) -> void { ChurningClients(count,5,true);});
+        DoTimedTest("Pushing to 10 clients, no reads, churning",COUNT, [] (size_t count) -> void { ChurningClients(count,10,true);});
+
+        Footer();
+    }
 
-    Footer();
     DoTimedTest("Pushing to 1 client, single thread",COUNT, [] (size_t count) -> void { PassiveClients(count,1); });
     DoTimedTest("Pushing to 2 client, single thread",COUNT, [] (size_t count) -> void { PassiveClients(count,2); });
     DoTimedTest("Pushing to 3 client, single thread",COUNT, [] (size_t count) -> void { PassiveClients(count,3); });
     DoTimedTest("Pushing to 5 client, single thread",COUNT, [] (size_t count) -> void { PassiveClients(count,5); });
     DoTimedTest("Pushing to 10 client, single thread",COUNT, [] (size_t count) -> void { PassiveClients(count,10); });
 
+    if (!latencyMode) {
+        Footer();
+        DoTimedTest("Pushing to 1 client, no reads, shared ring",COUNT, [] (size_t count) -> void { IgnoringRingClients(count,1);});
+        DoTimedTest("Pushing to 5 clients, no reads, shared ring",COUNT, [] (size_t count) -> void { IgnoringRingClients(count,5);});
+        DoTimedTest("Pushing to 10 clients, no reads, shared ring",COUNT, [] (size_t count) -> void { IgnoringRingClients(count,10);});
+    }
+
+    Footer();
+    DoTimedTest("Pushing to 1 client, single thread, shared ring",COUNT, [] (size_t count) -> void { PassiveRingClients(count,1); });
+    DoTimedTest("Pushing to 5 client, single thread, shared ring",COUNT, [] (size_t count) -> void { PassiveRingClients(count,5); });
+    DoTimedTest("Pushing to 10 client, single thread, shared ring",COUNT, [] (size_t count) -> void { PassiveRingClients(count,10); });
+
+    if (!latencyMode) {
+        Footer();
+        DoTimedTest("JSON to 10 client, single thread, strings",COUNT, [] (size_t count) -> void { PassiveStringClients(count,10); });
+        DoTimedTest("JSON to 10 client, single thread, byte ring",COUNT, [] (size_t count) -> void { PassiveByteRingClients(count,10); });
+    }
+
     Footer();
     DoTimedTest("Fowarding to 1 client, single thread",COUNT, [] (size_t count) -> void { OnNewMessage(count,1); });
     DoTimedTest("Fowarding to 2 client, single thread",COUNT, [] (size_t count) -> void { OnNewMessage(count,2); });
@@ -158,6 +234,11 @@ int main(int argc, const char *argv[])
         Footer();
         DoTimedTest("Pushing to 10 client,10 client thread",COUNT, [] (size_t count) -> void { ThreadConsumers(count,10,10); });
 
+        Footer();
+        DoTimedTest("Pushing to 1 client, 1 client thread, shared ring",COUNT, [] (size_t count) -> void { ThreadRingConsumers(count,1,1); });
+        DoTimedTest("Pushing to 5 client, 5 client thread, shared ring",COUNT, [] (size_t count) -> void { ThreadRingConsumers(count,5,5); });
+        DoTimedTest("Pushing to 10 client,10 client thread, shared ring",COUNT, [] (size_t count) -> void { ThreadRingConsumers(count,10,10); });
+
         Footer();
         DoTimedTest("Pushing to 1 client, 1 client thread, batched",COUNT, [] (size_t count) -> void { ThreadConsumersBatched(count,1,1); });
         DoTimedTest("Pushing to 2 client, 1 client thread, batched",COUNT, [] (size_t count) -> void { ThreadConsumersBatched(count,2,1); });
@@ -183,10 +264,53 @@ int main(int argc, const char *argv[])
 
         Footer();
         DoTimedTest("Pushing to 10 client,10 client thread, batched",COUNT, [] (size_t count) -> void { ThreadConsumersBatched(count,10,10); });
+
+        Footer();
+        DoTimedTest("Pushing to 1 client, 1 client thread, auto-batched",COUNT, [] (size_t count) -> void { ThreadConsumersAutoBatched(count,1,1); });
+        DoTimedTest("Pushing to 5 client, 5 client thread, auto-batched",COUNT, [] (size_t count) -> void { ThreadConsumersAutoBatched(count,5,5); });
+        DoTimedTest("Pushing to 10 client,10 client thread, auto-batched",COUNT, [] (size_t count) -> void { ThreadConsumersAutoBatched(count,10,10); });
+
+        /**
+         * Large subscriber sets: fewer messages, so that each test pushes a
+         * similar number of copies in total.
+         */
+        Footer();
+        DoTimedTest("Pushing to 100 clients, 4 client thread",COUNT/10, [] (size_t count) -> void { ManyClients(count,100,4,0); });
+        DoTimedTest("Pushing to 1000 clients, 4 client thread",COUNT/100, [] (size_t count) -> void { ManyClients(count,1000,4,0); });
+
+        // Every thread spins: without a core each the fan-out is swamped
+        if (std::thread::hardware_concurrency() >= 8) {
+            DoTimedTest("Pushing to 100 clients, 4 client thread, fan-out x4",COUNT/10, [] (size_t count) -> void { ManyClients(count,100,4,3); });
+            DoTimedTest("Pushing to 1000 clients, 4 client thread, fan-out x4",COUNT/100, [] (size_t count) -> void { ManyClients(count,1000,4,3); });
+        }
+
+        const size_t samples = std::min<size_t>(COUNT, 10000);
+        Footer();
+        LatencyHeader("Hand-off Latency");
+        DoLatencyTest("Subscriber hand-off, blocking",samples, WaitStrategy::Blocking(), SubscriberHandOff);
+        DoLatencyTest("Subscriber hand-off, spin then park",samples, WaitStrategy::SpinThenPark(), SubscriberHandOff);
+        DoLatencyTest("Subscriber hand-off, busy poll",samples, WaitStrategy::BusyPoll(), SubscriberHandOff);
+        DoLatencyTest("Worker hand-off, blocking",samples, WaitStrategy::Blocking(), WorkerHandOff);
+        DoLatencyTest("Worker hand-off, spin then park",samples, WaitStrategy::SpinThenPark(), WorkerHandOff);
+        DoLatencyTest("Worker hand-off, busy poll",samples, WaitStrategy::BusyPoll(), WorkerHandOff);
+        DoLatencyTest("Shared memory hand-off, blocking",samples, WaitStrategy::Blocking(), ShmHandOff);
+        DoLatencyTest("Shared memory hand-off, busy poll",samples, WaitStrategy::BusyPoll(), ShmHandOff);
+    }
+
+    if (latencyMode) {
+        // Publisher stalls from subscription changes, against a stable client list
+        Footer();
+        LatencyHeader("Publish cost under subscription churn");
+        DoTimedTest("Pushing to 1 client, no reads",COUNT, [] (size_t count) -> void { ChurningClients(count,1,false);});
+        DoTimedTest("Pushing to 1 client, no reads, churning",COUNT, [] (size_t count) -> void { ChurningClients(count,1,true);});
+        DoTimedTest("Pushing to 5 clients, no reads",COUNT, [] (size_t count) -> void { ChurningClients(count,5,false);});
+        DoTimedTest("Pushing to 5 clients, no reads, churning",COUNT, [] (size_t count) -> void { ChurningClients(count,5,true);});
+        DoTimedTest("Pushing to 10 clients, no reads",COUNT, [] (size_t count) -> void { ChurningClients(count,10,false);});
+        DoTimedTest("Pushing to 10 clients, no reads, churning",COUNT, [] (size_t count) -> void { ChurningClients(count,10,true);});
     }
 
     Footer();
-    const char* fname = "results.csv";
+    const char* fname = latencyMode ? "latency.csv" : "results.csv";
     if ( args["file"] != "") {
         fname = args["file"].c_str();
     }
@@ -197,6 +321,37 @@ int main(int argc, const char *argv[])
 
 
 void dummy(const Msg& m);
+
+namespace {
+    long NowNS() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * The message to be published: stamped with the publication time when
+     * measuring latency.
+     */
+    inline Msg NewMessage() {
+        return Msg{latencyMode ? NowNS() : 1, 2, 3, 4};
+    }
+
+    /**
+     * Consume a published message, recording its latency when measuring
+     * latency.
+     *
+     * NOTE: The histogram may only be written by one thread, so consumers
+     *       on their own threads must keep their own, and merge it into
+     *       publishLatency on completion.
+     */
+    inline void Consume(const Msg& m, LatencyHistogram& latency) {
+        if (latencyMode) {
+            latency.Record(NowNS() - m.i);
+        }
+        dummy(m);
+    }
+}
+
 void BaselineLoop(size_t count) {
     for (size_t i = 0; i < count; ++i)
     {
@@ -224,7 +379,7 @@ void EmptyPush(size_t count) {
     PipePublisher<Msg> publisher;
     for (size_t i = 0; i < count; ++i)
     {
-        Msg m {1,2,3,4};
+        Msg m = NewMessage();
         publisher.Publish(m);
     }
 }
@@ -240,11 +395,63 @@ void IgnoringClients(size_t count, size_t clients) {
 
     for (size_t i = 0; i < count; ++i)
     {
-        Msg m {1,2,3,4};
+        Msg m = NewMessage();
         publisher.Publish(m);
     }
 }
 
+/**
+ * As IgnoringClients, but (if churn is set) another thread is continually
+ * adding and dropping (short lived) clients whilst we publish. The publisher
+ * should not be stalled by the subscription changes.
+ *
+ * In latency mode the cost of each Publish is recorded, so that the tail
+ * under churn may be compared with the run without it.
+ */
+void ChurningClients(size_t count, size_t clients, bool churn) {
+    PipePublisher<Msg> publisher;
+    std::vector<std::shared_ptr<PipeSubscriber<Msg>>> client_list;
+    client_list.reserve(clients);
+
+    for (size_t i =0; i < clients; ++i) {
+        client_list.push_back(publisher.NewClient(count));
+    }
+
+    class Handler: public IPipeConsumer<Msg> {
+    public:
+        void PushMessage(const Msg& m) { }
+    };
+
+    std::atomic<bool> stop(false);
+    std::thread churner;
+    if (churn) {
+        churner = std::thread([&publisher, &stop] () -> void {
+            while (!stop) {
+                std::shared_ptr<IPipeConsumer<Msg>> client(new Handler);
+                publisher.InstallClient(client);
+                std::this_thread::sleep_for(std::chrono::microseconds(10));
+            }
+        });
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        Msg m = NewMessage();
+        if (latencyMode) {
+            const long start = NowNS();
+            publisher.Publish(m);
+            publishLatency.Record(NowNS() - start);
+        } else {
+            publisher.Publish(m);
+        }
+    }
+
+    stop = true;
+    if (churner.joinable()) {
+        churner.join();
+    }
+}
+
 void PassiveClients(size_t count, size_t clients) {
     PipePublisher<Msg> publisher;
 
@@ -257,7 +464,7 @@ void PassiveClients(size_t count, size_t clients) {
 
     for (size_t i = 0; i < count; ++i)
     {
-        Msg m {1,2,3,4};
+        Msg m = NewMessage();
         publisher.Publish(m);
     }
 
@@ -265,7 +472,7 @@ void PassiveClients(size_t count, size_t clients) {
         auto& client = client_list[i];
         Msg m;
         while (client->GetNextMessage(m)) {
-            dummy(m);
+            Consume(m, publishLatency);
         }
     }
 }
@@ -279,6 +486,12 @@ public:
 
     void WaitForCompletion();
 
+    /**
+     * Publish-to-consume latency of the messages consumed. Only valid once
+     * WaitForCompletion has returned.
+     */
+    const LatencyHistogram& Latency() const { return latency; }
+
 private:
     void NotifyDone();
     std::mutex               completion_mutex;
@@ -286,6 +499,7 @@ private:
     bool                     done;
     bool                     waiting;
     size_t count;
+    LatencyHistogram         latency;
 
 };
 
@@ -297,7 +511,7 @@ ClientConsumer::ClientConsumer(
 {
     std::function<void (Msg&)> task = [&publisher, this, updatesToGet]
                                       (Msg& m) -> void {
-        dummy(m);
+        Consume(m, this->latency);
         this->count += 1;
         if (this->count >= updatesToGet) {
             this->NotifyDone();
@@ -342,13 +556,14 @@ void ThreadConsumers(size_t count, size_t clients, size_t threads) {
 
     for (size_t i = 0; i < count; ++i)
     {
-        Msg m {1,2,3,4};
+        Msg m = NewMessage();
         publisher.Publish(m);
     }
 
     for (size_t i = 0; i < clients; ++i) {
         auto it = consumers.find(i);
         it->second.WaitForCompletion();
+        publishLatency.Merge(it->second.Latency());
     }
 
 
@@ -374,7 +589,7 @@ void ThreadConsumersBatched(size_t count, size_t clients, size_t threads) {
     publisher.StartBatch();
     for (size_t i = 0; i < count; ++i)
     {
-        Msg m {1,2,3,4};
+        Msg m = NewMessage();
         publisher.Publish(m);
         if ( i % 1000 == 0) {
             publisher.StartBatch();
@@ -385,9 +600,301 @@ void ThreadConsumersBatched(size_t count, size_t clients, size_t threads) {
     for (size_t i = 0; i < clients; ++i) {
         auto it = consumers.find(i);
         it->second.WaitForCompletion();
+        publishLatency.Merge(it->second.Latency());
+    }
+
+
+}
+
+void ThreadConsumersAutoBatched(size_t count, size_t clients, size_t threads) {
+    PipePublisher<Msg> publisher;
+    std::map<size_t,WorkerThread> workers;
+    std::map<size_t,ClientConsumer> consumers;
+
+    for (size_t i =0; i < threads; ++i) {
+        WorkerThread& worker = workers[i];
+        worker.Start();
+    }
+
+    for (size_t i = 0; i < clients; ++i) {
+        WorkerThread& worker = workers[i%threads];
+        consumers.emplace(std::piecewise_construct,
+                          std::forward_as_tuple(i),
+                          std::forward_as_tuple(count, worker, publisher));
+    }
+
+    // The producer publishes one message at a time
+    publisher.EnableAutoBatching(100, std::chrono::microseconds(50));
+    for (size_t i = 0; i < count; ++i)
+    {
+        Msg m = NewMessage();
+        publisher.Publish(m);
+    }
+    publisher.Flush();
+
+    for (size_t i = 0; i < clients; ++i) {
+        auto it = consumers.find(i);
+        it->second.WaitForCompletion();
+        publishLatency.Merge(it->second.Latency());
+    }
+}
+
+/**
+ * Each client thread polls its share of the clients. Queues are kept small
+ * (and blocking) so that memory doesn't scale with the number of clients.
+ *
+ * @param helpers   Fan-out helper threads for the publisher (0 to disable)
+ */
+void ManyClients(size_t count, size_t clients, size_t threads, size_t helpers) {
+    PipePublisher<Msg> publisher;
+    if (helpers) {
+        publisher.EnableFanOut(helpers);
+    }
+
+    std::vector<std::shared_ptr<PipeSubscriber<Msg>>> client_list;
+    client_list.reserve(clients);
+    for (size_t i = 0; i < clients; ++i) {
+        client_list.push_back(publisher.NewClient(1024, PipeSubscriber<Msg>::BLOCK));
+    }
+
+    std::vector<std::thread> readers;
+    std::vector<LatencyHistogram> latencies(threads);
+    for (size_t t = 0; t < threads; ++t) {
+        readers.emplace_back([&, t] () -> void {
+            std::vector<size_t> got(clients, 0);
+            const size_t mine = (clients - t + threads - 1) / threads;
+            size_t complete = 0;
+            Msg m;
+
+            while (complete < mine) {
+                for (size_t i = t; i < clients; i += threads) {
+                    if (got[i] < count && client_list[i]->GetNextMessage(m)) {
+                        Consume(m, latencies[t]);
+                        if (++got[i] == count) {
+                            ++complete;
+                        }
+                    }
+                }
+            }
+        });
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        Msg m = NewMessage();
+        publisher.Publish(m);
+    }
+
+    for (size_t t = 0; t < threads; ++t) {
+        readers[t].join();
+        publishLatency.Merge(latencies[t]);
+    }
+}
+
+void IgnoringRingClients(size_t count, size_t clients) {
+    RingPublisher<Msg> publisher(count);
+    std::vector<std::shared_ptr<RingSubscriber<Msg>>> client_list;
+    client_list.reserve(clients);
+
+    for (size_t i =0; i < clients; ++i) {
+        client_list.push_back(publisher.NewClient());
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        Msg m = NewMessage();
+        publisher.Publish(m);
+    }
+}
+
+void PassiveRingClients(size_t count, size_t clients) {
+    RingPublisher<Msg> publisher(count);
+
+    std::vector<std::shared_ptr<RingSubscriber<Msg>>> client_list;
+    client_list.reserve(clients);
+
+    for (size_t i =0; i < clients; ++i) {
+        client_list.push_back(publisher.NewClient());
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        Msg m = NewMessage();
+        publisher.Publish(m);
     }
 
+    for (size_t i =0; i < clients; ++i) {
+        auto& client = client_list[i];
+        Msg m;
+        while (client->GetNextMessage(m)) {
+            Consume(m, publishLatency);
+        }
+    }
+}
+
+namespace {
+    // A typical serialized update: too long for the small string optimisation
+    const std::string JSON_MESSAGE =
+        "{\"instrument\": \"VOD.L\", \"bid\": 104.25, \"ask\": 104.5, "
+        "\"bidSize\": 12000, \"askSize\": 8500, \"seq\": 1234567}";
+
+    // Messages published between each drain of the clients
+    const size_t JSON_CHUNK = 1000;
+}
+
+void PassiveStringClients(size_t count, size_t clients) {
+    PipePublisher<std::string> publisher;
+
+    std::vector<std::shared_ptr<PipeSubscriber<std::string>>> client_list;
+    client_list.reserve(clients);
+
+    for (size_t i =0; i < clients; ++i) {
+        client_list.push_back(publisher.NewClient(JSON_CHUNK));
+    }
+
+    size_t bytes = 0;
+    for (size_t i = 0; i < count; i += JSON_CHUNK)
+    {
+        for (size_t j = 0; j < JSON_CHUNK; ++j) {
+            publisher.Publish(JSON_MESSAGE);
+        }
+
+        for (auto& client: client_list) {
+            std::string m;
+            while (client->GetNextMessage(m)) {
+                bytes += m.size();
+            }
+        }
+    }
+    dummy(Msg{static_cast<long>(bytes), 0, 0, 0});
+}
+
+void PassiveByteRingClients(size_t count, size_t clients) {
+    ByteRingPublisher publisher(JSON_CHUNK * ByteRing::RecordSize(JSON_MESSAGE.size()));
+
+    std::vector<std::shared_ptr<ByteRingSubscriber>> client_list;
+    client_list.reserve(clients);
+
+    for (size_t i =0; i < clients; ++i) {
+        client_list.push_back(publisher.NewClient());
+    }
+
+    size_t bytes = 0;
+    for (size_t i = 0; i < count; i += JSON_CHUNK)
+    {
+        for (size_t j = 0; j < JSON_CHUNK; ++j) {
+            publisher.Publish(JSON_MESSAGE);
+        }
+
+        for (auto& client: client_list) {
+            const char* data;
+            size_t size;
+            while (client->GetNextMessage(data, size)) {
+                bytes += size;
+            }
+        }
+    }
+    dummy(Msg{static_cast<long>(bytes), 0, 0, 0});
+}
+
+/**
+ * Equivalent of the ClientConsumer, reading from a shared ring
+ */
+class RingConsumer {
+public:
+    RingConsumer(
+        size_t udpatesToGet,
+        WorkerThread& worker,
+        RingPublisher<Msg>& publisher);
+
+    void WaitForCompletion();
+
+    /**
+     * Publish-to-consume latency of the messages consumed. Only valid once
+     * WaitForCompletion has returned.
+     */
+    const LatencyHistogram& Latency() const { return latency; }
+
+private:
+    void HandleUpdates();
+    std::shared_ptr<RingSubscriber<Msg>> client;
+    WorkerThread&            worker;
+    std::mutex               completion_mutex;
+    std::condition_variable  completion_flag;
+    bool                     done;
+    size_t                   count;
+    size_t                   updatesToGet;
+    LatencyHistogram         latency;
+};
+
+RingConsumer::RingConsumer(
+    size_t _updatesToGet,
+    WorkerThread& _worker,
+    RingPublisher<Msg>& publisher)
+    : client(publisher.NewClient()),
+      worker(_worker),
+      done(false),
+      count(0),
+      updatesToGet(_updatesToGet)
+{
+    worker.DoTask([this] () -> void { this->HandleUpdates(); });
+}
+
+void RingConsumer::HandleUpdates() {
+    Msg m;
+    size_t slice = 0;
+    while (slice < 1000 && client->GetNextMessage(m)) {
+        Consume(m, latency);
+        ++slice;
+    }
+    count += slice;
+
+    if (count >= updatesToGet) {
+        std::unique_lock<std::mutex> lock(this->completion_mutex);
+        done = true;
+        this->completion_flag.notify_all();
+    } else {
+        client->OnNextMessage([this] () -> void { this->HandleUpdates(); }, &worker);
+    }
+}
+
+void RingConsumer::WaitForCompletion() {
+    std::unique_lock<std::mutex> lock(this->completion_mutex);
+    while (!done) {
+        this->completion_flag.wait(lock);
+    }
+}
+
+void ThreadRingConsumers(size_t count, size_t clients, size_t threads) {
+    // Deliberately smaller than count: the publisher will have to wait on the
+    // consumers.
+    RingPublisher<Msg> publisher(64*1024);
+    std::map<size_t,WorkerThread> workers;
+    std::map<size_t,RingConsumer> consumers;
+
+    for (size_t i =0; i < threads; ++i) {
+        WorkerThread& worker = workers[i];
+        worker.Start();
+    }
+
+    for (size_t i = 0; i < clients; ++i) {
+        WorkerThread& worker = workers[i%threads];
+        consumers.emplace(std::piecewise_construct,
+                          std::forward_as_tuple(i),
+                          std::forward_as_tuple(count, worker, publisher));
+    }
 
+    for (size_t i = 0; i < count; ++i)
+    {
+        Msg m = NewMessage();
+        publisher.Publish(m);
+    }
+
+    for (size_t i = 0; i < clients; ++i) {
+        auto it = consumers.find(i);
+        it->second.WaitForCompletion();
+        publishLatency.Merge(it->second.Latency());
+    }
 }
 
 void OnNewMessage(size_t count, size_t num_clients) {
@@ -398,13 +905,15 @@ void OnNewMessage(size_t count, size_t num_clients) {
     for (size_t i = 0; i < num_clients; ++i) {
         auto client = publisher.NewClient(count);
 
-        client->OnNewMessage(dummy);
+        client->OnNewMessage([] (const Msg& m) -> void {
+            Consume(m, publishLatency);
+        });
         clients.push_back(client);
     }
 
     for (size_t i = 0; i < count; ++i)
     {
-        Msg m {1,2,3,4};
+        Msg m = NewMessage();
         publisher.Publish(m);
     }
 
@@ -418,14 +927,16 @@ void OnNewMessageBatched(size_t count, size_t num_clients) {
     for (size_t i = 0; i < num_clients; ++i) {
         auto client = publisher.NewClient(count);
 
-        client->OnNewMessage(dummy);
+        client->OnNewMessage([] (const Msg& m) -> void {
+            Consume(m, publishLatency);
+        });
         clients.push_back(client);
     }
 
     publisher.StartBatch();
     for (size_t i = 0; i < count; ++i)
     {
-        Msg m {1,2,3,4};
+        Msg m = NewMessage();
         publisher.Publish(m);
         if ( i % 1000 == 0) {
             publisher.StartBatch();
@@ -441,7 +952,7 @@ void OnNewMessageCustom(size_t count, size_t num_clients) {
     class Handler: public IPipeConsumer<Msg> {
     public:
         void PushMessage(const Msg& m) {
-            dummy(m);
+            Consume(m, publishLatency);
         }
     };
 
@@ -457,13 +968,14 @@ void OnNewMessageCustom(size_t count, size_t num_clients) {
 
     for (size_t i = 0; i < count; ++i)
     {
-        Msg m {1,2,3,4};
+        Msg m = NewMessage();
         publisher.Publish(m);
     }
 
 }
 
 void Header(size_t n) {
+    latencyTable = false;
     cout << "| ";
     cout << setw(50) << "Test Name";
     cout << " | ";
@@ -488,14 +1000,15 @@ void Header(size_t n) {
 }
 
 void Footer() {
+    const size_t columns = latencyTable ? 5 : 2;
     cout << "|-";
     cout << setw(50) << setfill('-') << "";
     cout << "-|-";
     cout << setw(22) << setfill('-') << "";
-    cout << "-|-";
-    cout << setw(14) << setfill('-') << "";
-    cout << "-|-";
-    cout << setw(14) << setfill('-') << "";
+    for (size_t i = 0; i < columns; ++i) {
+        cout << "-|-";
+        cout << setw(14) << setfill('-') << "";
+    }
     cout << "-|";
     cout << setfill(' ');
     cout << endl;
@@ -505,6 +1018,13 @@ void DoTimedTest(const std::string& name,
                  size_t n,
                  std::function<void(size_t count)> f)
 {
+    if (latencyMode) {
+        publishLatency.Reset();
+        f(n);
+        ReportLatency(name, publishLatency);
+        return;
+    }
+
     Time start;
     f(n);
     Time stop;
@@ -546,3 +1066,175 @@ void DoTimedTest(const std::string& name,
     cout << endl;
 }
 
+
+/*****************************************************************************
+ *                          Hand-off Latency
+ *****************************************************************************/
+
+namespace {
+    /**
+     * Wait for the consumer to receive the previous message, and then give it
+     * time to go idle so that we measure a cold hand-off.
+     */
+    void Pace(const std::atomic<size_t>& received, size_t expected) {
+        while (received.load() < expected) {
+            std::this_thread::yield();
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(20));
+    }
+}
+
+std::vector<long> SubscriberHandOff(size_t count, const WaitStrategy& strategy) {
+    PipePublisher<Msg> publisher;
+    std::shared_ptr<PipeSubscriber<Msg>> client(publisher.NewClient(1024));
+    std::vector<long> latencies;
+    latencies.reserve(count);
+    std::atomic<size_t> received(0);
+
+    std::thread consumer([&] () -> void {
+        Msg m;
+        while (received < count && client->WaitForMessage(m, strategy)) {
+            latencies.push_back(NowNS() - m.i);
+            ++received;
+        }
+    });
+
+    for (size_t i = 0; i < count; ++i) {
+        Pace(received, i);
+        publisher.Publish(Msg{NowNS(),0,0,0.0});
+    }
+
+    consumer.join();
+
+    return latencies;
+}
+
+std::vector<long> WorkerHandOff(size_t count, const WaitStrategy& strategy) {
+    WorkerThread worker(1024, strategy);
+    std::vector<long> latencies;
+    latencies.reserve(count);
+    std::atomic<size_t> received(0);
+
+    worker.Start();
+
+    for (size_t i = 0; i < count; ++i) {
+        Pace(received, i);
+        const long sent = NowNS();
+        worker.PostTask([&latencies, &received, sent] () -> void {
+            latencies.push_back(NowNS() - sent);
+            ++received;
+        });
+    }
+
+    worker.DoTask([] () -> void { });
+
+    return latencies;
+}
+
+/**
+ * Hand-off via a shared memory ring. The consumer is in the same process, but
+ * the path is the same as a cross-process consumer: a blocked consumer is
+ * woken by the connection's dispatch thread.
+ */
+std::vector<long> ShmHandOff(size_t count, const WaitStrategy& strategy) {
+    std::stringstream name;
+    name << "/publisherSpeed_" << getpid();
+
+    ShmPublisher<Msg> publisher(name.str(), 1024);
+    ShmConnection<Msg> connection(name.str());
+    std::shared_ptr<ShmSubscriber<Msg>> client(connection.NewClient());
+    std::vector<long> latencies;
+    latencies.reserve(count);
+    std::atomic<size_t> received(0);
+
+    std::thread consumer([&] () -> void {
+        Parker parker;
+        std::atomic<bool> notified(false);
+        auto ready = [&notified] () -> bool { return notified.load(); };
+
+        Msg m;
+        while (received < count) {
+            if (client->GetNextMessage(m)) {
+                latencies.push_back(NowNS() - m.i);
+                ++received;
+            } else if (strategy.mode != WaitStrategy::BUSY_POLL) {
+                notified = false;
+                client->OnNextMessage([&] () -> void {
+                    notified = true;
+                    parker.Wake();
+                });
+                parker.Wait(strategy, ready);
+            }
+        }
+    });
+
+    for (size_t i = 0; i < count; ++i) {
+        Pace(received, i);
+        publisher.Publish(Msg{NowNS(),0,0,0.0});
+    }
+
+    consumer.join();
+
+    return latencies;
+}
+
+void LatencyHeader(const std::string& title) {
+    latencyTable = true;
+    cout << "| ";
+    cout << setw(50) << left << title;
+    cout << " | ";
+    cout << left << setw(22) << "Samples";
+    const char* percentiles[] = {
+        "p50 (ns)", "p90 (ns)", "p99 (ns)", "p99.9 (ns)", "max (ns)"};
+    for (const char* percentile: percentiles) {
+        cout << " | ";
+        cout << setw(14) << left << percentile;
+    }
+    cout << " |";
+    cout << endl;
+    Footer();
+}
+
+/**
+ * Print the latency percentiles, and record them in the results file (one
+ * row per percentile, so that runs may be compared by compareTwo).
+ */
+void ReportLatency(const std::string& name, const LatencyHistogram& latency) {
+    struct Column {
+        const char* suffix;
+        long        value;
+    };
+
+    const Column columns[] = {
+        {" (p50 ns)",   static_cast<long>(latency.Percentile(50))},
+        {" (p90 ns)",   static_cast<long>(latency.Percentile(90))},
+        {" (p99 ns)",   static_cast<long>(latency.Percentile(99))},
+        {" (p99.9 ns)", static_cast<long>(latency.Percentile(99.9))},
+        {" (max ns)",   static_cast<long>(latency.Max())}
+    };
+
+    cout << "| ";
+    cout << setw(50) << left << name;
+    cout << " | ";
+    cout << left << setw(22) << latency.Count();
+    for (const Column& column: columns) {
+        cout << " | ";
+        cout << setw(14) << left << column.value;
+        results.AddRow(name + column.suffix, column.value+0);
+    }
+    cout << " |";
+    cout << endl;
+}
+
+void DoLatencyTest(const std::string& name,
+                   size_t n,
+                   const WaitStrategy& strategy,
+                   LatencyTest f)
+{
+    LatencyHistogram histogram;
+    for (long latency: f(n, strategy)) {
+        histogram.Record(latency);
+    }
+
+    ReportLatency(name, histogram);
+}
@@ -0,0 +1,139 @@
+#include <WorkerThread.h>
+#include <util_time.h>
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+
+using namespace std;
+
+const size_t postsPerProducer = 100000;
+const size_t maxProducers = 8;
+const size_t accountingRuns = 5;
+
+/**
+ * Post postsPerProducer tasks from each of the producer threads, and wait
+ * for the worker to execute them all.
+ *
+ * @param stats  Enable the worker's task accounting
+ *
+ * @returns the total number of posts per second
+ */
+double PostsPerSecond(size_t producers, bool stats = false) {
+    WorkerThread worker;
+    worker.EnableStats(stats);
+    std::atomic<size_t> count(0);
+    std::vector<std::thread> threads;
+    std::atomic<bool> go(false);
+
+    worker.Start();
+
+    for (size_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&] () -> void {
+            while (!go) {
+                std::this_thread::yield();
+            }
+            for (size_t i = 0; i < postsPerProducer; ++i) {
+                worker.PostTask([&count] () -> void {
+                    count.store(count.load(std::memory_order_relaxed) + 1,
+                                std::memory_order_relaxed);
+                });
+            }
+        });
+    }
+
+    Time start;
+    go = true;
+
+    for (std::thread& t: threads) {
+        t.join();
+    }
+    worker.DoTask([] () -> void { });
+
+    Time end;
+
+    const double secs = end.DiffUSecs(start) / 1e6;
+    const size_t posts = count.load();
+
+    if (posts != producers * postsPerProducer) {
+        cout << "Invalid number of tasks executed: " << posts << endl;
+        return 0;
+    }
+
+    return posts / secs;
+}
+
+/**
+ * Cost of a task, in ns, split between the posting thread and the worker.
+ *
+ * The tasks are all posted before the worker is started, so that the two
+ * are measured separately rather than fighting over the CPU.
+ */
+struct TaskCost {
+    double postNs;
+    double runNs;
+};
+
+TaskCost CostPerTask(bool stats) {
+    WorkerThread worker(2 * postsPerProducer);
+    worker.EnableStats(stats);
+    size_t count = 0;
+
+    Time start;
+    for (size_t i = 0; i < postsPerProducer; ++i) {
+        worker.PostTask([&count] () -> void { ++count; });
+    }
+    Time posted;
+
+    worker.Start();
+    worker.DoTask([] () -> void { });
+    Time end;
+
+    TaskCost cost;
+    cost.postNs = posted.DiffUSecs(start) * 1000.0 / postsPerProducer;
+    cost.runNs = end.DiffUSecs(posted) * 1000.0 / postsPerProducer;
+
+    return cost;
+}
+
+int main(int argc, const char *argv[])
+{
+    cout << "WorkerThread::PostTask throughput" << endl;
+    for (size_t producers = 1; producers <= maxProducers; ++producers) {
+        const double rate = PostsPerSecond(producers);
+        cout << "  " << producers << " producer(s): "
+             << static_cast<long>(rate) << " posts / second" << endl;
+
+        if (rate == 0) {
+            return 1;
+        }
+    }
+
+    /**
+     * The overhead is small next to the noise between runs, so compare the
+     * best of several runs of each.
+     */
+    TaskCost plain = {1e9, 1e9};
+    TaskCost accounted = {1e9, 1e9};
+    for (size_t run = 0; run < accountingRuns; ++run) {
+        const TaskCost plainRun = CostPerTask(false);
+        const TaskCost accountedRun = CostPerTask(true);
+
+        plain.postNs = std::min(plain.postNs, plainRun.postNs);
+        plain.runNs = std::min(plain.runNs, plainRun.runNs);
+        accounted.postNs = std::min(accounted.postNs, accountedRun.postNs);
+        accounted.runNs = std::min(accounted.runNs, accountedRun.runNs);
+    }
+
+    const double plainNs = plain.postNs + plain.runNs;
+    const double accountedNs = accounted.postNs + accounted.runNs;
+
+    cout << "Task accounting overhead (best of " << accountingRuns << ")"
+         << endl;
+    cout << "  Without accounting: " << plain.postNs << "ns to post, "
+         << plain.runNs << "ns to run" << endl;
+    cout << "  With accounting: " << accounted.postNs << "ns to post, "
+         << accounted.runNs << "ns to run" << endl;
+    cout << "  Overhead: " << (accountedNs - plainNs) << "ns / task" << endl;
+
+    return 0;
+}
@@ -0,0 +1,93 @@
+/*
+ * BlockPool.cpp
+ *
+ *  Created on: 16th October 2026
+ */
+
+#include "BlockPool.h"
+
+namespace {
+    const size_t NUM_SIZES =
+        BlockPool::MAX_POOLED_SIZE / BlockPool::BLOCK_GRANULARITY;
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    /**
+     * Blocks may still be freed by other thread_local destructors after the
+     * cache has been torn down: these go straight back to the heap.
+     */
+    thread_local bool cacheDestroyed = false;
+
+    struct Cache {
+        Cache() : heads(), counts() { }
+
+        ~Cache() {
+            cacheDestroyed = true;
+            for (size_t i = 0; i < NUM_SIZES; ++i) {
+                while (heads[i]) {
+                    FreeBlock* block = heads[i];
+                    heads[i] = block->next;
+                    ::operator delete(block);
+                }
+            }
+        }
+
+        FreeBlock* heads[NUM_SIZES];
+        size_t     counts[NUM_SIZES];
+    };
+
+    thread_local Cache cache;
+
+    size_t SizeIndex(size_t bytes) {
+        return (bytes == 0) ? 0 : (bytes - 1) / BlockPool::BLOCK_GRANULARITY;
+    }
+}
+
+void* BlockPool::Allocate(size_t bytes) {
+    void* block = nullptr;
+
+    if (bytes <= MAX_POOLED_SIZE) {
+        const size_t idx = SizeIndex(bytes);
+        if (!cacheDestroyed && cache.heads[idx]) {
+            FreeBlock*& head = cache.heads[idx];
+            block = head;
+            head = head->next;
+            --cache.counts[idx];
+        } else {
+            block = ::operator new((idx + 1) * BLOCK_GRANULARITY);
+        }
+    } else {
+        block = ::operator new(bytes);
+    }
+
+    return block;
+}
+
+void BlockPool::Free(void* block, size_t bytes) {
+    if (block) {
+        const size_t idx = SizeIndex(bytes);
+        if (bytes <= MAX_POOLED_SIZE &&
+            !cacheDestroyed &&
+            cache.counts[idx] < MAX_CACHED_BLOCKS)
+        {
+            FreeBlock* freeBlock = static_cast<FreeBlock*>(block);
+            freeBlock->next = cache.heads[idx];
+            cache.heads[idx] = freeBlock;
+            ++cache.counts[idx];
+        } else {
+            ::operator delete(block);
+        }
+    }
+}
+
+size_t BlockPool::CachedBlocks() {
+    size_t cached = 0;
+    if (!cacheDestroyed) {
+        for (size_t i = 0; i < NUM_SIZES; ++i) {
+            cached += cache.counts[i];
+        }
+    }
+    return cached;
+}
@@ -0,0 +1,80 @@
+/*
+ * Per-thread cache of small memory blocks
+ *
+ *  Created on: 16th October 2026
+ */
+
+#ifndef DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_BLOCK_POOL_H__
+#define DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_BLOCK_POOL_H__
+
+#include <cstddef>
+#include <new>
+
+/**
+ * Allocator for the small, short lived objects created on each asynchronous
+ * hop (future states, continuations).
+ *
+ * Blocks are rounded up to a multiple of BLOCK_GRANULARITY. Each thread keeps
+ * a free list per block size: freeing a block pushes it onto the free list
+ * of the *freeing* thread, and allocating pops from the allocating thread's
+ * list. Neither requires any synchronisation.
+ *
+ * A block allocated on one thread and freed on another (the usual case for a
+ * hop between event loops) migrates to the freeing thread. To stop a thread
+ * which only ever frees from hoarding memory, each free list is capped at
+ * MAX_CACHED_BLOCKS; beyond that blocks are returned to the heap.
+ *
+ * Blocks larger than MAX_POOLED_SIZE are passed straight through to the heap.
+ */
+namespace BlockPool {
+    const size_t BLOCK_GRANULARITY = 64;
+    const size_t MAX_POOLED_SIZE = 512;
+    const size_t MAX_CACHED_BLOCKS = 1024;
+
+    void* Allocate(size_t bytes);
+
+    /**
+     * Release a block from Allocate. bytes must be the size it was
+     * allocated with.
+     */
+    void Free(void* block, size_t bytes);
+
+    /**
+     * Number of free blocks cached by the calling thread.
+     */
+    size_t CachedBlocks();
+}
+
+/**
+ * STL allocator for the BlockPool, e.g for std::allocate_shared
+ */
+template <class T>
+class BlockPoolAllocator {
+public:
+    typedef T value_type;
+
+    BlockPoolAllocator() { }
+
+    template <class U>
+    BlockPoolAllocator(const BlockPoolAllocator<U>& ) { }
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(BlockPool::Allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) {
+        BlockPool::Free(p, n * sizeof(T));
+    }
+
+    template <class U>
+    bool operator==(const BlockPoolAllocator<U>& ) const {
+        return true;
+    }
+
+    template <class U>
+    bool operator!=(const BlockPoolAllocator<U>& ) const {
+        return false;
+    }
+};
+
+#endif
@@ -0,0 +1,172 @@
+/*
+ * Fixed size, lock-free, multi-producer queue
+ *
+ *  Created on: 16th October 2026
+ */
+
+#ifndef DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_BOUNDED_QUEUE_H__
+#define DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_BOUNDED_QUEUE_H__
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
+/**
+ * Pre-allocated ring of items, each cell carrying its own sequence number so
+ * that producers (and consumers) only ever contend on a single CAS of the
+ * relevant cursor. No memory is allocated after construction.
+ *
+ * Although intended to be drained by a single consumer, it is safe for any
+ * thread to pop from the queue (e.g. to cancel outstanding items).
+ *
+ * T must be default constructible, and move assignable.
+ */
+template <class T>
+class BoundedQueue {
+public:
+    /**
+     * @param size  Minimum capacity, rounded up to a power of two.
+     */
+    BoundedQueue(size_t size)
+        : mask(RoundUp(size) - 1),
+          cells(new Cell[mask + 1]),
+          enqueuePos(0),
+          dequeuePos(0)
+    {
+        for (size_t i = 0; i <= mask; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Push a new item on to the queue.
+     *
+     * @param item  The item to push. It is only moved from if the push
+     *              succeeds.
+     *
+     * @returns false if the queue was full.
+     */
+    bool TryPush(T&& item) {
+        Cell* cell = nullptr;
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        bool full = false;
+
+        while (!cell && !full) {
+            Cell& candidate = cells[pos & mask];
+            const size_t seq = candidate.sequence.load(std::memory_order_acquire);
+            const intptr_t diff = intptr_t(seq) - intptr_t(pos);
+
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed))
+                {
+                    cell = &candidate;
+                }
+            } else if (diff < 0) {
+                full = true;
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        if (cell) {
+            cell->data = std::move(item);
+            cell->sequence.store(pos + 1, std::memory_order_release);
+        }
+
+        return (cell != nullptr);
+    }
+
+    /**
+     * Pop the next item from the queue.
+     *
+     * @param item  Populated with the item, if there was one.
+     *
+     * @returns false if the queue was empty.
+     */
+    bool TryPop(T& item) {
+        Cell* cell = nullptr;
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        bool empty = false;
+
+        while (!cell && !empty) {
+            Cell& candidate = cells[pos & mask];
+            const size_t seq = candidate.sequence.load(std::memory_order_acquire);
+            const intptr_t diff = intptr_t(seq) - intptr_t(pos + 1);
+
+            if (diff == 0) {
+                if (dequeuePos.compare_exchange_weak(
+                        pos, pos + 1, std::memory_order_relaxed))
+                {
+                    cell = &candidate;
+                }
+            } else if (diff < 0) {
+                empty = true;
+            } else {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        if (cell) {
+            item = std::move(cell->data);
+            // Don't keep anything the item owned alive until the slot is
+            // re-used
+            cell->data = T();
+            cell->sequence.store(pos + mask + 1, std::memory_order_release);
+        }
+
+        return (cell != nullptr);
+    }
+
+    /**
+     * Check if there is an item ready to be popped.
+     *
+     * NOTE: This is only a snapshot, and may be immediately out of date if
+     *       other threads are pushing / popping.
+     */
+    bool Empty() const {
+        const size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        const size_t seq = cells[pos & mask].sequence.load(std::memory_order_acquire);
+        return (seq != pos + 1);
+    }
+
+    size_t Capacity() const {
+        return mask + 1;
+    }
+
+    /**
+     * Approximate number of items on the queue: as for Empty, this is only a
+     * snapshot. Items still being pushed are included.
+     */
+    size_t Size() const {
+        const size_t popped = dequeuePos.load(std::memory_order_relaxed);
+        const size_t pushed = enqueuePos.load(std::memory_order_relaxed);
+        return (pushed > popped) ? pushed - popped : 0;
+    }
+
+private:
+    static size_t RoundUp(size_t size) {
+        size_t rounded = 1;
+        while (rounded < size) {
+            rounded <<= 1;
+        }
+        return rounded;
+    }
+
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T                   data;
+    };
+
+    const size_t             mask;
+    std::unique_ptr<Cell[]>  cells;
+
+    // Keep the cursors away from each other, and any neighbouring data
+    char                     pad1[64];
+    std::atomic<size_t>      enqueuePos;
+    char                     pad2[64];
+    std::atomic<size_t>      dequeuePos;
+    char                     pad3[64];
+};
+
+#endif
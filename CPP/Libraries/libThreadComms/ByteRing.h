@@ -0,0 +1,132 @@
+/*
+ * Storage shared between a ByteRingPublisher and its subscribers
+ *
+ *  Created on: 16th October 2026
+ */
+
+#ifndef DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_BYTE_RING_H__
+#define DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_BYTE_RING_H__
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+
+/**
+ * Pre-allocated ring of variable length records, with a single write cursor.
+ *
+ * Cursors are byte offsets, which only ever increase. Each record is an 8 byte
+ * header (the payload length), followed by the payload, padded to the next 8
+ * bytes. A record never wraps around the end of the ring: if it would, the
+ * publisher first writes a padding record to fill the rest of the ring.
+ *
+ * As for the RingBuffer, synchronisation with the readers is left to the
+ * publisher: it must not wrap over unread data.
+ */
+class ByteRing {
+public:
+    struct RecordHeader {
+        uint32_t size;    // Payload bytes, or bytes to skip for padding
+        uint32_t flags;
+    };
+
+    enum FLAGS {
+        PADDING = 0x1    // Skip to the start of the ring
+    };
+
+    static const size_t ALIGNMENT = sizeof(RecordHeader);
+
+    /**
+     * @param size  Minimum number of bytes, rounded up to a power of two.
+     */
+    ByteRing(size_t size)
+        : ring(RoundUp(size) / ALIGNMENT),
+          mask(ring.size() * ALIGNMENT - 1),
+          writeCursor(0)
+    {
+    }
+
+    /**
+     * Number of bytes in the ring
+     */
+    size_t Size() const {
+        return mask + 1;
+    }
+
+    /**
+     * The largest payload which may be published: half the ring, so that
+     * a record (and any padding in front of it) always fits.
+     */
+    size_t MaxMessageSize() const {
+        return Size() / 2 - sizeof(RecordHeader);
+    }
+
+    /**
+     * Bytes taken up by a record with a payload of size bytes
+     */
+    static size_t RecordSize(size_t size) {
+        return (sizeof(RecordHeader) + size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    }
+
+    /**
+     * The record at the (aligned) byte offset pos
+     */
+    RecordHeader& Header(uint64_t pos) {
+        return *reinterpret_cast<RecordHeader*>(Data(pos));
+    }
+
+    const RecordHeader& Header(uint64_t pos) const {
+        return *reinterpret_cast<const RecordHeader*>(Data(pos));
+    }
+
+    char* Payload(uint64_t pos) {
+        return Data(pos) + sizeof(RecordHeader);
+    }
+
+    const char* Payload(uint64_t pos) const {
+        return Data(pos) + sizeof(RecordHeader);
+    }
+
+    /**
+     * The next byte to be written: all records before this one may be read.
+     */
+    uint64_t WriteCursor() const {
+        return writeCursor.load();
+    }
+
+    /**
+     * Mark all records up to (but not including) pos as readable.
+     *
+     * NOTE: Only the publisher thread may call this.
+     */
+    void Commit(uint64_t pos) {
+        writeCursor.store(pos);
+    }
+
+private:
+    static size_t RoundUp(size_t size) {
+        size_t rounded = 4 * ALIGNMENT;
+        while (rounded < size) {
+            rounded <<= 1;
+        }
+        return rounded;
+    }
+
+    char* Data(uint64_t pos) {
+        return reinterpret_cast<char*>(ring.data()) + (pos & mask);
+    }
+
+    const char* Data(uint64_t pos) const {
+        return reinterpret_cast<const char*>(ring.data()) + (pos & mask);
+    }
+
+    // Stored as words, to keep the headers aligned
+    std::vector<uint64_t>    ring;
+    const uint64_t           mask;
+
+    // Keep the cursor away from any neighbouring data
+    char                     pad1[64];
+    std::atomic<uint64_t>    writeCursor;
+    char                     pad2[64];
+};
+
+#endif
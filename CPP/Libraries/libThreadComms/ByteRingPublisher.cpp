@@ -0,0 +1,210 @@
+/*
+ * ByteRingPublisher.cpp
+ *
+ *  Created on: 16th October 2026
+ */
+
+#include "ByteRingPublisher.h"
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+ByteRingPublisher::ByteRingPublisher(size_t size)
+   : ring(new ByteRing(size)),
+     gatingPosition(0),
+     batching(false),
+     clientsReaped(false),
+     nextClients(nullptr),
+     numClients(0)
+{
+}
+
+ByteRingPublisher::~ByteRingPublisher()
+{
+    EndBatch();
+    delete nextClients.exchange(nullptr);
+}
+
+std::shared_ptr<ByteRingSubscriber> ByteRingPublisher::NewClient() {
+    std::unique_lock<std::mutex> lock(subscriptionMutex);
+
+    /**
+     * The publisher can not have wrapped past the current write cursor, so it
+     * is safe to start reading from here, even before the publication thread
+     * has picked up the new client.
+     */
+    ClientRef client(new ByteRingSubscriber(ring, ring->WriteCursor()));
+    subscriptions.push_back(client);
+    PublishClientList();
+
+    return client;
+}
+
+void ByteRingPublisher::Publish(const char* data, size_t size) {
+    if (size > ring->MaxMessageSize()) {
+        throw MessageTooLargeException{
+            "Message of " + std::to_string(size) + " bytes can not fit in a ring of " +
+            std::to_string(ring->Size()) + " bytes"};
+    }
+
+    UpdateClientList();
+
+    uint64_t pos = ring->WriteCursor();
+    const size_t record = ByteRing::RecordSize(size);
+    const size_t offset = pos & (ring->Size() - 1);
+
+    // Records may not wrap: skip to the start of the ring if necessary
+    const size_t padding = (offset + record > ring->Size())
+                              ? ring->Size() - offset
+                              : 0;
+    const uint64_t end = pos + padding + record;
+
+    if (end - gatingPosition > ring->Size()) {
+        gatingPosition = WaitForSpace(end);
+    }
+
+    if (padding) {
+        ByteRing::RecordHeader& skip = ring->Header(pos);
+        skip.size = static_cast<uint32_t>(padding);
+        skip.flags = ByteRing::PADDING;
+        pos += padding;
+    }
+
+    ByteRing::RecordHeader& header = ring->Header(pos);
+    header.size = static_cast<uint32_t>(size);
+    header.flags = 0;
+    memcpy(ring->Payload(pos), data, size);
+
+    ring->Commit(end);
+
+    for (auto it = clients.begin(); it != clients.end();) {
+        ClientRef& client = *it;
+
+        if (!batching && Reapable(client))
+        {
+            it = clients.erase(it);
+            clientsReaped = true;
+        }
+        else
+        {
+            client->OnPublish();
+            ++it;
+        }
+    }
+
+    ReleaseClients();
+}
+
+uint64_t ByteRingPublisher::WaitForSpace(uint64_t end) {
+    const uint64_t written = ring->WriteCursor();
+    uint64_t minPos = written;
+    bool full = true;
+
+    while (full) {
+        minPos = written;
+        for (ClientRef& client: clients) {
+            if (!Reapable(client)) {
+                minPos = std::min(minPos, client->ReadCursor());
+            }
+        }
+
+        full = (end - minPos > ring->Size());
+
+        if (full) {
+            if (batching) {
+                // Deferred notifications may be what the slow client is
+                // waiting on...
+                for (ClientRef& client: clients) {
+                    client->EndBatch();
+                    client->StartBatch();
+                }
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    return minPos;
+}
+
+void ByteRingPublisher::StartBatch() {
+    EndBatch();
+    UpdateClientList();
+
+    batching = true;
+    for (ClientRef& client: clients) {
+        client->StartBatch();
+    }
+}
+
+void ByteRingPublisher::EndBatch() {
+    if (batching) {
+        batching = false;
+        for (ClientRef& client: clients) {
+            client->EndBatch();
+        }
+    }
+}
+
+size_t ByteRingPublisher::NumClients() {
+    return numClients;
+}
+
+void ByteRingPublisher::UpdateClientList() {
+    if (nextClients.load(std::memory_order_acquire)) {
+        std::unique_ptr<ClientList> next(
+            nextClients.exchange(nullptr, std::memory_order_acq_rel));
+
+        if (next.get()) {
+            if (batching) {
+                for (ClientRef& client: *next) {
+                    if (std::find(clients.begin(), clients.end(), client) == clients.end()) {
+                        client->StartBatch();
+                    }
+                }
+
+                for (ClientRef& client: clients) {
+                    if (std::find(next->begin(), next->end(), client) == next->end()) {
+                        client->EndBatch();
+                    }
+                }
+            }
+
+            clients.swap(*next);
+        }
+    }
+}
+
+void ByteRingPublisher::PublishClientList() {
+    PruneSubscriptions();
+
+    std::unique_ptr<ClientList> next(new ClientList(subscriptions));
+
+    delete nextClients.exchange(next.release(), std::memory_order_acq_rel);
+}
+
+bool ByteRingPublisher::Reapable(const ClientRef& client) {
+    /**
+     * The subscription list, and our snapshot, hold a reference each.
+     */
+    return (client->Aborted() || client.use_count() <= 2);
+}
+
+void ByteRingPublisher::ReleaseClients() {
+    if (clientsReaped && subscriptionMutex.try_lock()) {
+        PruneSubscriptions();
+        clientsReaped = false;
+        subscriptionMutex.unlock();
+    }
+}
+
+void ByteRingPublisher::PruneSubscriptions() {
+    for (auto it = subscriptions.begin(); it != subscriptions.end();) {
+        if ((*it)->Aborted() || it->unique()) {
+            it = subscriptions.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    numClients = subscriptions.size();
+}
@@ -0,0 +1,171 @@
+/*
+ * Publish variable length messages to multiple consumers via a single shared
+ * ring of bytes
+ *
+ *  Created on: 16th October 2026
+ */
+
+#ifndef DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_BYTE_RING_PUBLISHER_H__
+#define DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_BYTE_RING_PUBLISHER_H__
+
+#include <ByteRingSubscriber.h>
+#include <ByteRing.h>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <memory>
+
+/**
+ * Variant of the RingPublisher for variable length messages, e.g serialized
+ * JSON.
+ *
+ * A PipePublisher<std::string> copies (and so allocates) each message once
+ * per client. Here each message is copied exactly once, as a length prefixed
+ * record, into a single pre-allocated ring of bytes, and clients read it in
+ * place. Publishing allocates nothing.
+ *
+ * As for the RingPublisher, the ring is never allowed to wrap over unread
+ * data: if it is full, the publisher will wait for the slowest consumer to
+ * catch up.
+ */
+class ByteRingPublisher {
+public:
+    /**
+     * The message can never fit in the ring, see MaxMessageSize
+     */
+    struct MessageTooLargeException {
+        std::string msg;
+    };
+
+    /**
+     * Create a new publisher
+     *
+     * @param size   The number of bytes in the ring. This will be rounded up
+     *               to the next power of two.
+     */
+    ByteRingPublisher(size_t size);
+
+    virtual ~ByteRingPublisher();
+
+    /**
+     * Create a new subscription to the publisher. The client will receive all
+     * messages published after this call returns.
+     */
+    std::shared_ptr<ByteRingSubscriber> NewClient();
+
+    /**
+     * Copy a new message into the ring, and notify all clients.
+     *
+     * NOTE: Only one thread may publish.
+     *
+     * @param data   The start of the message
+     * @param size   The length of the message, in bytes. A
+     *               MessageTooLargeException is thrown if this is larger than
+     *               MaxMessageSize.
+     */
+    void Publish(const char* data, size_t size);
+
+    void Publish(const std::string& msg) {
+        Publish(msg.data(), msg.size());
+    }
+
+    /**
+     * Start a new batch of messages.
+     *
+     * As for RingPublisher, unread message notifications will be deferred
+     * until the batch is completed, unless the publisher is forced to wait on
+     * a client.
+     *
+     * EndBatch MUST be called on completion of the batch.
+     */
+    void StartBatch();
+
+    /**
+     * End the current batch.
+     *
+     * If there is not currently a batch being processed, this call has no
+     * effect.
+     */
+    void EndBatch();
+
+    size_t NumClients();
+
+    /**
+     * Number of bytes in the ring
+     */
+    size_t Size() const { return ring->Size(); }
+
+    /**
+     * The largest message which may be published
+     */
+    size_t MaxMessageSize() const { return ring->MaxMessageSize(); }
+private:
+    typedef std::shared_ptr<ByteRingSubscriber> ClientRef;
+    typedef std::vector<ClientRef> ClientList;
+
+    /**
+     * Adopt the most recent snapshot of the client list, see PipePublisher.
+     *
+     * This is done on every publish, even mid-batch: a new client must be
+     * gated on as soon as it has subscribed. Clients which join (or leave)
+     * the list mid-batch are moved into (or out of) the batch.
+     *
+     * MUST only be called from the publication thread.
+     */
+    void UpdateClientList();
+
+    /**
+     * Hand a new snapshot of the client list to the publication thread.
+     *
+     * MUST be called under the subscription lock.
+     */
+    void PublishClientList();
+
+    /**
+     * Check if the client has aborted, or we hold the only remaining
+     * references to it.
+     */
+    bool Reapable(const ClientRef& client);
+
+    /**
+     * Drop any reaped clients from the subscription list, if the subscription
+     * lock is free.
+     *
+     * MUST only be called from the publication thread.
+     */
+    void ReleaseClients();
+
+    /**
+     * Drop dead clients from the subscription list.
+     *
+     * MUST be called under the subscription lock.
+     */
+    void PruneSubscriptions();
+
+    /**
+     * Wait until every client has read up to the point that the ring may be
+     * written up to (but not including) end.
+     *
+     * @returns The new gating position
+     */
+    uint64_t WaitForSpace(uint64_t end);
+
+    /*********************************
+     *           Data
+     *********************************/
+    std::shared_ptr<ByteRing>          ring;
+
+    // Owned by the publication thread
+    uint64_t                           gatingPosition;
+    bool                               batching;
+    bool                               clientsReaped;
+    ClientList                         clients;
+
+    std::mutex                         subscriptionMutex;
+    ClientList                         subscriptions;
+    std::atomic<ClientList*>           nextClients;
+    std::atomic<size_t>                numClients;
+};
+
+#endif
@@ -0,0 +1,188 @@
+/*
+ * ByteRingSubscriber.cpp
+ *
+ *  Created on: 16th October 2026
+ */
+
+#include "ByteRingSubscriber.h"
+#include <IPostable.h>
+
+ByteRingSubscriber::ByteRingSubscriber(
+    std::shared_ptr<ByteRing> _ring,
+    uint64_t start)
+        : onNotify(nullptr),
+          targetToNotify(nullptr),
+          onNewMessage(nullptr),
+          ring(std::move(_ring)),
+          batching(false),
+          aborted(false),
+          nextRead(start),
+          readCursor(start)
+{
+    forwardMessage = false;
+    notifyOnMessage = false;
+}
+
+ByteRingSubscriber::~ByteRingSubscriber() {
+    aborted = true;
+    if (batching) {
+        ByteRingSubscriber::EndBatch();
+    }
+}
+
+void ByteRingSubscriber::Abort() {
+    aborted = true;
+}
+
+uint64_t ByteRingSubscriber::SkipPadding(uint64_t pos) const {
+    const ByteRing::RecordHeader& header = ring->Header(pos);
+    if (header.flags & ByteRing::PADDING) {
+        // Always committed along with the record which follows it
+        pos += header.size;
+    }
+
+    return pos;
+}
+
+bool ByteRingSubscriber::GetNextMessage(const char*& data, size_t& size) {
+    bool gotMsg = false;
+
+    if (!forwardMessage) {
+        Release();
+
+        if (nextRead < ring->WriteCursor()) {
+            const uint64_t pos = SkipPadding(nextRead);
+            const ByteRing::RecordHeader& header = ring->Header(pos);
+
+            data = ring->Payload(pos);
+            size = header.size;
+
+            // Held until the view is released
+            nextRead = pos + ByteRing::RecordSize(header.size);
+            gotMsg = true;
+        }
+    }
+
+    return gotMsg;
+}
+
+void ByteRingSubscriber::Release() {
+    if (readCursor.load(std::memory_order_relaxed) != nextRead) {
+        // The publisher may now re-use the space
+        readCursor.store(nextRead, std::memory_order_release);
+    }
+}
+
+void ByteRingSubscriber::OnPublish() {
+    /**
+     * Remember, only one thread is allowed to publish...
+     */
+    if ( forwardMessage ) {
+        if (batching) {
+            // Already locked...
+            ForwardMessages(onNewMessage);
+        } else {
+            Lock notifyLock(onNotifyMutex);
+            // No need to re-check post-lock since it is not possible to
+            // unset the onNewMessage callback
+            ForwardMessages(onNewMessage);
+        }
+    } else if (!batching && notifyOnMessage) {
+        Lock notifyLock(onNotifyMutex);
+        if (notifyOnMessage)
+        {
+            NotifyNextMessage();
+        }
+    }
+}
+
+void ByteRingSubscriber::ForwardMessages(const NewMessasgCallback& f) {
+    const uint64_t end = ring->WriteCursor();
+    uint64_t read = nextRead;
+
+    while (!aborted && read < end) {
+        const uint64_t pos = SkipPadding(read);
+        const ByteRing::RecordHeader& header = ring->Header(pos);
+
+        f(ring->Payload(pos), header.size);
+
+        read = pos + ByteRing::RecordSize(header.size);
+        nextRead = read;
+        readCursor.store(read, std::memory_order_release);
+    }
+}
+
+void ByteRingSubscriber::NotifyNextMessage() {
+    if (targetToNotify) {
+        targetToNotify->PostTask(onNotify);
+        targetToNotify = nullptr;
+    } else {
+        onNotify();
+    }
+    onNotify = nullptr;
+    notifyOnMessage = false;
+}
+
+void ByteRingSubscriber::OnNextMessage(const NextMessageCallback& f) {
+    this->OnNextMessage(f,nullptr);
+}
+
+void ByteRingSubscriber::OnNextMessage(
+         const NextMessageCallback& f,
+         IPostable* target)
+{
+    if (!aborted) {
+        Lock notifyLock(onNotifyMutex);
+
+        // We have the lock, so the publisher is now locked out.
+        notifyOnMessage = true;
+
+        if ( nextRead < ring->WriteCursor()) {
+            onNotify = nullptr;
+            targetToNotify = nullptr;
+            notifyOnMessage = false;
+            if (target) {
+                target->PostTask(f);
+            } else {
+                f();
+            }
+        } else {
+            onNotify = f;
+            targetToNotify = target;
+        }
+    }
+}
+
+void ByteRingSubscriber::OnNewMessage(const NewMessasgCallback& f) {
+    if (!aborted) {
+        Lock notifyLock(onNotifyMutex);
+
+        // Any view the client is holding is done with
+        Release();
+
+        forwardMessage = true;
+        onNewMessage = f;
+        ForwardMessages(f);
+    }
+}
+
+void ByteRingSubscriber::StartBatch() {
+    batching = true;
+    onNotifyMutex.lock();
+}
+
+void ByteRingSubscriber::EndBatch() {
+    if (batching) {
+        batching = false;
+
+        // Publisher thread: nextRead belongs to the client
+        bool unread =
+            (readCursor.load(std::memory_order_relaxed) < ring->WriteCursor());
+
+        if (notifyOnMessage && unread) {
+            NotifyNextMessage();
+        }
+
+        onNotifyMutex.unlock();
+    }
+}
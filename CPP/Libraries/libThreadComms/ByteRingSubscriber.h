@@ -0,0 +1,168 @@
+/*
+ * Subscribe to updates from the Byte Ring Publisher
+ *
+ *  Created on: 16th October 2026
+ */
+
+#ifndef DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_BYTE_RING_SUBSCRIBER_H__
+#define DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_BYTE_RING_SUBSCRIBER_H__
+
+#include <atomic>
+#include <mutex>
+#include <functional>
+#include <memory>
+#include <ByteRing.h>
+
+class ByteRingPublisher;
+class IPostable;
+
+/**
+ * Read cursor into a ByteRingPublisher's ring.
+ *
+ * Messages are read in place, as a pointer / length view of the ring: nothing
+ * is copied, or allocated. The consumer side API otherwise matches the
+ * RingSubscriber.
+ */
+class ByteRingSubscriber {
+public:
+    virtual ~ByteRingSubscriber();
+
+    /**
+     * Read the next message from the ring.
+     *
+     * The view remains valid until the next call to GetNextMessage (or
+     * Release): until then the publisher will not write over it. A client
+     * which holds on to a view will therefore hold up the publisher.
+     *
+     * @param data   Populated with the start of the message
+     * @param size   Populated with the length of the message, in bytes
+     *
+     * @returns true if a message was read, false otherwise (data and size
+     *          are left unchanged).
+     */
+    bool GetNextMessage(const char*& data, size_t& size);
+
+    /**
+     * Hand the last message read by GetNextMessage back to the publisher,
+     * without reading the next one.
+     */
+    void Release();
+
+    /**
+     * Trigger a callback function ON **ETIHER** the publisher thread OR the
+     * current thread when there is at least one unread message.
+     *
+     * See PipeSubscriber::OnNextMessage
+     */
+    typedef std::function<void(void)> NextMessageCallback;
+    void OnNextMessage(const NextMessageCallback& f);
+
+    /**
+     * Variant of the OnNextMessage callback which posts the task to another
+     * event loop.
+     *
+     *  @param  f          The callback to trigger
+     *  @param  target     The object to post the task to.
+     */
+    void OnNextMessage(const NextMessageCallback& f, IPostable* target);
+
+    /**
+     * Trigger a callback function for each new message received by the
+     * subsciber. The function will be called from the **PUBLISHER THREAD**,
+     * and the view is only valid for the duration of the call.
+     *
+     * See PipeSubscriber::OnNewMessage
+     */
+    typedef std::function<void(const char* data, size_t size)> NewMessasgCallback;
+    void OnNewMessage(const NewMessasgCallback&  f);
+
+    /**
+     * Stop consuming updates: the client will no longer hold up the
+     * publisher.
+     *
+     * MUST be called from the client thread.
+     */
+    void Abort();
+
+protected:
+    friend class ByteRingPublisher;
+
+    ByteRingSubscriber(std::shared_ptr<ByteRing> ring, uint64_t start);
+
+    /*********************************
+     *   Interface for Publisher
+     *********************************/
+    /**
+     * Called by the publisher, once a new message has been committed to the
+     * ring.
+     */
+    void OnPublish();
+
+    void StartBatch();
+    void EndBatch();
+
+    /**
+     * The oldest byte this client will hold up the publisher on.
+     */
+    uint64_t ReadCursor() const {
+        return readCursor.load(std::memory_order_acquire);
+    }
+
+    bool Aborted() const {
+        return aborted.load(std::memory_order_relaxed);
+    }
+
+private:
+    void NotifyNextMessage();
+
+    /**
+     * Skip over any padding at pos
+     *
+     * @returns The start of the next record to read
+     */
+    uint64_t SkipPadding(uint64_t pos) const;
+
+    /**
+     * Forward all unread messages to the onNewMessage callback. MUST be
+     * called under lock.
+     */
+    void ForwardMessages(const NewMessasgCallback& f);
+
+    /***********************************
+     *          Synchronisation
+     ***********************************/
+    typedef std::unique_lock<std::mutex> Lock;
+    std::mutex                           onNotifyMutex;
+
+    /***********************************
+     * Unread data Notification
+     ***********************************/
+    NextMessageCallback  onNotify;
+    IPostable*           targetToNotify;
+    std::atomic<bool>    notifyOnMessage;
+
+    /***********************************
+     * Forward Messages
+     ***********************************/
+    NewMessasgCallback   onNewMessage;
+    std::atomic<bool>    forwardMessage;
+
+    /*********************************
+     *           Data
+     *********************************/
+    std::shared_ptr<ByteRing>            ring;
+    bool                                 batching;
+    std::atomic<bool>                    aborted;
+
+    /**
+     * The end of the last message read by the client (the start of the next
+     * one). The read cursor lags behind it until the view is released.
+     */
+    uint64_t                             nextRead;
+
+    char                                 pad1[64];
+    std::atomic<uint64_t>                readCursor;
+    char                                 pad2[64];
+};
+
+#endif
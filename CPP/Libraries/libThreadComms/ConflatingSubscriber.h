@@ -0,0 +1,173 @@
+/*
+ * Subscribe to the latest value of each key published by a PipePublisher
+ *
+ *  Created on: 16th October 2026
+ */
+
+#ifndef DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_CONFLATING_SUBSCRIBER_H__
+#define DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_CONFLATING_SUBSCRIBER_H__
+
+#include <PipeSubscriber.h>
+#include <unordered_map>
+#include <type_traits>
+#include <vector>
+
+/**
+ * A last-value-cache consumer. Rather than queuing every update, the
+ * subscriber holds a single slot per key, along with a list of the keys which
+ * have been updated since they were last read.
+ *
+ * A slow consumer will therefore only ever see the latest update for each
+ * key, and memory is bounded by the number of keys, rather than the rate of
+ * publication.
+ *
+ * Keys are returned in the order they were first updated since they were last
+ * read.
+ *
+ * The consumer interface (GetNextMessage / OnNextMessage) matches
+ * PipeSubscriber, so the subscriber may be used with
+ * WorkerThread::ConsumeUpdates:
+ *
+ *   worker.ConsumeUpdates<ConflatingSubscriber<Msg,KeyFn>>(
+ *       publisher, task, maxSlizeSize, maxKeys);
+ *
+ * @param KeyFn   Functor to extract the key from a message. The key must be
+ *                usable as the key to a std::unordered_map.
+ */
+template <class Message, class KeyFn>
+class ConflatingSubscriber: public IPipeConsumer<Message> {
+public:
+    typedef ConflatingSubscriber<Message, KeyFn> Type;
+    typedef typename std::decay<
+        typename std::result_of<KeyFn(const Message&)>::type>::type Key;
+
+    /**
+     * Create a new consumer:
+     *
+     * @param parent   The publisher we are being installed to (unused)
+     * @param maxKeys  Maximum number of distinct keys. Slots are
+     *                 pre-allocated for every key.
+     * @param keyFn    Functor to extract the key from a message.
+     */
+    ConflatingSubscriber(
+        PipePublisher<Message>* parent,
+        size_t maxKeys,
+        KeyFn keyFn = KeyFn());
+
+    virtual ~ConflatingSubscriber() {}
+
+    /**
+     * Pop the latest value of the next updated key, and populate msg with the
+     * result.
+     *
+     * If there is no message to pop, msg is left unchanged
+     *
+     * @param msg   The message to populate.
+     *
+     * @returns true if msg was populated, false otherwise.
+     */
+    bool GetNextMessage(Message& msg);
+
+    /**
+     * Trigger a callback function ON **ETIHER** the publisher thread OR the
+     * current thread when there is at least one updated key.
+     *
+     * See PipeSubscriber::OnNextMessage
+     */
+    typedef std::function<void(void)> NextMessageCallback;
+    void OnNextMessage(const NextMessageCallback& f);
+
+    /**
+     * Variant of the OnNextMessage callback which posts the task to another
+     * event loop.
+     *
+     *  @param  f          The callback to trigger
+     *  @param  target     The object to post the task to.
+     */
+    void OnNextMessage(const NextMessageCallback& f, IPostable* target);
+
+    /**
+     * Number of keys with an unread update
+     */
+    size_t Pending();
+
+    /**
+     * Number of updates which were overwritten before they were read.
+     */
+    size_t ConflatedMessages() const {
+        return conflated.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Published if a message is received for a new key, but all slots have
+     * already been allocated.
+     */
+    struct TooManyKeysException {
+        Message msg;
+    };
+
+protected:
+    /*********************************
+     *   Interface for Publisher
+     *********************************/
+    virtual void PushMessage(const Message& msg);
+
+    virtual void StartBatch();
+
+    virtual void EndBatch();
+
+private:
+    typedef std::unique_lock<std::mutex> Lock;
+
+    /**
+     * Trigger the notification, if there is one pending. MUST be called under
+     * lock.
+     *
+     * @param f       Populated with the callback to trigger
+     * @param target  Populated with the target to post to
+     */
+    void TakeNotification(NextMessageCallback& f, IPostable*& target);
+
+    static void Notify(const NextMessageCallback& f, IPostable* target);
+
+    /**
+     * Find the slot for the key, allocating a new one if required.
+     *
+     * Only the publisher thread may call this
+     */
+    size_t Slot(const Message& msg);
+
+    struct KeySlot {
+        Message msg;
+        bool    dirty;
+    };
+
+    /***********************************
+     *    Publisher Thread Only
+     ***********************************/
+    KeyFn                           keyFn;
+    std::unordered_map<Key, size_t> index;
+    bool                            batching;
+
+    /***********************************
+     *    Shared, under conflationMutex
+     ***********************************/
+    std::mutex                      conflationMutex;
+    std::vector<KeySlot>            slots;
+
+    // Ring of slots with unread updates. Since each key may only appear
+    // once, this can never exceed the number of slots.
+    std::vector<size_t>             dirtyKeys;
+    size_t                          dirtyHead;
+    size_t                          dirtyCount;
+
+    NextMessageCallback             onNotify;
+    IPostable*                      targetToNotify;
+    bool                            notifyOnMessage;
+
+    std::atomic<size_t>             conflated;
+};
+
+#include "ConflatingSubscriber.hpp"
+
+#endif
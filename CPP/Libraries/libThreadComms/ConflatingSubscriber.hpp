@@ -0,0 +1,178 @@
+#include <IPostable.h>
+
+template <class Message, class KeyFn>
+ConflatingSubscriber<Message,KeyFn>::ConflatingSubscriber(
+    PipePublisher<Message>* parent,
+    size_t maxKeys,
+    KeyFn _keyFn)
+        : keyFn(_keyFn),
+          batching(false),
+          slots(maxKeys),
+          dirtyKeys(maxKeys),
+          dirtyHead(0),
+          dirtyCount(0),
+          onNotify(nullptr),
+          targetToNotify(nullptr),
+          notifyOnMessage(false),
+          conflated(0)
+{
+    index.reserve(maxKeys);
+}
+
+template <class Message, class KeyFn>
+size_t ConflatingSubscriber<Message,KeyFn>::Slot(const Message& msg) {
+    size_t slot = 0;
+    Key key = keyFn(msg);
+    auto it = index.find(key);
+
+    if (it != index.end()) {
+        slot = it->second;
+    } else if (index.size() < slots.size()) {
+        slot = index.size();
+        index.emplace(std::move(key), slot);
+    } else {
+        throw TooManyKeysException {msg};
+    }
+
+    return slot;
+}
+
+template <class Message, class KeyFn>
+void ConflatingSubscriber<Message,KeyFn>::PushMessage(const Message& msg) {
+    const size_t slot = Slot(msg);
+
+    NextMessageCallback f(nullptr);
+    IPostable* target = nullptr;
+    {
+        Lock lock(conflationMutex);
+        KeySlot& keySlot = slots[slot];
+        keySlot.msg = msg;
+
+        if (keySlot.dirty) {
+            // Only the publisher thread updates the counter
+            conflated.store(conflated.load(std::memory_order_relaxed) + 1,
+                            std::memory_order_relaxed);
+        } else {
+            keySlot.dirty = true;
+            dirtyKeys[(dirtyHead + dirtyCount) % dirtyKeys.size()] = slot;
+            ++dirtyCount;
+        }
+
+        if (!batching) {
+            TakeNotification(f, target);
+        }
+    }
+
+    // The callback is free to read from us, so it must be triggered
+    // outside the lock.
+    Notify(f, target);
+}
+
+template <class Message, class KeyFn>
+bool ConflatingSubscriber<Message,KeyFn>::GetNextMessage(Message& msg) {
+    bool gotMsg = false;
+    Lock lock(conflationMutex);
+
+    if (dirtyCount > 0) {
+        KeySlot& keySlot = slots[dirtyKeys[dirtyHead]];
+        dirtyHead = (dirtyHead + 1) % dirtyKeys.size();
+        --dirtyCount;
+
+        msg = keySlot.msg;
+        keySlot.dirty = false;
+        gotMsg = true;
+    }
+
+    return gotMsg;
+}
+
+template <class Message, class KeyFn>
+size_t ConflatingSubscriber<Message,KeyFn>::Pending() {
+    Lock lock(conflationMutex);
+    return dirtyCount;
+}
+
+template <class Message, class KeyFn>
+void ConflatingSubscriber<Message,KeyFn>::OnNextMessage(
+    const NextMessageCallback& f)
+{
+    this->OnNextMessage(f,nullptr);
+}
+
+template <class Message, class KeyFn>
+void ConflatingSubscriber<Message,KeyFn>::OnNextMessage(
+    const NextMessageCallback& f,
+    IPostable* target)
+{
+    if (this->State() == IPipeConsumer<Message>::CONSUMING) {
+        bool unread = false;
+        {
+            Lock lock(conflationMutex);
+            unread = (dirtyCount > 0);
+
+            if (unread) {
+                onNotify = nullptr;
+                targetToNotify = nullptr;
+                notifyOnMessage = false;
+            } else {
+                onNotify = f;
+                targetToNotify = target;
+                notifyOnMessage = true;
+            }
+        }
+
+        if (unread) {
+            Notify(f, target);
+        }
+    }
+}
+
+template <class Message, class KeyFn>
+void ConflatingSubscriber<Message,KeyFn>::StartBatch() {
+    batching = true;
+}
+
+template <class Message, class KeyFn>
+void ConflatingSubscriber<Message,KeyFn>::EndBatch() {
+    if (batching) {
+        batching = false;
+
+        NextMessageCallback f(nullptr);
+        IPostable* target = nullptr;
+        {
+            Lock lock(conflationMutex);
+            if (dirtyCount > 0) {
+                TakeNotification(f, target);
+            }
+        }
+
+        Notify(f, target);
+    }
+}
+
+template <class Message, class KeyFn>
+void ConflatingSubscriber<Message,KeyFn>::TakeNotification(
+    NextMessageCallback& f,
+    IPostable*& target)
+{
+    if (notifyOnMessage) {
+        f.swap(onNotify);
+        target = targetToNotify;
+        targetToNotify = nullptr;
+        notifyOnMessage = false;
+    }
+}
+
+template <class Message, class KeyFn>
+void ConflatingSubscriber<Message,KeyFn>::Notify(
+    const NextMessageCallback& f,
+    IPostable* target)
+{
+    if (f) {
+        if (target) {
+            target->PostTask(f);
+        } else {
+            f();
+        }
+    }
+}
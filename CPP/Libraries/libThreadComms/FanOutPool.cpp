@@ -0,0 +1,110 @@
+/*
+ * FanOutPool.cpp
+ *
+ *  Created on: 16th October 2026
+ */
+
+#include "FanOutPool.h"
+
+FanOutPool::FanOutPool(size_t count, const WaitStrategy& _strategy)
+    : strategy(_strategy),
+      generation(0),
+      current(nullptr),
+      stopping(false),
+      outstanding(0)
+{
+    helpers.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        helpers.emplace_back(new Helper);
+    }
+
+    // Only start once the list is complete, it must not be re-allocated under
+    // the helpers.
+    for (size_t i = 0; i < count; ++i) {
+        Helper& helper = *helpers[i];
+        helper.thread = std::thread([this, i, &helper] () -> void {
+            this->HelperLoop(i + 1, helper);
+        });
+    }
+}
+
+FanOutPool::~FanOutPool() {
+    stopping.store(true);
+    generation.fetch_add(1);
+
+    for (std::unique_ptr<Helper>& helper: helpers) {
+        helper->parker.Wake();
+    }
+
+    for (std::unique_ptr<Helper>& helper: helpers) {
+        helper->thread.join();
+    }
+}
+
+void FanOutPool::HelperLoop(size_t shard, Helper& helper) {
+    uint64_t seen = 0;
+
+    while (true) {
+        auto ready = [this, &seen] () -> bool {
+            return generation.load(std::memory_order_acquire) != seen;
+        };
+
+        while (!helper.parker.Wait(strategy, ready)) {
+        }
+
+        seen = generation.load(std::memory_order_acquire);
+
+        if (stopping.load(std::memory_order_relaxed)) {
+            break;
+        }
+
+        try {
+            (*current)(shard);
+        } catch (...) {
+            helper.error = std::current_exception();
+        }
+
+        if (outstanding.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            done.Wake();
+        }
+    }
+}
+
+void FanOutPool::Run(const Task& task) {
+    current = &task;
+    outstanding.store(helpers.size(), std::memory_order_relaxed);
+
+    // Publishes current, and the outstanding count, to the helpers
+    generation.fetch_add(1, std::memory_order_release);
+
+    for (std::unique_ptr<Helper>& helper: helpers) {
+        helper->parker.Wake();
+    }
+
+    std::exception_ptr error = nullptr;
+    try {
+        task(0);
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    auto complete = [this] () -> bool {
+        return outstanding.load(std::memory_order_acquire) == 0;
+    };
+
+    while (!done.Wait(strategy, complete)) {
+    }
+
+    for (std::unique_ptr<Helper>& helper: helpers) {
+        if (helper->error) {
+            if (!error) {
+                error = helper->error;
+            }
+            helper->error = nullptr;
+        }
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
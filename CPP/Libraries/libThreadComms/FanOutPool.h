@@ -0,0 +1,98 @@
+/*
+ * Split a single thread's work across a small set of helper threads
+ *
+ *  Created on: 16th October 2026
+ */
+
+#ifndef DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_FAN_OUT_POOL_H__
+#define DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_FAN_OUT_POOL_H__
+
+#include "WaitStrategy.h"
+#include <functional>
+#include <exception>
+#include <thread>
+#include <memory>
+#include <vector>
+#include <atomic>
+
+/**
+ * Fork / join helper for the PipePublisher's fan-out mode: a task is split
+ * into shards, shard 0 is run on the calling thread, and each of the others
+ * on a dedicated helper thread. Run only returns once every shard is complete.
+ *
+ * Unlike a WorkerThreadPool there is no queue: each call to Run is a single
+ * hand-off to threads which are already waiting for it, so the overhead is a
+ * couple of cache line transfers per helper (whilst the helpers are spinning).
+ *
+ * NOTE: Only one thread may call Run at a time.
+ */
+class FanOutPool {
+public:
+    typedef std::function<void (size_t shard)> Task;
+
+    /**
+     * Start the helper threads.
+     *
+     * @param helpers   Number of helper threads. The pool runs helpers + 1
+     *                  shards.
+     * @param strategy  How the helpers (and the calling thread) wait for each
+     *                  other.
+     */
+    FanOutPool(size_t helpers,
+               const WaitStrategy& strategy = WaitStrategy::SpinThenPark());
+
+    /**
+     * Stops and joins the helper threads.
+     */
+    ~FanOutPool();
+
+    FanOutPool(const FanOutPool& rhs) = delete;
+    FanOutPool& operator=(const FanOutPool& rhs) = delete;
+
+    /**
+     * Number of shards each task is split into
+     */
+    size_t Shards() const {
+        return helpers.size() + 1;
+    }
+
+    /**
+     * Run task(shard) for each shard in [0, Shards()), and wait for them all
+     * to complete.
+     *
+     * If any shard throws, the exception (from the lowest numbered shard) is
+     * re-thrown here, once every shard is complete.
+     */
+    void Run(const Task& task);
+
+private:
+    struct Helper {
+        Helper(): error(nullptr) {}
+
+        std::thread         thread;
+        Parker              parker;
+        std::exception_ptr  error;
+    };
+
+    void HelperLoop(size_t shard, Helper& helper);
+
+    const WaitStrategy                    strategy;
+
+    /**
+     * Bumped for each call to Run. Helpers wait for it to move on from the
+     * last generation they ran.
+     */
+    std::atomic<uint64_t>                 generation;
+    const Task*                           current;
+    std::atomic<bool>                     stopping;
+
+    /**
+     * Shards still running. The caller waits on done for this to reach zero.
+     */
+    std::atomic<size_t>                   outstanding;
+    Parker                                done;
+
+    std::vector<std::unique_ptr<Helper>>  helpers;
+};
+
+#endif
@@ -0,0 +1,99 @@
+/*
+ * Future.cpp
+ *
+ *  Created on: 16th October 2026
+ */
+
+#include "Future.h"
+#include <logger.h>
+
+using namespace FutureDetail;
+
+StateBase::StateBase()
+    : continuations(nullptr)
+{
+}
+
+StateBase::~StateBase() {
+    Continuation* list = continuations.load(std::memory_order_acquire);
+
+    // Never completed: the continuations will never run
+    while (list && list != Completed()) {
+        std::unique_ptr<Continuation> continuation(list);
+        list = continuation->next;
+    }
+}
+
+StateBase::Continuation* StateBase::Completed() {
+    static Continuation sentinel;
+    return &sentinel;
+}
+
+bool StateBase::Ready() const {
+    return (continuations.load(std::memory_order_acquire) == Completed());
+}
+
+bool StateBase::Failed() const {
+    return (Ready() && error);
+}
+
+void StateBase::Push(Continuation* continuation) {
+    continuation->next = continuations.load(std::memory_order_acquire);
+
+    bool queued = false;
+    while (!queued && continuation->next != Completed()) {
+        queued = continuations.compare_exchange_weak(
+                     continuation->next,
+                     continuation,
+                     std::memory_order_release,
+                     std::memory_order_acquire);
+    }
+
+    if (!queued) {
+        // Already complete, nothing to wait for
+        std::unique_ptr<Continuation> ready(continuation);
+        ready->Run();
+    }
+}
+
+void StateBase::Fail(std::exception_ptr _error) {
+    error = _error;
+    Complete();
+}
+
+void StateBase::Complete() {
+    Continuation* list = continuations.exchange(
+        Completed(), std::memory_order_acq_rel);
+
+    if (list == Completed()) {
+        SLOG_FROM(LOG_ERROR, "FutureDetail::StateBase::Complete",
+                  "Future was completed twice");
+        list = nullptr;
+    }
+
+    // The stack is in reverse order...
+    Continuation* ordered = nullptr;
+    while (list) {
+        Continuation* next = list->next;
+        list->next = ordered;
+        ordered = list;
+        list = next;
+    }
+
+    while (ordered) {
+        std::unique_ptr<Continuation> continuation(ordered);
+        ordered = continuation->next;
+
+        /**
+         * The completing thread doesn't know about the continuations, so
+         * there is no-one to report the error to: but the remaining
+         * continuations must still run.
+         */
+        try {
+            continuation->Run();
+        } catch (...) {
+            SLOG_FROM(LOG_ERROR, "FutureDetail::StateBase::Complete",
+                      "Unhandled exception in future continuation");
+        }
+    }
+}
@@ -0,0 +1,391 @@
+/*
+ * Non-blocking futures, with continuations posted to an event loop
+ *
+ *  Created on: 16th October 2026
+ */
+
+#ifndef DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_FUTURE_H__
+#define DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_FUTURE_H__
+
+#include "IPostable.h"
+#include "BlockPool.h"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <exception>
+#include <functional>
+#include <type_traits>
+
+/**
+ * Thrown by Future::Value, or used to fail a future:
+ *
+ *    - The value was requested before the future was ready
+ *    - The promise was destroyed without a value (e.g the task was
+ *      discarded by an aborted WorkerThread)
+ *    - The promise was fulfilled twice
+ */
+struct FutureException {
+    std::string msg;
+};
+
+template <class T>
+class Future;
+
+template <class T>
+class Promise;
+
+namespace FutureDetail {
+    /**
+     * Placeholder value for a Future<void>
+     */
+    struct Empty { };
+
+    template <class T>
+    struct Storage {
+        typedef T type;
+    };
+
+    template <>
+    struct Storage<void> {
+        typedef Empty type;
+    };
+
+    /**
+     * Untyped state shared by a Promise and its Futures: the error (if any),
+     * and the list of continuations to run on completion.
+     *
+     * Completion is lock-free: continuations are pushed onto an intrusive
+     * stack, which is swapped for a sentinel on completion. Whoever loses
+     * the race runs the continuation.
+     *
+     * Each continuation is a single BlockPool allocation holding the
+     * callable itself, so attaching one never allocates a std::function.
+     */
+    class StateBase: public std::enable_shared_from_this<StateBase> {
+    public:
+        StateBase();
+
+        virtual ~StateBase();
+
+        StateBase(const StateBase& rhs) = delete;
+        StateBase& operator=(const StateBase& rhs) = delete;
+
+        bool Ready() const;
+
+        /**
+         * The future completed with an error rather than a value
+         */
+        bool Failed() const;
+
+        const std::exception_ptr& Error() const {
+            return error;
+        }
+
+        /**
+         * Run f on completion. If the future has already completed f is run
+         * immediately on the calling thread, otherwise it is run by the
+         * completing thread.
+         */
+        template <class F>
+        void OnComplete(F&& f) {
+            typedef Callback<typename std::decay<F>::type> Node;
+            Push(new Node(std::forward<F>(f)));
+        }
+
+        void Fail(std::exception_ptr error);
+
+    protected:
+        /**
+         * Mark the state as complete, and run any continuations (in the
+         * order they were added). The result must already be in place.
+         */
+        void Complete();
+
+    private:
+        struct Continuation {
+            Continuation() : next(nullptr) { }
+
+            virtual ~Continuation() { }
+
+            virtual void Run() { }
+
+            static void* operator new(size_t bytes) {
+                return BlockPool::Allocate(bytes);
+            }
+
+            static void operator delete(void* block, size_t bytes) {
+                BlockPool::Free(block, bytes);
+            }
+
+            Continuation* next;
+        };
+
+        template <class F>
+        struct Callback: public Continuation {
+            template <class G>
+            Callback(G&& _f) : f(std::forward<G>(_f)) { }
+
+            virtual void Run() override {
+                f();
+            }
+
+            F f;
+        };
+
+        void Push(Continuation* continuation);
+
+        /**
+         * Sentinel for the continuation list, once complete
+         */
+        static Continuation* Completed();
+
+        std::atomic<Continuation*>  continuations;
+        std::exception_ptr          error;
+    };
+
+    template <class T>
+    class State: public StateBase {
+    public:
+        typedef typename Storage<T>::type Result;
+
+        State() : hasValue(false) { }
+
+        virtual ~State();
+
+        template <class... Args>
+        void SetValue(Args&&... args);
+
+        const Result& Value() const {
+            return *reinterpret_cast<const Result*>(&storage);
+        }
+    private:
+        typename std::aligned_storage<sizeof(Result), alignof(Result)>::type storage;
+        bool hasValue;
+    };
+
+    /**
+     * Promises and their states are created on every hop, so they are
+     * allocated (together with their shared_ptr control blocks) from the
+     * BlockPool.
+     */
+    template <class T>
+    std::shared_ptr<State<T>> NewState() {
+        return std::allocate_shared<State<T>>(BlockPoolAllocator<State<T>>());
+    }
+
+    template <class T>
+    std::shared_ptr<Promise<T>> NewPromise() {
+        return std::allocate_shared<Promise<T>>(BlockPoolAllocator<Promise<T>>());
+    }
+
+    template <class T>
+    struct Unwrap {
+        typedef T type;
+    };
+
+    template <class T>
+    struct Unwrap<Future<T>> {
+        typedef T type;
+    };
+
+    /**
+     * Invoke a continuation with the value of a Future<T>
+     */
+    template <class T, class F>
+    struct Call {
+        typedef typename std::result_of<F(const T&)>::type Result;
+
+        static Result Invoke(F& f, const T& value) {
+            return f(value);
+        }
+    };
+
+    template <class F>
+    struct Call<void, F> {
+        typedef typename std::result_of<F()>::type Result;
+
+        static Result Invoke(F& f, const Empty& ) {
+            return f();
+        }
+    };
+}
+
+/**
+ * The result of an asynchronous operation (e.g WorkerThread::Submit).
+ *
+ * Unlike std::future there is no blocking get: the value is consumed by a
+ * continuation, which is run (or posted to an event loop) by the thread which
+ * completes the future. Multi-stage pipelines across threads can therefore
+ * be built without any thread ever parking to wait on another:
+ *
+ *    worker.Submit(LoadData)
+ *          .Then(Process, &otherWorker)
+ *          .Then(Reply, &server);
+ *
+ * Futures are cheap to copy: all copies share the same result.
+ *
+ * If an operation fails (its task throws, or its promise is broken), the
+ * failure propagates down the chain of continuations, skipping each of
+ * them, to the first future whose Error is inspected.
+ */
+template <class T>
+class Future {
+public:
+    typedef typename FutureDetail::Storage<T>::type Result;
+
+    /**
+     * An invalid future, which will never complete.
+     */
+    Future() { }
+
+    /**
+     * False for a default constructed future
+     */
+    bool Valid() const {
+        return state.get() != nullptr;
+    }
+
+    /**
+     * The future has completed, either with a value or an error.
+     */
+    bool Ready() const {
+        return state && state->Ready();
+    }
+
+    /**
+     * The future completed with an error rather than a value
+     */
+    bool Failed() const {
+        return state && state->Failed();
+    }
+
+    /**
+     * The error the future completed with, or nullptr.
+     */
+    std::exception_ptr Error() const;
+
+    /**
+     * The value of a completed future. If the future failed, its error is
+     * re-thrown. If the future is not yet ready, a FutureException is
+     * thrown.
+     *
+     * For a Future<void>, this is an empty placeholder.
+     */
+    const Result& Value() const;
+
+    /**
+     * Run f with the value of this future once it has completed:
+     *
+     *    - If target is provided, f is posted to it
+     *    - Otherwise, it is run on the thread which completes the future (or
+     *      the calling thread, if this future has already completed).
+     *
+     * f is called with a const reference to the value (or no arguments,
+     * for a Future<void>).
+     *
+     * @returns A future for the result of f. If f itself returns a
+     *          Future<U>, this is unwrapped to a Future<U> which completes
+     *          with it.
+     */
+    template <class F>
+    Future<typename FutureDetail::Unwrap<
+        typename FutureDetail::Call<T, F>::Result>::type>
+    Then(F f, IPostable* target = nullptr) const;
+
+    /**
+     * Run f with this future (whether it succeeded or failed) once it has
+     * completed. See Then.
+     *
+     * f is called as f(const Future<T>&).
+     */
+    template <class F>
+    void OnComplete(F f, IPostable* target = nullptr) const;
+
+    /**
+     * Complete promise with the result of this future.
+     */
+    void Forward(const std::shared_ptr<Promise<T>>& promise) const;
+
+private:
+    friend class Promise<T>;
+    typedef FutureDetail::State<T> State;
+
+    Future(const std::shared_ptr<State>& _state) : state(_state) { }
+
+    std::shared_ptr<State> state;
+};
+
+/**
+ * The producer side of a Future.
+ *
+ * A promise is not copyable (it may only be completed once), so continuations
+ * which need to complete it should hold it by std::shared_ptr. If the
+ * promise is destroyed without a value, its future fails with a
+ * FutureException, so that discarding a task can never leave a continuation
+ * waiting forever.
+ */
+template <class T>
+class Promise {
+public:
+    Promise();
+
+    ~Promise();
+
+    Promise(const Promise& rhs) = delete;
+    Promise& operator=(const Promise& rhs) = delete;
+
+    Future<T> GetFuture() const {
+        return Future<T>(state);
+    }
+
+    /**
+     * Complete the future with a value (no arguments for a Promise<void>).
+     *
+     * Throws a FutureException if the promise has already been completed.
+     */
+    template <class... Args>
+    void SetValue(Args&&... args);
+
+    /**
+     * Complete the future with an error.
+     */
+    void SetError(std::exception_ptr error);
+
+    /**
+     * Complete the future with the result of f(), or its exception if it
+     * throws.
+     */
+    template <class F>
+    void SetResultOf(F& f);
+
+    bool Fulfilled() const {
+        return fulfilled;
+    }
+
+private:
+    void Fulfil();
+
+    std::shared_ptr<FutureDetail::State<T>> state;
+    bool fulfilled;
+};
+
+/**
+ * A future which completes once all of futures have completed (successfully
+ * or not). The individual results are read from the futures themselves.
+ */
+template <class T>
+Future<std::vector<Future<T>>> WhenAll(const std::vector<Future<T>>& futures);
+
+/**
+ * A future which completes with the index of the first of futures to
+ * complete (successfully or not).
+ *
+ * If futures is empty, the returned future fails.
+ */
+template <class T>
+Future<size_t> WhenAny(const std::vector<Future<T>>& futures);
+
+#include "Future.hpp"
+
+#endif
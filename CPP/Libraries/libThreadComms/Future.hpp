@@ -0,0 +1,266 @@
+namespace FutureDetail {
+    template <class T>
+    State<T>::~State() {
+        if (hasValue) {
+            reinterpret_cast<Result*>(&storage)->~Result();
+        }
+    }
+
+    template <class T>
+    template <class... Args>
+    void State<T>::SetValue(Args&&... args) {
+        new (&storage) Result(std::forward<Args>(args)...);
+        hasValue = true;
+        Complete();
+    }
+
+    /**
+     * Complete a promise with the result of a call
+     */
+    template <class T>
+    struct Produce {
+        template <class F>
+        static void Run(Promise<T>& promise, F& f) {
+            promise.SetValue(f());
+        }
+    };
+
+    template <>
+    struct Produce<void> {
+        template <class F>
+        static void Run(Promise<void>& promise, F& f) {
+            f();
+            promise.SetValue();
+        }
+    };
+
+    /**
+     * Complete the promise returned by Then with the result of the
+     * continuation: if the continuation returns a future, the promise is
+     * completed when that future completes.
+     */
+    template <class R>
+    struct Continue {
+        template <class F>
+        static void Run(const std::shared_ptr<Promise<R>>& promise, F& f) {
+            promise->SetResultOf(f);
+        }
+    };
+
+    template <class U>
+    struct Continue<Future<U>> {
+        template <class F>
+        static void Run(const std::shared_ptr<Promise<U>>& promise, F& f) {
+            Future<U> inner;
+            bool started = false;
+            try {
+                inner = f();
+                started = true;
+            } catch (...) {
+                promise->SetError(std::current_exception());
+            }
+
+            if (started) {
+                inner.Forward(promise);
+            }
+        }
+    };
+}
+
+/*****************************************************************************
+ *                          Future
+ *****************************************************************************/
+
+template <class T>
+std::exception_ptr Future<T>::Error() const {
+    std::exception_ptr error;
+    if (Ready()) {
+        error = state->Error();
+    }
+
+    return error;
+}
+
+template <class T>
+const typename Future<T>::Result& Future<T>::Value() const {
+    if (!Ready()) {
+        throw FutureException{"Value requested from a future which is not ready"};
+    }
+
+    if (state->Failed()) {
+        std::rethrow_exception(state->Error());
+    }
+
+    return state->Value();
+}
+
+template <class T>
+template <class F>
+void Future<T>::OnComplete(F f, IPostable* target) const {
+    if (state) {
+        /**
+         * The state owns the callback, so it must not own the state...
+         */
+        State* source = state.get();
+
+        state->OnComplete([source, f, target] () mutable -> void {
+            Future<T> self(std::static_pointer_cast<State>(source->shared_from_this()));
+
+            if (target) {
+                target->PostTask([self, f] () mutable -> void { f(self); });
+            } else {
+                f(self);
+            }
+        });
+    }
+}
+
+template <class T>
+template <class F>
+Future<typename FutureDetail::Unwrap<
+    typename FutureDetail::Call<T, F>::Result>::type>
+Future<T>::Then(F f, IPostable* target) const
+{
+    typedef typename FutureDetail::Call<T, F>::Result R;
+    typedef typename FutureDetail::Unwrap<R>::type U;
+
+    std::shared_ptr<Promise<U>> promise(FutureDetail::NewPromise<U>());
+    Future<U> result = promise->GetFuture();
+
+    OnComplete([promise, f] (const Future<T>& source) mutable -> void {
+        if (source.Failed()) {
+            promise->SetError(source.Error());
+        } else {
+            auto call = [&source, &f] () -> R {
+                return FutureDetail::Call<T, F>::Invoke(f, source.Value());
+            };
+            FutureDetail::Continue<R>::Run(promise, call);
+        }
+    }, target);
+
+    return result;
+}
+
+template <class T>
+void Future<T>::Forward(const std::shared_ptr<Promise<T>>& promise) const {
+    OnComplete([promise] (const Future<T>& source) -> void {
+        if (source.Failed()) {
+            promise->SetError(source.Error());
+        } else {
+            promise->SetValue(source.Value());
+        }
+    });
+}
+
+/*****************************************************************************
+ *                          Promise
+ *****************************************************************************/
+
+template <class T>
+Promise<T>::Promise()
+    : state(FutureDetail::NewState<T>()),
+      fulfilled(false)
+{
+}
+
+template <class T>
+Promise<T>::~Promise() {
+    if (!fulfilled) {
+        state->Fail(std::make_exception_ptr(
+            FutureException{"Promise was destroyed without a value"}));
+    }
+}
+
+template <class T>
+void Promise<T>::Fulfil() {
+    if (fulfilled) {
+        throw FutureException{"Promise has already been fulfilled"};
+    }
+    fulfilled = true;
+}
+
+template <class T>
+template <class... Args>
+void Promise<T>::SetValue(Args&&... args) {
+    Fulfil();
+    state->SetValue(std::forward<Args>(args)...);
+}
+
+template <class T>
+void Promise<T>::SetError(std::exception_ptr error) {
+    Fulfil();
+    state->Fail(error);
+}
+
+template <class T>
+template <class F>
+void Promise<T>::SetResultOf(F& f) {
+    try {
+        FutureDetail::Produce<T>::Run(*this, f);
+    } catch (...) {
+        SetError(std::current_exception());
+    }
+}
+
+/*****************************************************************************
+ *                          Combinators
+ *****************************************************************************/
+
+template <class T>
+Future<std::vector<Future<T>>> WhenAll(const std::vector<Future<T>>& futures) {
+    typedef std::vector<Future<T>> Results;
+
+    struct Join {
+        Join(const Results& _futures)
+            : remaining(_futures.size()), futures(_futures) { }
+
+        std::atomic<size_t>  remaining;
+        Results              futures;
+        Promise<Results>     promise;
+    };
+
+    std::shared_ptr<Join> join(new Join(futures));
+    Future<Results> result = join->promise.GetFuture();
+
+    if (futures.empty()) {
+        join->promise.SetValue(futures);
+    } else {
+        for (const Future<T>& future: futures) {
+            future.OnComplete([join] (const Future<T>& ) -> void {
+                if (join->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    join->promise.SetValue(join->futures);
+                }
+            });
+        }
+    }
+
+    return result;
+}
+
+template <class T>
+Future<size_t> WhenAny(const std::vector<Future<T>>& futures) {
+    struct Race {
+        Race() : won(false) { }
+
+        std::atomic<bool>  won;
+        Promise<size_t>    promise;
+    };
+
+    std::shared_ptr<Race> race(new Race);
+    Future<size_t> result = race->promise.GetFuture();
+
+    if (futures.empty()) {
+        race->promise.SetError(std::make_exception_ptr(
+            FutureException{"WhenAny requires at least one future"}));
+    } else {
+        for (size_t i = 0; i < futures.size(); ++i) {
+            futures[i].OnComplete([race, i] (const Future<T>& ) -> void {
+                if (!race->won.exchange(true, std::memory_order_acq_rel)) {
+                    race->promise.SetValue(i);
+                }
+            });
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,43 @@
+/*
+ * Interface to be implemented by consumers of batched updates
+ *
+ *  Created on: 16th October 2026
+ */
+
+#ifndef DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_INTERFACE_BATCH_HANDLER_H__
+#define DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_INTERFACE_BATCH_HANDLER_H__
+#include <cstddef>
+
+/**
+ * Handler for the batch aware WorkerThread::ConsumeUpdates.
+ *
+ * Each time the worker is woken it drains every update published up to the
+ * end of the most recent batch, in one go:
+ *
+ *     OnBatchStart()
+ *     OnUpdates(...)   // One or more slices
+ *     OnBatchEnd()
+ *
+ * Work which only needs doing once per batch (a single JSON publication, a
+ * single redraw) should therefore be done in OnBatchEnd.
+ *
+ * Batches which have all ended by the time the worker wakes are delivered
+ * together. Updates published outside of a batch are released immediately,
+ * and delivered with whatever else is waiting.
+ */
+template <class Msg>
+class IBatchHandler {
+public:
+    virtual void OnBatchStart() { }
+
+    /**
+     * A slice of the batch. Never called with an empty slice.
+     */
+    virtual void OnUpdates(Msg* msgs, size_t count) = 0;
+
+    virtual void OnBatchEnd() { }
+
+    virtual ~IBatchHandler() {}
+};
+
+#endif
@@ -0,0 +1,113 @@
+/*
+ * LatencyHistogram.cpp
+ *
+ *  Created on: 16th October 2026
+ */
+
+#include "LatencyHistogram.h"
+#include <algorithm>
+#include <cmath>
+
+const size_t LatencyHistogram::SUB_BUCKET_BITS;
+const size_t LatencyHistogram::SUB_BUCKETS;
+const size_t LatencyHistogram::BUCKETS;
+
+LatencyHistogram::LatencyHistogram()
+    : sum(0),
+      max(0)
+{
+    for (std::atomic<uint64_t>& bucket: buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        const uint64_t count = other.buckets[i].load(std::memory_order_relaxed);
+        if (count) {
+            Increment(buckets[i], count);
+        }
+    }
+
+    Increment(sum, other.sum.load(std::memory_order_relaxed));
+
+    const uint64_t otherMax = other.Max();
+    if (otherMax > Max()) {
+        max.store(otherMax, std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::Reset() {
+    for (std::atomic<uint64_t>& bucket: buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    sum.store(0, std::memory_order_relaxed);
+    max.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::Count() const {
+    uint64_t count = 0;
+    for (const std::atomic<uint64_t>& bucket: buckets) {
+        count += bucket.load(std::memory_order_relaxed);
+    }
+
+    return count;
+}
+
+double LatencyHistogram::Mean() const {
+    const uint64_t count = Count();
+    double mean = 0;
+
+    if (count) {
+        mean = static_cast<double>(sum.load(std::memory_order_relaxed)) / count;
+    }
+
+    return mean;
+}
+
+uint64_t LatencyHistogram::Percentile(double percentile) const {
+    /**
+     * Take a copy first: the counts may be changing under us, and the rank
+     * must be calculated from the same counts we search.
+     */
+    uint64_t counts[BUCKETS];
+    uint64_t total = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        counts[i] = buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+
+    uint64_t value = 0;
+
+    if (total) {
+        percentile = std::min(std::max(percentile, 0.0), 100.0);
+        const uint64_t rank = std::max<uint64_t>(
+            1, static_cast<uint64_t>(std::ceil(total * percentile / 100.0)));
+
+        uint64_t seen = 0;
+        size_t i = 0;
+        for (; i < BUCKETS; ++i) {
+            seen += counts[i];
+            if (seen >= rank) {
+                break;
+            }
+        }
+
+        value = std::min(BucketUpperBound(std::min(i, BUCKETS - 1)), Max());
+    }
+
+    return value;
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(size_t index) {
+    uint64_t bound = index;
+
+    if (index >= SUB_BUCKETS) {
+        const size_t shift = index / SUB_BUCKETS - 1;
+        const uint64_t subBucket = index % SUB_BUCKETS;
+        const uint64_t lower = (SUB_BUCKETS + subBucket) << shift;
+        bound = lower + ((1ull << shift) - 1);
+    }
+
+    return bound;
+}
@@ -0,0 +1,129 @@
+/*
+ * Log-linear histogram of latency samples
+ *
+ *  Created on: 16th October 2026
+ */
+
+#ifndef DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_LATENCY_HISTOGRAM_H__
+#define DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_LATENCY_HISTOGRAM_H__
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Fixed size histogram covering the full range of a uint64_t (typically
+ * nanoseconds):
+ *
+ *    - Values below 32 each have their own bucket
+ *    - Above that, each power of two is split into 32 linear buckets, so that
+ *      a reported percentile is within ~3% of the true value.
+ *
+ * Recording a sample is a handful of instructions, with no allocation, so
+ * may be done on the hot path.
+ *
+ * The buckets are relaxed atomics: a single thread may record (or Merge /
+ * Reset) whilst any number of other threads read. Readers see a consistent
+ * value for each bucket, but a snapshot taken during recording may be a few
+ * samples behind.
+ */
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    LatencyHistogram(const LatencyHistogram& rhs) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram& rhs) = delete;
+
+    /**
+     * Add a new sample.
+     *
+     * NOTE: Only a single thread may record to the histogram at once.
+     */
+    void Record(uint64_t value) {
+        Increment(buckets[BucketIndex(value)], 1);
+        Increment(sum, value);
+
+        if (value > max.load(std::memory_order_relaxed)) {
+            max.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Add all samples from other to this histogram.
+     *
+     * NOTE: As for Record, this is a write to the histogram.
+     */
+    void Merge(const LatencyHistogram& other);
+
+    /**
+     * Discard all samples.
+     *
+     * NOTE: As for Record, this is a write to the histogram.
+     */
+    void Reset();
+
+    /**
+     * Number of samples recorded
+     */
+    uint64_t Count() const;
+
+    /**
+     * The largest sample recorded (exact)
+     */
+    uint64_t Max() const {
+        return max.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Mean of the samples recorded (exact), or 0 if there are none.
+     */
+    double Mean() const;
+
+    /**
+     * The value below which the specified percentage of samples fall, e.g
+     * Percentile(99.9). This is the upper bound of the bucket holding the
+     * sample, so may over-estimate by up to 1/32 (but never by more than
+     * Max()).
+     *
+     * @param percentile  In the range [0, 100]
+     *
+     * @returns The percentile, or 0 if there are no samples.
+     */
+    uint64_t Percentile(double percentile) const;
+
+    /**
+     * Layout of the buckets, exposed for tests.
+     */
+    static size_t BucketIndex(uint64_t value) {
+        size_t index = value;
+
+        if (value >= SUB_BUCKETS) {
+            const size_t exponent = 63 - __builtin_clzll(value);
+            const size_t shift = exponent - SUB_BUCKET_BITS;
+            const size_t subBucket = (value >> shift) & (SUB_BUCKETS - 1);
+            index = (shift + 1) * SUB_BUCKETS + subBucket;
+        }
+
+        return index;
+    }
+
+    static uint64_t BucketUpperBound(size_t index);
+
+    static const size_t SUB_BUCKET_BITS = 5;
+    static const size_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static const size_t BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+private:
+    /**
+     * Single writer increment: no need for a locked instruction.
+     */
+    static void Increment(std::atomic<uint64_t>& counter, uint64_t value) {
+        counter.store(counter.load(std::memory_order_relaxed) + value,
+                      std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t>  buckets[BUCKETS];
+    std::atomic<uint64_t>  sum;
+    std::atomic<uint64_t>  max;
+};
+
+#endif
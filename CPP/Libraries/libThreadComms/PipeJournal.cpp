@@ -0,0 +1,304 @@
+/*
+ * PipeJournal.cpp
+ *
+ *  Created on: 16th October 2026
+ */
+
+#include "PipeJournal.h"
+#include <binaryReader.h>
+#include <logger.h>
+#include <sstream>
+#include <iomanip>
+#include <cstddef>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+    const uint64_t MAGIC = 0x4c4e524a45504950ull; // "PIPEJRNL"
+    const uint32_t VERSION = 1;
+
+    /**
+     * The first 64 bytes of each segment
+     */
+    struct SegmentHeader {
+        uint64_t magic;
+        uint32_t version;
+        uint32_t messageSize;
+        uint64_t records;     // Complete records in this segment
+        uint64_t reserved[5];
+    };
+
+    const long RECORDS_OFFSET = offsetof(SegmentHeader, records);
+
+    size_t RecordSize(size_t messageSize) {
+        return ((sizeof(uint64_t) + messageSize + 7) / 8) * 8;
+    }
+
+    std::string Error(const std::string& what, const std::string& name) {
+        return what + " " + name + ": " + strerror(errno);
+    }
+}
+
+/*****************************************************************************
+ *                          MappedFileWriter
+ *****************************************************************************/
+
+MappedFileWriter::MappedFileWriter(const std::string& _fname, size_t _size)
+    : fname(_fname),
+      size(_size),
+      data(nullptr)
+{
+    const int fd = open(fname.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw MappedFileException{Error("Failed to create", fname)};
+    }
+
+    if (ftruncate(fd, size) != 0) {
+        const std::string msg = Error("Failed to size", fname);
+        close(fd);
+        throw MappedFileException{msg};
+    }
+
+    void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (mapping == MAP_FAILED) {
+        throw MappedFileException{Error("Failed to map", fname)};
+    }
+
+    data = static_cast<unsigned char*>(mapping);
+}
+
+MappedFileWriter::~MappedFileWriter() {
+    if (data) {
+        munmap(data, size);
+    }
+}
+
+void MappedFileWriter::CheckBounds(long offset, long count) const {
+    if (!data || offset < 0 || count < 0 ||
+        static_cast<size_t>(offset + count) > size)
+    {
+        std::stringstream msg;
+        msg << "Write of " << count << " bytes at " << offset
+            << " is outside of " << fname;
+        throw OutOfBoundsException{msg.str()};
+    }
+}
+
+void MappedFileWriter::Write(long offset, const void *src, long count) {
+    CheckBounds(offset, count);
+    memcpy(data + offset, src, count);
+}
+
+void MappedFileWriter::Put(long offset, unsigned char c) {
+    CheckBounds(offset, 1);
+    data[offset] = c;
+}
+
+void MappedFileWriter::Fill(long offset, unsigned char c, long count) {
+    CheckBounds(offset, count);
+    memset(data + offset, c, count);
+}
+
+void MappedFileWriter::Flush() {
+    if (data) {
+        msync(data, size, MS_ASYNC);
+    }
+}
+
+void MappedFileWriter::Close(size_t newSize) {
+    if (data) {
+        munmap(data, size);
+        data = nullptr;
+
+        if (truncate(fname.c_str(), newSize) != 0) {
+            throw MappedFileException{Error("Failed to truncate", fname)};
+        }
+        size = newSize;
+    }
+}
+
+/*****************************************************************************
+ *                          PipeJournal::Writer
+ *****************************************************************************/
+
+std::string PipeJournal::SegmentName(const std::string& path, size_t index) {
+    std::stringstream name;
+    name << path << "." << std::setw(6) << std::setfill('0') << index;
+    return name.str();
+}
+
+PipeJournal::Writer::Writer(
+    const std::string& _path,
+    size_t _messageSize,
+    size_t _segmentSize)
+        : path(_path),
+          messageSize(_messageSize),
+          recordSize(RecordSize(_messageSize)),
+          segmentSize(_segmentSize),
+          offset(0),
+          segmentIndex(0),
+          segmentRecords(0),
+          records(0)
+{
+    if (segmentSize < sizeof(SegmentHeader) + recordSize) {
+        std::stringstream msg;
+        msg << "Segment size " << segmentSize << " can not hold a record of "
+            << recordSize << " bytes";
+        throw JournalException{msg.str()};
+    }
+
+    // Otherwise the reader would carry on into the previous recording
+    RemoveStaleSegments(1);
+
+    Roll();
+}
+
+PipeJournal::Writer::~Writer() {
+    try {
+        segment->Close(offset);
+    } catch (MappedFileWriter::MappedFileException& e) {
+        SLOG_FROM(LOG_ERROR, "PipeJournal::Writer::~Writer", e.msg);
+    }
+}
+
+void PipeJournal::Writer::RemoveStaleSegments(size_t from) {
+    for (size_t i = from; unlink(SegmentName(path, i).c_str()) == 0; ++i) {
+    }
+}
+
+void PipeJournal::Writer::Roll() {
+    if (segment) {
+        segment->Close(offset);
+        ++segmentIndex;
+    }
+
+    segment.reset(new MappedFileWriter(SegmentName(path, segmentIndex), segmentSize));
+    segmentRecords = 0;
+
+    SegmentHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.messageSize = messageSize;
+
+    BinaryWriter(*segment) << header;
+    offset = sizeof(header);
+}
+
+void PipeJournal::Writer::Append(uint64_t timestamp, const void* msg) {
+    if (offset + recordSize > segmentSize) {
+        Roll();
+    }
+
+    BinaryWriter pos(*segment, offset);
+    pos << timestamp;
+    pos.Write(msg, messageSize);
+    offset += recordSize;
+
+    // Only publish the record once it is complete
+    ++segmentRecords;
+    ++records;
+    BinaryWriter(*segment, RECORDS_OFFSET) << segmentRecords;
+}
+
+void PipeJournal::Writer::Flush() {
+    segment->Flush();
+}
+
+/*****************************************************************************
+ *                          PipeJournal::Reader
+ *****************************************************************************/
+
+PipeJournal::Reader::Reader(const std::string& _path, size_t _messageSize)
+    : path(_path),
+      messageSize(_messageSize),
+      recordSize(RecordSize(_messageSize)),
+      mapping(MAP_FAILED),
+      mappingSize(0),
+      segmentIndex(0),
+      segmentRecords(0),
+      nextRecord(0)
+{
+    if (!Open(0)) {
+        throw JournalException{Error("Failed to open", SegmentName(path, 0))};
+    }
+}
+
+PipeJournal::Reader::~Reader() {
+    Close();
+}
+
+void PipeJournal::Reader::Close() {
+    segment.reset();
+    if (mapping != MAP_FAILED) {
+        munmap(mapping, mappingSize);
+        mapping = MAP_FAILED;
+    }
+}
+
+bool PipeJournal::Reader::Open(size_t index) {
+    const std::string name = SegmentName(path, index);
+    const int fd = open(name.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(SegmentHeader)) {
+        close(fd);
+        throw JournalException{"Segment " + name + " is truncated"};
+    }
+
+    Close();
+    mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (mapping == MAP_FAILED) {
+        throw JournalException{Error("Failed to map", name)};
+    }
+
+    mappingSize = info.st_size;
+    segment.reset(new DataReader(mapping, mappingSize));
+    segmentIndex = index;
+    nextRecord = 0;
+
+    SegmentHeader header;
+    BinaryReader(*segment) >> header;
+
+    if (header.magic != MAGIC || header.version != VERSION) {
+        throw JournalException{name + " is not a journal segment"};
+    }
+
+    if (header.messageSize != messageSize) {
+        throw JournalException{name + " holds a different message type"};
+    }
+
+    if (sizeof(SegmentHeader) + header.records * recordSize > mappingSize) {
+        throw JournalException{"Segment " + name + " is truncated"};
+    }
+
+    segmentRecords = header.records;
+
+    return true;
+}
+
+bool PipeJournal::Reader::Next(uint64_t& timestamp, void* msg) {
+    while (nextRecord == segmentRecords) {
+        if (!Open(segmentIndex + 1)) {
+            return false;
+        }
+    }
+
+    BinaryReader pos(*segment, sizeof(SegmentHeader) + nextRecord * recordSize);
+    pos >> timestamp;
+    pos.Read(msg, messageSize);
+    ++nextRecord;
+
+    return true;
+}
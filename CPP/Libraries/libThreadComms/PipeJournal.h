@@ -0,0 +1,199 @@
+/*
+ * Segmented binary journal of fixed size messages, see PipeRecorder
+ *
+ *  Created on: 16th October 2026
+ */
+
+#ifndef DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_PIPE_JOURNAL_H__
+#define DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_PIPE_JOURNAL_H__
+
+#include <binaryWriter.h>
+#include <dataReader.h>
+#include <string>
+#include <memory>
+#include <cstdint>
+
+/**
+ * A FileLikeWriter over a memory mapped file of a fixed size. Writes are
+ * plain copies into the mapping: the kernel writes the pages back in its own
+ * time (or on Flush).
+ */
+class MappedFileWriter: public FileLikeWriter {
+public:
+    /**
+     * Failed to create, size, or map the file.
+     */
+    struct MappedFileException {
+        std::string msg;
+    };
+
+    /**
+     * Write beyond the end of the mapping
+     */
+    struct OutOfBoundsException {
+        std::string msg;
+    };
+
+    /**
+     * Create (or truncate) the file, and map size bytes of it.
+     */
+    MappedFileWriter(const std::string& fname, size_t size);
+
+    virtual ~MappedFileWriter();
+
+    MappedFileWriter(const MappedFileWriter& rhs) = delete;
+    MappedFileWriter& operator=(const MappedFileWriter& rhs) = delete;
+
+    virtual void Write(long offset, const void *src, long size);
+    virtual void Put(long offset, unsigned char c);
+    virtual void Fill(long offset, unsigned char c, long count);
+
+    /**
+     * Schedule the mapping to be written back to disk (without waiting)
+     */
+    virtual void Flush();
+
+    /**
+     * Unmap the file, and truncate it to size bytes. No further writes may
+     * be made.
+     */
+    void Close(size_t size);
+
+    size_t Size() const { return size; }
+
+private:
+    void CheckBounds(long offset, long count) const;
+
+    const std::string  fname;
+    size_t             size;
+    unsigned char*     data;
+};
+
+/**
+ * Untyped storage for the PipeRecorder / PipeReplayer.
+ *
+ * A journal is a sequence of segment files, <path>.000000, <path>.000001, ...
+ * Each segment is a small header followed by fixed size records:
+ *
+ *    uint64_t  timestamp   (ns since the epoch, when the message was published)
+ *    char      message[messageSize]
+ *
+ * padded to a multiple of 8 bytes. Records never span segments: once a
+ * segment is full the next one is started.
+ *
+ * The header's record count is updated after each record is written, so a
+ * journal whose writer crashed can still be read up to the last complete
+ * record (subject to what the kernel had written back).
+ */
+namespace PipeJournal {
+    const size_t DEFAULT_SEGMENT_SIZE = 64 * 1024 * 1024;
+
+    /**
+     * The journal is missing, corrupt, or holds a different message type.
+     */
+    struct JournalException {
+        std::string msg;
+    };
+
+    /**
+     * Name of the index'th segment of the journal at path
+     */
+    std::string SegmentName(const std::string& path, size_t index);
+
+    class Writer {
+    public:
+        /**
+         * Start a new journal at path, replacing any existing segments.
+         *
+         * @param path         Base name of the segment files
+         * @param messageSize  Size of a single message, in bytes
+         * @param segmentSize  Size of each segment file. Must be large enough
+         *                     for at least one record.
+         */
+        Writer(const std::string& path, size_t messageSize, size_t segmentSize);
+
+        /**
+         * Truncates the final segment to the data actually written
+         */
+        ~Writer();
+
+        Writer(const Writer& rhs) = delete;
+        Writer& operator=(const Writer& rhs) = delete;
+
+        /**
+         * Append a new record. Rolls on to a new segment if the current one
+         * is full.
+         */
+        void Append(uint64_t timestamp, const void* msg);
+
+        /**
+         * Schedule all data written so far to be written back to disk
+         */
+        void Flush();
+
+        size_t Records() const { return records; }
+        size_t Segments() const { return segmentIndex + 1; }
+
+    private:
+        void Roll();
+
+        void RemoveStaleSegments(size_t from);
+
+        const std::string  path;
+        const size_t       messageSize;
+        const size_t       recordSize;
+        const size_t       segmentSize;
+
+        std::unique_ptr<MappedFileWriter>  segment;
+        long                               offset;
+        size_t                             segmentIndex;
+        uint64_t                           segmentRecords;
+        size_t                             records;
+    };
+
+    class Reader {
+    public:
+        /**
+         * Open the journal at path for reading.
+         *
+         * Throws a JournalException if there is no such journal, or it was
+         * recorded for a different message size.
+         */
+        Reader(const std::string& path, size_t messageSize);
+
+        ~Reader();
+
+        Reader(const Reader& rhs) = delete;
+        Reader& operator=(const Reader& rhs) = delete;
+
+        /**
+         * Read the next record, moving on to the next segment as required.
+         *
+         * @returns false once there are no more records
+         */
+        bool Next(uint64_t& timestamp, void* msg);
+
+    private:
+        /**
+         * Map the index'th segment.
+         *
+         * @returns false if there is no such segment
+         */
+        bool Open(size_t index);
+
+        void Close();
+
+        const std::string  path;
+        const size_t       messageSize;
+        const size_t       recordSize;
+
+        void*                        mapping;
+        size_t                       mappingSize;
+        std::unique_ptr<DataReader>  segment;
+        size_t                       segmentIndex;
+        uint64_t                     segmentRecords;
+        uint64_t                     nextRecord;
+    };
+}
+
+#endif
@@ -9,10 +9,15 @@
 #define DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_PIPE_PUBLISHER_H__
 
 #include <PipeSubscriber.h>
+#include <FanOutPool.h>
+#include <ProfiledMutex.h>
 #include <mutex>
 #include <map>
 #include <thread>
 #include <vector>
+#include <atomic>
+#include <memory>
+#include <chrono>
 
 #include <boost/lockfree/queue.hpp>
 
@@ -27,6 +32,11 @@
  * will only be triggered once, at which point the client should drain the
  * queue, and re-configure the notification. See PipeSubscriber
  *
+ * The publication thread never takes a lock: it works from its own snapshot
+ * of the client list. Subscription changes build a new snapshot under the
+ * subscription mutex, and hand it over to the publication thread via an
+ * atomic pointer. The new snapshot is picked up on the next publication
+ * (RCU style), so adding clients never stalls the publisher.
  */
 template <class Message>
 class PipePublisher { 
@@ -40,6 +50,10 @@ public:
     /**
      * Create a new subscription to the publisher.
      *
+     * Dropping the last copy of the returned handle unsubscribes the client:
+     * it is aborted, so that a publisher blocked on it (BLOCK policy) is
+     * released.
+     *
      * @param  maxSize  Maximum number of unread messages
      */
     template <class Client = PipeSubscriber<Message>, class... Args>
@@ -60,9 +74,10 @@ public:
      *
      * EndBatch MUST be called on completion of the batch.
      *
-     * Dispatching messages as part of a batch is more efficient, but it leaves
-     * the publisher in a locked state, meaning:
-     *    - New clients may not be added or removed.
+     * Dispatching messages as part of a batch is more efficient, but it freezes
+     * the client list for the duration of the batch, meaning:
+     *    - New clients will not receive any updates until the batch is
+     *      complete.
      *    - Dead clients will be kept alive until the batch is complete
      *    - Some clients may not process any updates until EndBatch is called.
      *      (The client chooses whether or not to respect we are publishing as
@@ -79,11 +94,115 @@ public:
     void EndBatch();
 
     /**
-     * Notify all clients that no more updates will be published.
+     * Coalesce individual publications into batches, for producers which
+     * publish one message at a time and so can't frame batches themselves.
+     *
+     * Whilst enabled, published messages are held by the publisher until
+     * either maxMessages have been published, or maxDelay has passed since
+     * the first of them was published, and are then dispatched as a single
+     * batch. Each client's notification lock is therefore only taken once
+     * per micro-batch, rather than once per message. (The cost is an extra
+     * copy of each message, and a clock read per publication.)
+     *
+     * NOTE: The delay is only checked when a message is published. A producer
+     *       which may go quiet must call FlushIfDue (or Flush) from its idle
+     *       path, otherwise the final messages are held until the next
+     *       publication. Anything still held when the publisher is destroyed
+     *       is discarded.
+     *
+     * Explicit batches (StartBatch / EndBatch) are dispatched as normal,
+     * after anything already being held.
+     *
+     * @param maxMessages  Largest micro-batch. Must be at least 1.
+     * @param maxDelay     Longest a message may be held for
+     */
+    void EnableAutoBatching(size_t maxMessages, std::chrono::microseconds maxDelay);
+
+    /**
+     * Dispatch anything currently held, and publish each subsequent message
+     * immediately.
+     */
+    void DisableAutoBatching();
+
+    /**
+     * Dispatch any messages held by auto-batching now.
+     */
+    void Flush();
+
+    /**
+     * Dispatch any messages held by auto-batching, if the oldest of them has
+     * been held for the maximum delay.
+     */
+    void FlushIfDue();
+
+    /**
+     * With hundreds of clients, publication is dominated by copying the
+     * message into each client's queue, one after the other. In fan-out mode
+     * the client list is split into shards, and each shard is pushed to by
+     * its own thread: the publication thread, plus one of a small pool of
+     * helper threads. Publish still returns only once every client has been
+     * pushed to, so each client sees messages (and batches) in the order
+     * they were published.
+     *
+     * Each client is always pushed to from the same thread, for as long as
+     * the client list is unchanged. In particular a client's batch is
+     * started, pushed to, and ended all on the same thread.
+     *
+     * NOTE: Callbacks triggered by a push (OnNextMessage, OnNewMessage) are
+     *       made from the thread doing the push, which may be one of the
+     *       helpers rather than the publication thread.
+     *
+     * Publications to fewer than minClients are made on the publication
+     * thread alone, since the hand-off would cost more than it saved.
+     *
+     * NOTE: Fan-out only pays off if there are spare cores for the helpers.
+     *       With the default strategy they spin whilst waiting for the next
+     *       publication.
+     *
+     * NOTE: Must not be called part way through a batch.
+     *
+     * @param helpers      Number of helper threads
+     * @param minClients   Smallest client list to fan out to
+     * @param strategy     How the helpers wait for the next publication
+     */
+    void EnableFanOut(size_t helpers,
+                      size_t minClients = DEFAULT_FAN_OUT_MIN_CLIENTS,
+                      const WaitStrategy& strategy = WaitStrategy::SpinThenPark());
+
+    /**
+     * Stop the helper threads, and publish from the publication thread alone.
+     */
+    void DisableFanOut();
+
+    static const size_t DEFAULT_FAN_OUT_MIN_CLIENTS = 64;
+
+    /**
+     * Notify all clients that no more updates will be published. Anything
+     * held by auto-batching is dispatched first.
      */
     void Done();
 
     size_t NumClients();
+
+    /**
+     * Start (or stop) maintaining per-subscriber stats. This applies to both
+     * current, and future, subscriptions.
+     *
+     * Stats are disabled by default. Whilst enabled the publisher pays for a
+     * handful of relaxed stores per message, and a read of the subscriber's
+     * queue indices (for the high-water mark).
+     */
+    void EnableStats(bool enable = true);
+
+    /**
+     * Snapshot the counters of each current subscription. Subscribers which
+     * do not keep stats (e.g custom IPipeConsumers) are not included.
+     *
+     * This only takes the subscription lock (which the publication thread
+     * never waits for), so is cheap enough to be polled periodically whilst
+     * publishing.
+     */
+    std::vector<PipeSubscriberStats> Stats();
 private:
 
     class Lock {
@@ -102,7 +221,6 @@ private:
         ~Batch();
     private:
         Type&      parent;
-        Type::Lock lock;
     };
 
     friend class Type::Lock;
@@ -110,12 +228,117 @@ private:
     friend class PipeSubscriber<Message>;
     friend class IPipeConsumer<Message>;
 
+    typedef std::chrono::steady_clock Clock;
+
     typedef std::shared_ptr<IPipeConsumer<Message>> ClientRef;
     typedef std::weak_ptr<IPipeConsumer<Message>> pClient;
 
     typedef std::vector<ClientRef> ClientList;
 
-    void RemoveClient(typename ClientList::iterator client);
+    /**
+     * Call f(client) for each client in the publication thread's snapshot,
+     * fanning out if enabled.
+     *
+     * MUST only be called from the publication thread.
+     */
+    template <class F>
+    void ForEachClient(F f);
+
+    /**
+     * As ForEachClient, but reapable clients are skipped, and removed from
+     * the snapshot.
+     *
+     * MUST only be called from the publication thread.
+     */
+    template <class F>
+    void ForEachLiveClient(F f);
+
+    /**
+     * The client list is large enough to be fanned out
+     */
+    bool FanningOut() const {
+        return fanOut && clients.size() >= fanOutMinClients;
+    }
+
+    /**
+     * Push the message to every client, outside of a batch.
+     *
+     * MUST only be called from the publication thread.
+     */
+    void Dispatch(const Message& msg);
+
+    /**
+     * Push the message to every client in the current batch.
+     *
+     * MUST only be called from the publication thread.
+     */
+    void DispatchToBatch(const Message& msg);
+
+    /**
+     * Hold the message for the next micro-batch, dispatching the batch if it
+     * is now full or due.
+     */
+    void Defer(const Message& msg);
+
+    /**
+     * Remove the client from the publication thread's snapshot. It will be
+     * released from the subscription list by ReleaseClients.
+     *
+     * MUST only be called from the publication thread.
+     */
+    void RemoveClient(typename ClientList::iterator& client);
+
+    /**
+     * Holds the application's reference to a client created by NewClient.
+     * The application's handles share this, rather than the client, so we
+     * know when the last one has been dropped.
+     */
+    template <class Client>
+    struct ClientHandle {
+        ~ClientHandle() {
+            client->Abort();
+        }
+
+        std::shared_ptr<Client> client;
+    };
+
+    /**
+     * Check if the client is no longer interested in updates: either it has
+     * aborted, or we hold the only remaining references to it.
+     */
+    bool Reapable(const ClientRef& client);
+
+    /**
+     * Drop any reaped clients from the subscription list. If another thread
+     * currently has the subscription lock this is skipped, and will be
+     * re-attempted on the next publication.
+     *
+     * MUST only be called from the publication thread.
+     */
+    void ReleaseClients();
+
+    /**
+     * Drop dead clients from the subscription list.
+     *
+     * MUST be called under the subscription lock.
+     */
+    void PruneSubscriptions();
+
+    /**
+     * Build a new snapshot of the client list from the current
+     * subscriptions, and hand it over to the publication thread.
+     *
+     * MUST be called under the subscription lock.
+     */
+    void PublishClientList();
+
+    /**
+     * Adopt the most recent snapshot of the client list, if the
+     * subscriptions have changed since we last published.
+     *
+     * MUST only be called from the publication thread.
+     */
+    void UpdateClientList();
 
     // Lock the subscription mutex
     void DoLock();
@@ -129,11 +352,30 @@ private:
     /*********************************
      *           Data
      *********************************/
-    std::mutex                         subscriptionMutex;
+    ProfiledMutex<std::mutex>          subscriptionMutex;
     std::thread::id                    subscriptionLockOwner;
+    ClientList                         subscriptions;
+
+    // Owned by the publication thread
     ClientList                         clients;
+    // Handed over to the publication thread on the next publish
+    std::atomic<ClientList*>           nextClients;
     std::atomic<size_t>                numClients;
+    bool                               clientsReaped;
     std::unique_ptr<Batch>             currentBatch;
+    bool                               statsEnabled;
+
+    // Auto-batching (publication thread only), disabled if the size is 0
+    size_t                             autoBatchSize;
+    Clock::duration                    autoBatchDelay;
+    std::vector<Message>               pending;
+    Clock::time_point                  pendingSince;
+
+    // Fan-out (publication thread only), disabled if there is no pool
+    std::unique_ptr<FanOutPool>        fanOut;
+    size_t                             fanOutMinClients;
+    std::vector<char>                  fanOutReaped;
+    std::atomic<bool>                  fanOutAnyReaped;
 };
 
 
@@ -2,13 +2,22 @@
 
 template <class Message>
 PipePublisher<Message>::PipePublisher() 
-   : numClients(0)
+   : subscriptionMutex("PipePublisher::subscriptionMutex"),
+     nextClients(nullptr),
+     numClients(0),
+     clientsReaped(false),
+     statsEnabled(false),
+     autoBatchSize(0),
+     autoBatchDelay(Clock::duration::zero()),
+     fanOutMinClients(0),
+     fanOutAnyReaped(false)
 {
 }
 
 template <class Message>
 PipePublisher<Message>::~PipePublisher() 
 {
+    delete nextClients.exchange(nullptr);
 }
 
 template <class Message>
@@ -41,71 +50,261 @@ void PipePublisher<Message>::Unlock() {
 template<class Message>
 inline void PipePublisher<Message>::Done() {
     EndBatch();
+    Flush();
 
-    Lock clientLock(*this);
-
-    for (auto it = clients.begin(); it != clients.end();) {
-        ClientRef& client = *it;
+    UpdateClientList();
 
-        bool aborting = (
-                client->state.load(std::memory_order_relaxed) ==
-                IPipeConsumer<Message>::ABORTING);
+    ForEachLiveClient([] (ClientRef& client) -> void {
+        client->Done();
+    });
 
-        if (aborting || client.unique())
-        {
-            RemoveClient(it);
-        }
-        else
-        {
-            client->Done();
-            ++it;
-        }
-    }
+    ReleaseClients();
 }
 
 template <class Message>
 void PipePublisher<Message>::Publish(const Message& msg) {
     if (currentBatch.get()) {
+        DispatchToBatch(msg);
+    } else if (autoBatchSize) {
+        Defer(msg);
+    } else {
+        Dispatch(msg);
+    }
+}
+
+template <class Message>
+void PipePublisher<Message>::DispatchToBatch(const Message& msg) {
+    ForEachClient([&msg] (ClientRef& client) -> void {
+        client->PushMessage(msg);
+    });
+}
+
+template <class Message>
+void PipePublisher<Message>::Dispatch(const Message& msg) {
+    UpdateClientList();
+
+    ForEachLiveClient([&msg] (ClientRef& client) -> void {
+        client->PushMessage(msg);
+    });
+
+    ReleaseClients();
+}
+
+template <class Message>
+template <class F>
+void PipePublisher<Message>::ForEachClient(F f) {
+    if (FanningOut()) {
+        fanOut->Run([this, &f] (size_t shard) -> void {
+            const size_t shards = fanOut->Shards();
+            const size_t end = clients.size() * (shard + 1) / shards;
+
+            for (size_t i = clients.size() * shard / shards; i < end; ++i) {
+                f(clients[i]);
+            }
+        });
+    } else {
         for (auto it = clients.begin(); it != clients.end(); ++it) {
-            ClientRef& client = *it;
-            client->PushMessage(msg);
+            f(*it);
         }
-    } else if (numClients > 0) {
-        Lock clientLock(*this);
+    }
+}
 
+template <class Message>
+template <class F>
+void PipePublisher<Message>::ForEachLiveClient(F f) {
+    if (FanningOut()) {
+        /**
+         * The snapshot can't be modified whilst the shards are iterating it:
+         * flag the dead clients, and remove them once every shard is
+         * complete.
+         */
+        fanOutReaped.assign(clients.size(), 0);
+
+        fanOut->Run([this, &f] (size_t shard) -> void {
+            const size_t shards = fanOut->Shards();
+            const size_t end = clients.size() * (shard + 1) / shards;
+
+            for (size_t i = clients.size() * shard / shards; i < end; ++i) {
+                ClientRef& client = clients[i];
+                if (Reapable(client)) {
+                    fanOutReaped[i] = 1;
+                    fanOutAnyReaped.store(true, std::memory_order_relaxed);
+                } else {
+                    f(client);
+                }
+            }
+        });
+
+        if (fanOutAnyReaped.load(std::memory_order_relaxed)) {
+            fanOutAnyReaped.store(false, std::memory_order_relaxed);
+
+            size_t i = 0;
+            for (auto it = clients.begin(); it != clients.end(); ++i) {
+                if (fanOutReaped[i]) {
+                    RemoveClient(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+    } else {
         for (auto it = clients.begin(); it != clients.end();) {
             ClientRef& client = *it;
 
-            bool aborting = (
-                    client->state.load(std::memory_order_relaxed) ==
-                    IPipeConsumer<Message>::ABORTING);
-
-            if (aborting || client.unique())
+            if (Reapable(client))
             {
                 RemoveClient(it);
             }
             else
             {
-                client->PushMessage(msg);
+                f(client);
                 ++it;
             }
         }
     }
 }
 
+template <class Message>
+void PipePublisher<Message>::Defer(const Message& msg) {
+    const bool first = pending.empty();
+    if (first) {
+        pendingSince = Clock::now();
+    }
+
+    pending.push_back(msg);
+
+    // No need to check the clock if this is the only message being held
+    if (pending.size() >= autoBatchSize ||
+        (!first && Clock::now() - pendingSince >= autoBatchDelay))
+    {
+        Flush();
+    }
+}
+
+template <class Message>
+void PipePublisher<Message>::Flush() {
+    if (pending.size() == 1) {
+        // Not worth the cost of a batch
+        Dispatch(pending.front());
+    } else if (!pending.empty()) {
+        Batch batch(*this);
+
+        for (const Message& msg: pending) {
+            DispatchToBatch(msg);
+        }
+    }
+
+    pending.clear();
+}
+
+template <class Message>
+void PipePublisher<Message>::FlushIfDue() {
+    if (!pending.empty() && Clock::now() - pendingSince >= autoBatchDelay) {
+        Flush();
+    }
+}
+
+template <class Message>
+void PipePublisher<Message>::EnableAutoBatching(
+    size_t maxMessages,
+    std::chrono::microseconds maxDelay)
+{
+    Flush();
+
+    autoBatchSize = std::max<size_t>(maxMessages, 1);
+    autoBatchDelay = maxDelay;
+    pending.reserve(autoBatchSize);
+}
+
+template <class Message>
+void PipePublisher<Message>::DisableAutoBatching() {
+    Flush();
+
+    autoBatchSize = 0;
+    pending.shrink_to_fit();
+}
+
 template <class Message>
 template <class Client, class... Args>
 std::shared_ptr<Client> PipePublisher<Message>::NewClient(Args... args) {
-    std::shared_ptr<Client> client (new Client(this, args...));
-    InstallClient(client);
-    return client;
+    std::shared_ptr<ClientHandle<Client>> handle(new ClientHandle<Client>);
+    handle->client.reset(new Client(this, args...));
+    InstallClient(handle->client);
 
+    return std::shared_ptr<Client>(handle, handle->client.get());
+}
+
+template <class Message>
+void PipePublisher<Message>::RemoveClient(typename ClientList::iterator& it) {
+    it = clients.erase(it);
+    clientsReaped = true;
 }
 
 template <class Message>
-void PipePublisher<Message>::RemoveClient(typename ClientList::iterator it) {
-    clients.erase(it);
-    --numClients;
+bool PipePublisher<Message>::Reapable(const ClientRef& client) {
+    bool aborting = (
+            client->state.load(std::memory_order_relaxed) ==
+            IPipeConsumer<Message>::ABORTING);
+
+    /**
+     * The subscription list, and our snapshot, hold a reference each. Whilst
+     * a new snapshot is waiting to be picked up the count will be higher, so
+     * the client will be reaped after we have adopted it.
+     */
+    return (aborting || client.use_count() <= 2);
+}
+
+template <class Message>
+void PipePublisher<Message>::ReleaseClients() {
+    if (clientsReaped && TryLock()) {
+        PruneSubscriptions();
+        clientsReaped = false;
+        Unlock();
+    }
+}
+
+template <class Message>
+void PipePublisher<Message>::PruneSubscriptions() {
+    for (auto it = subscriptions.begin(); it != subscriptions.end();) {
+        bool aborting = (
+                (*it)->state.load(std::memory_order_relaxed) ==
+                IPipeConsumer<Message>::ABORTING);
+
+        if (aborting || it->unique()) {
+            it = subscriptions.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    numClients = subscriptions.size();
+}
+
+template <class Message>
+void PipePublisher<Message>::UpdateClientList() {
+    if (nextClients.load(std::memory_order_acquire)) {
+        std::unique_ptr<ClientList> next(
+            nextClients.exchange(nullptr, std::memory_order_acq_rel));
+
+        if (next.get()) {
+            // The old snapshot is released (along with any clients only it
+            // was keeping alive) when next goes out of scope.
+            clients.swap(*next);
+        }
+    }
+}
+
+template <class Message>
+void PipePublisher<Message>::PublishClientList() {
+    PruneSubscriptions();
+
+    std::unique_ptr<ClientList> next(new ClientList(subscriptions));
+
+    /**
+     * If the publication thread has not yet picked up the previous snapshot
+     * it never will, so it is safe to discard it.
+     */
+    delete nextClients.exchange(next.release(), std::memory_order_acq_rel);
 }
 
 template<class Message>
@@ -125,18 +324,48 @@ size_t PipePublisher<Message>::NumClients() {
     return numClients;
 }
 
+template<class Message>
+void PipePublisher<Message>::EnableStats(bool enable) {
+    Lock clientLock(*this);
+    statsEnabled = enable;
+
+    for (ClientRef& client: subscriptions) {
+        client->EnableStats(enable);
+    }
+}
+
+template<class Message>
+std::vector<PipeSubscriberStats> PipePublisher<Message>::Stats() {
+    std::vector<PipeSubscriberStats> stats;
+    Lock clientLock(*this);
+    stats.reserve(subscriptions.size());
+
+    for (ClientRef& client: subscriptions) {
+        PipeSubscriberStats clientStats;
+        if (client->GetStats(clientStats)) {
+            stats.push_back(clientStats);
+        }
+    }
+
+    return stats;
+}
+
 template<class Message>
 void PipePublisher<Message>::InstallClient(
     std::shared_ptr<IPipeConsumer<Message>> client)
 {
     Lock clientLock(*this);
+    client->EnableStats(statsEnabled);
     client->publishers.push_back(this);
-    clients.emplace_back(std::move(client));
-    ++numClients;
+    subscriptions.emplace_back(client);
+    PublishClientList();
 }
 
 template<class Message>
 void PipePublisher<Message>::StartBatch() {
+    // Anything held was published before the new batch
+    Flush();
+
     currentBatch.reset(nullptr); // Must destroy the old BEFORE allocating the
                                  // new, otherwise we get a deadlock
 
@@ -151,34 +380,59 @@ void PipePublisher<Message>::EndBatch() {
 
 template<class Message>
 inline PipePublisher<Message>::Batch::Batch(Type& _parent)
-   : parent(_parent), lock(Type::Lock(_parent))
+   : parent(_parent)
 {
-    for (auto it = parent.clients.begin(); it != parent.clients.end(); ++it) {
-        ClientRef& client = *it;
+    parent.UpdateClientList();
+
+    parent.ForEachClient([] (ClientRef& client) -> void {
         client->StartBatch();
-    }
+    });
 }
 
 
 template<class Message>
 PipePublisher<Message>::Batch::~Batch() {
-    for (auto it = parent.clients.begin(); it != parent.clients.end();) {
-        ClientRef& client = *it;
-
-        bool aborting = (
-                client->state.load(std::memory_order_relaxed) ==
-                IPipeConsumer<Message>::ABORTING);
-
-        if (aborting || client.unique())
-        {
+    /**
+     * Every client started the batch, so every client must end it - even
+     * one which has become reapable since. It holds its notification lock
+     * until EndBatch, which must be released before we drop our reference.
+     */
+    parent.ForEachClient([] (ClientRef& client) -> void {
+        client->EndBatch();
+    });
+
+    ClientList& clients = parent.clients;
+    for (auto it = clients.begin(); it != clients.end();) {
+        if (parent.Reapable(*it)) {
             parent.RemoveClient(it);
-        }
-        else
-        {
-            client->EndBatch();
+        } else {
             ++it;
         }
     }
+
+    parent.ReleaseClients();
+}
+
+template<class Message>
+void PipePublisher<Message>::EnableFanOut(
+    size_t helpers,
+    size_t minClients,
+    const WaitStrategy& strategy)
+{
+    // Clients must be pushed to from the same thread for the whole of a batch
+    EndBatch();
+    Flush();
+
+    fanOut.reset(new FanOutPool(helpers, strategy));
+    fanOutMinClients = minClients;
+}
+
+template<class Message>
+void PipePublisher<Message>::DisableFanOut() {
+    EndBatch();
+    Flush();
+
+    fanOut.reset(nullptr);
 }
 
 
@@ -0,0 +1,83 @@
+/*
+ * Record the messages published by a PipePublisher to a binary journal
+ *
+ *  Created on: 16th October 2026
+ */
+
+#ifndef DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_PIPE_RECORDER_H__
+#define DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_PIPE_RECORDER_H__
+
+#include "PipeSubscriber.h"
+#include "PipeJournal.h"
+#include <atomic>
+#include <type_traits>
+
+/**
+ * A consumer which captures the exact stream of messages emitted by a
+ * publisher, so that it can be replayed offline by a PipeReplayer:
+ *
+ *    auto recorder = publisher.NewClient<PipeRecorder<Msg>>("/tmp/prices");
+ *
+ * Each message is time-stamped, and appended to the journal, on the
+ * publisher's thread as it is published. There is no queue, and no extra
+ * thread: the cost to the publisher is a clock read and a copy into a
+ * memory mapped page. Rolling on to a new segment (creating and mapping a
+ * file) is also done on the publisher's thread, so segments should be large
+ * enough that this is rare.
+ *
+ * Messages are copied byte for byte, and so must be trivially copyable.
+ *
+ * Recording stops when the publisher is done, or the recorder is aborted,
+ * and the journal is finalised once the last reference to the recorder is
+ * released.
+ */
+template <class Message>
+class PipeRecorder: public IPipeConsumer<Message> {
+public:
+    static_assert(std::is_trivially_copyable<Message>::value,
+                  "Only trivially copyable messages can be recorded");
+
+    /**
+     * Start a new journal, replacing any previous recording at path.
+     *
+     * @param parent       The publisher we are being installed to (unused)
+     * @param path         Base name of the journal's segment files
+     * @param segmentSize  Size of each segment file
+     */
+    PipeRecorder(
+        PipePublisher<Message>* parent,
+        const std::string& path,
+        size_t segmentSize = PipeJournal::DEFAULT_SEGMENT_SIZE);
+
+    virtual ~PipeRecorder() {}
+
+    /**
+     * Number of messages recorded so far. May be called from any thread.
+     */
+    size_t Recorded() const {
+        return recorded.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Schedule the data recorded so far to be written back to disk.
+     *
+     * NOTE: Must not be called whilst the publisher may be publishing.
+     */
+    void Flush() {
+        journal.Flush();
+    }
+
+protected:
+    /**
+     * Publisher thread: append the message to the journal
+     */
+    virtual void PushMessage(const Message& msg) override;
+
+private:
+    PipeJournal::Writer   journal;
+    std::atomic<size_t>   recorded;
+};
+
+#include "PipeRecorder.hpp"
+
+#endif
@@ -0,0 +1,23 @@
+#include <chrono>
+
+template <class Message>
+PipeRecorder<Message>::PipeRecorder(
+    PipePublisher<Message>* parent,
+    const std::string& path,
+    size_t segmentSize)
+        : journal(path, sizeof(Message), segmentSize),
+          recorded(0)
+{
+}
+
+template <class Message>
+void PipeRecorder<Message>::PushMessage(const Message& msg) {
+    const uint64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    journal.Append(now, &msg);
+
+    // Only the publisher thread updates the counter
+    recorded.store(recorded.load(std::memory_order_relaxed) + 1,
+                   std::memory_order_relaxed);
+}
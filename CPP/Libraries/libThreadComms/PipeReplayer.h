@@ -0,0 +1,67 @@
+/*
+ * Re-publish a journal captured by a PipeRecorder
+ *
+ *  Created on: 16th October 2026
+ */
+
+#ifndef DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_PIPE_REPLAYER_H__
+#define DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_PIPE_REPLAYER_H__
+
+#include "PipePublisher.h"
+#include "PipeJournal.h"
+#include <type_traits>
+
+/**
+ * A load source for benchmarking consumers, driven by a stream captured from
+ * production:
+ *
+ *    PipePublisher<Msg> publisher;
+ *    auto client = publisher.NewClient(1024);
+ *
+ *    PipeReplayer<Msg> replayer("/tmp/prices");
+ *    replayer.Replay(publisher, PipeReplayer<Msg>::ORIGINAL);
+ *
+ * Messages are published on the calling thread, which becomes the
+ * publisher's thread for the duration of the replay.
+ */
+template <class Message>
+class PipeReplayer {
+public:
+    static_assert(std::is_trivially_copyable<Message>::value,
+                  "Only trivially copyable messages can be replayed");
+
+    enum PACING {
+        ORIGINAL,           // Reproduce the gaps between the recorded messages
+        AS_FAST_AS_POSSIBLE // Publish each message as soon as it is read
+    };
+
+    /**
+     * Open the journal at path.
+     *
+     * Throws a PipeJournal::JournalException if there is no such journal,
+     * or it holds a different message type.
+     */
+    PipeReplayer(const std::string& path);
+
+    /**
+     * Publish every message in the journal to target, and then return. The
+     * publisher is not marked as done, so several journals may be replayed
+     * through it.
+     *
+     * With ORIGINAL pacing the first message is published immediately, and
+     * each subsequent message at the same offset from the start of the replay
+     * as it was from the first message in the recording. If the consumers
+     * can not keep up (with a BLOCK subscriber, say) the replay falls behind,
+     * and then publishes as fast as possible until it has caught up.
+     *
+     * @returns The number of messages published
+     */
+    size_t Replay(PipePublisher<Message>& target, PACING pacing = ORIGINAL);
+
+private:
+    const std::string path;
+};
+
+#include "PipeReplayer.hpp"
+
+#endif
@@ -0,0 +1,56 @@
+#include <chrono>
+#include <thread>
+
+template <class Message>
+PipeReplayer<Message>::PipeReplayer(const std::string& _path)
+    : path(_path)
+{
+    // Fail early if the journal is not usable
+    PipeJournal::Reader check(path, sizeof(Message));
+}
+
+template <class Message>
+size_t PipeReplayer<Message>::Replay(
+    PipePublisher<Message>& target,
+    PACING pacing)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    /**
+     * Sleeping is only accurate to tens of microseconds: spin for the last
+     * stretch of each gap.
+     */
+    const Clock::duration spinThreshold = std::chrono::microseconds(100);
+
+    PipeJournal::Reader journal(path, sizeof(Message));
+    Message msg;
+    uint64_t timestamp = 0;
+    uint64_t first = 0;
+    size_t published = 0;
+    const Clock::time_point start = Clock::now();
+
+    while (journal.Next(timestamp, &msg)) {
+        if (published == 0) {
+            first = timestamp;
+        }
+
+        if (pacing == ORIGINAL) {
+            // The wall clock may have been stepped back during the recording
+            const uint64_t offset = (timestamp > first) ? timestamp - first : 0;
+            const Clock::time_point due = start + std::chrono::nanoseconds(offset);
+
+            Clock::duration wait = due - Clock::now();
+            if (wait > spinThreshold) {
+                std::this_thread::sleep_for(wait - spinThreshold);
+            }
+
+            while (Clock::now() < due) {
+            }
+        }
+
+        target.Publish(msg);
+        ++published;
+    }
+
+    return published;
+}
@@ -0,0 +1,161 @@
+/*
+ * Publish updates to the consumers of a single key
+ *
+ *  Created on: 16th October 2026
+ */
+
+#ifndef DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_PIPE_ROUTER_H__
+#define DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_PIPE_ROUTER_H__
+
+#include <PipePublisher.h>
+#include <boost/lockfree/queue.hpp>
+#include <unordered_map>
+#include <functional>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+/**
+ * Keyed variant of the PipePublisher: each message is published under a key
+ * (e.g an instrument), and is only pushed to the clients subscribed to that
+ * key, plus any wildcard clients (subscribed to every key). Clients
+ * therefore don't pay for the copy, or the queue space, of messages they
+ * would only discard.
+ *
+ * Each key is a topic with its own PipePublisher, so the clients of a key
+ * behave exactly as if subscribed to a PipePublisher: any IPipeConsumer may
+ * be installed, and adding (or dropping) a client never stalls publication.
+ *
+ * The index from key to topic is owned by the publication thread. A topic is
+ * created by the first subscription to its key, and handed over to the
+ * publication thread via a lock-free queue, to be adopted on the next
+ * publication. Publishing to a key with no topic is a single hash lookup.
+ *
+ * Topics are never removed: memory is bounded by the number of distinct keys
+ * subscribed to, rather than the number of subscriptions. Dead clients are
+ * reaped by their topic on its next publication.
+ *
+ * As for the PipePublisher, only a single thread may publish.
+ */
+template <class Message, class Key, class Hash = std::hash<Key>>
+class PipeRouter {
+public:
+    typedef PipeRouter<Message, Key, Hash> Type;
+
+    /**
+     * @param expectedKeys  Number of keys to size the index for. The index
+     *                      is re-hashed (on the publication thread) if this
+     *                      is exceeded.
+     */
+    PipeRouter(size_t expectedKeys = 1024);
+
+    virtual ~PipeRouter();
+
+    PipeRouter(const PipeRouter& rhs) = delete;
+    PipeRouter& operator=(const PipeRouter& rhs) = delete;
+
+    /**
+     * Create a new subscription to messages published under key.
+     *
+     * See PipePublisher::NewClient
+     */
+    template <class Client = PipeSubscriber<Message>, class... Args>
+    std::shared_ptr<Client> NewClient(const Key& key, Args... args);
+
+    void InstallClient(
+        const Key& key,
+        std::shared_ptr<IPipeConsumer<Message>> client);
+
+    /**
+     * Create a new subscription to messages published under any key.
+     */
+    template <class Client = PipeSubscriber<Message>, class... Args>
+    std::shared_ptr<Client> NewWildcardClient(Args... args);
+
+    void InstallWildcardClient(std::shared_ptr<IPipeConsumer<Message>> client);
+
+    /**
+     * Publish a new message to the clients of key, and the wildcard clients.
+     */
+    void Publish(const Key& key, const Message& msg);
+
+    /**
+     * Start a new batch of messages. See PipePublisher::StartBatch.
+     *
+     * The batch is only started on a topic when a message is first published
+     * to it, so the cost of a batch is proportional to the number of keys
+     * published to, rather than the number of keys.
+     */
+    void StartBatch();
+
+    /**
+     * End the current batch. See PipePublisher::EndBatch.
+     */
+    void EndBatch();
+
+    /**
+     * Notify all clients (of all keys) that no more updates will be
+     * published.
+     */
+    void Done();
+
+    /**
+     * Number of keys which have been subscribed to.
+     */
+    size_t NumKeys();
+
+    /**
+     * Number of clients subscribed to key (excluding wildcard clients).
+     */
+    size_t NumClients(const Key& key);
+
+    size_t NumWildcardClients();
+
+private:
+    struct Topic {
+        Topic(const Key& _key) : key(_key), batching(false) { }
+
+        const Key               key;
+        PipePublisher<Message>  publisher;
+
+        // Owned by the publication thread
+        bool                    batching;
+    };
+
+    /**
+     * Find the topic for key, creating it (and handing it over to the
+     * publication thread) if required.
+     */
+    Topic& GetTopic(const Key& key);
+
+    /**
+     * Add any newly created topics to the index.
+     *
+     * MUST only be called from the publication thread.
+     */
+    void AdoptTopics();
+
+    /*********************************
+     *     Subscription side
+     *********************************/
+    std::mutex                                        topicMutex;
+    std::unordered_map<Key, std::unique_ptr<Topic>, Hash> topics;
+
+    // Topics waiting to be adopted by the publication thread
+    boost::lockfree::queue<Topic*>                    newTopics;
+    std::atomic<bool>                                 topicsAdded;
+
+    /*********************************
+     *     Publication thread
+     *********************************/
+    std::unordered_map<Key, Topic*, Hash>             index;
+    std::vector<Topic*>                               batchTopics;
+    bool                                              batching;
+
+    PipePublisher<Message>                            wildcard;
+};
+
+#include "PipeRouter.hpp"
+
+#endif
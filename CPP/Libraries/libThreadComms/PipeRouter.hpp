@@ -0,0 +1,169 @@
+template <class Message, class Key, class Hash>
+PipeRouter<Message, Key, Hash>::PipeRouter(size_t expectedKeys)
+    : newTopics(128),
+      topicsAdded(false),
+      batching(false)
+{
+    topics.reserve(expectedKeys);
+    index.reserve(expectedKeys);
+}
+
+template <class Message, class Key, class Hash>
+PipeRouter<Message, Key, Hash>::~PipeRouter() {
+    // Topics are owned by the topics map: just discard the hand-over
+    Topic* topic = nullptr;
+    while (newTopics.pop(topic)) { }
+}
+
+template <class Message, class Key, class Hash>
+template <class Client, class... Args>
+std::shared_ptr<Client> PipeRouter<Message, Key, Hash>::NewClient(
+    const Key& key,
+    Args... args)
+{
+    return GetTopic(key).publisher.template NewClient<Client>(args...);
+}
+
+template <class Message, class Key, class Hash>
+void PipeRouter<Message, Key, Hash>::InstallClient(
+    const Key& key,
+    std::shared_ptr<IPipeConsumer<Message>> client)
+{
+    GetTopic(key).publisher.InstallClient(client);
+}
+
+template <class Message, class Key, class Hash>
+template <class Client, class... Args>
+std::shared_ptr<Client> PipeRouter<Message, Key, Hash>::NewWildcardClient(
+    Args... args)
+{
+    return wildcard.template NewClient<Client>(args...);
+}
+
+template <class Message, class Key, class Hash>
+void PipeRouter<Message, Key, Hash>::InstallWildcardClient(
+    std::shared_ptr<IPipeConsumer<Message>> client)
+{
+    wildcard.InstallClient(client);
+}
+
+template <class Message, class Key, class Hash>
+typename PipeRouter<Message, Key, Hash>::Topic&
+    PipeRouter<Message, Key, Hash>::GetTopic(const Key& key)
+{
+    std::unique_lock<std::mutex> lock(topicMutex);
+    std::unique_ptr<Topic>& topic = topics[key];
+
+    if (!topic.get()) {
+        topic.reset(new Topic(key));
+
+        /**
+         * The topic is installed before we return, so the subscription is
+         * live from the next publication (just as for a PipePublisher).
+         */
+        newTopics.push(topic.get());
+        topicsAdded.store(true, std::memory_order_release);
+    }
+
+    /**
+     * Topics are never removed, so the reference remains valid once we
+     * release the lock.
+     */
+    return *topic;
+}
+
+template <class Message, class Key, class Hash>
+void PipeRouter<Message, Key, Hash>::AdoptTopics() {
+    /**
+     * Reset before draining the queue, as a single exchange: a relaxed store
+     * could land after the drain, wiping the flag of a topic the drain
+     * missed. The plain load keeps the read-modify-write off the publication
+     * path until there is something to adopt.
+     */
+    if (topicsAdded.load(std::memory_order_relaxed) &&
+        topicsAdded.exchange(false, std::memory_order_acq_rel))
+    {
+
+        newTopics.consume_all([this] (Topic* topic) -> void {
+            index[topic->key] = topic;
+        });
+    }
+}
+
+template <class Message, class Key, class Hash>
+void PipeRouter<Message, Key, Hash>::Publish(const Key& key, const Message& msg) {
+    AdoptTopics();
+
+    auto it = index.find(key);
+    if (it != index.end()) {
+        Topic& topic = *it->second;
+
+        if (batching && !topic.batching) {
+            topic.batching = true;
+            topic.publisher.StartBatch();
+            batchTopics.push_back(&topic);
+        }
+
+        topic.publisher.Publish(msg);
+    }
+
+    wildcard.Publish(msg);
+}
+
+template <class Message, class Key, class Hash>
+void PipeRouter<Message, Key, Hash>::StartBatch() {
+    EndBatch();
+
+    batching = true;
+    wildcard.StartBatch();
+}
+
+template <class Message, class Key, class Hash>
+void PipeRouter<Message, Key, Hash>::EndBatch() {
+    if (batching) {
+        for (Topic* topic: batchTopics) {
+            topic->publisher.EndBatch();
+            topic->batching = false;
+        }
+        batchTopics.clear();
+
+        wildcard.EndBatch();
+        batching = false;
+    }
+}
+
+template <class Message, class Key, class Hash>
+void PipeRouter<Message, Key, Hash>::Done() {
+    EndBatch();
+    AdoptTopics();
+
+    for (auto& pair: index) {
+        pair.second->publisher.Done();
+    }
+
+    wildcard.Done();
+}
+
+template <class Message, class Key, class Hash>
+size_t PipeRouter<Message, Key, Hash>::NumKeys() {
+    std::unique_lock<std::mutex> lock(topicMutex);
+    return topics.size();
+}
+
+template <class Message, class Key, class Hash>
+size_t PipeRouter<Message, Key, Hash>::NumClients(const Key& key) {
+    size_t clients = 0;
+    std::unique_lock<std::mutex> lock(topicMutex);
+
+    auto it = topics.find(key);
+    if (it != topics.end()) {
+        clients = it->second->publisher.NumClients();
+    }
+
+    return clients;
+}
+
+template <class Message, class Key, class Hash>
+size_t PipeRouter<Message, Key, Hash>::NumWildcardClients() {
+    return wildcard.NumClients();
+}
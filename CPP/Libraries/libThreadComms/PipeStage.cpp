@@ -0,0 +1,75 @@
+/*
+ * PipeStage.cpp
+ *
+ *  Created on: 16th October 2026
+ */
+
+#include "PipeStage.h"
+#include <sstream>
+#include <iomanip>
+
+namespace {
+    /**
+     * The busiest stage is the bottleneck. If nothing is doing any work, the
+     * stage that is furthest behind is the best guess.
+     */
+    size_t FindBottleneck(const std::vector<PipeStageStats>& stats) {
+        size_t bottleneck = 0;
+        for (size_t i = 1; i < stats.size(); ++i) {
+            const PipeStageStats& current = stats[bottleneck];
+            const PipeStageStats& candidate = stats[i];
+
+            if (candidate.busy > current.busy ||
+                (candidate.busy == current.busy &&
+                 candidate.queueDepth > current.queueDepth))
+            {
+                bottleneck = i;
+            }
+        }
+        return bottleneck;
+    }
+}
+
+std::string PipeStageReport(const std::vector<const IPipeStage*>& stages) {
+    std::vector<PipeStageStats> stats;
+    stats.reserve(stages.size());
+    for (const IPipeStage* stage: stages) {
+        stats.push_back(stage->Stats());
+    }
+
+    std::stringstream report;
+    report << std::left << std::setw(20) << "Stage" << std::right
+           << std::setw(8) << "Workers"
+           << std::setw(12) << "Processed"
+           << std::setw(12) << "Rate (/s)"
+           << std::setw(8) << "Busy %"
+           << std::setw(10) << "p50 (ns)"
+           << std::setw(10) << "p99 (ns)"
+           << std::setw(12) << "Max (ns)"
+           << std::setw(8) << "Queue"
+           << std::setw(8) << "HWM"
+           << std::endl;
+
+    const size_t bottleneck = FindBottleneck(stats);
+    for (size_t i = 0; i < stats.size(); ++i) {
+        const PipeStageStats& stage = stats[i];
+        report << std::left << std::setw(20) << stage.name << std::right
+               << std::setw(8) << stage.workers
+               << std::setw(12) << stage.processed
+               << std::setw(12) << static_cast<uint64_t>(stage.rate)
+               << std::setw(8) << std::fixed << std::setprecision(1)
+                               << stage.busy * 100
+               << std::setw(10) << stage.p50
+               << std::setw(10) << stage.p99
+               << std::setw(12) << stage.max
+               << std::setw(8) << stage.queueDepth
+               << std::setw(8) << stage.highWaterMark;
+
+        if (i == bottleneck) {
+            report << "  <- bottleneck";
+        }
+        report << std::endl;
+    }
+
+    return report.str();
+}
@@ -0,0 +1,225 @@
+/*
+ * A stage of a multi-threaded processing pipeline
+ *
+ *  Created on: 16th October 2026
+ */
+
+#ifndef DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_PIPE_STAGE_H__
+#define DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_PIPE_STAGE_H__
+
+#include "PipePublisher.h"
+#include "WorkerThread.h"
+#include "LatencyHistogram.h"
+#include <logger.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <functional>
+
+/**
+ * Snapshot of a stage's counters, see PipeStage::Stats
+ */
+struct PipeStageStats {
+    std::string name;
+    size_t      workers;
+    size_t      processed;      // Messages published by the stage
+    double      rate;           // Messages per second, since construction
+    double      busy;           // Fraction of worker time spent in the transform
+    uint64_t    p50;            // Transform time per message (ns)
+    uint64_t    p99;
+    uint64_t    max;
+    size_t      queueDepth;     // Unread messages on the input queue
+    size_t      highWaterMark;  // Deepest the input queue has been
+};
+
+/**
+ * Untyped interface to a PipeStage, so that the stages of a pipeline can be
+ * reported on together.
+ */
+class IPipeStage {
+public:
+    virtual PipeStageStats Stats() const = 0;
+
+    virtual ~IPipeStage() {}
+};
+
+/**
+ * Format a table of the stats of each stage of a pipeline, marking the
+ * bottleneck: the busiest stage, or if none is busy the stage with the
+ * deepest input queue.
+ */
+std::string PipeStageReport(const std::vector<const IPipeStage*>& stages);
+
+/**
+ * A stage of a pipeline, e.g decode -> enrich -> publish:
+ *
+ *    PipePublisher<Raw> source;
+ *    PipeStage<Raw, Decoded> decode("decode", source, Decode);
+ *    PipeStage<Decoded, Enriched> enrich("enrich", decode.Output(), Enrich, 4);
+ *
+ *    auto sink = enrich.Output().NewClient(1024);
+ *
+ * The stage consumes from its input publisher on its own WorkerThread,
+ * applies the transform, and publishes the result to Output(). Each message
+ * is copied once into the stage's input queue, and once into each consumer
+ * of the output.
+ *
+ * Every queue between threads is a bounded single-producer / single-consumer
+ * ring of queueSize messages. The stage subscribes to its input with the
+ * BLOCK policy, so a slow stage applies back-pressure to the stages before
+ * it rather than growing (or dropping) without bound.
+ *
+ * Parallel stages
+ * ---------------
+ * If workers > 1, the transform is run on that many additional threads. The
+ * stage thread assigns each message a sequence number, and deals messages
+ * round-robin to the workers. Results are collected in sequence order, so
+ * the output order always matches the input order. The transform must
+ * therefore be safe to call concurrently.
+ *
+ * The number of messages in flight to each worker is limited to queueSize:
+ * once every slot is taken the stage stops reading its input until results
+ * are collected.
+ *
+ * Lifetime
+ * --------
+ * The stage subscribes to its input, and starts processing, on construction.
+ * Stages should be built from the source towards the sink, and consumers of
+ * the final output installed, before anything is published. Messages
+ * published to Output() before it has any clients are dropped, as for any
+ * other PipePublisher.
+ *
+ * The end of the input (PipePublisher::Done) is not propagated.
+ */
+template <class In, class Out>
+class PipeStage: public IPipeStage {
+public:
+    typedef std::function<Out (const In&)> Transform;
+
+    /**
+     * @param name       Name of the stage, for the report
+     * @param input      The publisher to consume from
+     * @param f          The transform to apply to each message
+     * @param workers    Number of threads to run the transform on. With
+     *                   one worker the transform is run on the stage thread.
+     * @param queueSize  Capacity of each queue between threads
+     */
+    PipeStage(const std::string& name,
+              PipePublisher<In>& input,
+              const Transform& f,
+              size_t workers = 1,
+              size_t queueSize = 1024);
+
+    virtual ~PipeStage();
+
+    PipeStage(const PipeStage& rhs) = delete;
+    PipeStage& operator=(const PipeStage& rhs) = delete;
+
+    /**
+     * Downstream stages, and consumers, subscribe here.
+     */
+    PipePublisher<Out>& Output() {
+        return output;
+    }
+
+    /**
+     * Snapshot the counters of the stage. May be called from any thread.
+     */
+    virtual PipeStageStats Stats() const override;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Job {
+        uint64_t seq;
+        In       msg;
+    };
+
+    struct Result {
+        uint64_t seq;
+        Out      msg;
+    };
+
+    /**
+     * A thread running the transform. For a single worker stage this is
+     * the stage thread itself, and there are no queues.
+     */
+    struct Lane {
+        Lane(size_t queueSize);
+
+        std::shared_ptr<PipeSubscriber<Job>>     jobQueue;
+        std::shared_ptr<PipeSubscriber<Result>>  resultQueue;
+
+        /**
+         * Publisher thread: stage thread (jobs) / lane thread (results)
+         */
+        PipePublisher<Job>     jobs;
+        PipePublisher<Result>  results;
+
+        /**
+         * Stage thread only
+         */
+        size_t                 inFlight;
+
+        /**
+         * Written by the thread running the transform
+         */
+        std::atomic<size_t>    processed;
+        std::atomic<uint64_t>  busyNs;
+        LatencyHistogram       serviceTime;
+
+        std::unique_ptr<WorkerThread>  thread;
+    };
+
+    /**
+     * Run the transform, and record its cost against lane.
+     */
+    Out Apply(Lane& lane, const In& msg);
+
+    /**
+     * Stage thread: consume from the input, either transforming directly
+     * (single worker), or dealing to the lanes.
+     */
+    void ReadInput();
+
+    /**
+     * Lane thread: run the transform on the lane's jobs
+     */
+    void RunJobs(Lane& lane);
+
+    /**
+     * Stage thread: publish results in sequence order
+     */
+    void CollectResults();
+
+    const std::string                    name;
+    const Transform                      transform;
+    const size_t                         queueSize;
+    const Clock::time_point              started;
+
+    std::shared_ptr<PipeSubscriber<In>>  input;
+    PipePublisher<Out>                   output;
+
+    std::vector<std::unique_ptr<Lane>>   lanes;
+
+    /**
+     * Stage thread only (the high-water mark may be read by anyone)
+     */
+    std::vector<In>                      slice;
+    uint64_t                             nextDispatch;
+    uint64_t                             nextCollect;
+    bool                                 inputPaused;
+    std::atomic<size_t>                  highWaterMark;
+
+    /**
+     * Declared last: the thread must be stopped before anything it uses is
+     * destroyed.
+     */
+    WorkerThread                         stageThread;
+};
+
+#include "PipeStage.hpp"
+
+#endif
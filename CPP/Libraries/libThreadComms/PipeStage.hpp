@@ -0,0 +1,221 @@
+template <class In, class Out>
+PipeStage<In, Out>::Lane::Lane(size_t queueSize)
+    : inFlight(0),
+      processed(0),
+      busyNs(0)
+{
+    /**
+     * No more than queueSize messages are ever in flight on a lane, so
+     * neither queue can fill. (A single worker stage has no queues.)
+     */
+    if (queueSize > 0) {
+        jobQueue = jobs.NewClient(queueSize);
+        resultQueue = results.NewClient(queueSize);
+        thread.reset(new WorkerThread);
+    }
+}
+
+template <class In, class Out>
+PipeStage<In, Out>::PipeStage(
+    const std::string& _name,
+    PipePublisher<In>& source,
+    const Transform& f,
+    size_t workers,
+    size_t _queueSize)
+        : name(_name),
+          transform(f),
+          queueSize(_queueSize),
+          started(Clock::now()),
+          slice(_queueSize),
+          nextDispatch(0),
+          nextCollect(0),
+          inputPaused(false),
+          highWaterMark(0)
+{
+    input = source.NewClient(queueSize, PipeSubscriber<In>::BLOCK);
+
+    if (workers > 1) {
+        // The stage thread only deals, the transform runs on the lanes
+        for (size_t i = 0; i < workers; ++i) {
+            lanes.emplace_back(new Lane(queueSize));
+            Lane& lane = *lanes.back();
+            lane.thread->PostTask([this, &lane] () -> void {
+                this->RunJobs(lane);
+            });
+            lane.thread->Start();
+        }
+
+        stageThread.PostTask([this] () -> void {
+            this->CollectResults();
+        });
+    } else {
+        lanes.emplace_back(new Lane(0));
+    }
+
+    stageThread.PostTask([this] () -> void { this->ReadInput(); });
+    stageThread.Start();
+}
+
+template <class In, class Out>
+PipeStage<In, Out>::~PipeStage() {
+    // Release anyone blocked publishing to us
+    input->Abort();
+
+    stageThread.Abort();
+    for (std::unique_ptr<Lane>& lane: lanes) {
+        if (lane->thread) {
+            lane->thread->Abort();
+        }
+    }
+
+    stageThread.Join();
+    for (std::unique_ptr<Lane>& lane: lanes) {
+        if (lane->thread) {
+            lane->thread->Join();
+        }
+    }
+}
+
+template <class In, class Out>
+Out PipeStage<In, Out>::Apply(Lane& lane, const In& msg) {
+    const Clock::time_point start = Clock::now();
+
+    Out result = transform(msg);
+
+    const uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock::now() - start).count();
+
+    lane.serviceTime.Record(ns);
+    lane.busyNs.store(lane.busyNs.load(std::memory_order_relaxed) + ns,
+                      std::memory_order_relaxed);
+    lane.processed.store(lane.processed.load(std::memory_order_relaxed) + 1,
+                         std::memory_order_relaxed);
+
+    return result;
+}
+
+template <class In, class Out>
+void PipeStage<In, Out>::ReadInput() {
+    /**
+     * Sampled as we wake, which is when the queue is at its deepest. (Rather
+     * than enabling stats on the input publisher, which would cost every
+     * other subscriber too.)
+     */
+    const size_t depth = input->Stats().queueDepth;
+    if (depth > highWaterMark.load(std::memory_order_relaxed)) {
+        highWaterMark.store(depth, std::memory_order_relaxed);
+    }
+
+    if (lanes.size() == 1) {
+        Lane& lane = *lanes.front();
+        const size_t count = input->GetNextMessages(slice.data(), slice.size());
+
+        if (count > 1) {
+            output.StartBatch();
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            output.Publish(Apply(lane, slice[i]));
+        }
+
+        output.EndBatch();
+
+        input->OnNextMessage([this] () -> void { this->ReadInput(); }, &stageThread);
+    } else {
+        Lane* lane = lanes[nextDispatch % lanes.size()].get();
+        bool space = (lane->inFlight < queueSize);
+        In msg;
+
+        while (space && input->GetNextMessage(msg)) {
+            lane->jobs.Publish(Job{nextDispatch, msg});
+            ++lane->inFlight;
+            ++nextDispatch;
+
+            lane = lanes[nextDispatch % lanes.size()].get();
+            space = (lane->inFlight < queueSize);
+        }
+
+        if (space) {
+            input->OnNextMessage([this] () -> void { this->ReadInput(); }, &stageThread);
+        } else {
+            // Resumed by CollectResults once the lane has drained
+            inputPaused = true;
+        }
+    }
+}
+
+template <class In, class Out>
+void PipeStage<In, Out>::RunJobs(Lane& lane) {
+    Job job;
+    size_t count = 0;
+    while (count < queueSize && lane.jobQueue->GetNextMessage(job)) {
+        lane.results.Publish(Result{job.seq, Apply(lane, job.msg)});
+        ++count;
+    }
+
+    lane.jobQueue->OnNextMessage(
+        [this, &lane] () -> void { this->RunJobs(lane); },
+        lane.thread.get());
+}
+
+template <class In, class Out>
+void PipeStage<In, Out>::CollectResults() {
+    Result result;
+    Lane* lane = lanes[nextCollect % lanes.size()].get();
+
+    bool collected = false;
+    while (lane->resultQueue->GetNextMessage(result)) {
+        collected = true;
+
+        if (result.seq != nextCollect) {
+            SLOG_FROM(LOG_ERROR, "PipeStage::CollectResults",
+                      "Stage " << name << " expected sequence " << nextCollect
+                      << ", but got " << result.seq);
+        }
+
+        output.Publish(result.msg);
+        --lane->inFlight;
+        ++nextCollect;
+
+        lane = lanes[nextCollect % lanes.size()].get();
+    }
+
+    lane->resultQueue->OnNextMessage(
+        [this] () -> void { this->CollectResults(); },
+        &stageThread);
+
+    if (collected && inputPaused) {
+        inputPaused = false;
+        ReadInput();
+    }
+}
+
+template <class In, class Out>
+PipeStageStats PipeStage<In, Out>::Stats() const {
+    PipeStageStats stats;
+    stats.name = name;
+    stats.workers = lanes.size();
+    stats.processed = 0;
+
+    LatencyHistogram serviceTime;
+    uint64_t busyNs = 0;
+    for (const std::unique_ptr<Lane>& lane: lanes) {
+        stats.processed += lane->processed.load(std::memory_order_relaxed);
+        busyNs += lane->busyNs.load(std::memory_order_relaxed);
+        serviceTime.Merge(lane->serviceTime);
+    }
+
+    const double elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock::now() - started).count();
+
+    stats.rate = (elapsed > 0) ? stats.processed * 1e9 / elapsed : 0;
+    stats.busy = (elapsed > 0) ? busyNs / (elapsed * lanes.size()) : 0;
+    stats.p50 = serviceTime.Percentile(50);
+    stats.p99 = serviceTime.Percentile(99);
+    stats.max = serviceTime.Max();
+
+    stats.queueDepth = input->Stats().queueDepth;
+    stats.highWaterMark = highWaterMark.load(std::memory_order_relaxed);
+
+    return stats;
+}
@@ -16,11 +16,46 @@
 #include <bitset>
 #include <thread>
 #include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include "WaitStrategy.h"
+#include <ProfiledMutex.h>
+#include "Future.h"
 
 template <class Message>
 class PipePublisher;
 class IPostable;
 
+/**
+ * Snapshot of a single subscription's counters, as reported by
+ * PipePublisher::Stats.
+ *
+ * Apart from the queue depth, and the full queue counters (which are always
+ * maintained), the counters only advance whilst stats are enabled on the
+ * publisher.
+ */
+struct PipeSubscriberStats {
+    PipeSubscriberStats();
+
+    size_t    pushed;          // Messages queued (or forwarded) by the publisher
+    size_t    consumed;        // Messages read by the client
+    size_t    queueDepth;      // Unread messages at the time of the snapshot
+    size_t    highWaterMark;   // Largest queue depth seen by the publisher
+
+    size_t    dropped;         // See PipeSubscriber::DroppedMessages
+    size_t    blocked;         // See PipeSubscriber::BlockedMessages
+    bool      disconnected;    // See PipeSubscriber::Disconnected
+
+    size_t    lockWaits;       // Times the publisher found onNotify locked
+    uint64_t  lockWaitNs;      // Total time the publisher spent waiting for it
+
+    size_t    batches;         // Completed batches
+    size_t    batchedMessages; // Messages published as part of a batch
+    size_t    largestBatch;    // Most messages published in a single batch
+};
+
 template <class Message>
 class IPipeConsumer {
 public:
@@ -91,6 +126,23 @@ protected:
      * NOTE: This will be triggered on the publisher's thread
      */
     virtual void EndBatch() {}
+
+    /**
+     * Start, or stop, maintaining the counters reported by GetStats.
+     *
+     * NOTE: This may be called from any thread.
+     */
+    virtual void EnableStats(bool enable) {}
+
+    /**
+     * Populate stats with a snapshot of the consumer's counters.
+     *
+     * Implementations which do not keep stats should leave the default,
+     * which returns false.
+     *
+     * NOTE: This may be called from any thread.
+     */
+    virtual bool GetStats(PipeSubscriberStats& stats) const { return false; }
 private:
     /**
      *
@@ -127,6 +179,22 @@ class PipeSubscriber: public IPipeConsumer<Message> {
 public:
     typedef PipeSubscriber<Message> Type;
 
+    /**
+     * What to do when the publisher pushes to a full queue.
+     */
+    enum FullQueuePolicy {
+        THROW,       // Throw PushToFullQueueException on the publisher thread
+        BLOCK,       // Spin the publisher until there is space (or the
+                     // subscription is aborted, or the last handle to the
+                     // client is dropped)
+        DROP_NEWEST, // Discard the message being published
+        DROP_OLDEST, // Discard the oldest unread message. NOTE: Since the
+                     // publisher must now pop from the queue, reads from the
+                     // queue will take a (usually uncontended) lock.
+        DISCONNECT   // Abort the subscription. Unread messages may still be
+                     // read, but no further messages will be published.
+    };
+
     virtual ~PipeSubscriber();
 
     /** 
@@ -142,7 +210,139 @@ public:
     bool GetNextMessage(Message& msg);
 
     /**
-     * Trigger a callback function ON **ETIHER** the publisher thread OR the
+     * Pop up to max messages off the queue in one go, populating the
+     * contiguous array out.
+     *
+     * This is considerably cheaper than repeated calls to GetNextMessage,
+     * since the queue indices are only read and updated once.
+     *
+     * @param out   Array of at least max messages to populate
+     * @param max   The maximum number of messages to pop
+     *
+     * @returns The number of messages populated
+     */
+    size_t GetNextMessages(Message* out, size_t max);
+
+    /**
+     * Batch aware variant of GetNextMessages: only messages from batches
+     * the publisher has ended are popped. Messages from a batch still in
+     * progress are left on the queue.
+     *
+     * Messages published outside of a batch are available immediately. If
+     * the FullQueuePolicy is BLOCK, and a batch will not fit on the queue,
+     * the publisher releases the partial batch rather than wait forever.
+     *
+     * @param out   Array of at least max messages to populate
+     * @param max   The maximum number of messages to pop
+     *
+     * @returns The number of messages populated
+     */
+    size_t GetCommittedMessages(Message* out, size_t max);
+
+    /**
+     * Number of messages that GetCommittedMessages could currently pop.
+     */
+    size_t CommittedMessages() const;
+
+    /**
+     * Block the current thread until there is a message to pop, and populate
+     * msg with the result.
+     *
+     * This bypasses the OnNextMessage callback machinery: the publisher
+     * wakes the waiting thread directly (if it is parked), so the hand-off
+     * cost is determined by the wait strategy.
+     *
+     * NOTE: Only a single thread may wait on the subscriber at a time.
+     *
+     * @param msg       The message to populate.
+     * @param strategy  How to wait for the next message.
+     *
+     * @returns true if msg was populated, false if the subscription has ended
+     *          and there are no messages left to read.
+     */
+    bool WaitForMessage(
+        Message& msg,
+        const WaitStrategy& strategy = WaitStrategy::Blocking());
+
+    /**
+     * Non-blocking equivalent of WaitForMessage: returns a future for the
+     * next message, e.g
+     *
+     *    client->NextMessage(worker).Then(Handle);
+     *
+     * If a message is already waiting, the future is completed immediately
+     * on the calling thread. Otherwise the message is read on target's
+     * event loop (never the publisher thread) once it arrives, and the
+     * future is completed there.
+     *
+     * If the subscription has already ended and there is nothing left to
+     * read, the future fails with a FutureException. (As for OnNextMessage,
+     * there is no notification if the subscription ends whilst waiting.)
+     *
+     * NOTE: The subscriber must outlive the wait, and no other thread may
+     *       read from it until the future has completed.
+     *
+     * NOTE: A loop which consumes messages by calling NextMessage from a
+     *       continuation should give that continuation a target, otherwise
+     *       a backlog of messages is consumed by recursion.
+     */
+    Future<Message> NextMessage(IPostable& target);
+
+    struct ReadyFdException {
+        std::string msg;
+    };
+
+    /**
+     * File descriptor (an eventfd) which becomes readable when there are
+     * messages to read, allowing many subscribers (and sockets) to be waited
+     * on from a single epoll / boost::asio loop, e.g:
+     *
+     *    boost::asio::posix::stream_descriptor ready(io, client->ReadyFd());
+     *
+     * The publisher only signals the descriptor when the queue moves from
+     * empty to non-empty, and no lock is taken on the publish path. This is
+     * edge triggered: the consumer should:
+     *    1. Wait for the descriptor to become readable
+     *    2. Call ClearReady (or read the 8 byte counter itself)
+     *    3. Read messages until a read comes back short (GetNextMessage
+     *       returns false, or GetNextMessages returns fewer than max)
+     * Only then is the descriptor re-armed: stopping before the queue has
+     * been drained means there will be no further signal.
+     *
+     * Messages published in a batch are signalled once the batch is
+     * complete, so the descriptor can also drive GetCommittedMessages.
+     *
+     * Once the subscription has ended (see Ended) the descriptor is left
+     * readable.
+     *
+     * The descriptor is created on the first call, and closed when the
+     * subscriber is destroyed.
+     *
+     * NOTE: Only the client thread may call this function.
+     *
+     * @returns The file descriptor. ReadyFdException is thrown if the eventfd
+     *          could not be created.
+     */
+    int ReadyFd();
+
+    /**
+     * Reset the descriptor returned by ReadyFd, before reading from the
+     * queue. A no-op if there is nothing to clear.
+     */
+    void ClearReady();
+
+    /**
+     * True once the publisher has finished, or the subscription has been
+     * aborted: no further messages will be published. Unread messages may
+     * still be read.
+     */
+    bool Ended() {
+        return this->State() != IPipeConsumer<Message>::CONSUMING;
+    }
+
+    /**
+     * Trigger a callback function ON **ETIHER** the publisher thread (or one
+     * of its fan-out helpers, see PipePublisher::EnableFanOut) OR the
      * current thread when there is at least one unread message. This can be
      * used to trigger a post to the subscriber thread if desired, e.g using
      * boost::asio::io_service::post.
@@ -169,7 +369,8 @@ public:
 
     /**
      * Trigger a callback function for each new message received by the
-     * subsciber. The function will be called from the **PUBLISHER THREAD**.
+     * subsciber. The function will be called from the **PUBLISHER THREAD**
+     * (or one of its fan-out helpers, see PipePublisher::EnableFanOut).
      *
      * If there are any unread message currently in the queue, these will be 
      * triggered on the **CURRENT THREAD** before this function returns. 
@@ -184,6 +385,36 @@ public:
     typedef std::function<void(const Message&)> NewMessasgCallback;
     void OnNewMessage(const NewMessasgCallback&  f);
 
+    /**
+     * Number of messages discarded due to the FullQueuePolicy.
+     */
+    size_t DroppedMessages() const {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Number of messages the publisher had to wait for space for (BLOCK
+     * policy only).
+     */
+    size_t BlockedMessages() const {
+        return blocked.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * True if the subscription was aborted because the queue was full
+     * (DISCONNECT policy only).
+     */
+    bool Disconnected() const {
+        return disconnected.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Snapshot of the subscription's counters. Unless stats have been enabled
+     * on the publisher (see PipePublisher::EnableStats), only the queue depth
+     * and full queue counters are populated.
+     */
+    PipeSubscriberStats Stats() const;
+
 protected:
     friend class PipePublisher<Message>;
     /*********************************
@@ -192,12 +423,15 @@ protected:
     /**
      * Create a new consumer:
      *
-     * @param maxSize  Maximum unread messages before an exception is
+     * @param maxSize  Maximum unread messages before the policy is
      *                 triggered on the producer.
+     * @param policy   What to do when there are already maxSize unread
+     *                 messages.
      */
     PipeSubscriber(
         PipePublisher<Message>* parent,
-        size_t maxSize);
+        size_t maxSize,
+        FullQueuePolicy policy = THROW);
 
      struct PushToFullQueueException {
          Message msg;
@@ -222,13 +456,78 @@ private:
      virtual void OnStateChange() final;
      virtual void StartBatch() final;
      virtual void EndBatch() final;
+     virtual void EnableStats(bool enable) final;
+     virtual bool GetStats(PipeSubscriberStats& stats) const final;
     void NotifyNextMessage();
 
+    typedef std::unique_lock<ProfiledMutex<std::mutex>> Lock;
+
+    /**
+     * Lock onNotifyMutex from the publisher thread. If stats are enabled, and
+     * the lock is contended, the time spent waiting is recorded.
+     */
+    Lock LockNotify();
+
+    /**
+     * Push the message on to the queue, applying the FullQueuePolicy if
+     * there is no space.
+     *
+     * @returns true if msg was added to the queue.
+     */
+    bool Enqueue(const Message& msg);
+    bool OnFullQueue(const Message& msg);
+
+    /**
+     * Pop from the queue, respecting the DROP_OLDEST lock.
+     */
+    bool Pop(Message& msg);
+    size_t Pop(Message* out, size_t max, bool committedOnly = false);
+
+    /**
+     * Move the next message off the queue and pass it to f, rather than
+     * assigning it to a default constructed copy.
+     */
+    template <class F>
+    bool Consume(F&& f);
+
+    /**
+     * Ready descriptor handshake. A read which came back short arms the
+     * descriptor; the publisher disarms it when it next signals.
+     */
+    void ArmReady(bool committedOnly);
+    void SignalReady();
+
+    /**
+     * Release the messages pushed so far to GetCommittedMessages. Publisher
+     * thread only.
+     */
+    void Commit();
+
+    /**
+     * Record that count messages have been removed from the queue.
+     */
+    void CountTaken(size_t count);
+
+    void CountDrop();
+
+    /**
+     * Stats counters: a no-op unless stats are enabled
+     */
+    void CountPush();
+    void CountConsumed(size_t count);
+
+    /**
+     * Single writer counter: only the publisher thread may update it.
+     */
+    static void Increment(std::atomic<size_t>& counter, size_t count = 1) {
+        counter.store(counter.load(std::memory_order_relaxed) + count,
+                      std::memory_order_relaxed);
+    }
+
     /***********************************
      *          Synchronisation
      ***********************************/
-    typedef std::unique_lock<std::mutex> Lock;
-    std::mutex                           onNotifyMutex;
+    ProfiledMutex<std::mutex>            onNotifyMutex;
 
     /***********************************
      * Unread data Notification
@@ -249,9 +548,52 @@ private:
      *           Data
      *********************************/
     bool                 batching;
-    bool                 aborted;
+    std::atomic<bool>    aborted;
 
     boost::lockfree::spsc_queue<Message>  messages;
+
+    /**
+     * Batch boundaries: messages which have been committed, and taken off
+     * the queue (by the client, or dropped by DROP_OLDEST), since the
+     * subscription started. Committed is only written by the publisher,
+     * uncommitted is publisher only.
+     */
+    std::atomic<size_t>  committed;
+    size_t               uncommitted;
+    std::atomic<size_t>  taken;
+
+    // Consumer blocked in WaitForMessage
+    Parker               waiter;
+
+    // Consumer waiting on ReadyFd (-1 until requested)
+    int                  readyFd;
+    std::atomic<bool>    readyFdEnabled;
+    std::atomic<bool>    readyArmed;
+
+    /*********************************
+     *     Full Queue Handling
+     *********************************/
+    const FullQueuePolicy  policy;
+    std::mutex             popMutex;
+    std::atomic<size_t>    dropped;
+    std::atomic<size_t>    blocked;
+    std::atomic<bool>      disconnected;
+
+    /*********************************
+     *          Stats
+     *********************************/
+    std::atomic<bool>      keepStats;
+    // Updated by the publisher thread
+    std::atomic<size_t>    pushed;
+    std::atomic<size_t>    highWaterMark;
+    std::atomic<size_t>    lockWaits;
+    std::atomic<uint64_t>  lockWaitNs;
+    std::atomic<size_t>    batches;
+    std::atomic<size_t>    batchedMessages;
+    std::atomic<size_t>    largestBatch;
+    size_t                 batchPushed;
+    // Updated by the client thread
+    std::atomic<size_t>    consumed;
 };
 
 
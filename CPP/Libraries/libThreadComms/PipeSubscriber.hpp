@@ -1,7 +1,30 @@
 #include <PipePublisher.h>
 #include <IPostable.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
 
 
+inline PipeSubscriberStats::PipeSubscriberStats()
+    : pushed(0),
+      consumed(0),
+      queueDepth(0),
+      highWaterMark(0),
+      dropped(0),
+      blocked(0),
+      disconnected(false),
+      lockWaits(0),
+      lockWaitNs(0),
+      batches(0),
+      batchedMessages(0),
+      largestBatch(0)
+{
+}
+
 template<class Message>
 IPipeConsumer<Message>::IPipeConsumer()
    : state(CONSUMING)
@@ -47,14 +70,36 @@ bool IPipeConsumer<Message>::ChangeState(STATE& current, STATE to) {
 template <class Message>
 PipeSubscriber<Message>::PipeSubscriber(
     PipePublisher<Message>* _parent,
-    size_t maxSize)
-        : onNotify(nullptr),
+    size_t maxSize,
+    FullQueuePolicy _policy)
+        : onNotifyMutex("PipeSubscriber::onNotifyMutex"),
+          onNotify(nullptr),
           targetToNotify(nullptr),
           onNewMessage(nullptr),
           batching(false),
           aborted(false),
-          messages(maxSize)
+          messages(maxSize),
+          committed(0),
+          uncommitted(0),
+          taken(0),
+          policy(_policy),
+          dropped(0),
+          blocked(0),
+          disconnected(false),
+          keepStats(false),
+          pushed(0),
+          highWaterMark(0),
+          lockWaits(0),
+          lockWaitNs(0),
+          batches(0),
+          batchedMessages(0),
+          largestBatch(0),
+          batchPushed(0),
+          consumed(0)
 {
+    readyFd = -1;
+    readyFdEnabled = false;
+    readyArmed = false;
     forwardMessage = false;
     notifyOnMessage = false;
 }
@@ -65,6 +110,10 @@ PipeSubscriber<Message>::~PipeSubscriber() {
     if (batching) {
         PipeSubscriber<Message>::EndBatch();
     }
+
+    if (readyFd >= 0) {
+        close(readyFd);
+    }
 }
 
 template<class Message>
@@ -89,27 +138,25 @@ void PipeSubscriber<Message>::PushMessage(const Message& msg) {
             // Already locked...
             onNewMessage(msg);
         } else {
-            Lock notifyLock(onNotifyMutex);
+            Lock notifyLock(LockNotify());
             // No need to re-check post-lock since it is not possible to
             // unset the onNewMessage callback
             onNewMessage(msg);
         }
+        CountPush();
+        CountConsumed(1);
     } else {
         if (batching)
         {
-            if ( !messages.push(msg) ) {
-                throw PushToFullQueueException {msg};
-            }
+            Enqueue(msg);
         }
         else
         {
             if (notifyOnMessage)
             {
-                Lock notifyLock(onNotifyMutex);
+                Lock notifyLock(LockNotify());
 
-                if ( !messages.push(msg) ) {
-                    throw PushToFullQueueException {msg};
-                }
+                Enqueue(msg);
 
                 if (notifyOnMessage)
                 {
@@ -118,49 +165,496 @@ void PipeSubscriber<Message>::PushMessage(const Message& msg) {
             }
             else
             {
-                if ( !messages.push(msg) ) {
-                    throw PushToFullQueueException {msg};
-                }
+                Enqueue(msg);
 
                 if (notifyOnMessage)
                 {
-                    Lock notifyLock(onNotifyMutex);
+                    Lock notifyLock(LockNotify());
                     if (notifyOnMessage)
                     {
                         NotifyNextMessage();
                     }
                 }
             }
+
+            SignalReady();
+        }
+
+        waiter.Wake();
+    }
+}
+
+template <class Message>
+bool PipeSubscriber<Message>::Enqueue(const Message& msg) {
+    bool pushed = messages.push(msg);
+
+    if (!pushed) {
+        pushed = OnFullQueue(msg);
+    }
+
+    if (pushed) {
+        ++uncommitted;
+        if (!batching) {
+            Commit();
+        }
+
+        CountPush();
+    }
+
+    return pushed;
+}
+
+template <class Message>
+void PipeSubscriber<Message>::Commit() {
+    if (uncommitted) {
+        committed.store(committed.load(std::memory_order_relaxed) + uncommitted,
+                        std::memory_order_release);
+        uncommitted = 0;
+    }
+}
+
+template <class Message>
+bool PipeSubscriber<Message>::OnFullQueue(const Message& msg) {
+    bool pushed = false;
+
+    switch (policy) {
+    case THROW:
+        throw PushToFullQueueException {msg};
+        break;
+
+    case BLOCK:
+        // Only the publisher thread updates the counters
+        Increment(blocked);
+
+        if (batching) {
+            // The client may be waiting for the batch to complete before
+            // draining the queue.
+            Commit();
+
+            if (notifyOnMessage) {
+                NotifyNextMessage();
+            }
+            SignalReady();
+
+            /**
+             * The client must be able to re-register for notifications
+             * whilst it drains the queue, so we can't keep the notification
+             * lock for the rest of the batch whilst we wait.
+             */
+            onNotifyMutex.unlock();
+        }
+
+        while (!pushed && this->State() == IPipeConsumer<Message>::CONSUMING)
+        {
+            std::this_thread::yield();
+            pushed = messages.push(msg);
+        }
+
+        if (batching) {
+            // Held until EndBatch
+            LockNotify().release();
+        }
+
+        if (!pushed) {
+            CountDrop();
+        }
+        break;
+
+    case DROP_NEWEST:
+        CountDrop();
+        break;
+
+    case DROP_OLDEST:
+        {
+            std::unique_lock<std::mutex> popLock(popMutex);
+            if (messages.consume_one([] (const Message&) -> void { })) {
+                /**
+                 * Committed messages are always at the front of the queue,
+                 * so if none are left we have just dropped part of the
+                 * current batch.
+                 */
+                if (CommittedMessages() == 0 && uncommitted > 0) {
+                    --uncommitted;
+                } else {
+                    CountTaken(1);
+                }
+                CountDrop();
+            }
+            pushed = messages.push(msg);
+        }
+        break;
+
+    case DISCONNECT:
+        CountDrop();
+        disconnected = true;
+        IPipeConsumer<Message>::Abort();
+        break;
+    }
+
+    return pushed;
+}
+
+template <class Message>
+void PipeSubscriber<Message>::CountDrop() {
+    Increment(dropped);
+}
+
+template <class Message>
+void PipeSubscriber<Message>::CountPush() {
+    if (keepStats.load(std::memory_order_relaxed)) {
+        Increment(pushed);
+
+        if (batching) {
+            ++batchPushed;
+        }
+
+        const size_t depth = messages.read_available();
+        if (depth > highWaterMark.load(std::memory_order_relaxed)) {
+            highWaterMark.store(depth, std::memory_order_relaxed);
+        }
+    }
+}
+
+template <class Message>
+void PipeSubscriber<Message>::CountConsumed(size_t count) {
+    /**
+     * Usually only the client thread consumes, but forwarded messages are
+     * consumed on the publisher thread.
+     */
+    if (count && keepStats.load(std::memory_order_relaxed)) {
+        consumed.fetch_add(count, std::memory_order_relaxed);
+    }
+}
+
+template <class Message>
+typename PipeSubscriber<Message>::Lock PipeSubscriber<Message>::LockNotify() {
+    Lock notifyLock(onNotifyMutex, std::defer_lock);
+
+    if (keepStats.load(std::memory_order_relaxed) && !notifyLock.try_lock()) {
+        /**
+         * Only pay for the clock when we actually have to wait.
+         */
+        typedef std::chrono::steady_clock Clock;
+        const Clock::time_point start = Clock::now();
+        notifyLock.lock();
+        const uint64_t waited = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            Clock::now() - start).count();
+
+        Increment(lockWaits);
+        lockWaitNs.store(lockWaitNs.load(std::memory_order_relaxed) + waited,
+                         std::memory_order_relaxed);
+    } else if (!notifyLock.owns_lock()) {
+        notifyLock.lock();
+    }
+
+    return notifyLock;
+}
+
+template <class Message>
+void PipeSubscriber<Message>::EnableStats(bool enable) {
+    keepStats.store(enable, std::memory_order_relaxed);
+}
+
+template <class Message>
+bool PipeSubscriber<Message>::GetStats(PipeSubscriberStats& stats) const {
+    stats.pushed = pushed.load(std::memory_order_relaxed);
+    stats.consumed = consumed.load(std::memory_order_relaxed);
+    stats.queueDepth = messages.read_available();
+    stats.highWaterMark = highWaterMark.load(std::memory_order_relaxed);
+    stats.dropped = DroppedMessages();
+    stats.blocked = BlockedMessages();
+    stats.disconnected = Disconnected();
+    stats.lockWaits = lockWaits.load(std::memory_order_relaxed);
+    stats.lockWaitNs = lockWaitNs.load(std::memory_order_relaxed);
+    stats.batches = batches.load(std::memory_order_relaxed);
+    stats.batchedMessages = batchedMessages.load(std::memory_order_relaxed);
+    stats.largestBatch = largestBatch.load(std::memory_order_relaxed);
+
+    return true;
+}
+
+template <class Message>
+PipeSubscriberStats PipeSubscriber<Message>::Stats() const {
+    PipeSubscriberStats stats;
+    GetStats(stats);
+
+    return stats;
+}
+
+template <class Message>
+bool PipeSubscriber<Message>::Pop(Message& msg) {
+    bool popped = false;
+    if (policy == DROP_OLDEST) {
+        std::unique_lock<std::mutex> popLock(popMutex);
+        popped = messages.pop(msg);
+        CountTaken(popped ? 1 : 0);
+    } else {
+        popped = messages.pop(msg);
+        CountTaken(popped ? 1 : 0);
+    }
+
+    if (popped) {
+        CountConsumed(1);
+    } else {
+        ArmReady(false);
+    }
+    return popped;
+}
+
+template <class Message>
+template <class F>
+bool PipeSubscriber<Message>::Consume(F&& f) {
+    /**
+     * Moved off the queue before f is called: f may well come back to us for
+     * the next message, and must not find this one still at the front (or
+     * the DROP_OLDEST lock held).
+     */
+    struct Destroy {
+        void operator()(Message* msg) { msg->~Message(); }
+    };
+    typename std::aligned_storage<
+        sizeof(Message), alignof(Message)>::type storage;
+    std::unique_ptr<Message, Destroy> msg;
+    auto take = [&] (Message& next) -> void {
+        msg.reset(new (&storage) Message(std::move(next)));
+    };
+
+    if (policy == DROP_OLDEST) {
+        std::unique_lock<std::mutex> popLock(popMutex);
+        CountTaken(messages.consume_one(take) ? 1 : 0);
+    } else {
+        CountTaken(messages.consume_one(take) ? 1 : 0);
+    }
+
+    if (msg) {
+        CountConsumed(1);
+        f(*msg);
+    } else {
+        ArmReady(false);
+    }
+    return static_cast<bool>(msg);
+}
+
+template <class Message>
+size_t PipeSubscriber<Message>::Pop(Message* out, size_t max, bool committedOnly) {
+    const size_t requested = max;
+    size_t popped = 0;
+    if (policy == DROP_OLDEST) {
+        // Hold the lock whilst reading the boundary: the publisher may drop
+        std::unique_lock<std::mutex> popLock(popMutex);
+        if (committedOnly) {
+            max = std::min(max, CommittedMessages());
+        }
+        popped = messages.pop(out, max);
+        CountTaken(popped);
+    } else {
+        if (committedOnly) {
+            max = std::min(max, CommittedMessages());
+        }
+        popped = messages.pop(out, max);
+        CountTaken(popped);
+    }
+
+    CountConsumed(popped);
+
+    if (popped < requested) {
+        ArmReady(committedOnly);
+    }
+    return popped;
+}
+
+template <class Message>
+int PipeSubscriber<Message>::ReadyFd() {
+    if (readyFd < 0) {
+        readyFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (readyFd < 0) {
+            throw ReadyFdException{
+                std::string("Failed to create eventfd: ") + strerror(errno)};
+        }
+
+        // Publishes readyFd to the publisher thread
+        readyFdEnabled.store(true, std::memory_order_release);
+
+        // Anything already on the queue must be signalled
+        ArmReady(false);
+    }
+
+    return readyFd;
+}
+
+template <class Message>
+void PipeSubscriber<Message>::ClearReady() {
+    if (readyFd >= 0) {
+        uint64_t count = 0;
+        while (read(readyFd, &count, sizeof(count)) < 0 && errno == EINTR) {
+        }
+    }
+}
+
+template <class Message>
+void PipeSubscriber<Message>::ArmReady(bool committedOnly) {
+    if (readyFdEnabled.load(std::memory_order_relaxed) &&
+        !readyArmed.load(std::memory_order_relaxed))
+    {
+        readyArmed.store(true, std::memory_order_relaxed);
+
+        /**
+         * Pairs with the fence in SignalReady: either the publisher sees the
+         * descriptor armed, or we see its message here.
+         */
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        const bool unread = committedOnly ? CommittedMessages() > 0
+                                          : messages.read_available() > 0;
+        if ((unread || Ended()) && readyArmed.exchange(false)) {
+            const uint64_t one = 1;
+            while (write(readyFd, &one, sizeof(one)) < 0 && errno == EINTR) {
+            }
+        }
+    }
+}
+
+template <class Message>
+void PipeSubscriber<Message>::SignalReady() {
+    /**
+     * A single load when the descriptor is not in use. Otherwise the write
+     * is only made on the empty -> non-empty transition, whilst the consumer
+     * is waiting.
+     */
+    if (readyFdEnabled.load(std::memory_order_acquire)) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (readyArmed.load(std::memory_order_relaxed) &&
+            readyArmed.exchange(false))
+        {
+            const uint64_t one = 1;
+            while (write(readyFd, &one, sizeof(one)) < 0 && errno == EINTR) {
+            }
         }
     }
 }
 
+template <class Message>
+void PipeSubscriber<Message>::CountTaken(size_t count) {
+    /**
+     * Written by the client thread, or (under the pop lock) the publisher
+     * for DROP_OLDEST.
+     */
+    if (count) {
+        taken.store(taken.load(std::memory_order_relaxed) + count,
+                    std::memory_order_relaxed);
+    }
+}
+
 template<class Message>
 void PipeSubscriber<Message>::OnStateChange() {
     typename IPipeConsumer<Message>::STATE state = this->State();
     if (state == IPipeConsumer<Message>::ABORTING)
     {
         /**
-         * The subscriber is a single threaded CLIENT, which means that the
-         * abort MUST have come from the CLIENT thread, so it is safe to
-         * not-atomically acquire and update aborted;
-         *
-         * (Aborting from the publisher thread, or any other thread, is a bug)
+         * Usually the abort comes from the CLIENT thread, but the publisher
+         * may also disconnect us if the queue is full (DISCONNECT policy).
          */
         aborted = true;
     }
+
+    // Anyone waiting on us needs to know that there is nothing more coming.
+    waiter.Wake();
+    SignalReady();
 }
 
 template <class Message>
 bool PipeSubscriber<Message>::GetNextMessage(Message& msg) {
     bool gotMsg = false;
-    if ( messages.pop(msg) ) {
+    if ( Pop(msg) ) {
         gotMsg = true;
     }
 
     return gotMsg;
 }
 
+template <class Message>
+size_t PipeSubscriber<Message>::GetNextMessages(Message* out, size_t max) {
+    return Pop(out, max);
+}
+
+template <class Message>
+size_t PipeSubscriber<Message>::GetCommittedMessages(Message* out, size_t max) {
+    return Pop(out, max, true);
+}
+
+template <class Message>
+size_t PipeSubscriber<Message>::CommittedMessages() const {
+    const size_t c = committed.load(std::memory_order_acquire);
+    const size_t t = taken.load(std::memory_order_relaxed);
+
+    return (c > t) ? c - t : 0;
+}
+
+template <class Message>
+bool PipeSubscriber<Message>::WaitForMessage(
+    Message& msg,
+    const WaitStrategy& strategy)
+{
+    auto ready = [this] () -> bool {
+        return (messages.read_available() > 0 ||
+                this->State() != IPipeConsumer<Message>::CONSUMING);
+    };
+
+    bool gotMsg = Pop(msg);
+    while (!gotMsg && this->State() == IPipeConsumer<Message>::CONSUMING) {
+        waiter.Wait(strategy, ready);
+        gotMsg = Pop(msg);
+    }
+
+    if (!gotMsg) {
+        // Subscription has ended, but there may have been a final message
+        gotMsg = Pop(msg);
+    }
+
+    return gotMsg;
+}
+
+template <class Message>
+Future<Message> PipeSubscriber<Message>::NextMessage(IPostable& target) {
+    std::shared_ptr<Promise<Message>> promise(
+        FutureDetail::NewPromise<Message>());
+    Future<Message> result = promise->GetFuture();
+
+    auto fulfil = [&promise] (Message& msg) -> void {
+        promise->SetValue(std::move(msg));
+    };
+
+    if (Consume(fulfil)) {
+        return result;
+    }
+
+    if (this->aborted || this->State() != IPipeConsumer<Message>::CONSUMING) {
+        // Subscription has ended, but there may have been a final message
+        if (!Consume(fulfil)) {
+            promise->SetError(std::make_exception_ptr(
+                FutureException{"Subscription has ended"}));
+        }
+    } else {
+        /**
+         * Always posted: OnNextMessage may call us back with onNotifyMutex
+         * held, and the continuations must be free to wait again.
+         */
+        OnNextMessage([this, promise] () -> void {
+            auto fulfil = [&promise] (Message& msg) -> void {
+                promise->SetValue(std::move(msg));
+            };
+
+            if (!Consume(fulfil)) {
+                promise->SetError(std::make_exception_ptr(
+                    FutureException{"Subscription has ended"}));
+            }
+        }, &target);
+    }
+
+    return result;
+}
+
 template <class Message>
 void PipeSubscriber<Message>::OnNextMessage(const NextMessageCallback& f) {
     this->OnNextMessage(f,nullptr);
@@ -168,8 +662,10 @@ void PipeSubscriber<Message>::OnNextMessage(const NextMessageCallback& f) {
 
 template<class Message>
 void PipeSubscriber<Message>::StartBatch() {
+    // Held until EndBatch
+    LockNotify().release();
     batching = true;
-    onNotifyMutex.lock();
+    batchPushed = 0;
 
 }
 
@@ -179,6 +675,17 @@ void PipeSubscriber<Message>::EndBatch() {
 
         batching = false;
 
+        // Released before the client is notified
+        Commit();
+
+        if (keepStats.load(std::memory_order_relaxed)) {
+            Increment(batches);
+            Increment(batchedMessages, batchPushed);
+            if (batchPushed > largestBatch.load(std::memory_order_relaxed)) {
+                largestBatch.store(batchPushed, std::memory_order_relaxed);
+            }
+        }
+
         if (notifyOnMessage) {
             if (targetToNotify) {
                 targetToNotify->PostTask(onNotify);
@@ -190,6 +697,8 @@ void PipeSubscriber<Message>::EndBatch() {
             notifyOnMessage = false;
         }
 
+        SignalReady();
+
         onNotifyMutex.unlock();
     }
 }
@@ -228,6 +737,6 @@ void PipeSubscriber<Message>::OnNewMessage(const NewMessasgCallback& f) {
 
         forwardMessage = true;
         onNewMessage = f;
-        while (!this->aborted && messages.consume_one(f)) { }
+        while (!this->aborted && Consume(f)) { }
     }
 }
@@ -0,0 +1,83 @@
+/*
+ * Storage shared between a RingPublisher and its subscribers
+ *
+ *  Created on: 16th October 2026
+ */
+
+#ifndef DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_RING_BUFFER_H__
+#define DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_RING_BUFFER_H__
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+
+/**
+ * Pre-allocated ring of messages, with a single write cursor.
+ *
+ * Synchronisation with the readers is left to the RingPublisher: it is the
+ * publisher's responsibility not to wrap over unread data.
+ */
+template <class Message>
+class RingBuffer {
+public:
+    /**
+     * @param size  Minimum number of messages, rounded up to a power of two.
+     */
+    RingBuffer(size_t size)
+        : ring(RoundUp(size)),
+          mask(ring.size() - 1),
+          writeCursor(0)
+    {
+    }
+
+    /**
+     * The slot for the specified sequence
+     */
+    Message& operator[](uint64_t seq) {
+        return ring[seq & mask];
+    }
+
+    const Message& operator[](uint64_t seq) const {
+        return ring[seq & mask];
+    }
+
+    size_t Size() const {
+        return ring.size();
+    }
+
+    /**
+     * The next sequence to be written: all sequences before this one may be
+     * read.
+     */
+    uint64_t WriteCursor() const {
+        return writeCursor.load();
+    }
+
+    /**
+     * Mark all sequences up to (but not including) seq as readable.
+     *
+     * NOTE: Only the publisher thread may call this.
+     */
+    void Commit(uint64_t seq) {
+        writeCursor.store(seq);
+    }
+
+private:
+    static size_t RoundUp(size_t size) {
+        size_t rounded = 1;
+        while (rounded < size) {
+            rounded <<= 1;
+        }
+        return rounded;
+    }
+
+    std::vector<Message>     ring;
+    const uint64_t           mask;
+
+    // Keep the cursor away from any neighbouring data
+    char                     pad1[64];
+    std::atomic<uint64_t>    writeCursor;
+    char                     pad2[64];
+};
+
+#endif
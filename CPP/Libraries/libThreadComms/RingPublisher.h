@@ -0,0 +1,157 @@
+/*
+ * Publish updates to multiple consumers via a single shared ring buffer
+ *
+ *  Created on: 16th October 2026
+ */
+
+#ifndef DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_RING_PUBLISHER_H__
+#define DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_RING_PUBLISHER_H__
+
+#include <RingSubscriber.h>
+#include <RingBuffer.h>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <memory>
+
+/**
+ * Alternative to the PipePublisher, for large numbers of consumers
+ * ("disruptor" style).
+ *
+ * Rather than copying each message into a queue per client, each message is
+ * copied exactly once into a single pre-allocated ring. Each RingSubscriber
+ * only holds a read cursor into the ring.
+ *
+ * The ring is never allowed to wrap over unread data: if it is full, the
+ * publisher will wait for the slowest consumer to catch up. (A consumer which
+ * is never drained will therefore stall the publisher - use Abort, or drop the
+ * client, to stop consuming.)
+ *
+ * The consumer side API (GetNextMessage, OnNextMessage, OnNewMessage) matches
+ * PipeSubscriber.
+ */
+template <class Message>
+class RingPublisher {
+public:
+    typedef RingPublisher<Message> Type;
+
+    /**
+     * Create a new publisher
+     *
+     * @param size   The number of messages in the ring. This will be rounded
+     *               up to the next power of two.
+     */
+    RingPublisher(size_t size);
+
+    virtual ~RingPublisher();
+
+    /**
+     * Create a new subscription to the publisher. The client will receive all
+     * messages published after this call returns.
+     */
+    std::shared_ptr<RingSubscriber<Message>> NewClient();
+
+    /**
+     * Publish a new message to all clients.
+     *
+     * NOTE: Only one thread may publish.
+     */
+    void Publish(const Message& msg);
+
+    /**
+     * Start a new batch of messages.
+     *
+     * As for PipePublisher, unread message notifications will be deferred
+     * until the batch is completed, unless the publisher is forced to wait on
+     * a client.
+     *
+     * EndBatch MUST be called on completion of the batch.
+     */
+    void StartBatch();
+
+    /**
+     * End the current batch.
+     *
+     * If there is not currently a batch being processed, this call has no
+     * effect.
+     */
+    void EndBatch();
+
+    size_t NumClients();
+
+    /**
+     * Number of messages the ring can hold
+     */
+    size_t Size() const { return ring->Size(); }
+private:
+    friend class RingSubscriber<Message>;
+
+    typedef std::shared_ptr<RingSubscriber<Message>> ClientRef;
+    typedef std::vector<ClientRef> ClientList;
+
+    /**
+     * Adopt the most recent snapshot of the client list, see PipePublisher.
+     *
+     * This is done on every publish, even mid-batch: a new client must be
+     * gated on as soon as it has subscribed. Clients which join (or leave)
+     * the list mid-batch are moved into (or out of) the batch.
+     *
+     * MUST only be called from the publication thread.
+     */
+    void UpdateClientList();
+
+    /**
+     * Hand a new snapshot of the client list to the publication thread.
+     *
+     * MUST be called under the subscription lock.
+     */
+    void PublishClientList();
+
+    /**
+     * Check if the client has aborted, or we hold the only remaining
+     * references to it.
+     */
+    bool Reapable(const ClientRef& client);
+
+    /**
+     * Drop any reaped clients from the subscription list, if the subscription
+     * lock is free.
+     *
+     * MUST only be called from the publication thread.
+     */
+    void ReleaseClients();
+
+    /**
+     * Drop dead clients from the subscription list.
+     *
+     * MUST be called under the subscription lock.
+     */
+    void PruneSubscriptions();
+
+    /**
+     * Wait until the slowest client has read the slot to be written by seq.
+     *
+     * @returns The new gating sequence
+     */
+    uint64_t WaitForSlot(uint64_t seq);
+
+    /*********************************
+     *           Data
+     *********************************/
+    std::shared_ptr<RingBuffer<Message>> ring;
+
+    // Owned by the publication thread
+    uint64_t                           gatingSequence;
+    bool                               batching;
+    bool                               clientsReaped;
+    ClientList                         clients;
+
+    std::mutex                         subscriptionMutex;
+    ClientList                         subscriptions;
+    std::atomic<ClientList*>           nextClients;
+    std::atomic<size_t>                numClients;
+};
+
+#include "RingPublisher.hpp"
+#endif
@@ -0,0 +1,188 @@
+#include <algorithm>
+
+template <class Message>
+RingPublisher<Message>::RingPublisher(size_t size)
+   : ring(new RingBuffer<Message>(size)),
+     gatingSequence(0),
+     batching(false),
+     clientsReaped(false),
+     nextClients(nullptr),
+     numClients(0)
+{
+}
+
+template <class Message>
+RingPublisher<Message>::~RingPublisher()
+{
+    EndBatch();
+    delete nextClients.exchange(nullptr);
+}
+
+template <class Message>
+std::shared_ptr<RingSubscriber<Message>> RingPublisher<Message>::NewClient() {
+    std::unique_lock<std::mutex> lock(subscriptionMutex);
+
+    /**
+     * The publisher can not have wrapped past the current write cursor, so it
+     * is safe to start reading from here, even before the publication thread
+     * has picked up the new client.
+     */
+    ClientRef client(new RingSubscriber<Message>(ring, ring->WriteCursor()));
+    subscriptions.push_back(client);
+    PublishClientList();
+
+    return client;
+}
+
+template <class Message>
+void RingPublisher<Message>::Publish(const Message& msg) {
+    UpdateClientList();
+
+    const uint64_t seq = ring->WriteCursor();
+
+    if (seq - gatingSequence >= ring->Size()) {
+        gatingSequence = WaitForSlot(seq);
+    }
+
+    (*ring)[seq] = msg;
+    ring->Commit(seq + 1);
+
+    for (auto it = clients.begin(); it != clients.end();) {
+        ClientRef& client = *it;
+
+        if (!batching && Reapable(client))
+        {
+            it = clients.erase(it);
+            clientsReaped = true;
+        }
+        else
+        {
+            client->OnPublish();
+            ++it;
+        }
+    }
+
+    ReleaseClients();
+}
+
+template <class Message>
+uint64_t RingPublisher<Message>::WaitForSlot(uint64_t seq) {
+    uint64_t minSeq = seq;
+    bool full = true;
+
+    while (full) {
+        minSeq = seq;
+        for (ClientRef& client: clients) {
+            if (!Reapable(client)) {
+                minSeq = std::min(minSeq, client->ReadCursor());
+            }
+        }
+
+        full = (seq - minSeq >= ring->Size());
+
+        if (full) {
+            if (batching) {
+                // Deferred notifications may be what the slow client is
+                // waiting on...
+                for (ClientRef& client: clients) {
+                    client->EndBatch();
+                    client->StartBatch();
+                }
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    return minSeq;
+}
+
+template <class Message>
+void RingPublisher<Message>::StartBatch() {
+    EndBatch();
+    UpdateClientList();
+
+    batching = true;
+    for (ClientRef& client: clients) {
+        client->StartBatch();
+    }
+}
+
+template <class Message>
+void RingPublisher<Message>::EndBatch() {
+    if (batching) {
+        batching = false;
+        for (ClientRef& client: clients) {
+            client->EndBatch();
+        }
+    }
+}
+
+template <class Message>
+size_t RingPublisher<Message>::NumClients() {
+    return numClients;
+}
+
+template <class Message>
+void RingPublisher<Message>::UpdateClientList() {
+    if (nextClients.load(std::memory_order_acquire)) {
+        std::unique_ptr<ClientList> next(
+            nextClients.exchange(nullptr, std::memory_order_acq_rel));
+
+        if (next.get()) {
+            if (batching) {
+                for (ClientRef& client: *next) {
+                    if (std::find(clients.begin(), clients.end(), client) == clients.end()) {
+                        client->StartBatch();
+                    }
+                }
+
+                for (ClientRef& client: clients) {
+                    if (std::find(next->begin(), next->end(), client) == next->end()) {
+                        client->EndBatch();
+                    }
+                }
+            }
+
+            clients.swap(*next);
+        }
+    }
+}
+
+template <class Message>
+void RingPublisher<Message>::PublishClientList() {
+    PruneSubscriptions();
+
+    std::unique_ptr<ClientList> next(new ClientList(subscriptions));
+
+    delete nextClients.exchange(next.release(), std::memory_order_acq_rel);
+}
+
+template <class Message>
+bool RingPublisher<Message>::Reapable(const ClientRef& client) {
+    /**
+     * The subscription list, and our snapshot, hold a reference each.
+     */
+    return (client->Aborted() || client.use_count() <= 2);
+}
+
+template <class Message>
+void RingPublisher<Message>::ReleaseClients() {
+    if (clientsReaped && subscriptionMutex.try_lock()) {
+        PruneSubscriptions();
+        clientsReaped = false;
+        subscriptionMutex.unlock();
+    }
+}
+
+template <class Message>
+void RingPublisher<Message>::PruneSubscriptions() {
+    for (auto it = subscriptions.begin(); it != subscriptions.end();) {
+        if ((*it)->Aborted() || it->unique()) {
+            it = subscriptions.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    numClients = subscriptions.size();
+}
@@ -0,0 +1,149 @@
+/*
+ * Subscribe to updates from the Ring Publisher
+ *
+ *  Created on: 16th October 2026
+ */
+
+#ifndef DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_RING_SUBSCRIBER_H__
+#define DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_RING_SUBSCRIBER_H__
+
+#include <atomic>
+#include <mutex>
+#include <functional>
+#include <memory>
+#include <RingBuffer.h>
+
+template <class Message>
+class RingPublisher;
+class IPostable;
+
+/**
+ * Read cursor into a RingPublisher's ring.
+ *
+ * As for PipeSubscriber, reading is lockless, except for the configuration
+ * and dispatch of the onMessage notification.
+ */
+template <class Message>
+class RingSubscriber {
+public:
+    typedef RingSubscriber<Message> Type;
+
+    virtual ~RingSubscriber();
+
+    /**
+     * Read the next message from the ring, and populate msg with the result.
+     *
+     * If there is no message to read, msg is left unchanged
+     *
+     * @param msg   The message to populate.
+     *
+     * @returns true if msg was populated, false otherwise.
+     */
+    bool GetNextMessage(Message& msg);
+
+    /**
+     * Trigger a callback function ON **ETIHER** the publisher thread OR the
+     * current thread when there is at least one unread message.
+     *
+     * See PipeSubscriber::OnNextMessage
+     */
+    typedef std::function<void(void)> NextMessageCallback;
+    void OnNextMessage(const NextMessageCallback& f);
+
+    /**
+     * Variant of the OnNextMessage callback which posts the task to another
+     * event loop.
+     *
+     *  @param  f          The callback to trigger
+     *  @param  target     The object to post the task to.
+     */
+    void OnNextMessage(const NextMessageCallback& f, IPostable* target);
+
+    /**
+     * Trigger a callback function for each new message received by the
+     * subsciber. The function will be called from the **PUBLISHER THREAD**.
+     *
+     * See PipeSubscriber::OnNewMessage
+     */
+    typedef std::function<void(const Message&)> NewMessasgCallback;
+    void OnNewMessage(const NewMessasgCallback&  f);
+
+    /**
+     * Stop consuming updates: the client will no longer hold up the
+     * publisher.
+     *
+     * MUST be called from the client thread.
+     */
+    void Abort();
+
+protected:
+    friend class RingPublisher<Message>;
+
+    RingSubscriber(std::shared_ptr<RingBuffer<Message>> ring, uint64_t start);
+
+    /*********************************
+     *   Interface for Publisher
+     *********************************/
+    /**
+     * Called by the publisher, once a new message has been committed to the
+     * ring.
+     */
+    void OnPublish();
+
+    void StartBatch();
+    void EndBatch();
+
+    /**
+     * The slowest sequence this client will hold up the publisher on.
+     */
+    uint64_t ReadCursor() const {
+        return readCursor.load(std::memory_order_acquire);
+    }
+
+    bool Aborted() const {
+        return aborted.load(std::memory_order_relaxed);
+    }
+
+private:
+    void NotifyNextMessage();
+
+    /**
+     * Forward all unread messages to the onNewMessage callback. MUST be
+     * called under lock.
+     */
+    void ForwardMessages(const NewMessasgCallback& f);
+
+    /***********************************
+     *          Synchronisation
+     ***********************************/
+    typedef std::unique_lock<std::mutex> Lock;
+    std::mutex                           onNotifyMutex;
+
+    /***********************************
+     * Unread data Notification
+     ***********************************/
+    NextMessageCallback  onNotify;
+    IPostable*           targetToNotify;
+    std::atomic<bool>    notifyOnMessage;
+
+    /***********************************
+     * Forward Messages
+     ***********************************/
+    NewMessasgCallback   onNewMessage;
+    std::atomic<bool>    forwardMessage;
+
+    /*********************************
+     *           Data
+     *********************************/
+    std::shared_ptr<RingBuffer<Message>> ring;
+    bool                                 batching;
+    std::atomic<bool>                    aborted;
+
+    char                                 pad1[64];
+    std::atomic<uint64_t>                readCursor;
+    char                                 pad2[64];
+};
+
+#include "RingSubscriber.hpp"
+
+#endif
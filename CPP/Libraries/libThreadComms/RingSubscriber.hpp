@@ -0,0 +1,159 @@
+#include <IPostable.h>
+
+template <class Message>
+RingSubscriber<Message>::RingSubscriber(
+    std::shared_ptr<RingBuffer<Message>> _ring,
+    uint64_t start)
+        : onNotify(nullptr),
+          targetToNotify(nullptr),
+          onNewMessage(nullptr),
+          ring(std::move(_ring)),
+          batching(false),
+          aborted(false),
+          readCursor(start)
+{
+    forwardMessage = false;
+    notifyOnMessage = false;
+}
+
+template <class Message>
+RingSubscriber<Message>::~RingSubscriber() {
+    aborted = true;
+    if (batching) {
+        RingSubscriber<Message>::EndBatch();
+    }
+}
+
+template <class Message>
+void RingSubscriber<Message>::Abort() {
+    aborted = true;
+}
+
+template <class Message>
+bool RingSubscriber<Message>::GetNextMessage(Message& msg) {
+    bool gotMsg = false;
+    const uint64_t read = readCursor.load(std::memory_order_relaxed);
+
+    if (!forwardMessage && read < ring->WriteCursor()) {
+        msg = (*ring)[read];
+
+        // The publisher may now re-use the slot
+        readCursor.store(read + 1, std::memory_order_release);
+        gotMsg = true;
+    }
+
+    return gotMsg;
+}
+
+template <class Message>
+void RingSubscriber<Message>::OnPublish() {
+    /**
+     * Remember, only one thread is allowed to publish...
+     */
+    if ( forwardMessage ) {
+        if (batching) {
+            // Already locked...
+            ForwardMessages(onNewMessage);
+        } else {
+            Lock notifyLock(onNotifyMutex);
+            // No need to re-check post-lock since it is not possible to
+            // unset the onNewMessage callback
+            ForwardMessages(onNewMessage);
+        }
+    } else if (!batching && notifyOnMessage) {
+        Lock notifyLock(onNotifyMutex);
+        if (notifyOnMessage)
+        {
+            NotifyNextMessage();
+        }
+    }
+}
+
+template <class Message>
+void RingSubscriber<Message>::ForwardMessages(const NewMessasgCallback& f) {
+    const uint64_t end = ring->WriteCursor();
+    uint64_t read = readCursor.load(std::memory_order_relaxed);
+
+    while (!aborted && read < end) {
+        f((*ring)[read]);
+        ++read;
+        readCursor.store(read, std::memory_order_release);
+    }
+}
+
+template<class Message>
+void RingSubscriber<Message>::NotifyNextMessage() {
+    if (targetToNotify) {
+        targetToNotify->PostTask(onNotify);
+        targetToNotify = nullptr;
+    } else {
+        onNotify();
+    }
+    onNotify = nullptr;
+    notifyOnMessage = false;
+}
+
+template <class Message>
+void RingSubscriber<Message>::OnNextMessage(const NextMessageCallback& f) {
+    this->OnNextMessage(f,nullptr);
+}
+
+template <class Message>
+void RingSubscriber<Message>::OnNextMessage(
+         const NextMessageCallback& f,
+         IPostable* target)
+{
+    if (!aborted) {
+        Lock notifyLock(onNotifyMutex);
+
+        // We have the lock, so the publisher is now locked out.
+        notifyOnMessage = true;
+
+        if ( readCursor.load(std::memory_order_relaxed) < ring->WriteCursor()) {
+            onNotify = nullptr;
+            targetToNotify = nullptr;
+            notifyOnMessage = false;
+            if (target) {
+                target->PostTask(f);
+            } else {
+                f();
+            }
+        } else {
+            onNotify = f;
+            targetToNotify = target;
+        }
+    }
+}
+
+template <class Message>
+void RingSubscriber<Message>::OnNewMessage(const NewMessasgCallback& f) {
+    if (!aborted) {
+        Lock notifyLock(onNotifyMutex);
+
+        forwardMessage = true;
+        onNewMessage = f;
+        ForwardMessages(f);
+    }
+}
+
+template<class Message>
+void RingSubscriber<Message>::StartBatch() {
+    batching = true;
+    onNotifyMutex.lock();
+}
+
+template<class Message>
+void RingSubscriber<Message>::EndBatch() {
+    if (batching) {
+        batching = false;
+
+        bool unread =
+            (readCursor.load(std::memory_order_relaxed) < ring->WriteCursor());
+
+        if (notifyOnMessage && unread) {
+            NotifyNextMessage();
+        }
+
+        onNotifyMutex.unlock();
+    }
+}
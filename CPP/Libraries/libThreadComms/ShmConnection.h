@@ -0,0 +1,98 @@
+/*
+ * Attach to a ShmPublisher running in another process
+ *
+ *  Created on: 16th October 2026
+ */
+
+#ifndef DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_SHM_CONNECTION_H__
+#define DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_SHM_CONNECTION_H__
+
+#include <ShmSubscriber.h>
+#include <ShmRing.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <type_traits>
+
+/**
+ * The reader side of a ShmPublisher: maps the publisher's ring, and creates
+ * clients reading from it.
+ *
+ * Since the publisher can not call into another process, OnNextMessage
+ * notifications are dispatched by a thread owned by the connection. It
+ * sleeps on a futex in the ring (so only costs the publisher a system call
+ * whilst a client is actually waiting), and periodically checks that the
+ * publisher's process is still alive. Notifications cease once the
+ * connection is destroyed, although its clients may continue to poll.
+ *
+ * If the publisher is restarted, a new connection must be made: the old
+ * clients will report that they are Finished.
+ */
+template <class Message>
+class ShmConnection {
+public:
+    static_assert(std::is_trivially_copyable<Message>::value,
+                  "Only trivially copyable messages may be shared between processes");
+
+    typedef ShmSubscriber<Message> Client;
+
+    /**
+     * Attach to the named ring.
+     *
+     * Throws a ShmRing::ShmRingException if there is no such ring, or it
+     * holds a different message type.
+     */
+    ShmConnection(const std::string& name);
+
+    /**
+     * Stop the dispatch thread.
+     */
+    virtual ~ShmConnection();
+
+    /**
+     * Create a new subscription to the publisher. The client will receive all
+     * messages published after this call returns.
+     *
+     * Throws a ShmRing::TooManyReadersException if the publisher's
+     * maxClients limit has been reached.
+     */
+    std::shared_ptr<Client> NewClient();
+
+    /**
+     * False if the publisher has been destroyed, or its process has exited
+     */
+    bool PublisherAlive() const;
+
+private:
+    typedef std::shared_ptr<Client> ClientRef;
+    typedef std::vector<std::weak_ptr<Client>> ClientList;
+
+    /**
+     * The dispatch thread's main loop
+     */
+    void Run();
+
+    /**
+     * Trigger any outstanding notifications
+     *
+     * @returns true if there are clients still waiting on a message
+     */
+    bool Dispatch();
+
+    std::shared_ptr<ShmRing>          ring;
+    std::shared_ptr<ShmDispatchState> dispatch;
+
+    std::mutex                        clientsMutex;
+    ClientList                        clients;
+
+    // Dispatch thread only: re-used to avoid allocating on each wake-up
+    std::vector<ClientRef>            live;
+
+    std::atomic<bool>                 running;
+    std::thread                       dispatchThread;
+};
+
+#include "ShmConnection.hpp"
+#endif
@@ -0,0 +1,102 @@
+#include <algorithm>
+
+template <class Message>
+ShmConnection<Message>::ShmConnection(const std::string& name)
+   : ring(ShmRing::Attach(name, sizeof(Message))),
+     dispatch(new ShmDispatchState),
+     running(true)
+{
+    dispatchThread = std::thread([this] () -> void { this->Run(); });
+}
+
+template <class Message>
+ShmConnection<Message>::~ShmConnection()
+{
+    {
+        std::unique_lock<std::mutex> lock(dispatch->mutex);
+        running = false;
+        dispatch->wakeUp.notify_all();
+    }
+    ring->WakeReaders();
+
+    dispatchThread.join();
+}
+
+template <class Message>
+std::shared_ptr<typename ShmConnection<Message>::Client>
+    ShmConnection<Message>::NewClient()
+{
+    ClientRef client(new Client(ring, dispatch));
+
+    std::unique_lock<std::mutex> lock(clientsMutex);
+    clients.push_back(client);
+
+    return client;
+}
+
+template <class Message>
+bool ShmConnection<Message>::PublisherAlive() const {
+    return ring->WriterAlive();
+}
+
+template <class Message>
+void ShmConnection<Message>::Run() {
+    // How often to check that the publisher is still alive
+    const std::chrono::milliseconds livenessInterval(100);
+
+    while (running) {
+        const uint64_t cursor = ring->WriteCursor();
+        const bool waiting = Dispatch();
+
+        if (!running) {
+            // Time to leave...
+        } else if (waiting) {
+            ring->WaitForPublish(cursor, livenessInterval);
+        } else {
+            std::unique_lock<std::mutex> lock(dispatch->mutex);
+            if (!dispatch->armed && running) {
+                dispatch->wakeUp.wait_for(lock, livenessInterval);
+            }
+            dispatch->armed = false;
+        }
+
+        /**
+         * Only bother checking the publisher's process if it has gone quiet
+         */
+        if (!dispatch->finished && ring->WriteCursor() == cursor &&
+            !ring->WriterAlive())
+        {
+            dispatch->finished = true;
+        }
+    }
+}
+
+template <class Message>
+bool ShmConnection<Message>::Dispatch() {
+    live.clear();
+    {
+        std::unique_lock<std::mutex> lock(clientsMutex);
+
+        for (auto it = clients.begin(); it != clients.end();) {
+            ClientRef client = it->lock();
+            if (client) {
+                live.push_back(std::move(client));
+                ++it;
+            } else {
+                it = clients.erase(it);
+            }
+        }
+    }
+
+    bool waiting = false;
+    for (ClientRef& client: live) {
+        if (client->Dispatch()) {
+            waiting = true;
+        }
+    }
+
+    // Don't keep the clients alive whilst we sleep
+    live.clear();
+
+    return waiting;
+}
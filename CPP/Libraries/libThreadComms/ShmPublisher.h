@@ -0,0 +1,101 @@
+/*
+ * Publish updates to consumers in other processes, via shared memory
+ *
+ *  Created on: 16th October 2026
+ */
+
+#ifndef DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_SHM_PUBLISHER_H__
+#define DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_SHM_PUBLISHER_H__
+
+#include <ShmRing.h>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+/**
+ * Cross-process equivalent of the RingPublisher: each message is copied once
+ * into a ring in a POSIX shared memory object (/dev/shm/<name>), from which
+ * any number of processes may read via a ShmConnection.
+ *
+ * As for the RingPublisher, the ring is never allowed to wrap over unread
+ * data: if it is full, the publisher will wait for the slowest live reader
+ * to catch up. Readers whose process has exited are detected, and dropped.
+ *
+ * Since the raw bytes are shared, Message must be trivially copyable (no
+ * pointers, std::strings etc).
+ */
+template <class Message>
+class ShmPublisher {
+public:
+    static_assert(std::is_trivially_copyable<Message>::value,
+                  "Only trivially copyable messages may be shared between processes");
+
+    typedef ShmPublisher<Message> Type;
+
+    /**
+     * Create the shared ring.
+     *
+     * Throws a ShmRing::ShmRingException if the ring can not be created, or
+     * another live process is already publishing under this name.
+     *
+     * @param name        Name of the ring, e.g "/prices"
+     * @param size        The number of messages in the ring. This will be
+     *                    rounded up to the next power of two.
+     * @param maxClients  The maximum number of clients which may be attached
+     *                    at once, across all processes.
+     */
+    ShmPublisher(const std::string& name, size_t size, size_t maxClients = 64);
+
+    /**
+     * Close the ring: clients will see the end of the stream once they have
+     * drained any unread messages.
+     */
+    virtual ~ShmPublisher();
+
+    /**
+     * Publish a new message to all clients.
+     *
+     * NOTE: Only one thread may publish.
+     */
+    void Publish(const Message& msg);
+
+    /**
+     * Start a new batch of messages.
+     *
+     * Waking readers (a system call, if any are blocked) is deferred until
+     * the batch is completed, unless the publisher is forced to wait on a
+     * client.
+     *
+     * EndBatch MUST be called on completion of the batch.
+     */
+    void StartBatch();
+
+    /**
+     * End the current batch.
+     *
+     * If there is not currently a batch being processed, this call has no
+     * effect.
+     */
+    void EndBatch();
+
+    /**
+     * Number of clients currently attached, across all processes.
+     */
+    size_t NumClients();
+
+    /**
+     * Number of messages the ring can hold
+     */
+    size_t Size() const { return ring->Size(); }
+
+private:
+    std::shared_ptr<ShmRing> ring;
+
+    // Owned by the publication thread
+    uint64_t                 writeCursor;
+    uint64_t                 gatingSequence;
+    bool                     batching;
+};
+
+#include "ShmPublisher.hpp"
+#endif
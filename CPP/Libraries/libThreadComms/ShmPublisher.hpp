@@ -0,0 +1,61 @@
+#include <cstring>
+
+template <class Message>
+ShmPublisher<Message>::ShmPublisher(
+    const std::string& name,
+    size_t size,
+    size_t maxClients)
+   : ring(ShmRing::Create(name, sizeof(Message), size, maxClients)),
+     writeCursor(0),
+     gatingSequence(0),
+     batching(false)
+{
+}
+
+template <class Message>
+ShmPublisher<Message>::~ShmPublisher()
+{
+    EndBatch();
+}
+
+template <class Message>
+void ShmPublisher<Message>::Publish(const Message& msg) {
+    const uint64_t seq = writeCursor;
+
+    if (seq - gatingSequence >= ring->Size()) {
+        if (batching) {
+            // Deferred notifications may be what the slow client is
+            // waiting on...
+            ring->Notify();
+        }
+        gatingSequence = ring->WaitForReaders(seq);
+    }
+
+    memcpy(ring->Slot(seq), &msg, sizeof(Message));
+
+    writeCursor = seq + 1;
+    ring->Commit(writeCursor);
+
+    if (!batching) {
+        ring->Notify();
+    }
+}
+
+template <class Message>
+void ShmPublisher<Message>::StartBatch() {
+    EndBatch();
+    batching = true;
+}
+
+template <class Message>
+void ShmPublisher<Message>::EndBatch() {
+    if (batching) {
+        batching = false;
+        ring->Notify();
+    }
+}
+
+template <class Message>
+size_t ShmPublisher<Message>::NumClients() {
+    return ring->NumReaders();
+}
@@ -0,0 +1,394 @@
+/*
+ * ShmRing.cpp
+ *
+ *  Created on: 16th October 2026
+ */
+
+#include "ShmRing.h"
+#include <algorithm>
+#include <thread>
+#include <climits>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+              "Cursors in shared memory require lock-free 64bit atomics");
+
+namespace {
+    const uint64_t MAGIC = 0x474e495248534d44ull; // "DMSHRING"
+    const uint32_t VERSION = 1;
+    const size_t   CACHE_LINE = 64;
+
+    enum READER_STATE {
+        FREE = 0,
+        CLAIMING,
+        ACTIVE
+    };
+
+    size_t Align(size_t bytes) {
+        return ((bytes + CACHE_LINE - 1) / CACHE_LINE) * CACHE_LINE;
+    }
+
+    size_t RoundUp(size_t size) {
+        size_t rounded = 1;
+        while (rounded < size) {
+            rounded <<= 1;
+        }
+        return rounded;
+    }
+
+    bool ProcessAlive(pid_t pid) {
+        return (kill(pid, 0) == 0 || errno == EPERM);
+    }
+
+    /**
+     * The notification word is shared between processes, so the
+     * PRIVATE futex ops can not be used.
+     */
+    void FutexWait(std::atomic<uint32_t>& word,
+                   uint32_t expected,
+                   const std::chrono::nanoseconds& timeout)
+    {
+        timespec ts;
+        ts.tv_sec = timeout.count() / 1000000000;
+        ts.tv_nsec = timeout.count() % 1000000000;
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word),
+                FUTEX_WAIT, expected, &ts, nullptr, 0);
+    }
+
+    void FutexWakeAll(std::atomic<uint32_t>& word) {
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word),
+                FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    }
+
+    std::string Error(const std::string& what, const std::string& name) {
+        return what + " " + name + ": " + strerror(errno);
+    }
+}
+
+struct ShmRing::Header {
+    std::atomic<uint64_t> magic;   // Set once the ring is initialised
+    uint32_t              version;
+    uint32_t              messageSize;
+    uint64_t              size;
+    uint64_t              maxReaders;
+    std::atomic<int32_t>  writerPid;
+    std::atomic<uint32_t> closed;
+
+    char                  pad1[CACHE_LINE];
+    std::atomic<uint64_t> writeCursor;
+    char                  pad2[CACHE_LINE];
+
+    // Futex word, bumped by Notify if there are waiters
+    std::atomic<uint32_t> notifySeq;
+    std::atomic<uint32_t> waiters;
+    char                  pad3[CACHE_LINE];
+};
+
+struct ShmRing::Reader {
+    std::atomic<uint32_t> state;
+    std::atomic<int32_t>  pid;
+    std::atomic<uint64_t> readCursor;
+    char                  pad[CACHE_LINE - 16];
+};
+
+ShmRing::ShmRing(const std::string& _name, bool _writer)
+    : name(_name),
+      writer(_writer),
+      mapping(MAP_FAILED),
+      mappingSize(0),
+      header(nullptr),
+      readers(nullptr),
+      messages(nullptr),
+      messageSize(0),
+      size(0),
+      mask(0),
+      maxReaders(0)
+{
+}
+
+std::shared_ptr<ShmRing> ShmRing::Create(
+    const std::string& name,
+    size_t messageSize,
+    size_t size,
+    size_t maxReaders)
+{
+    const size_t ringSize = RoundUp(size);
+    const size_t readersOffset = Align(sizeof(Header));
+    const size_t messagesOffset = Align(readersOffset + maxReaders * sizeof(Reader));
+    const size_t bytes = messagesOffset + ringSize * messageSize;
+
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+
+    if (fd < 0 && errno == EEXIST) {
+        /**
+         * Left over from a previous writer: we can take it over as long as
+         * the writer is no longer using it.
+         */
+        bool inUse = false;
+        try {
+            std::shared_ptr<ShmRing> existing(Attach(name, messageSize));
+            inUse = existing->WriterAlive();
+        } catch (ShmRingException& e) {
+            // Not a valid ring (or a different message type), safe to replace
+        }
+
+        if (inUse) {
+            throw ShmRingException{"Ring " + name + " already has a live writer"};
+        }
+
+        shm_unlink(name.c_str());
+        fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    }
+
+    if (fd < 0) {
+        throw ShmRingException{Error("Failed to create", name)};
+    }
+
+    if (ftruncate(fd, bytes) != 0) {
+        const std::string msg = Error("Failed to size", name);
+        close(fd);
+        shm_unlink(name.c_str());
+        throw ShmRingException{msg};
+    }
+
+    std::shared_ptr<ShmRing> ring(new ShmRing(name, true));
+    ring->Map(fd, bytes);
+    close(fd);
+
+    // The new object is zero filled, so only the layout needs populating
+    Header& header = *ring->header;
+    header.version = VERSION;
+    header.messageSize = messageSize;
+    header.size = ringSize;
+    header.maxReaders = maxReaders;
+    header.writerPid = getpid();
+
+    ring->messageSize = messageSize;
+    ring->size = ringSize;
+    ring->mask = ringSize - 1;
+    ring->maxReaders = maxReaders;
+    ring->readers = reinterpret_cast<Reader*>(
+        static_cast<char*>(ring->mapping) + readersOffset);
+    ring->messages = static_cast<char*>(ring->mapping) + messagesOffset;
+
+    header.magic.store(MAGIC, std::memory_order_release);
+
+    return ring;
+}
+
+std::shared_ptr<ShmRing> ShmRing::Attach(
+    const std::string& name,
+    size_t messageSize)
+{
+    const int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        throw ShmRingException{Error("Failed to open", name)};
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(Header)) {
+        close(fd);
+        throw ShmRingException{"Ring " + name + " has not been initialised"};
+    }
+
+    std::shared_ptr<ShmRing> ring(new ShmRing(name, false));
+    ring->Map(fd, info.st_size);
+    close(fd);
+
+    Header& header = *ring->header;
+    if (header.magic.load(std::memory_order_acquire) != MAGIC ||
+        header.version != VERSION)
+    {
+        throw ShmRingException{"Ring " + name + " has not been initialised"};
+    }
+
+    if (header.messageSize != messageSize) {
+        throw ShmRingException{"Ring " + name + " holds a different message type"};
+    }
+
+    const size_t readersOffset = Align(sizeof(Header));
+    const size_t messagesOffset = Align(readersOffset + header.maxReaders * sizeof(Reader));
+    if (ring->mappingSize < messagesOffset + header.size * messageSize) {
+        throw ShmRingException{"Ring " + name + " is truncated"};
+    }
+
+    ring->messageSize = messageSize;
+    ring->size = header.size;
+    ring->mask = header.size - 1;
+    ring->maxReaders = header.maxReaders;
+    ring->readers = reinterpret_cast<Reader*>(
+        static_cast<char*>(ring->mapping) + readersOffset);
+    ring->messages = static_cast<char*>(ring->mapping) + messagesOffset;
+
+    return ring;
+}
+
+void ShmRing::Map(int fd, size_t bytes) {
+    mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    if (mapping == MAP_FAILED) {
+        throw ShmRingException{Error("Failed to map", name)};
+    }
+
+    mappingSize = bytes;
+    header = static_cast<Header*>(mapping);
+}
+
+ShmRing::~ShmRing() {
+    if (writer && header) {
+        header->closed = 1;
+
+        // Make sure no-one is left waiting for the next message
+        WakeReaders();
+
+        shm_unlink(name.c_str());
+    }
+
+    if (mapping != MAP_FAILED) {
+        munmap(mapping, mappingSize);
+    }
+}
+
+uint64_t ShmRing::WriteCursor() const {
+    return header->writeCursor.load(std::memory_order_acquire);
+}
+
+void ShmRing::Commit(uint64_t seq) {
+    header->writeCursor.store(seq);
+}
+
+void ShmRing::Notify() {
+    // Pairs with WaitForPublish: either we see the waiter, or it sees the
+    // committed cursor.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (header->waiters.load(std::memory_order_relaxed) != 0) {
+        header->notifySeq.fetch_add(1);
+        FutexWakeAll(header->notifySeq);
+    }
+}
+
+void ShmRing::WakeReaders() {
+    header->notifySeq.fetch_add(1);
+    FutexWakeAll(header->notifySeq);
+}
+
+uint64_t ShmRing::WaitForReaders(uint64_t seq) {
+    uint64_t gating = seq;
+    bool full = true;
+
+    for (size_t attempt = 0; full; ++attempt) {
+        gating = seq;
+        for (size_t i = 0; i < maxReaders; ++i) {
+            Reader& reader = readers[i];
+            if (reader.state.load() == ACTIVE) {
+                gating = std::min(gating, reader.readCursor.load(std::memory_order_acquire));
+            }
+        }
+
+        full = (seq - gating >= size);
+
+        if (full) {
+            /**
+             * Check if we're waiting on a reader which has died, rather than
+             * one which is just slow...
+             */
+            bool reclaimed = false;
+            for (size_t i = 0; i < maxReaders; ++i) {
+                Reader& reader = readers[i];
+                uint32_t state = ACTIVE;
+                if (reader.state.load() == ACTIVE &&
+                    seq - reader.readCursor.load() >= size &&
+                    !ProcessAlive(reader.pid.load()) &&
+                    reader.state.compare_exchange_strong(state, FREE))
+                {
+                    reclaimed = true;
+                }
+            }
+
+            if (!reclaimed) {
+                if (attempt < 100) {
+                    std::this_thread::yield();
+                } else {
+                    std::this_thread::sleep_for(std::chrono::microseconds(50));
+                }
+            }
+        }
+    }
+
+    return gating;
+}
+
+size_t ShmRing::NumReaders() const {
+    size_t count = 0;
+    for (size_t i = 0; i < maxReaders; ++i) {
+        if (readers[i].state.load() == ACTIVE) {
+            ++count;
+        }
+    }
+
+    return count;
+}
+
+size_t ShmRing::AcquireReader() {
+    for (size_t i = 0; i < maxReaders; ++i) {
+        Reader& reader = readers[i];
+        uint32_t state = FREE;
+
+        if (reader.state.compare_exchange_strong(state, CLAIMING)) {
+            reader.pid = getpid();
+            reader.readCursor = WriteCursor();
+            reader.state = ACTIVE;
+
+            /**
+             * The writer may have computed its gating sequence before we
+             * became active, and so be free to overwrite anything before its
+             * current cursor. Re-reading the cursor after becoming active
+             * puts us beyond anything it could have gated on without us.
+             */
+            reader.readCursor = WriteCursor();
+
+            return i;
+        }
+    }
+
+    throw TooManyReadersException{
+        "All " + std::to_string(maxReaders) + " reader slots of " + name + " are in use"};
+}
+
+void ShmRing::ReleaseReader(size_t reader) {
+    ReaderSlot(reader).state = FREE;
+}
+
+std::atomic<uint64_t>& ShmRing::ReadCursor(size_t reader) {
+    return ReaderSlot(reader).readCursor;
+}
+
+ShmRing::Reader& ShmRing::ReaderSlot(size_t reader) {
+    return readers[reader];
+}
+
+bool ShmRing::WriterAlive() const {
+    return (header->closed.load() == 0 && ProcessAlive(header->writerPid.load()));
+}
+
+void ShmRing::WaitForPublish(uint64_t cursor, const Clock::duration& timeout) {
+    header->waiters.fetch_add(1);
+    const uint32_t notifySeq = header->notifySeq.load();
+
+    if (header->writeCursor.load() == cursor && header->closed.load() == 0) {
+        FutexWait(header->notifySeq,
+                  notifySeq,
+                  std::chrono::duration_cast<std::chrono::nanoseconds>(timeout));
+    }
+
+    header->waiters.fetch_sub(1);
+}
@@ -0,0 +1,211 @@
+/*
+ * Ring of fixed size messages, shared between processes via /dev/shm
+ *
+ *  Created on: 16th October 2026
+ */
+
+#ifndef DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_SHM_RING_H__
+#define DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_SHM_RING_H__
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <cstdint>
+
+/**
+ * Untyped storage for the ShmPublisher / ShmSubscriber: a POSIX shared memory
+ * object (i.e a file under /dev/shm) holding
+ *
+ *    - A header, describing the layout, and owning the write cursor
+ *    - A fixed table of reader slots, one per attached subscriber. Each slot
+ *      holds the reader's pid and its read cursor.
+ *    - The ring of messages.
+ *
+ * As for the RingPublisher, the writer never wraps over data which has not
+ * been read by a live reader.
+ *
+ * Crashed peers are detected by pid:
+ *    - A reader slot whose process has exited is reclaimed by the writer
+ *      (so that the writer isn't blocked forever)
+ *    - A reader which finds that the writer's process has exited (or has
+ *      closed the ring) sees the ring as finished.
+ *
+ * NOTE: Cursors are accessed as std::atomics in the shared mapping, which
+ *       relies on 64bit atomics being lock-free (and so address-free).
+ */
+class ShmRing {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    /**
+     * Failed to create, or attach to, the shared memory object.
+     */
+    struct ShmRingException {
+        std::string msg;
+    };
+
+    /**
+     * No free reader slot is available.
+     */
+    struct TooManyReadersException {
+        std::string msg;
+    };
+
+    /**
+     * Create a new ring, to be written to by the calling process.
+     *
+     * If a ring of the same name already exists, it is replaced, unless its
+     * writer is still alive, in which case a ShmRingException is thrown.
+     *
+     * @param name         Name of the shared memory object, e.g "/prices"
+     * @param messageSize  Size of a single message, in bytes
+     * @param size         Number of messages in the ring. This will be
+     *                     rounded up to the next power of two.
+     * @param maxReaders   The maximum number of subscribers which may be
+     *                     attached at once (across all processes).
+     */
+    static std::shared_ptr<ShmRing> Create(
+        const std::string& name,
+        size_t messageSize,
+        size_t size,
+        size_t maxReaders);
+
+    /**
+     * Attach to an existing ring.
+     *
+     * Throws a ShmRingException if the ring does not exist, or was created
+     * for a different message size.
+     */
+    static std::shared_ptr<ShmRing> Attach(
+        const std::string& name,
+        size_t messageSize);
+
+    /**
+     * Unmap the ring. If this is the writer, the ring is closed (so that
+     * readers see that there will be no further messages) and the name is
+     * unlinked: existing readers retain their mapping.
+     */
+    ~ShmRing();
+
+    ShmRing(const ShmRing& rhs) = delete;
+    ShmRing& operator=(const ShmRing& rhs) = delete;
+
+    /**
+     * Number of messages in the ring
+     */
+    size_t Size() const { return size; }
+
+    /**
+     * Storage for the specified sequence
+     */
+    void* Slot(uint64_t seq) {
+        return messages + (seq & mask) * messageSize;
+    }
+
+    /**
+     * The next sequence to be written: all sequences before this one may be
+     * read.
+     */
+    uint64_t WriteCursor() const;
+
+    /***********************************
+     *        Writer Interface
+     ***********************************/
+
+    /**
+     * Mark all sequences up to (but not including) seq as readable.
+     */
+    void Commit(uint64_t seq);
+
+    /**
+     * Wake any readers blocked in WaitForPublish.
+     */
+    void Notify();
+
+    /**
+     * Unconditionally wake every reader blocked in WaitForPublish (across all
+     * processes), e.g to shut down a reader thread.
+     */
+    void WakeReaders();
+
+    /**
+     * Wait until the slot to be written by seq is no longer required by any
+     * live reader.
+     *
+     * @returns The new gating sequence: seq may not pass this by more than
+     *          the size of the ring.
+     */
+    uint64_t WaitForReaders(uint64_t seq);
+
+    /**
+     * Number of reader slots in use
+     */
+    size_t NumReaders() const;
+
+    /***********************************
+     *        Reader Interface
+     ***********************************/
+
+    /**
+     * Claim a reader slot for the calling process. The reader's cursor is
+     * initialised to the current write cursor.
+     *
+     * Throws TooManyReadersException if there are no free slots.
+     *
+     * @returns The index of the slot
+     */
+    size_t AcquireReader();
+
+    /**
+     * Release the slot: the writer will no longer wait for it.
+     */
+    void ReleaseReader(size_t reader);
+
+    /**
+     * The next sequence to be read by the reader
+     */
+    std::atomic<uint64_t>& ReadCursor(size_t reader);
+
+    /**
+     * False if the writer has closed the ring, or its process no longer
+     * exists.
+     */
+    bool WriterAlive() const;
+
+    /**
+     * Block until the write cursor moves past cursor, the timeout expires, or
+     * a spurious wake-up.
+     */
+    void WaitForPublish(uint64_t cursor, const Clock::duration& timeout);
+
+private:
+    struct Header;
+    struct Reader;
+
+    ShmRing(const std::string& name, bool writer);
+
+    /**
+     * Map the shared memory object, and locate its components
+     */
+    void Map(int fd, size_t bytes);
+
+    Reader& ReaderSlot(size_t reader);
+
+    const std::string name;
+    const bool        writer;
+
+    void*             mapping;
+    size_t            mappingSize;
+
+    Header*           header;
+    Reader*           readers;
+    char*             messages;
+
+    size_t            messageSize;
+    size_t            size;
+    uint64_t          mask;
+    size_t            maxReaders;
+};
+
+#endif
@@ -0,0 +1,166 @@
+/*
+ * Subscribe to updates from a ShmPublisher in another process
+ *
+ *  Created on: 16th October 2026
+ */
+
+#ifndef DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_SHM_SUBSCRIBER_H__
+#define DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_SHM_SUBSCRIBER_H__
+
+#include <ShmRing.h>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+
+template <class Message>
+class ShmConnection;
+class IPostable;
+
+/**
+ * State shared between a ShmConnection's dispatch thread, and its clients.
+ * Held by the clients so that they may safely outlive the connection.
+ */
+struct ShmDispatchState {
+    ShmDispatchState(): armed(false), finished(false) { }
+
+    /**
+     * A client is waiting for its next message: make sure the dispatch
+     * thread is watching the ring.
+     */
+    void Arm() {
+        std::unique_lock<std::mutex> lock(mutex);
+        armed = true;
+        wakeUp.notify_one();
+    }
+
+    std::mutex              mutex;
+    std::condition_variable wakeUp;
+    bool                    armed;
+
+    /**
+     * Set by the dispatch thread once the publisher has gone
+     */
+    std::atomic<bool>       finished;
+};
+
+/**
+ * Read cursor into a ShmPublisher's ring, from any process.
+ *
+ * The consumer side API (GetNextMessage, OnNextMessage) matches
+ * PipeSubscriber, with the exception that the OnNextMessage callback is
+ * triggered from the ShmConnection's dispatch thread, rather than the
+ * publisher's thread.
+ */
+template <class Message>
+class ShmSubscriber {
+public:
+    typedef ShmSubscriber<Message> Type;
+
+    /**
+     * Release our reader slot, the publisher will no longer wait for us.
+     */
+    virtual ~ShmSubscriber();
+
+    /**
+     * Read the next message from the ring, and populate msg with the result.
+     *
+     * If there is no message to read, msg is left unchanged
+     *
+     * @param msg   The message to populate.
+     *
+     * @returns true if msg was populated, false otherwise.
+     */
+    bool GetNextMessage(Message& msg);
+
+    /**
+     * Trigger a callback function ON **ETIHER** the connection's dispatch
+     * thread OR the current thread when there is at least one unread message,
+     * or the publisher has gone away.
+     *
+     * As for PipeSubscriber, the callback will be triggered exactly once.
+     */
+    typedef std::function<void(void)> NextMessageCallback;
+    void OnNextMessage(const NextMessageCallback& f);
+
+    /**
+     * Variant of the OnNextMessage callback which posts the task to another
+     * event loop.
+     *
+     *  @param  f          The callback to trigger
+     *  @param  target     The object to post the task to.
+     */
+    void OnNextMessage(const NextMessageCallback& f, IPostable* target);
+
+    /**
+     * Stop consuming updates: the client will no longer hold up the
+     * publisher.
+     *
+     * MUST be called from the client thread.
+     */
+    void Abort();
+
+    /**
+     * True once every message has been read, and no more will arrive,
+     * because the publisher has been destroyed, or its process has exited.
+     *
+     * NOTE: A crashed publisher is detected by the ShmConnection's dispatch
+     *       thread, after a short delay.
+     */
+    bool Finished() const;
+
+protected:
+    friend class ShmConnection<Message>;
+
+    ShmSubscriber(
+        std::shared_ptr<ShmRing> ring,
+        std::shared_ptr<ShmDispatchState> dispatch);
+
+    /*********************************
+     *   Interface for Connection
+     *********************************/
+
+    /**
+     * Trigger the OnNextMessage callback, if it has been configured and
+     * there is anything to read (or the publisher has gone).
+     *
+     * @returns true if the client is still waiting for a message.
+     */
+    bool Dispatch();
+
+private:
+    bool Unread() const {
+        return (readCursor.load(std::memory_order_relaxed) < ring->WriteCursor());
+    }
+
+    static void Notify(const NextMessageCallback& f, IPostable* target);
+
+    /***********************************
+     *          Synchronisation
+     ***********************************/
+    typedef std::unique_lock<std::mutex> Lock;
+    std::mutex                           onNotifyMutex;
+
+    /***********************************
+     * Unread data Notification
+     ***********************************/
+    NextMessageCallback  onNotify;
+    IPostable*           targetToNotify;
+    std::atomic<bool>    notifyOnMessage;
+
+    /*********************************
+     *           Data
+     *********************************/
+    std::shared_ptr<ShmRing>             ring;
+    std::shared_ptr<ShmDispatchState>    dispatch;
+    const size_t                         reader;
+    std::atomic<bool>                    aborted;
+
+    // Our slot in the shared ring
+    std::atomic<uint64_t>&               readCursor;
+};
+
+#include "ShmSubscriber.hpp"
+
+#endif
@@ -0,0 +1,125 @@
+#include <IPostable.h>
+#include <cstring>
+
+template <class Message>
+ShmSubscriber<Message>::ShmSubscriber(
+    std::shared_ptr<ShmRing> _ring,
+    std::shared_ptr<ShmDispatchState> _dispatch)
+        : onNotify(nullptr),
+          targetToNotify(nullptr),
+          ring(std::move(_ring)),
+          dispatch(std::move(_dispatch)),
+          reader(ring->AcquireReader()),
+          aborted(false),
+          readCursor(ring->ReadCursor(reader))
+{
+    notifyOnMessage = false;
+}
+
+template <class Message>
+ShmSubscriber<Message>::~ShmSubscriber() {
+    Abort();
+}
+
+template <class Message>
+void ShmSubscriber<Message>::Abort() {
+    if (!aborted.exchange(true)) {
+        ring->ReleaseReader(reader);
+    }
+}
+
+template <class Message>
+bool ShmSubscriber<Message>::GetNextMessage(Message& msg) {
+    bool gotMsg = false;
+    const uint64_t read = readCursor.load(std::memory_order_relaxed);
+
+    if (!aborted && read < ring->WriteCursor()) {
+        memcpy(&msg, ring->Slot(read), sizeof(Message));
+
+        // The publisher may now re-use the slot
+        readCursor.store(read + 1, std::memory_order_release);
+        gotMsg = true;
+    }
+
+    return gotMsg;
+}
+
+template <class Message>
+bool ShmSubscriber<Message>::Finished() const {
+    return (aborted || (dispatch->finished && !Unread()));
+}
+
+template <class Message>
+bool ShmSubscriber<Message>::Dispatch() {
+    bool waiting = false;
+    NextMessageCallback callback = nullptr;
+    IPostable* target = nullptr;
+
+    if (notifyOnMessage) {
+        Lock notifyLock(onNotifyMutex);
+        if (notifyOnMessage) {
+            if (aborted || Unread() || dispatch->finished) {
+                callback.swap(onNotify);
+                target = targetToNotify;
+                targetToNotify = nullptr;
+                notifyOnMessage = false;
+            } else {
+                waiting = true;
+            }
+        }
+    }
+
+    // The callback is free to re-configure the notification...
+    if (callback) {
+        Notify(callback, target);
+    }
+
+    return waiting;
+}
+
+template<class Message>
+void ShmSubscriber<Message>::Notify(
+    const NextMessageCallback& f,
+    IPostable* target)
+{
+    if (target) {
+        target->PostTask(f);
+    } else {
+        f();
+    }
+}
+
+template <class Message>
+void ShmSubscriber<Message>::OnNextMessage(const NextMessageCallback& f) {
+    this->OnNextMessage(f,nullptr);
+}
+
+template <class Message>
+void ShmSubscriber<Message>::OnNextMessage(
+         const NextMessageCallback& f,
+         IPostable* target)
+{
+    if (!aborted) {
+        bool ready = false;
+        {
+            Lock notifyLock(onNotifyMutex);
+
+            if (Unread() || dispatch->finished) {
+                onNotify = nullptr;
+                targetToNotify = nullptr;
+                notifyOnMessage = false;
+                ready = true;
+            } else {
+                onNotify = f;
+                targetToNotify = target;
+                notifyOnMessage = true;
+            }
+        }
+
+        if (ready) {
+            Notify(f, target);
+        } else {
+            dispatch->Arm();
+        }
+    }
+}
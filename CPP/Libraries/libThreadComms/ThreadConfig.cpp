@@ -0,0 +1,195 @@
+/*
+ * ThreadConfig.cpp
+ *
+ *  Created on: 16th October 2026
+ */
+
+#include "ThreadConfig.h"
+#include <env.h>
+#include <OSTools.h>
+#include <logger.h>
+#include <cstring>
+#include <cstdlib>
+#include <cerrno>
+#include <sstream>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+
+namespace {
+    const size_t MAX_NODES = 1024;
+    const size_t NODE_WORDS = MAX_NODES / (8 * sizeof(unsigned long));
+
+    /**
+     * glibc doesn't wrap the memory policy calls (libnuma does), so call the
+     * kernel directly rather than pull in another dependency.
+     */
+    bool SetMemoryPolicy(int mode, const unsigned long* nodes) {
+        // The kernel ignores the final bit of maxnode...
+        return (syscall(SYS_set_mempolicy, mode, nodes, MAX_NODES + 1) == 0);
+    }
+
+    bool GetMemoryPolicy(int& mode, unsigned long* nodes) {
+        return (syscall(SYS_get_mempolicy, &mode, nodes, MAX_NODES, nullptr, 0) == 0);
+    }
+
+    std::vector<unsigned long> NodeMask(int node) {
+        std::vector<unsigned long> mask(NODE_WORDS, 0);
+        const size_t bits = 8 * sizeof(unsigned long);
+        mask[node / bits] |= (1ul << (node % bits));
+
+        return mask;
+    }
+}
+
+ThreadConfig::ThreadConfig()
+    : fifoPriority(0), numaLocal(false)
+{
+}
+
+ThreadConfig ThreadConfig::FromEnv(
+    const std::string& prefix,
+    const ThreadConfig& defaults)
+{
+    ThreadConfig config(defaults);
+
+    if (ENV::IsSet(prefix + "_CPUS")) {
+        config.cpus = ParseCPUList(ENV::GetEnvString(prefix + "_CPUS"));
+    }
+
+    config.name = ENV::GetEnvString(prefix + "_NAME", config.name);
+    config.fifoPriority =
+        ENV::GetEnvValue<int>(prefix + "_FIFO_PRIORITY", config.fifoPriority);
+
+    if (ENV::IsSet(prefix + "_NUMA_LOCAL")) {
+        config.numaLocal = true;
+    }
+
+    return config;
+}
+
+std::vector<int> ThreadConfig::ParseCPUList(const std::string& list) {
+    std::vector<int> cpus;
+    std::stringstream entries(list);
+    std::string entry;
+
+    while (std::getline(entries, entry, ',')) {
+        char* end = nullptr;
+        const long first = strtol(entry.c_str(), &end, 10);
+        long last = first;
+
+        if (end == entry.c_str()) {
+            // Not a number, skip it
+            continue;
+        } else if (*end == '-') {
+            const char* rangeEnd = end + 1;
+            last = strtol(rangeEnd, &end, 10);
+            if (end == rangeEnd) {
+                continue;
+            }
+        }
+
+        for (long cpu = first; cpu >= 0 && cpu <= last; ++cpu) {
+            cpus.push_back(static_cast<int>(cpu));
+        }
+    }
+
+    return cpus;
+}
+
+int ThreadConfig::NumaNode() const {
+    int node = -1;
+
+    if (numaLocal && !cpus.empty()) {
+        std::stringstream path;
+        path << "/sys/devices/system/cpu/cpu" << cpus[0] << "/node*";
+
+        for (const std::string& dir: OS::Glob(path.str())) {
+            const std::string nodeDir = OS::Basename(dir);
+            node = atoi(nodeDir.c_str() + strlen("node"));
+        }
+
+        if (node >= static_cast<int>(MAX_NODES)) {
+            node = -1;
+        }
+    }
+
+    return node;
+}
+
+bool ThreadConfig::Apply() const {
+    bool ok = true;
+    const pthread_t self = pthread_self();
+
+    if (!name.empty()) {
+        const std::string shortName = name.substr(0, 15);
+        if (pthread_setname_np(self, shortName.c_str()) != 0) {
+            SLOG_FROM(LOG_ERROR, "ThreadConfig::Apply",
+                      "Failed to set thread name: " << name);
+            ok = false;
+        }
+    }
+
+    if (!cpus.empty()) {
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        for (int cpu: cpus) {
+            if (cpu < CPU_SETSIZE) {
+                CPU_SET(cpu, &cpuSet);
+            }
+        }
+
+        const int err = pthread_setaffinity_np(self, sizeof(cpuSet), &cpuSet);
+        if (err != 0) {
+            SLOG_FROM(LOG_ERROR, "ThreadConfig::Apply",
+                      "Failed to set CPU affinity: " << strerror(err));
+            ok = false;
+        }
+    }
+
+    if (fifoPriority != 0) {
+        sched_param param;
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = fifoPriority;
+
+        const int err = pthread_setschedparam(self, SCHED_FIFO, &param);
+        if (err != 0) {
+            SLOG_FROM(LOG_ERROR, "ThreadConfig::Apply",
+                      "Failed to set SCHED_FIFO priority " << fifoPriority
+                      << ": " << strerror(err));
+            ok = false;
+        }
+    }
+
+    const int node = NumaNode();
+    if (node >= 0) {
+        if (!SetMemoryPolicy(MPOL_PREFERRED, NodeMask(node).data())) {
+            SLOG_FROM(LOG_ERROR, "ThreadConfig::Apply",
+                      "Failed to prefer NUMA node " << node
+                      << ": " << strerror(errno));
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+ThreadConfig::LocalAllocation::LocalAllocation(const ThreadConfig& config)
+    : active(false),
+      oldMode(MPOL_DEFAULT),
+      oldNodes(NODE_WORDS, 0)
+{
+    const int node = config.NumaNode();
+
+    if (node >= 0 && GetMemoryPolicy(oldMode, oldNodes.data())) {
+        active = SetMemoryPolicy(MPOL_PREFERRED, NodeMask(node).data());
+    }
+}
+
+ThreadConfig::LocalAllocation::~LocalAllocation() {
+    if (active) {
+        SetMemoryPolicy(oldMode, oldNodes.data());
+    }
+}
@@ -0,0 +1,100 @@
+/*
+ * Placement and scheduling configuration for a thread
+ *
+ *  Created on: 16th October 2026
+ */
+
+#ifndef DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_THREAD_CONFIG_H__
+#define DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_THREAD_CONFIG_H__
+
+#include <string>
+#include <vector>
+
+/**
+ * Controls where, and how, a thread runs:
+ *
+ *    cpus:          The CPUs the thread may run on. Empty to leave it to the
+ *                   scheduler.
+ *    name:          Name reported by top, gdb etc. Truncated to 15
+ *                   characters. Empty to inherit the parent's name.
+ *    fifoPriority:  If non-zero, run the thread under SCHED_FIFO at this
+ *                   priority (1-99). Usually requires CAP_SYS_NICE.
+ *    numaLocal:     Prefer the NUMA node of the first CPU in cpus for all
+ *                   memory allocated by the thread. Ignored if cpus is empty.
+ *
+ * The configuration may also be read from the environment (see FromEnv), so
+ * that placement can be adjusted for a given host without a rebuild.
+ */
+class ThreadConfig {
+public:
+    ThreadConfig();
+
+    /**
+     * Override the defaults with any of the following environment variables:
+     *
+     *    <prefix>_CPUS           CPU list, e.g "2,4-7"
+     *    <prefix>_NAME           Thread name
+     *    <prefix>_FIFO_PRIORITY  SCHED_FIFO priority
+     *    <prefix>_NUMA_LOCAL     Set (to anything) to enable numaLocal
+     *
+     * @param prefix    Prefix for the variable names, e.g DEV_TOOLS_IO_THREAD
+     * @param defaults  The configuration to use for unset variables.
+     */
+    static ThreadConfig FromEnv(
+        const std::string& prefix,
+        const ThreadConfig& defaults = ThreadConfig());
+
+    /**
+     * Parse a Linux style CPU list (as used by taskset -c, and in
+     * /sys/devices/system/cpu), e.g "0,2,8-11". Invalid entries are ignored.
+     */
+    static std::vector<int> ParseCPUList(const std::string& list);
+
+    /**
+     * Configure the CALLING thread. Typically called first thing by the
+     * thread's main loop, but may also be used for threads not owned by this
+     * library (e.g a publisher's thread).
+     *
+     * Failures (e.g insufficient privileges for SCHED_FIFO) are logged, and
+     * the remaining settings are still applied.
+     *
+     * @returns true if every setting was applied.
+     */
+    bool Apply() const;
+
+    /**
+     * The NUMA node memory should be allocated from, or -1 if the
+     * configuration does not request NUMA local allocation.
+     */
+    int NumaNode() const;
+
+    /**
+     * For the lifetime of the scope, memory first touched by the calling
+     * thread is preferentially allocated from the configuration's NUMA node.
+     * Used to place structures owned by a thread before the thread is
+     * started (e.g. a WorkerThread's queue).
+     *
+     * Does nothing if the configuration does not request NUMA local
+     * allocation.
+     */
+    class LocalAllocation {
+    public:
+        LocalAllocation(const ThreadConfig& config);
+
+        ~LocalAllocation();
+
+        LocalAllocation(const LocalAllocation& rhs) = delete;
+        LocalAllocation& operator=(const LocalAllocation& rhs) = delete;
+    private:
+        bool                       active;
+        int                        oldMode;
+        std::vector<unsigned long> oldNodes;
+    };
+
+    std::vector<int> cpus;
+    std::string      name;
+    int              fifoPriority;
+    bool             numaLocal;
+};
+
+#endif
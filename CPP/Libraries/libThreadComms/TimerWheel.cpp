@@ -0,0 +1,244 @@
+/*
+ * TimerWheel.cpp
+ *
+ *  Created on: 16th October 2026
+ */
+
+#include "TimerWheel.h"
+#include <algorithm>
+
+namespace {
+    typedef std::chrono::milliseconds Tick;
+}
+
+void TimerWheel::Handle::Cancel() {
+    if (timer && !timer->cancelled.exchange(true)) {
+        // Leave the wheel's thread to unlink it
+        std::shared_ptr<Cancellations> queue = wheel.lock();
+        if (queue) {
+            std::unique_lock<std::mutex> lock(queue->mutex);
+            queue->timers.push_back(timer);
+            queue->pending = true;
+        }
+    }
+}
+
+bool TimerWheel::Handle::Cancelled() const {
+    return (timer && timer->cancelled);
+}
+
+TimerWheel::TimerWheel()
+    : start(Clock::now()),
+      now(0),
+      count(0),
+      wheel(LEVELS * SLOTS),
+      cancellations(std::make_shared<Cancellations>())
+{
+    cancellations->pending = false;
+}
+
+TimerWheel::TimerRef TimerWheel::NewTimer(
+    const Task& t,
+    const Clock::time_point& when,
+    const Clock::duration& period)
+{
+    TimerRef timer(new Timer);
+    timer->task = t;
+    timer->when = when;
+    timer->period = period;
+    timer->cancelled = false;
+    timer->expires = 0;
+    timer->slot = NOT_PLACED;
+    timer->position = 0;
+
+    return timer;
+}
+
+TimerWheel::Handle TimerWheel::NewHandle(TimerRef timer) const {
+    return Handle(std::move(timer), cancellations);
+}
+
+void TimerWheel::Insert(TimerRef timer) {
+    /**
+     * The flag is set before the timer is queued for removal: if we've
+     * missed it here, the removal is still to come.
+     */
+    if (!timer->cancelled) {
+        timer->expires = TickFor(timer->when);
+        ++count;
+        Place(std::move(timer));
+    }
+}
+
+void TimerWheel::RemoveCancelled() {
+    if (cancellations->pending.load(std::memory_order_acquire)) {
+        std::vector<TimerRef> cancelled;
+        {
+            std::unique_lock<std::mutex> lock(cancellations->mutex);
+            cancelled.swap(cancellations->timers);
+            cancellations->pending = false;
+        }
+
+        for (TimerRef& timer: cancelled) {
+            // Otherwise already discarded (or yet to be inserted)
+            if (timer->slot != NOT_PLACED) {
+                Slot& slot = wheel[timer->slot];
+                slot.back()->position = timer->position;
+                std::swap(slot[timer->position], slot.back());
+                slot.pop_back();
+
+                timer->slot = NOT_PLACED;
+                --count;
+            }
+
+            // The handle may keep the timer, but not its task
+            timer->task = nullptr;
+        }
+    }
+}
+
+void TimerWheel::Advance(
+    const Clock::time_point& time,
+    const std::function<bool()>& running)
+{
+    RemoveCancelled();
+
+    if (time >= start) {
+        const uint64_t target =
+            std::chrono::duration_cast<Tick>(time - start).count();
+
+        if (count == 0) {
+            // Nothing to do, just catch up...
+            now = std::max(now, target + 1);
+        }
+
+        while (now <= target) {
+            if ((now & SLOT_MASK) == 0) {
+                for (size_t level = 1; level < LEVELS; ++level) {
+                    const uint64_t levelMask = (1ull << (SLOT_BITS * level)) - 1;
+                    if ((now & levelMask) == 0) {
+                        Cascade(level);
+                    }
+                }
+            }
+
+            Fire(running);
+            ++now;
+        }
+    }
+}
+
+TimerWheel::Clock::time_point TimerWheel::NextWakeUp() const {
+    Clock::time_point wakeUp = Clock::time_point::max();
+
+    if (count > 0) {
+        /**
+         * Look for the next populated slot, up until the next cascade - at
+         * which point we'll need to re-evaluate. The cascade is done when
+         * the boundary tick itself is processed, so we must wake for it.
+         */
+        uint64_t tick = now;
+        while (wakeUp == Clock::time_point::max()) {
+            if (!wheel[tick & SLOT_MASK].empty() || (tick & SLOT_MASK) == 0) {
+                wakeUp = TimeOf(tick);
+            }
+            ++tick;
+        }
+    }
+
+    return wakeUp;
+}
+
+uint64_t TimerWheel::TickFor(const Clock::time_point& time) const {
+    uint64_t tick = 0;
+    if (time > start) {
+        const Clock::duration offset = time - start;
+        Tick ticks = std::chrono::duration_cast<Tick>(offset);
+        if (ticks < offset) {
+            // Never fire early...
+            ++ticks;
+        }
+        tick = ticks.count();
+    }
+
+    return tick;
+}
+
+TimerWheel::Clock::time_point TimerWheel::TimeOf(uint64_t tick) const {
+    return start + Tick(tick);
+}
+
+void TimerWheel::Place(TimerRef&& timer) {
+    timer->expires = std::max(timer->expires, now);
+    const uint64_t delta = timer->expires - now;
+
+    size_t level = 0;
+    while (level < (LEVELS - 1) && delta >= (1ull << (SLOT_BITS * (level + 1)))) {
+        ++level;
+    }
+
+    uint64_t slotTick = timer->expires;
+    if (delta >= (1ull << (SLOT_BITS * LEVELS))) {
+        // Beyond the end of the wheel, park it in the furthest slot, and
+        // re-evaluate when it is cascaded.
+        slotTick = now + (1ull << (SLOT_BITS * LEVELS)) - 1;
+    }
+
+    const size_t idx = (slotTick >> (SLOT_BITS * level)) & SLOT_MASK;
+    Slot& slot = wheel[level * SLOTS + idx];
+    timer->slot = level * SLOTS + idx;
+    timer->position = slot.size();
+    slot.push_back(std::move(timer));
+}
+
+void TimerWheel::Detach(Slot& slot, Slot& detached) {
+    detached.swap(slot);
+    for (TimerRef& timer: detached) {
+        timer->slot = NOT_PLACED;
+    }
+}
+
+void TimerWheel::Cascade(size_t level) {
+    const size_t idx = (now >> (SLOT_BITS * level)) & SLOT_MASK;
+    Slot slot;
+    Detach(wheel[level * SLOTS + idx], slot);
+
+    for (TimerRef& timer: slot) {
+        if (timer->cancelled) {
+            --count;
+        } else {
+            Place(std::move(timer));
+        }
+    }
+}
+
+void TimerWheel::Fire(const std::function<bool()>& running) {
+    Slot& current = wheel[now & SLOT_MASK];
+
+    if (!current.empty()) {
+        // Tasks may re-schedule into this slot, so work on a copy.
+        Slot slot;
+        Detach(current, slot);
+
+        for (TimerRef& timer: slot) {
+            if (!timer->cancelled && running()) {
+                timer->task();
+            }
+
+            if (timer->cancelled || timer->period == Clock::duration::zero() || !running()) {
+                --count;
+            } else {
+                /**
+                 * Schedule the next trigger, skipping any we've already missed
+                 * rather than firing a burst to catch up.
+                 */
+                const Clock::time_point due = TimeOf(now);
+                if (timer->when <= due) {
+                    timer->when += ((due - timer->when) / timer->period + 1) * timer->period;
+                }
+                timer->expires = std::max(TickFor(timer->when), now + 1);
+                Place(std::move(timer));
+            }
+        }
+    }
+}
@@ -0,0 +1,197 @@
+/*
+ * Hierarchical timing wheel, used to schedule delayed and periodic tasks.
+ *
+ *  Created on: 16th October 2026
+ */
+
+#ifndef DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_TIMER_WHEEL_H__
+#define DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_TIMER_WHEEL_H__
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+/**
+ * A four level timing wheel of 256 slots per level, with a 1ms tick. Timers
+ * are placed in the coarsest level which can resolve them, and cascade down
+ * to the finer levels as their expiry approaches, giving O(1) insertion. The
+ * wheel covers 2^32 ticks (~49 days), timers further out than this are
+ * re-cascaded through the top level.
+ *
+ * Cancellation is O(1): the timer is flagged, and queued for the wheel's
+ * thread, which unlinks it from its slot on the next Advance.
+ *
+ * Timers never fire early, but may fire up to a tick late.
+ *
+ * NOTE: Other than the Handle, the wheel is not thread safe - it is intended to
+ *       be driven by a single (e.g worker) thread.
+ */
+class TimerWheel {
+public:
+    typedef std::chrono::steady_clock Clock;
+    typedef std::function<void()>     Task;
+
+    struct Timer {
+        Task                task;
+        Clock::time_point   when;
+        Clock::duration     period;  // zero for a one-shot timer
+        std::atomic<bool>   cancelled;
+
+        // Owned by the wheel
+        uint64_t            expires;
+        size_t              slot;     // NOT_PLACED if not in a slot
+        size_t              position; // Index within the slot
+    };
+    typedef std::shared_ptr<Timer> TimerRef;
+
+    /**
+     * Timers cancelled since the last Advance. Shared with the handles, which
+     * may outlive the wheel.
+     */
+    struct Cancellations {
+        std::mutex             mutex;
+        std::vector<TimerRef>  timers;
+        std::atomic<bool>      pending;
+    };
+
+    /**
+     * Handle to a timer, which may be used to cancel it from any thread.
+     */
+    class Handle {
+    public:
+        Handle() {}
+
+        Handle(TimerRef _timer, std::weak_ptr<Cancellations> _wheel)
+            : timer(std::move(_timer)), wheel(std::move(_wheel)) {}
+
+        /**
+         * Prevent any future triggering of the timer.
+         *
+         * NOTE: If the timer is currently executing on another thread, that
+         *       execution will complete.
+         */
+        void Cancel();
+
+        bool Cancelled() const;
+
+    private:
+        TimerRef                      timer;
+        std::weak_ptr<Cancellations>  wheel;
+    };
+
+    TimerWheel();
+
+    /**
+     * Create a new timer, ready to be inserted into a wheel. This may be
+     * called from any thread.
+     *
+     * @param t       The task to trigger
+     * @param when    When the task should (first) be triggered
+     * @param period  Period to re-trigger the timer on, or zero for a one-shot
+     *                timer.
+     */
+    static TimerRef NewTimer(
+        const Task& t,
+        const Clock::time_point& when,
+        const Clock::duration& period = Clock::duration::zero());
+
+    /**
+     * A handle to cancel the timer, once it has been inserted into this
+     * wheel. This may be called from any thread.
+     */
+    Handle NewHandle(TimerRef timer) const;
+
+    /**
+     * Schedule the timer. A timer which has already been cancelled is
+     * discarded.
+     */
+    void Insert(TimerRef timer);
+
+    /**
+     * Trigger all timers due before now.
+     *
+     * @param now       The current time
+     * @param running   Checked before each timer is triggered, if false no
+     *                  further timers will be triggered.
+     */
+    void Advance(
+        const Clock::time_point& now,
+        const std::function<bool()>& running);
+
+    /**
+     * The time at which Advance should next be called. This may be earlier than
+     * the next expiry, if timers need to be cascaded.
+     *
+     * @returns Clock::time_point::max() if there are no timers.
+     */
+    Clock::time_point NextWakeUp() const;
+
+    /**
+     * Number of timers in the wheel, including timers cancelled since the
+     * last Advance.
+     */
+    size_t Size() const {
+        return count;
+    }
+
+private:
+    static const size_t LEVELS = 4;
+    static const size_t SLOT_BITS = 8;
+    static const size_t SLOTS = 1 << SLOT_BITS;
+    static const size_t SLOT_MASK = SLOTS - 1;
+    static const size_t NOT_PLACED = static_cast<size_t>(-1);
+
+    typedef std::vector<TimerRef> Slot;
+
+    /**
+     * The first tick at, or after, the specified time.
+     */
+    uint64_t TickFor(const Clock::time_point& time) const;
+
+    Clock::time_point TimeOf(uint64_t tick) const;
+
+    /**
+     * Place the timer in the correct slot for its expiry
+     */
+    void Place(TimerRef&& timer);
+
+    /**
+     * Take every timer in the slot out of the wheel, ready to be processed.
+     */
+    void Detach(Slot& slot, Slot& detached);
+
+    /**
+     * Unlink the cancelled timers from their slots
+     */
+    void RemoveCancelled();
+
+    /**
+     * Re-distribute the current slot of the specified level to the lower
+     * levels.
+     */
+    void Cascade(size_t level);
+
+    /**
+     * Trigger all of the timers in the current level 0 slot.
+     */
+    void Fire(const std::function<bool()>& running);
+
+    const Clock::time_point start;
+
+    /**
+     * The next tick to be processed: all timers expiring before this have
+     * been triggered.
+     */
+    uint64_t               now;
+    size_t                 count;
+    std::vector<Slot>      wheel;
+
+    // The pointer is fixed on construction, so handles may copy it
+    const std::shared_ptr<Cancellations> cancellations;
+};
+
+#endif
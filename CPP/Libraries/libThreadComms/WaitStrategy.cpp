@@ -0,0 +1,66 @@
+/*
+ * WaitStrategy.cpp
+ *
+ *  Created on: 16th October 2026
+ */
+
+#include "WaitStrategy.h"
+#include <thread>
+#include <algorithm>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+              "Unable to use std::atomic<uint32_t> as a futex");
+
+void Parker::Park(const Clock::time_point& deadline) {
+    const bool forever = (deadline == Clock::time_point::max());
+    std::chrono::nanoseconds timeout(0);
+
+    if (!forever) {
+        const Clock::time_point now = Clock::now();
+        if (deadline > now) {
+            timeout = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                deadline - now);
+        }
+    }
+
+    if (forever || timeout.count() > 0) {
+#ifdef __linux__
+        struct timespec ts;
+        struct timespec* tsp = nullptr;
+        if (!forever) {
+            ts.tv_sec = timeout.count() / 1000000000;
+            ts.tv_nsec = timeout.count() % 1000000000;
+            tsp = &ts;
+        }
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&parked),
+                FUTEX_WAIT_PRIVATE, 1, tsp, nullptr, 0);
+#else
+        // No futex, fall back to polling...
+        const std::chrono::nanoseconds poll(50000);
+        if (parked.load() == 1) {
+            std::this_thread::sleep_for(forever ? poll : std::min(timeout, poll));
+        }
+#endif
+    }
+}
+
+void Parker::Unpark() {
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&parked),
+            FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#endif
+}
+
+void Parker::Relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
@@ -0,0 +1,162 @@
+/*
+ * How a thread should wait for work to arrive
+ *
+ *  Created on: 16th October 2026
+ */
+
+#ifndef DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_WAIT_STRATEGY_H__
+#define DEV_TOOLS_CPP_LIBRARIES_LIB_THEAD_COMMS_WAIT_STRATEGY_H__
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * Trade-off between hand-off latency, and CPU burnt whilst idle:
+ *
+ *    BLOCK:           Park the thread immediately. Cheapest when idle, but
+ *                     each hand-off pays for a futex wake and a context
+ *                     switch.
+ *    SPIN_THEN_PARK:  Poll for up to spinBudget iterations before parking,
+ *                     so that bursty traffic is picked up without a context
+ *                     switch.
+ *    BUSY_POLL:       Never park. Lowest latency, but consumes an entire
+ *                     core whilst idle.
+ */
+struct WaitStrategy {
+    enum MODE {
+        BLOCK,
+        SPIN_THEN_PARK,
+        BUSY_POLL
+    };
+
+    WaitStrategy(MODE _mode = BLOCK, size_t _spinBudget = 0)
+        : mode(_mode), spinBudget(_spinBudget) { }
+
+    static WaitStrategy Blocking() {
+        return WaitStrategy(BLOCK);
+    }
+
+    static WaitStrategy SpinThenPark(size_t spinBudget = 10000) {
+        return WaitStrategy(SPIN_THEN_PARK, spinBudget);
+    }
+
+    static WaitStrategy BusyPoll() {
+        return WaitStrategy(BUSY_POLL);
+    }
+
+    MODE    mode;
+    size_t  spinBudget;
+};
+
+/**
+ * Single waiter park / unpark primitive, implemented directly on a futex
+ * (where available).
+ *
+ * The waiting thread calls Wait with a predicate for the condition it is
+ * waiting on, the notifying thread calls Wake after making the condition
+ * true. Wake is cheap (a fence and a load) unless the waiter is actually
+ * parked.
+ */
+class Parker {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    Parker(): parked(0) { }
+
+    /**
+     * Wait until ready returns true, or the deadline passes.
+     *
+     * NOTE: As with a condition variable, spurious wake-ups are possible.
+     *       The caller must re-check its condition.
+     *
+     * @param strategy   How to wait
+     * @param ready      Predicate for the condition being waited on
+     * @param deadline   The latest time to wait until
+     *
+     * @returns the final result of ready()
+     */
+    template <class Ready>
+    bool Wait(const WaitStrategy& strategy,
+              const Ready& ready,
+              const Clock::time_point& deadline = Clock::time_point::max());
+
+    /**
+     * Wake the waiting thread, if it is parked.
+     */
+    void Wake();
+
+private:
+    /**
+     * Block on the futex until woken, or the deadline passes.
+     */
+    void Park(const Clock::time_point& deadline);
+
+    /**
+     * Wake the thread blocked in Park
+     */
+    void Unpark();
+
+    static void Relax();
+
+    std::atomic<uint32_t> parked;
+};
+
+template <class Ready>
+inline bool Parker::Wait(
+    const WaitStrategy& strategy,
+    const Ready& ready,
+    const Clock::time_point& deadline)
+{
+    bool isReady = ready();
+
+    if (!isReady && strategy.mode == WaitStrategy::BUSY_POLL) {
+        const bool forever = (deadline == Clock::time_point::max());
+        for (size_t i = 1; !isReady; ++i) {
+            Relax();
+            isReady = ready();
+
+            // Don't hammer the clock...
+            if (!forever && (i & 0xff) == 0 && Clock::now() >= deadline) {
+                break;
+            }
+        }
+    } else if (!isReady) {
+        if (strategy.mode == WaitStrategy::SPIN_THEN_PARK) {
+            for (size_t i = 0; !isReady && i < strategy.spinBudget; ++i) {
+                Relax();
+                isReady = ready();
+            }
+        }
+
+        if (!isReady) {
+            parked.store(1, std::memory_order_relaxed);
+
+            // Pairs with the fence in Wake: either we see the condition, or
+            // the notifier sees that we are parked.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            isReady = ready();
+            if (!isReady) {
+                Park(deadline);
+                isReady = ready();
+            }
+
+            parked.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    return isReady;
+}
+
+inline void Parker::Wake() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (parked.load(std::memory_order_relaxed) != 0 &&
+        parked.exchange(0) != 0)
+    {
+        Unpark();
+    }
+}
+
+#endif
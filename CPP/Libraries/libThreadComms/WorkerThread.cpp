@@ -7,94 +7,293 @@
 
 #include "WorkerThread.h"
 #include <logger.h>
+#include <algorithm>
 
-WorkerThread::WorkerThread()
-   : state(NOT_STARTED)
+WorkerThread::WorkerThread(
+    size_t queueSize,
+    const WaitStrategy& wait,
+    const ThreadConfig& threadConfig)
+   : state(NOT_STARTED),
+     config(threadConfig),
+     overflowMutex("WorkerThread::overflowMutex"),
+     overflowing(false),
+     waitStrategy(wait),
+     keepStats(false),
+     posts(0),
+     statsSince(0),
+     tasks(0),
+     slowTasks(0),
+     busyNs(0),
+     slowTaskThresholdNs(0),
+     onSlowTask(nullptr)
 {
+    // The queue is hammered by the worker, so place it on the worker's node
+    ThreadConfig::LocalAllocation placement(config);
+    workQueue.reset(new BoundedQueue<Job>(queueSize));
 }
 
 void WorkerThread::PostTask(const Task& t) {
-    std::unique_lock<std::mutex> lock(queueMutex);
     if (state != ABORTED) {
-        workQueue.push_back({t,false, std::promise<bool>()});
+        Push({t, nullptr, SamplePost()});
+    }
+}
 
-        if (state == SLEEPING) {
-            Wake(RUNNING);
-        }
+bool WorkerThread::DoTask(const Task& t) {
+    bool ok = false;
+    if (state != ABORTED) {
+        std::shared_ptr<std::promise<bool>> promise(new std::promise<bool>);
+        std::future<bool> result = promise->get_future();
+
+        // Already a round trip, so always worth a sample
+        const bool stamp = keepStats.load(std::memory_order_relaxed);
+        Push({t, std::move(promise), stamp ? NowNs() : 0});
+
+        ok = result.get();
     }
+
+    return ok;
+}
+
+WorkerThread::TimerHandle WorkerThread::PostTaskAt(
+    const Task& t,
+    const Clock::time_point& when)
+{
+    return Schedule(TimerWheel::NewTimer(t, when));
+}
+
+WorkerThread::TimerHandle WorkerThread::PostTaskAfter(
+    const Task& t,
+    const Clock::duration& delay)
+{
+    return Schedule(TimerWheel::NewTimer(t, Clock::now() + delay));
+}
+
+WorkerThread::TimerHandle WorkerThread::PostTaskEvery(
+    const Task& t,
+    const Clock::duration& period)
+{
+    const Clock::duration interval =
+        std::max<Clock::duration>(period, std::chrono::milliseconds(1));
+
+    return Schedule(TimerWheel::NewTimer(t, Clock::now() + interval, interval));
 }
 
-void WorkerThread::CancelJobs(std::list<Job>::iterator it) {
+WorkerThread::TimerHandle WorkerThread::Schedule(TimerWheel::TimerRef timer) {
+    TimerHandle handle = timers.NewHandle(timer);
+
+    // The wheel belongs to the worker thread...
+    PostTask([this, timer] () -> void { timers.Insert(timer); });
+
+    return handle;
+}
 
-    while (it != workQueue.end()) {
-        it->Cancel();
-        workQueue.erase(it++);
+uint64_t WorkerThread::SamplePost() {
+    uint64_t stamp = 0;
+    if (keepStats.load(std::memory_order_relaxed)) {
+        const size_t post = posts.fetch_add(1, std::memory_order_relaxed);
+
+        if (post % STATS_SAMPLE_INTERVAL == 0) {
+            stamp = NowNs();
+        }
     }
+
+    return stamp;
 }
 
-void WorkerThread::Stop() {
-    std::unique_lock<std::mutex> lock(queueMutex);
-    if (!workQueue.empty())
+void WorkerThread::Push(Job&& job) {
+    if (overflowing.load(std::memory_order_acquire) ||
+        !workQueue->TryPush(std::move(job)))
     {
-        // Can't pop the first item as it may be being executed.
-        CancelJobs(++workQueue.begin());
+        std::unique_lock<ProfiledMutex<std::mutex>> lock(overflowMutex);
+        overflow.push_back(std::move(job));
+        overflowing = true;
+    }
+
+    if (state == ABORTED) {
+        // Abort may already have cleared the queue
+        CancelJobs();
+    } else {
+        Wake();
+    }
+}
+
+bool WorkerThread::Pop(Job& job) {
+    bool popped = workQueue->TryPop(job);
+
+    if (!popped && overflowing.load(std::memory_order_acquire)) {
+        std::unique_lock<ProfiledMutex<std::mutex>> lock(overflowMutex);
+        if (overflow.empty()) {
+            overflowing = false;
+        } else {
+            // Anything on the work queue was posted before the overflow...
+            popped = workQueue->TryPop(job);
+
+            if (!popped) {
+                job = std::move(overflow.front());
+                overflow.pop_front();
+                popped = true;
+            }
+        }
+    }
+
+    return popped;
+}
+
+void WorkerThread::CancelJobs() {
+    Job job;
+    while (Pop(job)) {
+        job.Cancel();
     }
-    Wake(STOPPED);
 }
 
 WorkerThread::~WorkerThread() {
     Abort();
     Join();
-    CancelJobs(workQueue.begin());
+    CancelJobs();
 }
 
 void WorkerThread::Run() {
-    std::unique_lock<std::mutex> lock(queueMutex);
     while (state == RUNNING) {
-        // Drain the queue. Note that the lock will be relinquished during task
-        // execution to allow further work to be posted.
-        DoTasks(lock);
+        DoTasks();
+        RunTimers();
 
         if (state == RUNNING) {
-            // Queue is exhausted, and we have the lock so no more work can be
-            // posted until we start waiting...
-            Sleep(lock);
+            Sleep();
         } else {
             // Abort received whilst executing tasks - time to leave...
         }
     }
+
+    CancelJobs();
 }
 
-void WorkerThread::DoTasks(std::unique_lock<std::mutex>& lock) {
-    for (Task* t = GetTask(); t != nullptr; t = GetTask())
-    {
-        lock.unlock();
-        (*t)();
-        lock.lock();
+void WorkerThread::DoTasks() {
+    bool more = true;
+    const bool accounting = keepStats.load(std::memory_order_relaxed);
+    uint64_t busySince = accounting ? NowNs() : 0;
+    bool busy = false;
+
+    for (size_t budget = workQueue->Capacity(); more && budget > 0; --budget) {
+        Job job;
+        more = (state == RUNNING && Pop(job));
+
+        if (more) {
+            if (state == RUNNING) {
+                uint64_t end = 0;
+
+                // Time the samples, or every task when looking for slow ones
+                if (accounting && (job.posted != 0 || onSlowTask)) {
+                    const uint64_t start = NowNs();
+                    job.task();
+                    end = NowNs();
+                    CountTask(job, start, end);
+                } else {
+                    job.task();
+                }
 
-        TaskDone();
+                if (accounting) {
+                    Increment<size_t>(tasks, 1);
+                    busy = true;
+
+                    // DoTask's caller may go straight to the stats
+                    if (job.result) {
+                        end = (end != 0) ? end : NowNs();
+                        Increment<uint64_t>(busyNs, end - busySince);
+                        busySince = end;
+                        busy = false;
+                    }
+                }
+
+                job.Done();
+            } else {
+                // Abort raced with the pop
+                job.Cancel();
+            }
+        }
+    }
+
+    if (busy) {
+        Increment<uint64_t>(busyNs, NowNs() - busySince);
+    }
+}
+
+void WorkerThread::CountTask(const Job& job, uint64_t start, uint64_t end) {
+    const uint64_t runTime = end - start;
+
+    // Not stamped if unsampled, or posted before stats were enabled.
+    if (job.posted != 0) {
+        queueWaitTimes.Record((start > job.posted) ? start - job.posted : 0);
+    }
+
+    runTimes.Record(runTime);
+
+    if (onSlowTask && runTime > slowTaskThresholdNs) {
+        Increment<size_t>(slowTasks, 1);
+        onSlowTask(std::chrono::nanoseconds(runTime));
+    }
+}
+
+void WorkerThread::EnableStats(bool enable) {
+    uint64_t notStarted = 0;
+    if (enable) {
+        statsSince.compare_exchange_strong(notStarted, NowNs());
     }
+
+    keepStats.store(enable, std::memory_order_relaxed);
 }
 
-WorkerThread::Task* WorkerThread::GetTask() {
-    Task* task = nullptr;
-    if (state==RUNNING && !workQueue.empty()) {
-        task = &workQueue.front().task;
+WorkerThreadStats WorkerThread::Stats() {
+    WorkerThreadStats stats;
+    stats.tasks = tasks.load(std::memory_order_relaxed);
+    stats.slowTasks = slowTasks.load(std::memory_order_relaxed);
+    stats.busyNs = busyNs.load(std::memory_order_relaxed);
+
+    const uint64_t since = statsSince.load(std::memory_order_relaxed);
+    if (since != 0) {
+        stats.elapsedNs = NowNs() - since;
     }
-    return task;
+
+    stats.queueLength = workQueue->Size();
+    if (overflowing.load(std::memory_order_acquire)) {
+        std::unique_lock<ProfiledMutex<std::mutex>> lock(overflowMutex);
+        stats.queueLength += overflow.size();
+    }
+
+    return stats;
+}
+
+void WorkerThread::OnSlowTask(
+    const Clock::duration& threshold,
+    const SlowTaskCallback& f)
+{
+    const uint64_t thresholdNs =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(threshold).count();
+
+    PostTask([this, thresholdNs, f] () -> void {
+        slowTaskThresholdNs = thresholdNs;
+        onSlowTask = f;
+    });
+}
+
+void WorkerThread::RunTimers() {
+    timers.Advance(Clock::now(), [this] () -> bool {
+        return (state == RUNNING);
+    });
 }
 
 void WorkerThread::Abort() {
-    Stop();
-    std::unique_lock<std::mutex> lock(queueMutex);
-    Wake(ABORTED);
+    state = ABORTED;
+    CancelJobs();
+    Wake();
 }
 
 void WorkerThread::Start() {
-    if (state != RUNNING) {
-        std::unique_lock<std::mutex> lock(queueMutex);
-        state = RUNNING;
-        worker = std::thread([this] () -> void { this->Run();});
+    STATE expected = NOT_STARTED;
+    if (state.compare_exchange_strong(expected, RUNNING)) {
+        worker = std::thread([this] () -> void {
+            config.Apply();
+            this->Run();
+        });
     }
 }
 
@@ -105,58 +304,50 @@ void WorkerThread::Join() {
     }
 }
 
-bool WorkerThread::DoTask(const Task& t) {
-    bool ok = false;
-    std::future<bool> result;
-    {
-        std::unique_lock<std::mutex> lock(queueMutex);
-        if (state != ABORTED)
-        {
-            workQueue.push_back({t,true,std::promise<bool>()});
-            result = workQueue.back().result.get_future();
-
-            if (state == SLEEPING) {
-                Wake(RUNNING);
-            }
-        }
-    }
+void WorkerThread::Wake() {
+    parker.Wake();
+}
 
-    if (result.valid()) {
-        ok = result.get();
-    }
+void WorkerThread::Sleep() {
+    auto workToDo = [this] () -> bool {
+        return (state != RUNNING ||
+                !workQueue->Empty() ||
+                overflowing.load(std::memory_order_relaxed));
+    };
 
-    return ok;
+    parker.Wait(waitStrategy, workToDo, timers.NextWakeUp());
 }
 
-void WorkerThread::TaskDone() {
-    Job& job = workQueue.front();
-    if (job.promised)
-    {
-        job.result.set_value(true);
+void WorkerThread::Job::Done() {
+    if (result) {
+        result->set_value(true);
     }
-    workQueue.pop_front();
 }
 
-void WorkerThread::Wake(STATE newState) {
-    bool sleeping = (state == SLEEPING);
-    state = newState;
-
-    if (sleeping) {
-        notification.notify_all();
+void WorkerThread::Job::Cancel() {
+    if (result) {
+        result->set_value(false);
     }
 }
 
-void WorkerThread::Sleep(std::unique_lock<std::mutex>& lock) {
-    if (state == RUNNING) {
-        state = SLEEPING;
-        notification.wait(lock);
-    } else {
-        // It is not valid to sleep unless we are running.
-    }
+WorkerThreadStats::WorkerThreadStats()
+    : tasks(0),
+      slowTasks(0),
+      queueLength(0),
+      busyNs(0),
+      elapsedNs(0)
+{
 }
 
-void WorkerThread::Job::Cancel() {
-    if (promised) {
-        result.set_value(false);
+double WorkerThreadStats::BusyPercentage(const WorkerThreadStats& previous) const {
+    double busy = 0;
+    if (elapsedNs > previous.elapsedNs) {
+        busy = 100.0 * (busyNs - previous.busyNs) / (elapsedNs - previous.elapsedNs);
     }
+
+    return busy;
+}
+
+double WorkerThreadStats::BusyPercentage() const {
+    return BusyPercentage(WorkerThreadStats());
 }
@@ -13,16 +13,83 @@
  * Avoid false positives on helgrind output, from the std::thread library
  */
 #include "IPostable.h"
+#include "BoundedQueue.h"
+#include "TimerWheel.h"
+#include "WaitStrategy.h"
+#include "ThreadConfig.h"
+#include "Future.h"
+#include "IBatchHandler.h"
+#include "LatencyHistogram.h"
+#include <ProfiledMutex.h>
 #include <thread>
-#include <condition_variable>
-#include <queue>
+#include <deque>
 #include <mutex>
 #include <future>
+#include <vector>
+#include <atomic>
+#include <chrono>
 #include <PipePublisher.h>
 
+/**
+ * Snapshot of a WorkerThread's task accounting, see WorkerThread::Stats.
+ *
+ * The counters only advance whilst stats are enabled.
+ */
+struct WorkerThreadStats {
+    WorkerThreadStats();
+
+    size_t    tasks;        // Tasks executed
+    size_t    slowTasks;    // Tasks which exceeded the OnSlowTask threshold
+    size_t    queueLength;  // Tasks waiting to run at the time of the snapshot
+    uint64_t  busyNs;       // Time spent executing tasks
+    uint64_t  elapsedNs;    // Time since stats were first enabled
+
+    /**
+     * Percentage of the time spent executing tasks since an earlier
+     * snapshot (or since stats were enabled, if there isn't one).
+     */
+    double BusyPercentage(const WorkerThreadStats& previous) const;
+    double BusyPercentage() const;
+};
+
+/**
+ * A single thread, running tasks posted to it in order.
+ *
+ * Tasks are queued on a pre-allocated lock-free queue, so posting a task does
+ * not allocate (beyond any allocation std::function requires to store the
+ * task), or contend on a lock. Should the queue fill, tasks spill onto a
+ * (locked) overflow queue until the thread catches up.
+ *
+ * Delayed and periodic tasks are held on a timing wheel, which is serviced by
+ * the thread between tasks, so no additional threads are required.
+ *
+ * The thread may be pinned, named and NUMA placed via a ThreadConfig.
+ * Subscribers created by ConsumeUpdates are allocated from the worker thread
+ * itself, so their ring buffers follow its NUMA placement.
+ */
 class WorkerThread: public IPostable {
 public:
-    WorkerThread();
+    typedef TimerWheel::Clock   Clock;
+    typedef TimerWheel::Handle  TimerHandle;
+
+    /**
+     * One in this many PostTask calls is sampled by the task accounting, see
+     * EnableStats.
+     */
+    static const size_t STATS_SAMPLE_INTERVAL = 16;
+
+    /**
+     * @param queueSize  Number of tasks which may be queued before spilling
+     *                   onto the overflow queue.
+     * @param wait       How the thread should wait for new tasks when idle.
+     * @param config     Placement of the thread, unconstrained by default.
+     *                   An application may read this from the environment,
+     *                   under a prefix of its own, see ThreadConfig::FromEnv.
+     */
+    WorkerThread(
+        size_t queueSize = 1024,
+        const WaitStrategy& wait = WaitStrategy::Blocking(),
+        const ThreadConfig& config = ThreadConfig());
 
     /**
      * Post a task to the event loop.
@@ -40,8 +107,121 @@ public:
      */
     bool DoTask(const Task& t);
 
+    /**
+     * Post a task, without waiting for it to run.
+     *
+     * Rather than blocking on the result (as DoTask does), attach a
+     * continuation to the returned future, e.g:
+     *
+     *    worker.Submit(Calculate).Then(Publish, &publisherThread);
+     *
+     * If the task throws, the future fails with its exception. If the task
+     * is never run (the thread is aborted), the future fails with a
+     * FutureException.
+     *
+     * @param t  The task to be run. It may return a value, or void.
+     *
+     * @returns A future for the result of the task.
+     */
+    template <class F>
+    Future<typename std::result_of<F()>::type> Submit(F t);
+
+    /**
+     * Post a task to be run at the specified time. The task will not run
+     * early, but may be up to a 1ms tick late (or later, if the thread is busy
+     * with other tasks).
+     *
+     * @param t     The task to be run.
+     * @param when  The time to run the task
+     *
+     * @returns A handle which may be used to cancel the task
+     */
+    TimerHandle PostTaskAt(const Task& t, const Clock::time_point& when);
+
+    /**
+     * Post a task to be run after the specified delay.
+     *
+     * See PostTaskAt
+     */
+    TimerHandle PostTaskAfter(const Task& t, const Clock::duration& delay);
+
+    /**
+     * Post a task to be run every period, starting one period from now, until
+     * the returned handle is cancelled.
+     *
+     * Triggers which are missed (e.g because the thread was busy) are skipped,
+     * rather than run in a burst.
+     *
+     * @param t       The task to be run.
+     * @param period  The interval between runs, at least one tick (1ms).
+     *
+     * @returns A handle which may be used to cancel the task
+     */
+    TimerHandle PostTaskEvery(const Task& t, const Clock::duration& period);
+
     virtual ~WorkerThread();
 
+    /**
+     * Start (or stop) task accounting. Stats are disabled by default.
+     *
+     * Whilst enabled the worker records:
+     *    - The number of tasks run, and the total time busy running them: see
+     *      Stats. The busy time is read once per batch of tasks (and after
+     *      a DoTask), not per task.
+     *    - The time from a post to the start of the task: QueueWaitTimes
+     *    - The time a task ran for: RunTimes
+     *
+     * Reading the clock costs more than the rest of a post, so only one in
+     * every STATS_SAMPLE_INTERVAL calls to PostTask is stamped (on the
+     * posting thread) and timed: the histograms are a sample. DoTask is
+     * always stamped. Every task is timed whilst an OnSlowTask callback is
+     * installed.
+     *
+     * Timers (PostTaskAt etc) are not included.
+     *
+     * NOTE: This may be called from any thread.
+     */
+    void EnableStats(bool enable = true);
+
+    /**
+     * Snapshot the accounting counters. This may be called from any thread.
+     */
+    WorkerThreadStats Stats();
+
+    /**
+     * Histogram of the time (in ns) tasks spent queued, before they were
+     * started.
+     *
+     * The histogram is written by the worker thread: it may be read from any
+     * thread, see LatencyHistogram.
+     */
+    const LatencyHistogram& QueueWaitTimes() const {
+        return queueWaitTimes;
+    }
+
+    /**
+     * Histogram of the time (in ns) each task ran for, see QueueWaitTimes
+     */
+    const LatencyHistogram& RunTimes() const {
+        return runTimes;
+    }
+
+    /**
+     * Trigger a callback, on the worker thread, after any task which runs
+     * for longer than threshold (e.g to log it). Only tasks run whilst stats
+     * are enabled are checked: this disables the sampling of RunTimes, as
+     * every task must now be timed.
+     *
+     * The callback is installed by the worker thread itself, and so only
+     * applies to tasks posted after this call. Any previous callback is
+     * replaced; pass a null callback to remove it.
+     *
+     * @param threshold  Run time beyond which a task is considered slow
+     * @param f          Passed the run time of the slow task
+     */
+    typedef std::function<void (const Clock::duration& runTime)> SlowTaskCallback;
+    void OnSlowTask(const Clock::duration& threshold, const SlowTaskCallback& f);
+
     /**
      * Stop the thread, may be called by any thread.
      *
@@ -88,124 +268,327 @@ public:
         size_t maxQueueSize = 1000000,
         size_t maxSlizeSize = 100);
 
+    /**
+     * Variant of ConsumeUpdates where the task is passed each slice of
+     * updates as a single contiguous array. Updates are drained from the
+     * subscriber in bulk, see PipeSubscriber::GetNextMessages.
+     *
+     * @param publisher      The publisher to consume updates from
+     * @param t              The task to execute for each slice of updates.
+     *                       This will never be called with an empty slice.
+     * @param maxQueueSize   Argument to NewClient, see ConsumeUpdates
+     * @param maxSlizeSize   The maximum number of updates to pass to the task
+     *                       in one go.
+     */
+    template<class Msg>
+    void ConsumeUpdates(
+        PipePublisher<Msg>& publisher,
+        const std::function<void (Msg* msgs, size_t count)>& task,
+        size_t maxQueueSize = 1000000,
+        size_t maxSlizeSize = 100);
+
+    /**
+     * Batch aware variant of ConsumeUpdates. Rather than consuming in fixed
+     * slices as updates arrive, the worker is woken once per publisher batch
+     * (at EndBatch), and drains the whole batch in one task:
+     *
+     *    handler.OnBatchStart();
+     *    handler.OnUpdates(...);   // Once per slice
+     *    handler.OnBatchEnd();
+     *
+     * Updates from a batch still in progress are never delivered, so
+     * OnBatchEnd always falls on a batch boundary. See IBatchHandler.
+     *
+     * @param publisher      The publisher to consume updates from
+     * @param handler        The handler to pass the updates to. This must
+     *                       outlive the worker.
+     * @param maxQueueSize   Argument to NewClient, see ConsumeUpdates
+     * @param maxSlizeSize   The maximum number of updates to pass to
+     *                       OnUpdates in one go.
+     */
+    template<class Msg>
+    void ConsumeUpdates(
+        PipePublisher<Msg>& publisher,
+        IBatchHandler<Msg>& handler,
+        size_t maxQueueSize = 1000000,
+        size_t maxSlizeSize = 100);
+
+    /**
+     * Variant of ConsumeUpdates which consumes from a custom client type, such
+     * as a ConflatingSubscriber. The client is created, on the worker thread,
+     * by calling publisher.NewClient<Client>(args...)
+     *
+     * The client must provide the GetNextMessage and
+     * OnNextMessage(callback, target) interface of PipeSubscriber.
+     *
+     * @param publisher      The publisher to consume updates from
+     * @param t              The task to execute for each update.
+     * @param maxSlizeSize   The maximum number of updates to consume in one
+     *                       "task", see ConsumeUpdates
+     * @param args           Arguments to the Client's constructor
+     */
+    template<class Client, class Msg, class... Args>
+    void ConsumeUpdates(
+        PipePublisher<Msg>& publisher,
+        const std::function<void (Msg& m)>& task,
+        size_t maxSlizeSize,
+        Args... args);
+
 private:
-    enum STATE {NOT_STARTED, RUNNING, SLEEPING, STOPPED, ABORTED};
+    enum STATE {NOT_STARTED, RUNNING, ABORTED};
+
+    struct Job {
+        Task task;
+
+        /**
+         * Only allocated for DoTask, shared so that the waiting thread may
+         * safely destroy its future whilst we are still notifying it.
+         */
+        std::shared_ptr<std::promise<bool>> result;
+
+        /**
+         * When the job was posted (ns), or 0 if it was not sampled (or
+         * stats are disabled)
+         */
+        uint64_t posted;
+
+        /**
+         * The job has been executed, notify anyone waiting on us.
+         */
+        void Done();
+
+        /**
+         * The job will never be executed.
+         *
+         * Notify anyone waiting on us that they will not get a result.
+         */
+        void Cancel();
+    };
+
     /**
      * The thread's main loop
      */
     void Run();
 
     /**
-     * Execute all tasks on the queue, until it is exhausted.
+     * Execute all tasks on the queue, until it is exhausted, or the thread is
+     * aborted.
      *
-     * lock will be released whilst individual tasks are being executed, and
-     * then re-acquired.
+     * No more than a queue's worth of tasks are executed in one go, so that a
+     * busy queue can not starve the timers.
      */
-    void DoTasks(std::unique_lock<std::mutex>& lock);
+    void DoTasks();
 
     /**
-     * Get the next task, MUST be called whilst already under lock
+     * Trigger any timers which are due.
      */
-    Task* GetTask();
+    void RunTimers();
 
     /**
-     * Mark the current task as done, MUST be called whilst already under lock
+     * Schedule the timer on the worker thread
      */
-    void TaskDone();
+    TimerHandle Schedule(TimerWheel::TimerRef timer);
 
     /**
-     * Wake the run thread, in newState. MUST be invoked under lock.
-     *
-     * If the thread is not sleeping, the state is transitioned immediately.
-     *
-     * @param newState  The state of the thread after it has been woken. This
-     *                  would usually be RUNNING, indicating the thread should
-     *                  continue, but may also be ABORTED.
+     * Queue a new job, and wake the thread if it is sleeping.
      */
-    void Wake(STATE newState);
+    void Push(Job&& job);
 
     /**
-     * Nothing left to do, wait for more work.
+     * Get the next job, from the lock-free queue if possible, otherwise from
+     * the overflow queue.
      *
-     * The lock will be released whilst we wait, and will be re-acquired before
-     * Sleep returns...
+     * @param job   Populated with the next job
      *
-     * @param lock   The runtime lock
+     * @returns true if there was a job
+     */
+    bool Pop(Job& job);
+
+    /**
+     * Wake the run thread, if it is sleeping.
+     */
+    void Wake();
+
+    /**
+     * Nothing left to do, wait for more work, or the next timer.
+     */
+    void Sleep();
+
+    /**
+     * Cancel all queued jobs.
+     */
+    void CancelJobs();
+
+    /**
+     * Time stamp used by the task accounting
+     */
+    static uint64_t NowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            Clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * Stamp for a new post: the time, for one in every STATS_SAMPLE_INTERVAL
+     * posts whilst stats are enabled, otherwise 0.
      */
-    void Sleep(std::unique_lock<std::mutex>& lock);
+    uint64_t SamplePost();
 
     /**
-     * Stop the thread.
+     * Account for a timed task, run whilst stats are enabled. Worker thread
+     * only.
      *
-     * The queue lock will be acquired to perform this operation
+     * @param job    The task which has just been run
+     * @param start  When the task was started
+     * @param end    When the task completed
      */
-	void Stop();
+    void CountTask(const Job& job, uint64_t start, uint64_t end);
+
+    /**
+     * Single writer counter: only the worker thread may update it.
+     */
+    template <class T>
+    static void Increment(std::atomic<T>& counter, T count) {
+        counter.store(counter.load(std::memory_order_relaxed) + count,
+                      std::memory_order_relaxed);
+    }
 
     /**
      * Callback from ConsumeUpdates
      */
-    template<class Msg>
+    template<class Client, class Msg>
     void HandleUpdates(
-        PipeSubscriber<Msg>& client,
+        Client& client,
         const std::function<void (Msg& m)>& task,
         size_t maxSlizeSize = 100);
 
-    struct Job {
-        Task task;
-        bool promised;
-        std::promise<bool> result;
+    /**
+     * Callback from the bulk ConsumeUpdates
+     */
+    template<class Msg>
+    void HandleUpdates(
+        PipeSubscriber<Msg>& client,
+        const std::function<void (Msg* msgs, size_t count)>& task,
+        std::shared_ptr<std::vector<Msg>> slice);
 
-        /**
-         * The job will never be executed.
-         *
-         * Notify anyone waiting on us that they will not get a result.
-         */
-        void Cancel();
-    };
+    /**
+     * Callback from the batch aware ConsumeUpdates
+     */
+    template<class Msg>
+    void HandleBatches(
+        PipeSubscriber<Msg>& client,
+        IBatchHandler<Msg>& handler,
+        std::shared_ptr<std::vector<Msg>> slice);
+
+    std::atomic<STATE>           state;
+    const ThreadConfig           config;
 
     /**
-     * Cancel the specified jobs, and any that would be executed after it
-     *
-     * NOTE: This function must be called under lock
-     *
-     * @param it The first job to cancel
+     * Allocated on the worker's NUMA node, if configured
      */
-	void CancelJobs(std::list<Job>::iterator it);
+    std::unique_ptr<BoundedQueue<Job>> workQueue;
+
+    /**
+     * Jobs which didn't fit on the work queue. Once anything is on the
+     * overflow queue, all new jobs are pushed to it (preserving order) until
+     * it is drained.
+     */
+    ProfiledMutex<std::mutex>    overflowMutex;
+    std::deque<Job>              overflow;
+    std::atomic<bool>            overflowing;
+
+    /**
+     * The idle thread parks here
+     */
+    Parker                       parker;
+    const WaitStrategy           waitStrategy;
+
+    /**
+     * Worker thread only
+     */
+    TimerWheel                   timers;
 
-    std::mutex                   queueMutex;
-    std::condition_variable      notification;
-    std::list<Job>               workQueue;
-    STATE                        state;
     std::thread                  worker;
 
     std::vector<std::shared_ptr<void>> clients;
+
+    /*********************************
+     *      Task Accounting
+     *********************************/
+    std::atomic<bool>            keepStats;
+    /**
+     * Posts since stats were enabled. Any thread may post, so this is a
+     * (relaxed) locked add rather than the single-writer Increment.
+     */
+    std::atomic<size_t>          posts;
+    std::atomic<uint64_t>        statsSince;
+    LatencyHistogram             queueWaitTimes;
+    LatencyHistogram             runTimes;
+    // Updated by the worker thread
+    std::atomic<size_t>          tasks;
+    std::atomic<size_t>          slowTasks;
+    std::atomic<uint64_t>        busyNs;
+
+    /**
+     * Worker thread only
+     */
+    uint64_t                     slowTaskThresholdNs;
+    SlowTaskCallback             onSlowTask;
 };
 
+template <class F>
+inline Future<typename std::result_of<F()>::type> WorkerThread::Submit(F t) {
+    typedef typename std::result_of<F()>::type Result;
+
+    /**
+     * Owned by the task: if the task is discarded without being run, the
+     * promise is broken.
+     */
+    std::shared_ptr<Promise<Result>> promise(FutureDetail::NewPromise<Result>());
+    Future<Result> result = promise->GetFuture();
+
+    PostTask([promise, t] () mutable -> void {
+        promise->SetResultOf(t);
+    });
+
+    return result;
+}
+
 template<class Msg>
 inline void WorkerThread::ConsumeUpdates(
     PipePublisher<Msg>& publisher,
     const std::function<void (Msg& m)>& task,
     size_t maxQueueSize,
     size_t maxSlizeSize)
+{
+    ConsumeUpdates<PipeSubscriber<Msg>>(
+        publisher, task, maxSlizeSize, maxQueueSize);
+}
+
+template<class Client, class Msg, class... Args>
+inline void WorkerThread::ConsumeUpdates(
+    PipePublisher<Msg>& publisher,
+    const std::function<void (Msg& m)>& task,
+    size_t maxSlizeSize,
+    Args... args)
 {
     /**
      * We need to be on the worker thread to initialize the client...
      */
-    auto initializer = [&publisher, task,maxQueueSize, maxSlizeSize, this] () -> void {
-        std::shared_ptr<PipeSubscriber<Msg>> client =
-                publisher.NewClient(maxQueueSize);
+    auto initializer = [&publisher, task, maxSlizeSize, args..., this] () -> void {
+        std::shared_ptr<Client> client =
+                publisher.template NewClient<Client>(args...);
 
         clients.push_back(client);
 
-        HandleUpdates(*client,task,maxSlizeSize);
+        HandleUpdates<Client,Msg>(*client,task,maxSlizeSize);
     };
 
     this->DoTask(initializer);
 }
 
-template<class Msg>
+template<class Client, class Msg>
 inline void WorkerThread::HandleUpdates(
-    PipeSubscriber<Msg>& client,
+    Client& client,
     const std::function<void(Msg& m)>& task,
     size_t maxSlizeSize)
 {
@@ -217,7 +600,112 @@ inline void WorkerThread::HandleUpdates(
     }
 
     auto callback =  [this, &clientRef = client, maxSlizeSize, task] () -> void {
-        this->HandleUpdates(clientRef,task,maxSlizeSize);
+        this->HandleUpdates<Client,Msg>(clientRef,task,maxSlizeSize);
+    };
+
+    client.OnNextMessage(callback,this);
+}
+
+template<class Msg>
+inline void WorkerThread::ConsumeUpdates(
+    PipePublisher<Msg>& publisher,
+    const std::function<void (Msg* msgs, size_t count)>& task,
+    size_t maxQueueSize,
+    size_t maxSlizeSize)
+{
+    /**
+     * We need to be on the worker thread to initialize the client...
+     */
+    auto initializer = [&publisher, task,maxQueueSize, maxSlizeSize, this] () -> void {
+        std::shared_ptr<PipeSubscriber<Msg>> client =
+                publisher.NewClient(maxQueueSize);
+
+        clients.push_back(client);
+
+        std::shared_ptr<std::vector<Msg>> slice(
+            new std::vector<Msg>(maxSlizeSize));
+
+        HandleUpdates(*client,task,slice);
+    };
+
+    this->DoTask(initializer);
+}
+
+template<class Msg>
+inline void WorkerThread::HandleUpdates(
+    PipeSubscriber<Msg>& client,
+    const std::function<void (Msg* msgs, size_t count)>& task,
+    std::shared_ptr<std::vector<Msg>> slice)
+{
+    const size_t count = client.GetNextMessages(slice->data(), slice->size());
+
+    if (count > 0) {
+        task(slice->data(), count);
+    }
+
+    auto callback =  [this, &clientRef = client, task, slice] () -> void {
+        this->HandleUpdates(clientRef,task,slice);
+    };
+
+    client.OnNextMessage(callback,this);
+}
+
+template<class Msg>
+inline void WorkerThread::ConsumeUpdates(
+    PipePublisher<Msg>& publisher,
+    IBatchHandler<Msg>& handler,
+    size_t maxQueueSize,
+    size_t maxSlizeSize)
+{
+    /**
+     * We need to be on the worker thread to initialize the client...
+     */
+    auto initializer = [&publisher, &handler, maxQueueSize, maxSlizeSize, this] () -> void {
+        std::shared_ptr<PipeSubscriber<Msg>> client =
+                publisher.NewClient(maxQueueSize);
+
+        clients.push_back(client);
+
+        std::shared_ptr<std::vector<Msg>> slice(
+            new std::vector<Msg>(maxSlizeSize));
+
+        HandleBatches(*client,handler,slice);
+    };
+
+    this->DoTask(initializer);
+}
+
+template<class Msg>
+inline void WorkerThread::HandleBatches(
+    PipeSubscriber<Msg>& client,
+    IBatchHandler<Msg>& handler,
+    std::shared_ptr<std::vector<Msg>> slice)
+{
+    /**
+     * Only drain up to the boundary we started with: anything committed
+     * whilst we're running is left for the next wake up.
+     */
+    size_t remaining = client.CommittedMessages();
+
+    if (remaining > 0) {
+        handler.OnBatchStart();
+
+        while (remaining > 0) {
+            const size_t count = client.GetCommittedMessages(
+                slice->data(), std::min(remaining, slice->size()));
+            if (count == 0) {
+                break;
+            }
+
+            handler.OnUpdates(slice->data(), count);
+            remaining -= count;
+        }
+
+        handler.OnBatchEnd();
+    }
+
+    auto callback =  [this, &clientRef = client, &handler, slice] () -> void {
+        this->HandleBatches(clientRef,handler,slice);
     };
 
     client.OnNextMessage(callback,this);
@@ -0,0 +1,312 @@
+/*
+ * WorkerThreadPool.cpp
+ *
+ *  Created on: 16th October 2026
+ */
+
+#include "WorkerThreadPool.h"
+#include <algorithm>
+
+namespace {
+    /**
+     * The pool, and worker, which owns the current thread (if any). Used to
+     * keep work posted from within a task on the posting thread's queue.
+     */
+    thread_local WorkerThreadPool* currentPool = nullptr;
+    thread_local size_t            currentWorker = 0;
+}
+
+WorkerThreadPool::WorkerThreadPool(size_t threads, size_t numStrands)
+   : state(NOT_STARTED),
+     nextWorker(0),
+     nextStrand(0),
+     queued(0),
+     sleepers(0)
+{
+    threads = std::max<size_t>(threads, 1);
+    numStrands = std::max<size_t>(numStrands, 1);
+
+    workers.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers.emplace_back(new Worker);
+    }
+
+    strands.reserve(numStrands);
+    for (size_t i = 0; i < numStrands; ++i) {
+        strands.emplace_back(new StrandQueue(*this, i));
+    }
+}
+
+WorkerThreadPool::~WorkerThreadPool() {
+    Abort();
+    Join();
+}
+
+void WorkerThreadPool::PostTask(const Task& t) {
+    if (state != ABORTED) {
+        Push({t, nullptr});
+    }
+}
+
+void WorkerThreadPool::PostTask(const Task& t, StrandKey strand) {
+    if (state != ABORTED) {
+        PushToStrand({t, nullptr}, strand);
+    }
+}
+
+bool WorkerThreadPool::DoTask(const Task& t) {
+    bool ok = false;
+    if (state != ABORTED) {
+        std::shared_ptr<std::promise<bool>> promise(new std::promise<bool>);
+        std::future<bool> result = promise->get_future();
+        Job job = {t, std::move(promise)};
+        Push(std::move(job));
+        ok = result.get();
+    }
+
+    return ok;
+}
+
+bool WorkerThreadPool::DoTask(const Task& t, StrandKey strand) {
+    bool ok = false;
+    if (state != ABORTED) {
+        std::shared_ptr<std::promise<bool>> promise(new std::promise<bool>);
+        std::future<bool> result = promise->get_future();
+        Job job = {t, std::move(promise)};
+        PushToStrand(std::move(job), strand);
+        ok = result.get();
+    }
+
+    return ok;
+}
+
+void WorkerThreadPool::Abort() {
+    state = ABORTED;
+
+    {
+        Lock lock(sleepMutex);
+        notification.notify_all();
+    }
+
+    for (std::unique_ptr<Worker>& worker: workers) {
+        Lock lock(worker->queueMutex);
+        queued -= worker->workQueue.size();
+        CancelJobs(worker->workQueue);
+    }
+
+    for (std::unique_ptr<StrandQueue>& strand: strands) {
+        Lock lock(strand->queueMutex);
+        CancelJobs(strand->workQueue);
+    }
+}
+
+void WorkerThreadPool::Start() {
+    STATE expected = NOT_STARTED;
+    if (state.compare_exchange_strong(expected, RUNNING)) {
+        for (size_t i = 0; i < workers.size(); ++i) {
+            workers[i]->thread = std::thread([this, i] () -> void {
+                this->Run(i);
+            });
+        }
+    }
+}
+
+void WorkerThreadPool::Join() {
+    for (std::unique_ptr<Worker>& worker: workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+WorkerThreadPool::StrandKey WorkerThreadPool::NewStrand() {
+    return nextStrand++;
+}
+
+IPostable& WorkerThreadPool::Strand(StrandKey strand) {
+    return *strands[strand % strands.size()];
+}
+
+void WorkerThreadPool::Run(size_t idx) {
+    currentPool = this;
+    currentWorker = idx;
+
+    while (state == RUNNING) {
+        Job job;
+        if (GetJob(idx, job)) {
+            if (state == RUNNING) {
+                job.task();
+                job.Done();
+            } else {
+                job.Cancel();
+            }
+        } else {
+            Sleep();
+        }
+    }
+
+    currentPool = nullptr;
+}
+
+bool WorkerThreadPool::GetJob(size_t idx, Job& job) {
+    bool found = false;
+    {
+        Worker& worker = *workers[idx];
+        Lock lock(worker.queueMutex);
+        if (!worker.workQueue.empty()) {
+            job = std::move(worker.workQueue.front());
+            worker.workQueue.pop_front();
+            found = true;
+        }
+    }
+
+    // Nothing to do, try and steal from the back of someone else's queue...
+    for (size_t i = 1; !found && i < workers.size(); ++i) {
+        Worker& victim = *workers[(idx + i) % workers.size()];
+        Lock lock(victim.queueMutex);
+        if (!victim.workQueue.empty()) {
+            job = std::move(victim.workQueue.back());
+            victim.workQueue.pop_back();
+            found = true;
+        }
+    }
+
+    if (found) {
+        --queued;
+    }
+
+    return found;
+}
+
+void WorkerThreadPool::Push(Job&& job) {
+    size_t idx = 0;
+    if (currentPool == this) {
+        idx = currentWorker;
+    } else {
+        idx = nextWorker.fetch_add(1, std::memory_order_relaxed) % workers.size();
+    }
+    Worker& worker = *workers[idx];
+
+    /**
+     * Count the job before it is visible, so that a sleeping thread can never
+     * miss it.
+     */
+    ++queued;
+    {
+        Lock lock(worker.queueMutex);
+        worker.workQueue.push_back(std::move(job));
+    }
+
+    if (state == ABORTED) {
+        // Abort may have swept the queue before we were added.
+        Lock lock(worker.queueMutex);
+        queued -= worker.workQueue.size();
+        CancelJobs(worker.workQueue);
+    } else if (sleepers > 0) {
+        Lock lock(sleepMutex);
+        notification.notify_one();
+    }
+}
+
+void WorkerThreadPool::PushToStrand(Job&& job, StrandKey key) {
+    StrandQueue& strand = *strands[key % strands.size()];
+    bool schedule = false;
+    {
+        Lock lock(strand.queueMutex);
+        strand.workQueue.push_back(std::move(job));
+        if (!strand.scheduled) {
+            strand.scheduled = true;
+            schedule = true;
+        }
+    }
+
+    if (state == ABORTED) {
+        Lock lock(strand.queueMutex);
+        CancelJobs(strand.workQueue);
+    } else if (schedule) {
+        Push({[this, &strand] () -> void { this->RunStrand(strand); },
+              nullptr});
+    }
+}
+
+void WorkerThreadPool::RunStrand(StrandQueue& strand) {
+    Job job;
+    bool haveJob = false;
+    {
+        Lock lock(strand.queueMutex);
+        if (!strand.workQueue.empty()) {
+            job = std::move(strand.workQueue.front());
+            strand.workQueue.pop_front();
+            haveJob = true;
+        }
+    }
+
+    if (haveJob) {
+        if (state != ABORTED) {
+            job.task();
+            job.Done();
+        } else {
+            job.Cancel();
+        }
+    }
+
+    /**
+     * Only one job is run at a time, and the strand is then re-queued, so that
+     * a busy strand can not starve the rest of the pool.
+     */
+    bool reschedule = false;
+    {
+        Lock lock(strand.queueMutex);
+        if (strand.workQueue.empty()) {
+            strand.scheduled = false;
+        } else {
+            reschedule = true;
+        }
+    }
+
+    if (reschedule) {
+        Push({[this, &strand] () -> void { this->RunStrand(strand); },
+              nullptr});
+    }
+}
+
+void WorkerThreadPool::Sleep() {
+    Lock lock(sleepMutex);
+    ++sleepers;
+    while (state == RUNNING && queued == 0) {
+        notification.wait(lock);
+    }
+    --sleepers;
+}
+
+void WorkerThreadPool::CancelJobs(std::deque<Job>& queue) {
+    for (Job& job: queue) {
+        job.Cancel();
+    }
+    queue.clear();
+}
+
+void WorkerThreadPool::Job::Done() {
+    if (result) {
+        result->set_value(true);
+    }
+}
+
+void WorkerThreadPool::Job::Cancel() {
+    if (result) {
+        result->set_value(false);
+    }
+}
+
+WorkerThreadPool::StrandQueue::StrandQueue(
+    WorkerThreadPool& _pool,
+    StrandKey _key)
+        : scheduled(false),
+          pool(_pool),
+          key(_key)
+{
+}
+
+void WorkerThreadPool::StrandQueue::PostTask(const Task& t) {
+    pool.PostTask(t, key);
+}
@@ -0,0 +1,343 @@
+/*
+ * WorkerThreadPool.h
+ *
+ *  Created on: 16th October 2026
+ */
+
+#ifndef DEV_TOOLS_CPP_LIBRARIES_LIBTHREADCOMMS_WORKERTHREADPOOL_H_
+#define DEV_TOOLS_CPP_LIBRARIES_LIBTHREADCOMMS_WORKERTHREADPOOL_H_
+
+#include "IPostable.h"
+#include <thread>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <future>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <PipePublisher.h>
+
+/**
+ * A pool of worker threads, sharing the IPostable contract of WorkerThread.
+ *
+ * Each thread owns a deque of tasks. Tasks posted from a pool thread are
+ * queued on that thread's deque, tasks posted from outside the pool are
+ * distributed round-robin. A thread which exhausts its own deque will steal
+ * work from the back of its neighbours' deques.
+ *
+ * There are no ordering guarantees between tasks posted with PostTask. Tasks
+ * which must be run in order should be posted to a strand: tasks posted with
+ * the same strand key are run in the order they were posted, and never
+ * concurrently.
+ */
+class WorkerThreadPool: public IPostable {
+public:
+    typedef size_t StrandKey;
+
+    /**
+     * Create a new (stopped) pool
+     *
+     * @param threads   Number of worker threads
+     * @param strands   Number of distinct strands. Strand keys are mapped onto
+     *                  strands modulo this value, keys which share a strand
+     *                  are serialised with each other.
+     */
+    WorkerThreadPool(
+        size_t threads = std::thread::hardware_concurrency(),
+        size_t strands = 1024);
+
+    virtual ~WorkerThreadPool();
+
+    /**
+     * Post a task to the pool.
+     *
+     * @param t  The task to be run.
+     */
+    void PostTask(const Task& t);
+
+    /**
+     * Post a task to the specified strand. The task will not be run until all
+     * previous tasks posted to the strand have completed.
+     *
+     * @param t       The task to be run.
+     * @param strand  The strand to serialise the task on
+     */
+    void PostTask(const Task& t, StrandKey strand);
+
+    /**
+     * Post a task, and wait for the result
+     *
+     * @param t  The task to be run.
+     *
+     * @returns true if the task was executed, or false if it was aborted
+     */
+    bool DoTask(const Task& t);
+
+    /**
+     * Post a task to a strand, and wait for the result
+     *
+     * @param t       The task to be run.
+     * @param strand  The strand to serialise the task on
+     *
+     * @returns true if the task was executed, or false if it was aborted
+     */
+    bool DoTask(const Task& t, StrandKey strand);
+
+    /**
+     * Stop the pool, may be called by any thread.
+     *
+     * Tasks currently being executed will be completed, any other queued tasks
+     * are cancelled.
+     */
+    void Abort();
+
+    /**
+     * Start the worker threads
+     */
+    void Start();
+
+    /**
+     * Join the worker threads
+     */
+    void Join();
+
+    /**
+     * Number of worker threads in the pool.
+     */
+    size_t Size() const {
+        return workers.size();
+    }
+
+    /**
+     * Allocate a strand key. Keys are allocated round-robin across the
+     * available strands.
+     */
+    StrandKey NewStrand();
+
+    /**
+     * Get an IPostable which posts tasks to the specified strand.
+     *
+     * The returned reference is valid for the lifetime of the pool.
+     */
+    IPostable& Strand(StrandKey strand);
+
+    /**
+     * Process updates from the specified publisher on the pool, calling the
+     * task for each update.
+     *
+     * Each call allocates a new strand for the client, so updates from a single
+     * subscriber are handled in order, whilst separate subscribers may be
+     * handled concurrently.
+     *
+     * See WorkerThread::ConsumeUpdates
+     */
+    template<class Msg>
+    void ConsumeUpdates(
+        PipePublisher<Msg>& publisher,
+        const std::function<void (Msg& m)>& task,
+        size_t maxQueueSize = 1000000,
+        size_t maxSlizeSize = 100);
+
+    /**
+     * Variant of ConsumeUpdates which consumes from a custom client type.
+     *
+     * See WorkerThread::ConsumeUpdates
+     */
+    template<class Client, class Msg, class... Args>
+    void ConsumeUpdates(
+        PipePublisher<Msg>& publisher,
+        const std::function<void (Msg& m)>& task,
+        size_t maxSlizeSize,
+        Args... args);
+
+private:
+    enum STATE {NOT_STARTED, RUNNING, ABORTED};
+
+    struct Job {
+        Task task;
+
+        /**
+         * Only allocated for DoTask, shared so that the waiting thread may
+         * safely destroy its future whilst we are still notifying it.
+         */
+        std::shared_ptr<std::promise<bool>> result;
+
+        /**
+         * The job has been executed, notify anyone waiting on us.
+         */
+        void Done();
+
+        /**
+         * The job will never be executed.
+         *
+         * Notify anyone waiting on us that they will not get a result.
+         */
+        void Cancel();
+    };
+
+    typedef std::unique_lock<std::mutex> Lock;
+
+    /**
+     * Cancel all of the jobs on the queue. MUST be called under lock.
+     */
+    static void CancelJobs(std::deque<Job>& queue);
+
+    /**
+     * A queue of tasks owned by a single worker thread.
+     */
+    struct Worker {
+        std::mutex       queueMutex;
+        std::deque<Job>  workQueue;
+        std::thread      thread;
+    };
+
+    /**
+     * Tasks which must be executed sequentially. At most one task from the
+     * strand is queued on the pool at any time.
+     */
+    class StrandQueue: public IPostable {
+    public:
+        StrandQueue(WorkerThreadPool& pool, StrandKey key);
+
+        void PostTask(const Task& t);
+
+        std::mutex       queueMutex;
+        std::deque<Job>  workQueue;
+        bool             scheduled;
+    private:
+        WorkerThreadPool& pool;
+        StrandKey         key;
+    };
+
+    /**
+     * The thread's main loop
+     *
+     * @param idx  The index of the thread's worker
+     */
+    void Run(size_t idx);
+
+    /**
+     * Take the next job, from our own queue if possible, otherwise stealing
+     * from one of the other workers.
+     *
+     * @param idx  The index of the thread's worker
+     * @param job  Populated with the job
+     *
+     * @returns true if a job was found
+     */
+    bool GetJob(size_t idx, Job& job);
+
+    /**
+     * Queue the job on a worker, and wake a sleeping thread if required.
+     */
+    void Push(Job&& job);
+
+    /**
+     * Queue the job on the strand, scheduling the strand if it isn't already
+     */
+    void PushToStrand(Job&& job, StrandKey strand);
+
+    /**
+     * Execute the next job on the strand, and re-schedule it if there is more
+     * work to do.
+     */
+    void RunStrand(StrandQueue& strand);
+
+    /**
+     * Nothing left to do, wait for more work.
+     */
+    void Sleep();
+
+    /**
+     * Callback from ConsumeUpdates
+     */
+    template<class Client, class Msg>
+    void HandleUpdates(
+        Client& client,
+        const std::function<void (Msg& m)>& task,
+        size_t maxSlizeSize,
+        IPostable& strand);
+
+    std::atomic<STATE>                         state;
+    std::vector<std::unique_ptr<Worker>>       workers;
+    std::vector<std::unique_ptr<StrandQueue>>  strands;
+
+    std::atomic<size_t>                        nextWorker;
+    std::atomic<size_t>                        nextStrand;
+
+    /**
+     * Number of jobs on the worker queues (not yet taken by a thread)
+     */
+    std::atomic<size_t>                        queued;
+
+    std::mutex                                 sleepMutex;
+    std::condition_variable                    notification;
+    std::atomic<size_t>                        sleepers;
+
+    std::mutex                                 clientsMutex;
+    std::vector<std::shared_ptr<void>>         clients;
+};
+
+template<class Msg>
+inline void WorkerThreadPool::ConsumeUpdates(
+    PipePublisher<Msg>& publisher,
+    const std::function<void (Msg& m)>& task,
+    size_t maxQueueSize,
+    size_t maxSlizeSize)
+{
+    ConsumeUpdates<PipeSubscriber<Msg>>(
+        publisher, task, maxSlizeSize, maxQueueSize);
+}
+
+template<class Client, class Msg, class... Args>
+inline void WorkerThreadPool::ConsumeUpdates(
+    PipePublisher<Msg>& publisher,
+    const std::function<void (Msg& m)>& task,
+    size_t maxSlizeSize,
+    Args... args)
+{
+    const StrandKey key = NewStrand();
+    IPostable& strand = Strand(key);
+
+    /**
+     * Initialize the client on the strand, so that no update can be handled
+     * before we have finished...
+     */
+    auto initializer = [&publisher, task, maxSlizeSize, args..., &strand, this] () -> void {
+        std::shared_ptr<Client> client =
+                publisher.template NewClient<Client>(args...);
+
+        {
+            Lock lock(clientsMutex);
+            clients.push_back(client);
+        }
+
+        HandleUpdates<Client,Msg>(*client,task,maxSlizeSize,strand);
+    };
+
+    this->DoTask(initializer, key);
+}
+
+template<class Client, class Msg>
+inline void WorkerThreadPool::HandleUpdates(
+    Client& client,
+    const std::function<void(Msg& m)>& task,
+    size_t maxSlizeSize,
+    IPostable& strand)
+{
+    Msg m;
+    size_t count = 0;
+    while (count < maxSlizeSize && client.GetNextMessage(m)) {
+        task(m);
+        ++count;
+    }
+
+    auto callback =  [this, &clientRef = client, maxSlizeSize, task, &strand] () -> void {
+        this->HandleUpdates<Client,Msg>(clientRef,task,maxSlizeSize,strand);
+    };
+
+    client.OnNextMessage(callback,&strand);
+}
+
+#endif /* DEV_TOOLS_CPP_LIBRARIES_LIBTHREADCOMMS_WORKERTHREADPOOL_H_ */
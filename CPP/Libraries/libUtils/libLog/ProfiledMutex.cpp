@@ -0,0 +1,136 @@
+/*
+ * ProfiledMutex.cpp
+ *
+ *  Created on: 16th October 2026
+ */
+
+#include "ProfiledMutex.h"
+#include "env.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+
+namespace {
+    void ReportToStderr() {
+        LockProfile::Report(std::cerr);
+    }
+
+    /**
+     * Every profile, by name. Deliberately leaked: locks may be used (and
+     * so profiled) during static destruction.
+     */
+    struct Registry {
+        Registry() : reportAtExit(false) {
+            if (ENV::IsSet("DEV_TOOLS_LOCK_REPORT")) {
+                RegisterReport();
+            }
+        }
+
+        void RegisterReport() {
+            if (!reportAtExit) {
+                reportAtExit = true;
+                atexit(ReportToStderr);
+            }
+        }
+
+        std::mutex                                           mutex;
+        std::map<std::string, std::unique_ptr<LockProfile>>  profiles;
+        bool                                                 reportAtExit;
+    };
+
+    Registry& TheRegistry() {
+        static Registry* registry = new Registry;
+        return *registry;
+    }
+}
+
+LockProfile::LockProfile(const std::string& _name)
+    : name(_name),
+      acquisitions(0),
+      contended(0),
+      waitNs(0),
+      maxHoldNs(0)
+{
+}
+
+LockProfile& LockProfile::Get(const std::string& name) {
+    Registry& registry = TheRegistry();
+    std::unique_lock<std::mutex> lock(registry.mutex);
+
+    std::unique_ptr<LockProfile>& profile = registry.profiles[name];
+    if (!profile) {
+        profile.reset(new LockProfile(name));
+    }
+
+    return *profile;
+}
+
+bool LockProfile::Enabled() {
+#ifdef DEV_TOOLS_PROFILE_LOCKS
+    return true;
+#else
+    return false;
+#endif
+}
+
+LockProfile::Snapshot LockProfile::Snap() const {
+    Snapshot snap;
+    snap.name = name;
+    snap.acquisitions = acquisitions.load(std::memory_order_relaxed);
+    snap.contended = contended.load(std::memory_order_relaxed);
+    snap.waitNs = waitNs.load(std::memory_order_relaxed);
+    snap.maxHoldNs = maxHoldNs.load(std::memory_order_relaxed);
+
+    return snap;
+}
+
+std::vector<LockProfile::Snapshot> LockProfile::Snapshots() {
+    Registry& registry = TheRegistry();
+    std::unique_lock<std::mutex> lock(registry.mutex);
+
+    std::vector<Snapshot> snaps;
+    snaps.reserve(registry.profiles.size());
+
+    for (auto& profile: registry.profiles) {
+        snaps.push_back(profile.second->Snap());
+    }
+
+    return snaps;
+}
+
+void LockProfile::Report(std::ostream& os) {
+    std::vector<Snapshot> snaps = Snapshots();
+    std::sort(snaps.begin(), snaps.end(),
+        [] (const Snapshot& lhs, const Snapshot& rhs) -> bool {
+            return lhs.waitNs > rhs.waitNs;
+        });
+
+    os << "Lock contention report";
+    if (!Enabled()) {
+        os << " (lock profiling is disabled, build with PROFILE_LOCKS=YES)";
+    }
+    os << std::endl;
+
+    os << std::left << std::setw(36) << "Lock"
+       << std::right << std::setw(14) << "Acquired"
+       << std::setw(12) << "Contended"
+       << std::setw(14) << "Wait (us)"
+       << std::setw(16) << "Max Hold (us)" << std::endl;
+
+    for (const Snapshot& snap: snaps) {
+        os << std::left << std::setw(36) << snap.name
+           << std::right << std::setw(14) << snap.acquisitions
+           << std::setw(12) << snap.contended
+           << std::setw(14) << snap.waitNs / 1000
+           << std::setw(16) << snap.maxHoldNs / 1000 << std::endl;
+    }
+}
+
+void LockProfile::ReportAtExit() {
+    Registry& registry = TheRegistry();
+    std::unique_lock<std::mutex> lock(registry.mutex);
+    registry.RegisterReport();
+}
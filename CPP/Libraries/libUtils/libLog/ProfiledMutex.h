@@ -0,0 +1,205 @@
+/*
+ * Mutex wrapper which records contention on the lock
+ *
+ *  Created on: 16th October 2026
+ */
+
+#ifndef DEV_TOOLS_CPP_LIBRARIES_UTILS_LOG_PROFILED_MUTEX_H__
+#define DEV_TOOLS_CPP_LIBRARIES_UTILS_LOG_PROFILED_MUTEX_H__
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * Contention counters for a named lock. Every ProfiledMutex constructed with
+ * the same name shares a single profile (e.g the onNotifyMutex of every
+ * PipeSubscriber).
+ *
+ * Profiles are only populated when lock profiling is compiled in, see
+ * ProfiledMutex.
+ */
+class LockProfile {
+public:
+    struct Snapshot {
+        std::string  name;
+        uint64_t     acquisitions;  // Successful lock / try_lock calls
+        uint64_t     contended;     // Acquisitions which had to wait
+        uint64_t     waitNs;        // Total time spent waiting
+        uint64_t     maxHoldNs;     // Longest the lock has been held
+    };
+
+    /**
+     * The profile for the named lock, created on first use.
+     *
+     * Profiles are never destroyed, so locks may still be used during static
+     * destruction.
+     */
+    static LockProfile& Get(const std::string& name);
+
+    /**
+     * True if the ProfiledMutex was built with profiling enabled
+     */
+    static bool Enabled();
+
+    /**
+     * Snapshot every profile. This may be called from any thread.
+     */
+    static std::vector<Snapshot> Snapshots();
+
+    /**
+     * Print a table of every profile, most time spent waiting first.
+     */
+    static void Report(std::ostream& os);
+
+    /**
+     * Print the report to stderr when the process exits. This is done
+     * automatically if DEV_TOOLS_LOCK_REPORT is set.
+     */
+    static void ReportAtExit();
+
+    /**
+     * Record an acquisition of the lock
+     */
+    void Acquired(bool contended, uint64_t waitNs) {
+        acquisitions.fetch_add(1, std::memory_order_relaxed);
+        if (contended) {
+            this->contended.fetch_add(1, std::memory_order_relaxed);
+            this->waitNs.fetch_add(waitNs, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Record the release of the lock, after it was held for holdNs
+     */
+    void Released(uint64_t holdNs) {
+        uint64_t longest = maxHoldNs.load(std::memory_order_relaxed);
+        while (holdNs > longest &&
+               !maxHoldNs.compare_exchange_weak(
+                   longest, holdNs, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    Snapshot Snap() const;
+
+    static uint64_t NowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+private:
+    LockProfile(const std::string& name);
+
+    const std::string      name;
+
+    /**
+     * Updated by every instance of the lock, so (unlike the single writer
+     * counters elsewhere) these need a locked add.
+     */
+    std::atomic<uint64_t>  acquisitions;
+    std::atomic<uint64_t>  contended;
+    std::atomic<uint64_t>  waitNs;
+    std::atomic<uint64_t>  maxHoldNs;
+};
+
+/**
+ * Drop-in replacement for Mutex (std::mutex, or std::recursive_mutex) which
+ * records each acquisition in the LockProfile for its name.
+ *
+ * An uncontended lock costs a try_lock, a clock read (for the hold time), and
+ * a couple of relaxed atomic adds. The wait is only timed if the try_lock
+ * fails.
+ *
+ * This is always available, to profile a specific lock. Locks across the
+ * code base use ProfiledMutex, which is only profiled when lock profiling is
+ * compiled in.
+ */
+template <class Mutex = std::mutex>
+class ProfilingMutex {
+public:
+    explicit ProfilingMutex(const char* name)
+        : profile(LockProfile::Get(name)),
+          depth(0),
+          lockedAt(0)
+    {
+    }
+
+    ProfilingMutex(const ProfilingMutex& rhs) = delete;
+    ProfilingMutex& operator=(const ProfilingMutex& rhs) = delete;
+
+    void lock() {
+        bool contended = false;
+        uint64_t waited = 0;
+
+        // Only pay for the clock when we actually have to wait.
+        if (!mutex.try_lock()) {
+            const uint64_t start = LockProfile::NowNs();
+            mutex.lock();
+            contended = true;
+            waited = LockProfile::NowNs() - start;
+        }
+
+        profile.Acquired(contended, waited);
+        OnLocked();
+    }
+
+    bool try_lock() {
+        const bool locked = mutex.try_lock();
+        if (locked) {
+            profile.Acquired(false, 0);
+            OnLocked();
+        }
+        return locked;
+    }
+
+    void unlock() {
+        // A recursive lock is held until the outermost unlock
+        if (--depth == 0) {
+            profile.Released(LockProfile::NowNs() - lockedAt);
+        }
+        mutex.unlock();
+    }
+
+private:
+    void OnLocked() {
+        if (depth++ == 0) {
+            lockedAt = LockProfile::NowNs();
+        }
+    }
+
+    Mutex         mutex;
+    LockProfile&  profile;
+
+    // Only accessed by the thread holding the lock
+    size_t        depth;
+    uint64_t      lockedAt;
+};
+
+/**
+ * Lock profiling is compiled in by defining DEV_TOOLS_PROFILE_LOCKS
+ * (PROFILE_LOCKS=YES), making ProfiledMutex a ProfilingMutex. Otherwise
+ * ProfiledMutex is simply the underlying Mutex. NOTE: The switch changes the
+ * layout of any class holding a ProfiledMutex, so it must be applied to the
+ * whole build.
+ */
+#ifdef DEV_TOOLS_PROFILE_LOCKS
+
+template <class Mutex = std::mutex>
+using ProfiledMutex = ProfilingMutex<Mutex>;
+
+#else
+
+template <class Mutex = std::mutex>
+class ProfiledMutex: public Mutex {
+public:
+    explicit ProfiledMutex(const char* /* name */) { }
+};
+
+#endif
+
+#endif
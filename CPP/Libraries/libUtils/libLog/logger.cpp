@@ -77,7 +77,9 @@ LogDevice& LogFactory::CLOG() {
  * Logger Implementation
  */
 
-Logger::Logger() {
+Logger::Logger()
+    : loggingMutex("Logger::loggingMutex")
+{
     logLevelNames.resize(__NUM_LOG_LEVELS);
 
     logLevelNames[LOG_DEFAULT] = "STDOUT";
@@ -104,12 +106,12 @@ Logger::Logger() {
 }
 
 void Logger::RegisterLog(LogDevice& log) {
-    std::unique_lock<std::recursive_mutex> lock(loggingMutex);
+    std::unique_lock<ProfiledMutex<std::recursive_mutex>> lock(loggingMutex);
     devices.insert(log);
 }
 
 void Logger::RemoveLog(LogDevice& log) {
-    std::unique_lock<std::recursive_mutex> lock(loggingMutex);
+    std::unique_lock<ProfiledMutex<std::recursive_mutex>> lock(loggingMutex);
     devices.erase(log);
 }
 
@@ -118,7 +120,7 @@ void Logger::LogMessage( const string& message,
                          LOG_LEVEL level,
                          const string& context) {
     // Only one thread may log at a time
-    std::unique_lock<std::recursive_mutex> lock(loggingMutex);
+    std::unique_lock<ProfiledMutex<std::recursive_mutex>> lock(loggingMutex);
     for(const LogDeviceKey& device: devices) {
         device.Log(message, context, Time(), level );
     }
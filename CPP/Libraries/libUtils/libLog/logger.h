@@ -2,6 +2,7 @@
 #define __LOGGER_H__
 
 #include "binaryWriter.h"
+#include "ProfiledMutex.h"
 #include <set>
 #include <sstream>
 #include <vector>
@@ -176,7 +177,7 @@ private:
     bool enabled[__NUM_LOG_LEVELS];
     set<LogDeviceKey,LogDeviceKey::Less> devices;
     vector<string>           logLevelNames;
-    std::recursive_mutex     loggingMutex;
+    ProfiledMutex<std::recursive_mutex> loggingMutex;
 };
 
 
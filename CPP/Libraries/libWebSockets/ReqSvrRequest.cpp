@@ -34,7 +34,11 @@ ReqSvrRequest::~ReqSvrRequest() {
 
 const ReplyMessage& ReqSvrRequest::WaitForMessage() {
     statusFuture.wait();
-    const auto& response = GetMessage();
+    CheckReply(GetMessage());
+    return GetMessage();
+}
+
+void ReqSvrRequest::CheckReply(const ReplyMessage& response) {
     switch(response.state_)
     {
     case ReplyMessage::COMPLETE:
@@ -54,16 +58,23 @@ const ReplyMessage& ReqSvrRequest::WaitForMessage() {
     case ReplyMessage::PENDING:
         LOG_FROM(
             LOG_ERROR,
-            "ReqSvrRequest::WaitForMessage",
+            "ReqSvrRequest::CheckReply",
             "ReqSvrRequest completed with a non terminal state!");
         throw ServerDisconnectedError{ response.error };
         break;
     }
-    return GetMessage();
 }
 
-void ReqSvrRequest::OnComplete(ReplyMessage& reply) {
+void ReqSvrRequest::OnComplete(ReplyMessage& message) {
     statusFlag.set_value(1);
+
+    try {
+        CheckReply(message);
+        reply.SetValue(message);
+    } catch (...) {
+        reply.SetError(std::current_exception());
+    }
+
     ReleaseKeepAlive();
 }
 
@@ -2,6 +2,7 @@
 #define DEV_TOOLS_CPP_LIBRARIES_LIBWEBSOCKETS_REQSVRREQUEST_H_
 
 #include <future>
+#include <Future.h>
 #include "AsyncReqSvrRequest.h"
 
 class ReqSvrRequest: public AsyncReqSvrRequest {
@@ -32,6 +33,17 @@ public:
      */
     virtual const ReplyMessage& WaitForMessage();
 
+    /**
+     * Non-blocking alternative to WaitForMessage: attach a continuation to
+     * the returned future rather than parking the calling thread.
+     *
+     * The future is completed on the IO thread. In the event of a failure
+     * it fails with the ReqSvrRequestError WaitForMessage would have thrown.
+     */
+    Future<ReplyMessage> Reply() const {
+        return reply.GetFuture();
+    }
+
     struct ReqSvrRequestError {
         ReqSvrRequestError(std::string msg): msg_(std::move(msg)) {}
         std::string msg_;
@@ -50,9 +62,15 @@ protected:
 
     std::promise<int> statusFlag;
     std::future<int>  statusFuture;
+    Promise<ReplyMessage> reply;
     boost::asio::io_service& io_service;
 
 private:
+    /**
+     * Throw the appropriate ReqSvrRequestError if the request failed
+     */
+    static void CheckReply(const ReplyMessage& response);
+
     // Life cyle management - see comments in FactoryMethod and ReleaseKeepAlive
     // bodies.
     void ReleaseKeepAlive();
@@ -2,8 +2,8 @@
 #include <iostream>
 #include <logger.h>
 
-IOThread::IOThread()
-   : io_thread(&IOThread::IOLoop, this)
+IOThread::IOThread(const ThreadConfig& config)
+   : io_thread(&IOThread::IOLoop, this, config)
 {
 }
 
@@ -49,7 +49,9 @@ std::shared_ptr<ReqSvrRequest> IOThread::Request(
     return req;
 }
 
-void IOThread::IOLoop() {
+void IOThread::IOLoop(const ThreadConfig& config) {
+    config.Apply();
+
     boost::asio::io_service::work work(io_service);
     io_service.run();
 }
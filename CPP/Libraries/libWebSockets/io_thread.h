@@ -9,6 +9,7 @@
 #include <condition_variable>
 #include <mutex>
 #include <atomic>
+#include <ThreadConfig.h>
 
 #include "ReqSvrRequest.h"
 
@@ -20,8 +21,12 @@ class IOThread {
 public:
     /**
      * Start the new thread
+     *
+     * @param config  Placement of the new thread, unconstrained by default.
+     *                An application may read this from the environment, under
+     *                a prefix of its own, see ThreadConfig::FromEnv.
      */ 
-    IOThread();
+    IOThread(const ThreadConfig& config = ThreadConfig());
 
     virtual ~IOThread();
 
@@ -54,7 +59,7 @@ public:
      */
 
 private:
-    void IOLoop();
+    void IOLoop(const ThreadConfig& config);
 
     /**
      * Stop the thread. 
@@ -12,9 +12,14 @@ typedef client::connection_ptr connection_ptr;
 
 using namespace std;
 
-StreamClientThread::StreamClientThread(const std::string& url)
+StreamClientThread::StreamClientThread(
+    const std::string& url,
+    const ThreadConfig& config)
    : StreamClient(url),
-     io_thread([=] () -> void { this->Run(); })
+     io_thread([=] () -> void {
+         config.Apply();
+         this->Run();
+     })
 {
 }
 
@@ -6,6 +6,7 @@
 #include <websocketpp/client.hpp>
 #include <atomic>
 #include <thread>
+#include <ThreadConfig.h>
 
 /**
  * Subscribes to a websocket and triggers a call-back for each message.
@@ -73,7 +74,17 @@ private:
 
 class StreamClientThread: public StreamClient {
 public:
-    StreamClientThread(const std::string& url);
+    /**
+     * Connect to the url, running the event loop on a new thread.
+     *
+     * @param url     The websocket to subscribe to
+     * @param config  Placement of the new thread, unconstrained by default.
+     *                An application may read this from the environment, under
+     *                a prefix of its own, see ThreadConfig::FromEnv.
+     */
+    StreamClientThread(
+        const std::string& url,
+        const ThreadConfig& config = ThreadConfig());
 
     ~StreamClientThread();
 private:
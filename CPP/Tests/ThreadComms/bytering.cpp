@@ -0,0 +1,363 @@
+#include "tester.h"
+#include <ByteRingPublisher.h>
+#include <thread>
+#include <atomic>
+
+
+using namespace std;
+
+int PublishSingleConsumer(testLogger& log);
+int PublishDoubleConsumer(testLogger& log);
+int PublishNotify(testLogger& log);
+int PublishForEachData(testLogger& log);
+int RingWrap(testLogger& log);
+int GateOnSlowestClient(testLogger& log);
+int GateOnHeldView(testLogger& log);
+int SubscribeMidBatch(testLogger& log);
+int MessageTooLarge(testLogger& log);
+
+int main(int argc, const char *argv[])
+{
+    Test("Publish to a single consumer",PublishSingleConsumer).RunTest();
+    Test("Publish to two consumers",PublishDoubleConsumer).RunTest();
+    Test("On Next Message Callback",PublishNotify).RunTest();
+    Test("On data callback",PublishForEachData).RunTest();
+    Test("Ring wraps once data has been read",RingWrap).RunTest();
+    Test("Publisher waits for the slowest client",GateOnSlowestClient).RunTest();
+    Test("Publisher waits for a view to be released",GateOnHeldView).RunTest();
+    Test("Publisher waits for a client subscribed mid-batch",SubscribeMidBatch).RunTest();
+    Test("Message too large for the ring",MessageTooLarge).RunTest();
+
+    return 0;
+}
+
+bool MessagesMatch(testLogger& log,
+                   const std::vector<std::string>& sent,
+                   const std::vector<std::string>& got)
+{
+    bool match = true;
+    if (sent.size() != got.size()) {
+        log << "Invalid number of messages received: " << endl;
+        log << "Expected: " << sent.size() << endl;
+        log << "Got: " << got.size() << endl;
+        match = false;
+    }
+
+    for (size_t i = 0; match && i < sent.size(); ++i) {
+        if ( sent[i] != got[i] ) {
+            log << "Missmatch on message: " << i;
+            log.ReportStringDiff(sent[i],got[i]);
+            match = false;
+        }
+    }
+
+    return match;
+}
+
+std::vector<std::string> Drain(ByteRingSubscriber& client) {
+    std::vector<std::string> got;
+    const char* data = nullptr;
+    size_t size = 0;
+    while(client.GetNextMessage(data, size)) {
+        got.emplace_back(data, size);
+    }
+    return got;
+}
+
+/**
+ * Messages of varying length, including an empty one
+ */
+std::vector<std::string> MakeMessages(size_t count) {
+    std::vector<std::string> msgs;
+    for (size_t i = 0; i < count; ++i) {
+        msgs.push_back(std::string(i % 37, 'a' + (i % 26)) + std::to_string(i));
+    }
+    msgs.push_back("");
+    return msgs;
+}
+
+int PublishSingleConsumer(testLogger& log) {
+    ByteRingPublisher publisher(1024);
+    std::shared_ptr<ByteRingSubscriber> client(publisher.NewClient());
+    std::vector<std::string> toSend = {
+        "Message 1",
+        "Mesasge 2",
+        "{\"key\": \"Hello World!\"}"
+    };
+
+    for (auto& msg : toSend ) {
+        publisher.Publish(msg);
+    }
+
+    return MessagesMatch(log,toSend,Drain(*client)) ? 0 : 1;
+}
+
+int PublishDoubleConsumer(testLogger& log) {
+    ByteRingPublisher publisher(1024);
+    std::shared_ptr<ByteRingSubscriber> client(publisher.NewClient());
+    std::shared_ptr<ByteRingSubscriber> client2(publisher.NewClient());
+    std::vector<std::string> toSend = MakeMessages(10);
+
+    for (auto& msg : toSend ) {
+        publisher.Publish(msg);
+    }
+
+    if (!MessagesMatch(log,toSend,Drain(*client))) {
+        return 1;
+    }
+
+    if (!MessagesMatch(log,toSend,Drain(*client2))) {
+        return 1;
+    }
+
+    return 0;
+}
+
+int PublishNotify(testLogger& log) {
+    ByteRingPublisher publisher(1024);
+    std::shared_ptr<ByteRingSubscriber> client(publisher.NewClient());
+    std::vector<std::string> toSend = {
+        "Message 1",
+        "Mesasge 2",
+        "Hello World!"
+    };
+
+    std::vector<std::string> got;
+    auto f = [&] () -> void {
+        for (std::string& msg: Drain(*client)) {
+            got.push_back(msg);
+        }
+    };
+
+    client->OnNextMessage(f);
+
+    for (auto& msg : toSend ) {
+        publisher.Publish(msg);
+    }
+
+    std::vector<std::string> expected = {
+        "Message 1"
+    };
+
+    if (!MessagesMatch(log,expected,got)) {
+        return 1;
+    }
+
+    client->OnNextMessage(f);
+
+    if (!MessagesMatch(log,toSend,got)) {
+        return 1;
+    }
+
+    return 0;
+}
+
+int PublishForEachData(testLogger& log) {
+    ByteRingPublisher publisher(128);
+    std::shared_ptr<ByteRingSubscriber> client(publisher.NewClient());
+    std::vector<std::string> toSend = MakeMessages(100);
+
+    // Unread messages are forwarded first
+    publisher.Publish(toSend[0]);
+
+    std::vector<std::string> got;
+    client->OnNewMessage([&] (const char* data, size_t size) -> void {
+        got.emplace_back(data, size);
+    });
+
+    for (size_t i = 1; i < toSend.size(); ++i) {
+        publisher.Publish(toSend[i]);
+    }
+
+    return MessagesMatch(log,toSend,got) ? 0 : 1;
+}
+
+int RingWrap(testLogger& log) {
+    ByteRingPublisher publisher(128);
+    std::shared_ptr<ByteRingSubscriber> client(publisher.NewClient());
+    std::vector<std::string> toSend = MakeMessages(1000);
+
+    if (publisher.Size() != 128) {
+        log << "Invalid ring size: " << publisher.Size() << endl;
+        return 1;
+    }
+
+    // Records of every length, at every offset in the ring
+    std::vector<std::string> got;
+    for (auto& msg : toSend ) {
+        publisher.Publish(msg);
+        for (std::string& recvd: Drain(*client)) {
+            got.push_back(recvd);
+        }
+    }
+
+    return MessagesMatch(log,toSend,got) ? 0 : 1;
+}
+
+int GateOnSlowestClient(testLogger& log) {
+    ByteRingPublisher publisher(256);
+    std::shared_ptr<ByteRingSubscriber> fast(publisher.NewClient());
+    std::shared_ptr<ByteRingSubscriber> slow(publisher.NewClient());
+    std::vector<std::string> sent = MakeMessages(1000);
+
+    std::vector<std::string> gotFast;
+    std::vector<std::string> gotSlow;
+
+    std::thread fastReader([&] () -> void {
+        const char* data;
+        size_t size;
+        while (gotFast.size() < sent.size()) {
+            if (fast->GetNextMessage(data, size)) {
+                gotFast.emplace_back(data, size);
+            }
+        }
+    });
+
+    std::thread slowReader([&] () -> void {
+        const char* data;
+        size_t size;
+        while (gotSlow.size() < sent.size()) {
+            if (slow->GetNextMessage(data, size)) {
+                gotSlow.emplace_back(data, size);
+            }
+            std::this_thread::yield();
+        }
+    });
+
+    for (auto& msg: sent) {
+        publisher.Publish(msg);
+    }
+
+    fastReader.join();
+    slowReader.join();
+
+    if (!MessagesMatch(log,sent,gotFast)) {
+        return 1;
+    }
+
+    if (!MessagesMatch(log,sent,gotSlow)) {
+        return 1;
+    }
+
+    return 0;
+}
+
+int GateOnHeldView(testLogger& log) {
+    ByteRingPublisher publisher(64);
+    std::shared_ptr<ByteRingSubscriber> client(publisher.NewClient());
+    const std::string first(publisher.MaxMessageSize(), 'x');
+    const std::string second(publisher.MaxMessageSize(), 'y');
+
+    publisher.Publish(first);
+
+    const char* data = nullptr;
+    size_t size = 0;
+    client->GetNextMessage(data, size);
+
+    // Needs all of the ring, including the message we are looking at
+    std::atomic<bool> published(false);
+    std::thread publishThread([&] () -> void {
+        publisher.Publish(second);
+        publisher.Publish(second);
+        published = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    if (published || std::string(data, size) != first) {
+        log << "Publisher wrote over a view which was still held" << endl;
+        client->Abort();
+        publishThread.join();
+        return 1;
+    }
+
+    // Reading the next message releases the last one
+    std::vector<std::string> got;
+    while (got.size() < 2) {
+        if (client->GetNextMessage(data, size)) {
+            got.emplace_back(data, size);
+        }
+    }
+    publishThread.join();
+
+    std::vector<std::string> expected = { second, second };
+    return MessagesMatch(log,expected,got) ? 0 : 1;
+}
+
+int SubscribeMidBatch(testLogger& log) {
+    ByteRingPublisher publisher(256);
+    std::shared_ptr<ByteRingSubscriber> client(publisher.NewClient());
+    std::vector<std::string> sent = MakeMessages(50);
+
+    publisher.StartBatch();
+    std::shared_ptr<ByteRingSubscriber> late(publisher.NewClient());
+
+    std::vector<std::string> got;
+    std::vector<std::string> gotLate;
+
+    std::thread reader([&] () -> void {
+        const char* data;
+        size_t size;
+        while (got.size() < sent.size()) {
+            if (client->GetNextMessage(data, size)) {
+                got.emplace_back(data, size);
+            }
+        }
+    });
+
+    // Give the publisher every chance to wrap over the late client
+    std::thread lateReader([&] () -> void {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        const char* data;
+        size_t size;
+        while (gotLate.size() < sent.size()) {
+            if (late->GetNextMessage(data, size)) {
+                gotLate.emplace_back(data, size);
+            }
+        }
+    });
+
+    for (auto& msg: sent) {
+        publisher.Publish(msg);
+    }
+    publisher.EndBatch();
+
+    reader.join();
+    lateReader.join();
+
+    if (!MessagesMatch(log,sent,got)) {
+        return 1;
+    }
+
+    if (!MessagesMatch(log,sent,gotLate)) {
+        return 1;
+    }
+
+    return 0;
+}
+
+int MessageTooLarge(testLogger& log) {
+    ByteRingPublisher publisher(64);
+    std::shared_ptr<ByteRingSubscriber> client(publisher.NewClient());
+
+    bool thrown = false;
+    try {
+        publisher.Publish(std::string(publisher.MaxMessageSize() + 1, 'x'));
+    } catch (ByteRingPublisher::MessageTooLargeException& e) {
+        log << "Rejected: " << e.msg << endl;
+        thrown = true;
+    }
+
+    if (!thrown) {
+        log << "Oversized message was accepted" << endl;
+        return 1;
+    }
+
+    publisher.Publish(std::string(publisher.MaxMessageSize(), 'x'));
+    if (Drain(*client).size() != 1) {
+        log << "Largest message was not published" << endl;
+        return 1;
+    }
+
+    return 0;
+}
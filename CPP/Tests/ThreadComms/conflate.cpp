@@ -0,0 +1,364 @@
+#include "tester.h"
+#include <ConflatingSubscriber.h>
+#include <PipePublisher.h>
+#include <WorkerThread.h>
+#include <thread>
+
+
+using namespace std;
+
+int LatestValue(testLogger& log);
+int KeyOrder(testLogger& log);
+int RereadKey(testLogger& log);
+int PublishNotify(testLogger& log);
+int BatchNotify(testLogger& log);
+int TooManyKeys(testLogger& log);
+int WorkerConsume(testLogger& log);
+
+int main(int argc, const char *argv[])
+{
+    Test("Only the latest value is retained",LatestValue).RunTest();
+    Test("Keys are returned in the order they were updated",KeyOrder).RunTest();
+    Test("Key is re-published after being read",RereadKey).RunTest();
+    Test("On Next Message Callback",PublishNotify).RunTest();
+    Test("On Next Message Callback, batched",BatchNotify).RunTest();
+    Test("Publishing too many keys",TooManyKeys).RunTest();
+    Test("Consume updates on a worker thread",WorkerConsume).RunTest();
+
+    return 0;
+}
+
+struct Msg {
+    std::string   key;
+    std::string   message;
+};
+
+struct MsgKey {
+    const std::string& operator()(const Msg& msg) const {
+        return msg.key;
+    }
+};
+
+typedef ConflatingSubscriber<Msg, MsgKey> Client;
+
+bool MessagesMatch(testLogger& log,
+                   const std::vector<Msg>& sent,
+                   const std::vector<Msg>& got)
+{
+    bool match = true;
+    if (sent.size() != got.size()) {
+        log << "Invalid number of messages received: " << endl;
+        log << "Expected: " << sent.size() << endl;
+        log << "Got: " << got.size() << endl;
+        match = false;
+    }
+
+    if ( match ) {
+        for (size_t i = 0; match && i < sent.size(); ++i) {
+            const Msg& msg = sent[i];
+            const Msg& recvd = got[i];
+
+            if ( msg.key != recvd.key ) {
+                log << "Missmatch on key: " << i;
+                log.ReportStringDiff(msg.key,recvd.key);
+                match = false;
+            }
+
+            if ( msg.message != recvd.message ) {
+                log << "Missmatch on message: " << i;
+                log.ReportStringDiff(msg.message,recvd.message);
+                match = false;
+            }
+        }
+    }
+
+    return match;
+}
+
+std::vector<Msg> Drain(Client& client) {
+    std::vector<Msg> got;
+    Msg recvMsg;
+    while(client.GetNextMessage(recvMsg)) {
+        got.push_back(recvMsg);
+    }
+    return got;
+}
+
+int LatestValue(testLogger& log) {
+    PipePublisher<Msg> publisher;
+    std::shared_ptr<Client> client(publisher.NewClient<Client>(10));
+    std::vector<Msg> toSend = {
+        {"A", "Message 1"},
+        {"A", "Mesasge 2"},
+        {"A", "Hello World!"}
+    };
+
+    for (auto& msg : toSend ) {
+        publisher.Publish(msg);
+    }
+
+    std::vector<Msg> expected = {
+        {"A", "Hello World!"}
+    };
+
+    if (!MessagesMatch(log,expected,Drain(*client))) {
+        return 1;
+    }
+
+    if (client->ConflatedMessages() != 2) {
+        log << "Invalid conflated count: " << client->ConflatedMessages() << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int KeyOrder(testLogger& log) {
+    PipePublisher<Msg> publisher;
+    std::shared_ptr<Client> client(publisher.NewClient<Client>(10));
+    std::vector<Msg> toSend = {
+        {"B", "Message 1"},
+        {"A", "Mesasge 2"},
+        {"B", "Hello World!"},
+        {"C", "Message 3"}
+    };
+
+    for (auto& msg : toSend ) {
+        publisher.Publish(msg);
+    }
+
+    if (client->Pending() != 3) {
+        log << "Invalid number of pending keys: " << client->Pending() << endl;
+        return 1;
+    }
+
+    std::vector<Msg> expected = {
+        {"B", "Hello World!"},
+        {"A", "Mesasge 2"},
+        {"C", "Message 3"}
+    };
+
+    if (!MessagesMatch(log,expected,Drain(*client))) {
+        return 1;
+    }
+
+    return 0;
+}
+
+int RereadKey(testLogger& log) {
+    PipePublisher<Msg> publisher;
+    std::shared_ptr<Client> client(publisher.NewClient<Client>(10));
+
+    Msg msg1 = {"A", "Message 1"};
+    Msg msg2 = {"B", "Message 2"};
+    Msg msg3 = {"A", "Message 3"};
+
+    publisher.Publish(msg1);
+    publisher.Publish(msg2);
+
+    Msg recvMsg;
+    if (!client->GetNextMessage(recvMsg)) {
+        log << "Failed to read first message" << endl;
+        return 1;
+    }
+
+    publisher.Publish(msg3);
+
+    std::vector<Msg> expected = {
+        {"B", "Message 2"},
+        {"A", "Message 3"}
+    };
+
+    if (!MessagesMatch(log,expected,Drain(*client))) {
+        return 1;
+    }
+
+    if (client->ConflatedMessages() != 0) {
+        log << "Invalid conflated count: " << client->ConflatedMessages() << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int PublishNotify(testLogger& log) {
+    PipePublisher<Msg> publisher;
+    std::shared_ptr<Client> client(publisher.NewClient<Client>(10));
+    std::vector<Msg> toSend = {
+        {"A", "Message 1"},
+        {"B", "Mesasge 2"},
+        {"A", "Hello World!"}
+    };
+
+    std::vector<Msg> got;
+    auto f = [&] () -> void {
+        std::vector<Msg> latest = Drain(*client);
+        got.insert(got.end(), latest.begin(), latest.end());
+    };
+
+    client->OnNextMessage(f);
+
+    for (auto& msg : toSend ) {
+        publisher.Publish(msg);
+    }
+
+    std::vector<Msg> expected = {
+        {"A", "Message 1"}
+    };
+
+    if (!MessagesMatch(log,expected,got)) {
+        return 1;
+    }
+
+    client->OnNextMessage(f);
+
+    expected = {
+        {"A", "Message 1"},
+        {"B", "Mesasge 2"},
+        {"A", "Hello World!"}
+    };
+
+    if (!MessagesMatch(log,expected,got)) {
+        return 1;
+    }
+
+    return 0;
+}
+
+int BatchNotify(testLogger& log) {
+    PipePublisher<Msg> publisher;
+    std::shared_ptr<Client> client(publisher.NewClient<Client>(10));
+    std::vector<Msg> toSend = {
+        {"A", "Message 1"},
+        {"B", "Mesasge 2"},
+        {"A", "Hello World!"}
+    };
+
+    std::vector<Msg> got;
+    auto f = [&] () -> void {
+        got = Drain(*client);
+    };
+
+    client->OnNextMessage(f);
+
+    publisher.StartBatch();
+
+    for (auto& msg : toSend ) {
+        publisher.Publish(msg);
+    }
+
+    if (!MessagesMatch(log,{},got)) {
+        return 1;
+    }
+
+    publisher.EndBatch();
+
+    std::vector<Msg> expected = {
+        {"A", "Hello World!"},
+        {"B", "Mesasge 2"}
+    };
+
+    if (!MessagesMatch(log,expected,got)) {
+        return 1;
+    }
+
+    return 0;
+}
+
+int TooManyKeys(testLogger& log) {
+    PipePublisher<Msg> publisher;
+    std::shared_ptr<Client> client(publisher.NewClient<Client>(2));
+
+    Msg msg1 = {"A", "Message 1"};
+    Msg msg2 = {"B", "Message 2"};
+    Msg msg3 = {"C", "Message 3"};
+
+    publisher.Publish(msg1);
+    publisher.Publish(msg2);
+
+    bool thrown = false;
+    try {
+        publisher.Publish(msg3);
+    } catch (Client::TooManyKeysException& e) {
+        thrown = true;
+        if (e.msg.key != "C") {
+            log << "Invalid message on exception: " << e.msg.key << endl;
+            return 1;
+        }
+    }
+
+    if (!thrown) {
+        log << "Publishing a third key did not throw!" << endl;
+        return 1;
+    }
+
+    // Existing keys may still be updated
+    Msg msg4 = {"A", "Message 4"};
+    publisher.Publish(msg4);
+
+    std::vector<Msg> expected = {
+        {"A", "Message 4"},
+        {"B", "Message 2"}
+    };
+
+    if (!MessagesMatch(log,expected,Drain(*client))) {
+        return 1;
+    }
+
+    return 0;
+}
+
+int WorkerConsume(testLogger& log) {
+    PipePublisher<Msg> publisher;
+    WorkerThread worker;
+    std::vector<Msg> got;
+    std::mutex  comms_mutex;
+    std::condition_variable wait_for_complete;
+    bool done = false;
+
+    // Block the worker thread, so that updates back up behind it
+    std::mutex block_mutex;
+    std::unique_lock<std::mutex> block(block_mutex);
+
+    std::function<void (Msg&)> push = [&] (Msg& m) -> void {
+        std::unique_lock<std::mutex> blockLock(block_mutex);
+        got.push_back(m);
+        if (m.message == "Done") {
+            std::unique_lock<std::mutex> lock(comms_mutex);
+            done = true;
+            wait_for_complete.notify_all();
+        }
+    };
+
+    worker.Start();
+    worker.ConsumeUpdates<Client>(publisher,push,100,size_t(10));
+
+    for (size_t i = 0; i < 100; ++i) {
+        Msg msg = {"A", std::to_string(i)};
+        publisher.Publish(msg);
+    }
+    Msg last = {"A", "Done"};
+    publisher.Publish(last);
+
+    block.unlock();
+
+    std::unique_lock<std::mutex> lock(comms_mutex);
+    while (!done) {
+        wait_for_complete.wait(lock);
+    }
+
+    worker.Abort();
+    worker.Join();
+
+    if (got.size() > 2) {
+        log << "Updates were not conflated: " << got.size() << endl;
+        return 1;
+    }
+
+    if (got.back().message != "Done") {
+        log << "Latest value was not received: " << got.back().message << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,538 @@
+#include "tester.h"
+#include <WorkerThread.h>
+#include <Future.h>
+#include <PipePublisher.h>
+#include <util_time.h>
+#include <thread>
+#include <atomic>
+
+
+using namespace std;
+
+int SubmitValue(testLogger& log);
+int SubmitVoid(testLogger& log);
+int ThenOnTarget(testLogger& log);
+int ThenAlreadyReady(testLogger& log);
+int ThenUnwrapsFuture(testLogger& log);
+int TaskThrows(testLogger& log);
+int AbortedWorker(testLogger& log);
+int NotReady(testLogger& log);
+int AllOf(testLogger& log);
+int AnyOf(testLogger& log);
+int NextMessage(testLogger& log);
+int NextMessageEnded(testLogger& log);
+int NextMessageInline(testLogger& log);
+int PooledStates(testLogger& log);
+
+int main(int argc, const char *argv[])
+{
+    Test("Submit a task returning a value",SubmitValue).RunTest();
+    Test("Submit a task returning void",SubmitVoid).RunTest();
+    Test("Continuation posted to another thread",ThenOnTarget).RunTest();
+    Test("Continuation of a completed future",ThenAlreadyReady).RunTest();
+    Test("Continuation returning a future",ThenUnwrapsFuture).RunTest();
+    Test("Task throws",TaskThrows).RunTest();
+    Test("Task discarded by an aborted worker",AbortedWorker).RunTest();
+    Test("Value of an incomplete future",NotReady).RunTest();
+    Test("WhenAll",AllOf).RunTest();
+    Test("WhenAny",AnyOf).RunTest();
+    Test("Await the next message",NextMessage).RunTest();
+    Test("Await the next message of an ended subscription",NextMessageEnded).RunTest();
+    Test("Await the next message from an inline continuation",NextMessageInline).RunTest();
+    Test("Future states are pooled",PooledStates).RunTest();
+
+    return 0;
+}
+
+/**
+ * Wait (with a timeout) for the future to complete. Only the test
+ * thread ever waits...
+ */
+template <class T>
+bool WaitFor(const Future<T>& future) {
+    Time start;
+    while (!future.Ready() && Time().DiffUSecs(start) < 5000000) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return future.Ready();
+}
+
+int SubmitValue(testLogger& log) {
+    WorkerThread worker;
+    worker.Start();
+
+    Future<int> result = worker.Submit([] () -> int { return 42; });
+
+    if (!WaitFor(result)) {
+        log << "Future never completed" << endl;
+        return 1;
+    }
+
+    if (result.Failed() || result.Value() != 42) {
+        log << "Invalid result" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int SubmitVoid(testLogger& log) {
+    WorkerThread worker;
+    worker.Start();
+
+    std::thread::id ranOn;
+    Future<void> result = worker.Submit([&] () -> void {
+        ranOn = std::this_thread::get_id();
+    });
+
+    if (!WaitFor(result) || result.Failed()) {
+        log << "Future never completed" << endl;
+        return 1;
+    }
+
+    if (ranOn == std::this_thread::get_id()) {
+        log << "Task ran on the wrong thread" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int ThenOnTarget(testLogger& log) {
+    WorkerThread first;
+    WorkerThread second;
+    first.Start();
+    second.Start();
+
+    std::thread::id firstId;
+    std::thread::id secondId;
+    first.DoTask([&] () -> void { firstId = std::this_thread::get_id(); });
+    second.DoTask([&] () -> void { secondId = std::this_thread::get_id(); });
+
+    std::atomic<bool> stage1OnFirst(false);
+    std::atomic<bool> stage2OnSecond(false);
+
+    Future<std::string> result = first.Submit([&] () -> int {
+        stage1OnFirst = (std::this_thread::get_id() == firstId);
+        return 20;
+    }).Then([&] (const int& value) -> int {
+        stage2OnSecond = (std::this_thread::get_id() == secondId);
+        return value + 1;
+    }, &second).Then([] (const int& value) -> std::string {
+        return std::to_string(value * 2);
+    }, &first);
+
+    if (!WaitFor(result) || result.Failed()) {
+        log << "Future never completed" << endl;
+        return 1;
+    }
+
+    if (result.Value() != "42") {
+        log << "Invalid result: " << result.Value() << endl;
+        return 1;
+    }
+
+    if (!stage1OnFirst || !stage2OnSecond) {
+        log << "Stage ran on the wrong thread" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int ThenAlreadyReady(testLogger& log) {
+    WorkerThread worker;
+    worker.Start();
+
+    Future<int> result = worker.Submit([] () -> int { return 1; });
+    if (!WaitFor(result)) {
+        log << "Future never completed" << endl;
+        return 1;
+    }
+
+    // Completed, so with no target the continuation runs immediately
+    bool ran = false;
+    result.Then([&] (const int& ) -> void { ran = true; });
+
+    if (!ran) {
+        log << "Continuation did not run immediately" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int ThenUnwrapsFuture(testLogger& log) {
+    WorkerThread first;
+    WorkerThread second;
+    first.Start();
+    second.Start();
+
+    Future<int> result = first.Submit([] () -> int {
+        return 2;
+    }).Then([&second] (const int& value) -> Future<int> {
+        return second.Submit([value] () -> int { return value * 10; });
+    });
+
+    if (!WaitFor(result) || result.Failed() || result.Value() != 20) {
+        log << "Invalid chained result" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int TaskThrows(testLogger& log) {
+    WorkerThread worker;
+    worker.Start();
+
+    struct TestException {
+        int code;
+    };
+
+    std::atomic<bool> continued(false);
+    Future<int> result = worker.Submit([] () -> int {
+        throw TestException{7};
+    }).Then([&] (const int& value) -> int {
+        continued = true;
+        return value;
+    });
+
+    if (!WaitFor(result) || !result.Failed()) {
+        log << "Future did not fail" << endl;
+        return 1;
+    }
+
+    if (continued) {
+        log << "Continuation ran after a failure" << endl;
+        return 1;
+    }
+
+    try {
+        result.Value();
+        log << "Value did not throw" << endl;
+        return 1;
+    } catch (TestException& e) {
+        if (e.code != 7) {
+            log << "Invalid exception: " << e.code << endl;
+            return 1;
+        }
+    }
+
+    // The worker is unaffected
+    Future<int> next = worker.Submit([] () -> int { return 1; });
+    if (!WaitFor(next) || next.Failed()) {
+        log << "Worker did not survive the exception" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int AbortedWorker(testLogger& log) {
+    Future<int> queued;
+    {
+        WorkerThread worker;
+        // Never started: the task is cancelled when the worker is destroyed
+        queued = worker.Submit([] () -> int { return 1; });
+    }
+
+    if (!queued.Ready() || !queued.Failed()) {
+        log << "Queued task's future was not failed" << endl;
+        return 1;
+    }
+
+    WorkerThread aborted;
+    aborted.Start();
+    aborted.Abort();
+
+    Future<int> rejected = aborted.Submit([] () -> int { return 1; });
+    if (!rejected.Ready() || !rejected.Failed()) {
+        log << "Rejected task's future was not failed" << endl;
+        return 1;
+    }
+
+    try {
+        rejected.Value();
+        log << "Value did not throw" << endl;
+        return 1;
+    } catch (FutureException& e) {
+        log << "Failed with: " << e.msg << endl;
+    }
+
+    return 0;
+}
+
+int NotReady(testLogger& log) {
+    Promise<int> promise;
+    Future<int> future = promise.GetFuture();
+
+    try {
+        future.Value();
+        log << "Value of an incomplete future did not throw" << endl;
+        return 1;
+    } catch (FutureException& e) {
+        log << "Rejected: " << e.msg << endl;
+    }
+
+    promise.SetValue(3);
+
+    if (!future.Ready() || future.Value() != 3) {
+        log << "Promise did not complete the future" << endl;
+        return 1;
+    }
+
+    try {
+        promise.SetValue(4);
+        log << "Promise was fulfilled twice" << endl;
+        return 1;
+    } catch (FutureException& e) {
+        log << "Rejected: " << e.msg << endl;
+    }
+
+    return 0;
+}
+
+int AllOf(testLogger& log) {
+    const size_t numWorkers = 4;
+    std::vector<std::unique_ptr<WorkerThread>> workers;
+    std::vector<Future<size_t>> futures;
+
+    std::atomic<bool> release(false);
+    for (size_t i = 0; i < numWorkers; ++i) {
+        workers.emplace_back(new WorkerThread);
+        workers.back()->Start();
+        futures.push_back(workers.back()->Submit([i, &release] () -> size_t {
+            while (!release) {
+                std::this_thread::yield();
+            }
+            return i * i;
+        }));
+    }
+
+    Future<std::vector<Future<size_t>>> all = WhenAll(futures);
+
+    if (all.Ready()) {
+        log << "Completed before the tasks" << endl;
+        return 1;
+    }
+
+    release = true;
+
+    if (!WaitFor(all) || all.Failed()) {
+        log << "WhenAll never completed" << endl;
+        return 1;
+    }
+
+    const std::vector<Future<size_t>>& results = all.Value();
+    for (size_t i = 0; i < numWorkers; ++i) {
+        if (!results[i].Ready() || results[i].Value() != i * i) {
+            log << "Invalid result for task " << i << endl;
+            return 1;
+        }
+    }
+
+    Future<std::vector<Future<size_t>>> none = WhenAll(std::vector<Future<size_t>>());
+    if (!none.Ready() || none.Failed()) {
+        log << "WhenAll of nothing did not complete" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int AnyOf(testLogger& log) {
+    WorkerThread fast;
+    WorkerThread slow;
+    fast.Start();
+    slow.Start();
+
+    std::atomic<bool> release(false);
+    std::vector<Future<void>> futures;
+    futures.push_back(slow.Submit([&release] () -> void {
+        while (!release) {
+            std::this_thread::yield();
+        }
+    }));
+    futures.push_back(fast.Submit([] () -> void { }));
+
+    Future<size_t> first = WhenAny(futures);
+
+    if (!WaitFor(first) || first.Failed()) {
+        log << "WhenAny never completed" << endl;
+        release = true;
+        return 1;
+    }
+
+    release = true;
+
+    if (first.Value() != 1) {
+        log << "Invalid first future: " << first.Value() << endl;
+        return 1;
+    }
+
+    if (!WhenAny(std::vector<Future<void>>()).Failed()) {
+        log << "WhenAny of nothing did not fail" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int NextMessage(testLogger& log) {
+    const size_t toSend = 10000;
+    PipePublisher<size_t> publisher;
+    std::shared_ptr<PipeSubscriber<size_t>> client(publisher.NewClient(toSend));
+
+    WorkerThread worker;
+    worker.Start();
+
+    std::atomic<size_t> received(0);
+    std::atomic<bool> inOrder(true);
+    Promise<void> done;
+
+    /**
+     * An asynchronous loop: each message schedules the wait for the next.
+     */
+    std::function<void ()> next = [&] () -> void {
+        client->NextMessage(worker).Then([&] (const size_t& msg) -> void {
+            if (msg != received) {
+                inOrder = false;
+            }
+            ++received;
+
+            if (received == toSend) {
+                done.SetValue();
+            } else {
+                next();
+            }
+        }, &worker);
+    };
+    worker.PostTask(next);
+
+    for (size_t i = 0; i < toSend; ++i) {
+        publisher.Publish(i);
+    }
+
+    Future<void> result = done.GetFuture();
+    if (!WaitFor(result)) {
+        log << "Only received " << received << " messages" << endl;
+        return 1;
+    }
+
+    if (!inOrder) {
+        log << "Messages received out of order" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int NextMessageEnded(testLogger& log) {
+    PipePublisher<size_t> publisher;
+    std::shared_ptr<PipeSubscriber<size_t>> client(publisher.NewClient(1024));
+
+    WorkerThread worker;
+    worker.Start();
+
+    publisher.Publish(1);
+    publisher.Done();
+
+    // The final message can still be read
+    Future<size_t> last = client->NextMessage(worker);
+    if (!last.Ready() || last.Failed() || last.Value() != 1) {
+        log << "Final message was not read" << endl;
+        return 1;
+    }
+
+    Future<size_t> ended = client->NextMessage(worker);
+    if (!ended.Ready() || !ended.Failed()) {
+        log << "Waiting on an ended subscription did not fail" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int NextMessageInline(testLogger& log) {
+    const size_t toSend = 1000;
+    PipePublisher<size_t> publisher;
+    std::shared_ptr<PipeSubscriber<size_t>> client(
+        publisher.NewClient(toSend, PipeSubscriber<size_t>::DROP_OLDEST));
+
+    WorkerThread worker;
+    worker.Start();
+
+    std::atomic<size_t> received(0);
+    std::atomic<bool> inOrder(true);
+    Promise<void> done;
+
+    /**
+     * The continuation runs on the completing thread, so each wait is
+     * started from inside the read of the previous message.
+     */
+    std::function<void ()> next = [&] () -> void {
+        client->NextMessage(worker).Then([&] (const size_t& msg) -> void {
+            if (msg != received) {
+                inOrder = false;
+            }
+            ++received;
+
+            if (received == toSend) {
+                done.SetValue();
+            } else {
+                next();
+            }
+        });
+    };
+    worker.PostTask(next);
+
+    for (size_t i = 0; i < toSend; ++i) {
+        publisher.Publish(i);
+    }
+
+    Future<void> result = done.GetFuture();
+    if (!WaitFor(result)) {
+        log << "Only received " << received << " messages" << endl;
+        return 1;
+    }
+
+    if (!inOrder) {
+        log << "Messages received out of order" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int PooledStates(testLogger& log) {
+    {
+        Promise<size_t> warmUp;
+        warmUp.SetValue(1);
+    }
+
+    const size_t cached = BlockPool::CachedBlocks();
+    if (cached == 0) {
+        log << "Nothing was returned to the pool" << endl;
+        return 1;
+    }
+
+    {
+        Promise<size_t> promise;
+        if (BlockPool::CachedBlocks() >= cached) {
+            log << "State was not allocated from the pool" << endl;
+            return 1;
+        }
+
+        promise.GetFuture().Then([] (const size_t& ) -> void { });
+        promise.SetValue(2);
+    }
+
+    if (BlockPool::CachedBlocks() < cached) {
+        log << "Blocks were not returned to the pool: " << BlockPool::CachedBlocks()
+            << " / " << cached << endl;
+        return 1;
+    }
+
+    return 0;
+}
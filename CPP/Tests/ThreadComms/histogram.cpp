@@ -0,0 +1,176 @@
+#include "tester.h"
+#include <LatencyHistogram.h>
+#include <thread>
+#include <atomic>
+
+
+using namespace std;
+
+int BucketLayout(testLogger& log);
+int Percentiles(testLogger& log);
+int MergeAndReset(testLogger& log);
+int ConcurrentRead(testLogger& log);
+
+int main(int argc, const char *argv[])
+{
+    Test("Buckets cover the full range",BucketLayout).RunTest();
+    Test("Percentiles",Percentiles).RunTest();
+    Test("Merge and reset",MergeAndReset).RunTest();
+    Test("Read whilst recording",ConcurrentRead).RunTest();
+
+    return 0;
+}
+
+int BucketLayout(testLogger& log) {
+    const uint64_t values[] = {
+        0, 1, 31, 32, 33, 63, 64, 65, 1000, 123456789, (1ull << 40) + 12345,
+        ~0ull};
+
+    for (uint64_t value: values) {
+        const size_t index = LatencyHistogram::BucketIndex(value);
+        const uint64_t upper = LatencyHistogram::BucketUpperBound(index);
+        const uint64_t lower = index ? LatencyHistogram::BucketUpperBound(index - 1) + 1 : 0;
+
+        if (index >= LatencyHistogram::BUCKETS) {
+            log << "Bucket out of range for " << value << ": " << index << endl;
+            return 1;
+        }
+
+        if (value < lower || value > upper) {
+            log << "Value " << value << " not in bucket " << index
+                << " [" << lower << ", " << upper << "]" << endl;
+            return 1;
+        }
+
+        if (value >= 32 && (upper - lower) * 32 > value) {
+            log << "Bucket " << index << " is too wide for " << value << endl;
+            return 1;
+        }
+    }
+
+    if (LatencyHistogram::BucketIndex(~0ull) != LatencyHistogram::BUCKETS - 1) {
+        log << "Final bucket is not used for the largest value" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int Percentiles(testLogger& log) {
+    LatencyHistogram histogram;
+
+    if (histogram.Count() != 0 || histogram.Percentile(50) != 0) {
+        log << "Empty histogram reported data" << endl;
+        return 1;
+    }
+
+    for (uint64_t i = 1; i <= 10000; ++i) {
+        histogram.Record(i);
+    }
+
+    if (histogram.Count() != 10000 || histogram.Max() != 10000) {
+        log << "Invalid count / max: " << histogram.Count()
+            << " / " << histogram.Max() << endl;
+        return 1;
+    }
+
+    if (histogram.Mean() != 5000.5) {
+        log << "Invalid mean: " << histogram.Mean() << endl;
+        return 1;
+    }
+
+    struct Expected {
+        double   percentile;
+        uint64_t value;
+    };
+
+    const Expected expected[] = {
+        {50, 5000}, {90, 9000}, {99, 9900}, {99.9, 9990}, {100, 10000}};
+
+    for (const Expected& e: expected) {
+        const uint64_t got = histogram.Percentile(e.percentile);
+        log << "p" << e.percentile << ": " << got << endl;
+
+        // Never under-estimate, and over-estimate by at most one bucket
+        if (got < e.value || got > e.value + e.value / 32) {
+            log << "Invalid p" << e.percentile << ": " << got
+                << ", expected: " << e.value << endl;
+            return 1;
+        }
+    }
+
+    // Never report more than the largest value seen
+    LatencyHistogram single;
+    single.Record(1000);
+    if (single.Percentile(50) != 1000) {
+        log << "Percentile exceeds max: " << single.Percentile(50) << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int MergeAndReset(testLogger& log) {
+    LatencyHistogram fast;
+    LatencyHistogram slow;
+    for (size_t i = 0; i < 100; ++i) {
+        fast.Record(10);
+        slow.Record(1000000);
+    }
+
+    fast.Merge(slow);
+
+    if (fast.Count() != 200 || fast.Max() != 1000000) {
+        log << "Invalid merge: " << fast.Count() << " / " << fast.Max() << endl;
+        return 1;
+    }
+
+    if (fast.Percentile(50) != 10 || fast.Percentile(51) < 1000000) {
+        log << "Invalid merged percentiles: " << fast.Percentile(50)
+            << " / " << fast.Percentile(51) << endl;
+        return 1;
+    }
+
+    fast.Reset();
+    if (fast.Count() != 0 || fast.Max() != 0 || fast.Mean() != 0) {
+        log << "Reset did not discard samples" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int ConcurrentRead(testLogger& log) {
+    LatencyHistogram histogram;
+    const size_t toRecord = 1000000;
+    std::atomic<bool> done(false);
+
+    std::thread writer([&] () -> void {
+        for (size_t i = 0; i < toRecord; ++i) {
+            histogram.Record(i % 1000);
+        }
+        done = true;
+    });
+
+    uint64_t last = 0;
+    while (!done) {
+        const uint64_t count = histogram.Count();
+        if (count < last) {
+            log << "Count went backwards: " << last << " -> " << count << endl;
+            done = true;
+            writer.join();
+            return 1;
+        }
+        last = count;
+        histogram.Percentile(99);
+    }
+
+    writer.join();
+
+    if (histogram.Count() != toRecord) {
+        log << "Invalid final count: " << histogram.Count() << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,221 @@
+#include "tester.h"
+#include <PipeRecorder.h>
+#include <PipeReplayer.h>
+#include <util_time.h>
+#include <thread>
+#include <sstream>
+#include <unistd.h>
+
+
+using namespace std;
+
+int RecordReplay(testLogger& log);
+int MultipleSegments(testLogger& log);
+int OriginalPacing(testLogger& log);
+int WrongMessageType(testLogger& log);
+int ReplaceJournal(testLogger& log);
+
+int main(int argc, const char *argv[])
+{
+    Test("Record and replay a stream",RecordReplay).RunTest();
+    Test("Journal split across segments",MultipleSegments).RunTest();
+    Test("Replay at the original pace",OriginalPacing).RunTest();
+    Test("Replaying with the wrong message type",WrongMessageType).RunTest();
+    Test("New recording replaces the old one",ReplaceJournal).RunTest();
+
+    return 0;
+}
+
+struct Msg {
+    uint64_t seq;
+    double   value;
+    char     tag[12];
+};
+
+std::string JournalPath(const std::string& test) {
+    std::stringstream name;
+    name << "/tmp/dev_tools_journal_" << test << "_" << getpid();
+    return name.str();
+}
+
+void RemoveJournal(const std::string& path) {
+    for (size_t i = 0; unlink(PipeJournal::SegmentName(path, i).c_str()) == 0; ++i) {
+    }
+}
+
+Msg MakeMsg(uint64_t seq) {
+    Msg m = {seq, seq * 0.5, "message"};
+    return m;
+}
+
+/**
+ * Record toSend messages to the journal at path
+ */
+size_t Record(const std::string& path, size_t toSend, size_t segmentSize) {
+    PipePublisher<Msg> publisher;
+    auto recorder = publisher.NewClient<PipeRecorder<Msg>>(path, segmentSize);
+
+    for (size_t i = 0; i < toSend; ++i) {
+        publisher.Publish(MakeMsg(i));
+    }
+    publisher.Done();
+
+    return recorder->Recorded();
+}
+
+/**
+ * Replay the journal at path, and return everything that was published
+ */
+std::vector<Msg> Replay(const std::string& path, PipeReplayer<Msg>::PACING pacing) {
+    PipePublisher<Msg> publisher;
+    auto client = publisher.NewClient(1000000);
+
+    PipeReplayer<Msg> replayer(path);
+    replayer.Replay(publisher, pacing);
+
+    std::vector<Msg> got;
+    Msg msg;
+    while (client->GetNextMessage(msg)) {
+        got.push_back(msg);
+    }
+    return got;
+}
+
+bool CheckMessages(testLogger& log, const std::vector<Msg>& got, size_t expected) {
+    if (got.size() != expected) {
+        log << "Invalid number of messages replayed: " << got.size()
+            << ", expected: " << expected << endl;
+        return false;
+    }
+
+    for (size_t i = 0; i < got.size(); ++i) {
+        if (got[i].seq != i || got[i].value != i * 0.5 ||
+            std::string(got[i].tag) != "message")
+        {
+            log << "Missmatch on message: " << i << ", got: " << got[i].seq << endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int RecordReplay(testLogger& log) {
+    const std::string path = JournalPath("RecordReplay");
+    const size_t toSend = 10000;
+
+    if (Record(path, toSend, PipeJournal::DEFAULT_SEGMENT_SIZE) != toSend) {
+        log << "Not every message was recorded" << endl;
+        RemoveJournal(path);
+        return 1;
+    }
+
+    std::vector<Msg> got = Replay(path, PipeReplayer<Msg>::AS_FAST_AS_POSSIBLE);
+    RemoveJournal(path);
+
+    return CheckMessages(log, got, toSend) ? 0 : 1;
+}
+
+int MultipleSegments(testLogger& log) {
+    const std::string path = JournalPath("MultipleSegments");
+    const size_t toSend = 10000;
+
+    // Room for ~100 records per segment
+    Record(path, toSend, 4096);
+
+    if (access(PipeJournal::SegmentName(path, 50).c_str(), F_OK) != 0) {
+        log << "Journal was not split across segments" << endl;
+        RemoveJournal(path);
+        return 1;
+    }
+
+    std::vector<Msg> got = Replay(path, PipeReplayer<Msg>::AS_FAST_AS_POSSIBLE);
+    RemoveJournal(path);
+
+    return CheckMessages(log, got, toSend) ? 0 : 1;
+}
+
+int OriginalPacing(testLogger& log) {
+    const std::string path = JournalPath("OriginalPacing");
+    const size_t toSend = 5;
+    const long gapUs = 20000;
+
+    {
+        PipePublisher<Msg> publisher;
+        auto recorder = publisher.NewClient<PipeRecorder<Msg>>(path);
+
+        for (size_t i = 0; i < toSend; ++i) {
+            std::this_thread::sleep_for(std::chrono::microseconds(gapUs));
+            publisher.Publish(MakeMsg(i));
+        }
+    }
+
+    Time start;
+    std::vector<Msg> got = Replay(path, PipeReplayer<Msg>::ORIGINAL);
+    const long original = Time().DiffUSecs(start);
+
+    start.SetNow();
+    Replay(path, PipeReplayer<Msg>::AS_FAST_AS_POSSIBLE);
+    const long fast = Time().DiffUSecs(start);
+
+    RemoveJournal(path);
+
+    if (!CheckMessages(log, got, toSend)) {
+        return 1;
+    }
+
+    // The initial gap (before the first message) is not reproduced
+    if (original < static_cast<long>(toSend - 1) * gapUs) {
+        log << "Replay was too fast: " << original << "us" << endl;
+        return 1;
+    }
+
+    if (fast >= gapUs) {
+        log << "Un-paced replay was too slow: " << fast << "us" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int WrongMessageType(testLogger& log) {
+    const std::string path = JournalPath("WrongMessageType");
+    Record(path, 10, PipeJournal::DEFAULT_SEGMENT_SIZE);
+
+    bool thrown = false;
+    try {
+        PipeReplayer<uint64_t> replayer(path);
+    } catch (PipeJournal::JournalException& e) {
+        log << "Rejected: " << e.msg << endl;
+        thrown = true;
+    }
+
+    try {
+        PipeReplayer<Msg> replayer(JournalPath("NoSuchJournal"));
+        thrown = false;
+    } catch (PipeJournal::JournalException& e) {
+        log << "Rejected: " << e.msg << endl;
+    }
+
+    RemoveJournal(path);
+
+    if (!thrown) {
+        log << "Invalid journal was accepted" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int ReplaceJournal(testLogger& log) {
+    const std::string path = JournalPath("ReplaceJournal");
+
+    // A long recording, followed by a short one, to the same path
+    Record(path, 1000, 4096);
+    Record(path, 10, 4096);
+
+    std::vector<Msg> got = Replay(path, PipeReplayer<Msg>::AS_FAST_AS_POSSIBLE);
+    RemoveJournal(path);
+
+    return CheckMessages(log, got, 10) ? 0 : 1;
+}
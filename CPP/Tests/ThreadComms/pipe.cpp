@@ -1,7 +1,11 @@
 #include "tester.h"
 #include <PipePublisher.h>
 #include <thread>
+#include <atomic>
 #include <IPostable.h>
+#include <WorkerThread.h>
+#include <sys/epoll.h>
+#include <unistd.h>
 
 
 using namespace std;
@@ -18,6 +22,7 @@ int CustomBatchHandler(testLogger& log);
 int CustomBatchReset(testLogger& log);
 int CustomBatchAbort(testLogger& log);
 int CustomBatchDone(testLogger& log);
+int CustomBatchAbortEnd(testLogger& log);
 int InstallCustomHandler(testLogger& log);
 int PublishForEachDataUnread(testLogger& log);
 int Abort(testLogger& log);
@@ -25,6 +30,34 @@ int AbortNotify(testLogger& log);
 int AbortForEachData(testLogger& log);
 int AbortForEachDataUnread(testLogger& log);
 int AbortHandleDestruction(testLogger& log);
+int InstallWhilstPublishing(testLogger& log);
+int BulkRead(testLogger& log);
+int FullQueueThrow(testLogger& log);
+int FullQueueBlock(testLogger& log);
+int FullQueueBlockDropped(testLogger& log);
+int FullQueueBlockBatch(testLogger& log);
+int FullQueueDropNewest(testLogger& log);
+int FullQueueDropOldest(testLogger& log);
+int FullQueueDropOldestBatch(testLogger& log);
+int FullQueueDisconnect(testLogger& log);
+int WaitBlocking(testLogger& log);
+int WaitSpinThenPark(testLogger& log);
+int WaitBusyPoll(testLogger& log);
+int WaitEndOfSubscription(testLogger& log);
+int SubscriberStats(testLogger& log);
+int SubscriberStatsDisabled(testLogger& log);
+int CommittedRead(testLogger& log);
+int AutoBatchSize(testLogger& log);
+int AutoBatchDelay(testLogger& log);
+int AutoBatchBlock(testLogger& log);
+int FanOutOrder(testLogger& log);
+int FanOutReap(testLogger& log);
+int FanOutBatchReap(testLogger& log);
+int FanOutThrow(testLogger& log);
+int FanOutConsumers(testLogger& log);
+int ReadyFdEpoll(testLogger& log);
+int ReadyFdBatch(testLogger& log);
+int ReadyFdEnd(testLogger& log);
 //int AbortHandleDestoructionUnreadData(testLogger& log);
 
 
@@ -50,6 +83,35 @@ int main(int argc, const char *argv[])
     Test("Destruction of final handle results in abort",AbortHandleDestruction).RunTest();
     Test("Custom batch abort",CustomBatchAbort).RunTest();
     Test("Custom batch done",CustomBatchDone).RunTest();
+    Test("Aborted client still ends the batch",CustomBatchAbortEnd).RunTest();
+    Test("Install clients whilst publishing",InstallWhilstPublishing).RunTest();
+    Test("Read messages in bulk",BulkRead).RunTest();
+    Test("Full queue: throw",FullQueueThrow).RunTest();
+    Test("Full queue: block",FullQueueBlock).RunTest();
+    Test("Full queue: block, client dropped",FullQueueBlockDropped).RunTest();
+    Test("Full queue: block, client re-arms mid-batch",FullQueueBlockBatch).RunTest();
+    Test("Full queue: drop newest",FullQueueDropNewest).RunTest();
+    Test("Full queue: drop oldest",FullQueueDropOldest).RunTest();
+    Test("Full queue: drop oldest, batched",FullQueueDropOldestBatch).RunTest();
+    Test("Full queue: disconnect",FullQueueDisconnect).RunTest();
+    Test("Waiting for messages: blocking",WaitBlocking).RunTest();
+    Test("Waiting for messages: spin then park",WaitSpinThenPark).RunTest();
+    Test("Waiting for messages: busy poll",WaitBusyPoll).RunTest();
+    Test("Waiting for messages: end of subscription",WaitEndOfSubscription).RunTest();
+    Test("Subscription stats",SubscriberStats).RunTest();
+    Test("Subscription stats are disabled by default",SubscriberStatsDisabled).RunTest();
+    Test("Read messages from completed batches",CommittedRead).RunTest();
+    Test("Auto-batching: batch size",AutoBatchSize).RunTest();
+    Test("Auto-batching: batch delay",AutoBatchDelay).RunTest();
+    Test("Auto-batching: blocked by a full queue",AutoBatchBlock).RunTest();
+    Test("Fan-out: per client ordering",FanOutOrder).RunTest();
+    Test("Fan-out: dead clients are reaped",FanOutReap).RunTest();
+    Test("Fan-out: clients dropped mid-batch end it",FanOutBatchReap).RunTest();
+    Test("Fan-out: full queue exception",FanOutThrow).RunTest();
+    Test("Fan-out: consumer threads",FanOutConsumers).RunTest();
+    Test("Ready fd: epoll over several clients",ReadyFdEpoll).RunTest();
+    Test("Ready fd: batches are signalled once complete",ReadyFdBatch).RunTest();
+    Test("Ready fd: end of subscription",ReadyFdEnd).RunTest();
 
     return 0;
 }
@@ -730,6 +792,50 @@ int CustomBatchAbort(testLogger& log) {
     return 0;
 }
 
+int CustomBatchAbortEnd(testLogger& log) {
+    PipePublisher<Msg> publisher;
+
+    class Handler: public IPipeConsumer<Msg> {
+    public:
+        Handler() : startBatchCalls(0), endBatchCalls(0) { }
+        virtual void PushMessage(const Msg& m) { }
+
+        void StartBatch() {
+            startBatchCalls++;
+        }
+
+        void EndBatch() {
+            endBatchCalls++;
+        }
+
+        size_t startBatchCalls;
+        size_t endBatchCalls;
+    };
+
+    std::shared_ptr<Handler> client(new Handler);
+    publisher.InstallClient(client);
+
+    publisher.StartBatch();
+    publisher.Publish({"Message 1"});
+    client->Abort();
+    publisher.Publish({"Message 2"});
+    publisher.EndBatch();
+
+    if (client->startBatchCalls != 1 || client->endBatchCalls != 1) {
+        log << "Batch calls: " << client->startBatchCalls
+            << " / " << client->endBatchCalls << endl;
+        return 1;
+    }
+
+    publisher.Publish({"This should not be published"});
+    if (publisher.NumClients() != 0) {
+        log << "Aborted client was not released" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
 int CustomBatchDone(testLogger& log) {
     PipePublisher<Msg> publisher;
 
@@ -964,3 +1070,1205 @@ int AbortHandleDestruction(testLogger& log) {
 
     return 0;
 }
+
+int InstallWhilstPublishing(testLogger& log) {
+    PipePublisher<Msg> publisher;
+    const size_t toPublish = 10000;
+    const size_t numClients = 20;
+    std::vector<std::shared_ptr<PipeSubscriber<Msg>>> clients;
+    std::atomic<bool> installed(false);
+
+    auto install = [&] () -> void {
+        for (size_t i = 0; i < numClients; ++i) {
+            clients.push_back(publisher.NewClient(toPublish));
+
+            // Drop every other client, to exercise the reaper
+            std::shared_ptr<PipeSubscriber<Msg>> dropped(
+                publisher.NewClient(toPublish));
+            std::this_thread::yield();
+        }
+        installed = true;
+    };
+
+    std::thread installer(install);
+
+    size_t published = 0;
+    while (!installed && published < toPublish) {
+        publisher.Publish({std::to_string(published)});
+        ++published;
+    }
+    installer.join();
+
+    for (size_t i = 0; i < numClients; ++i) {
+        // Guarantee all clients have something to read...
+        publisher.Publish({std::to_string(published)});
+        ++published;
+    }
+
+    for (size_t i = 0; i < clients.size(); ++i) {
+        Msg msg;
+        std::vector<Msg> got;
+        while (clients[i]->GetNextMessage(msg)) {
+            got.push_back(msg);
+        }
+
+        if (got.empty()) {
+            log << "Client " << i << " received no messages" << endl;
+            return 1;
+        }
+
+        // Once subscribed, no messages may be missed
+        std::vector<Msg> expected;
+        size_t first = std::stoul(got[0].message);
+        for (size_t j = first; j < published; ++j) {
+            expected.push_back({std::to_string(j)});
+        }
+
+        if (!MessagesMatch(log,expected,got)) {
+            log << "Client " << i << " missed messages" << endl;
+            return 1;
+        }
+    }
+
+    if (publisher.NumClients() != numClients) {
+        log << "Dead clients were not reaped: " << publisher.NumClients() << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int BulkRead(testLogger& log) {
+    PipePublisher<Msg> publisher;
+    std::shared_ptr<PipeSubscriber<Msg>> client(publisher.NewClient(1024));
+    std::vector<Msg> toSend = {
+        {"Message 1"},
+        {"Mesasge 2"},
+        {"Hello World!"}
+    };
+
+    for (auto& msg : toSend ) {
+        publisher.Publish(msg);
+    }
+
+    Msg buf[2];
+    std::vector<Msg> got;
+
+    size_t count = client->GetNextMessages(buf,2);
+    if (count != 2) {
+        log << "Expected a full read, got: " << count << endl;
+        return 1;
+    }
+    got.insert(got.end(), buf, buf + count);
+
+    count = client->GetNextMessages(buf,2);
+    if (count != 1) {
+        log << "Expected a partial read, got: " << count << endl;
+        return 1;
+    }
+    got.insert(got.end(), buf, buf + count);
+
+    count = client->GetNextMessages(buf,2);
+    if (count != 0) {
+        log << "Expected an empty read, got: " << count << endl;
+        return 1;
+    }
+
+    if (!MessagesMatch(log,toSend,got)) {
+        return 1;
+    }
+
+    return 0;
+}
+
+std::vector<Msg> Drain(PipeSubscriber<Msg>& client) {
+    std::vector<Msg> got;
+    Msg recvMsg;
+    while(client.GetNextMessage(recvMsg)) {
+        got.push_back(recvMsg);
+    }
+    return got;
+}
+
+int FullQueueThrow(testLogger& log) {
+    PipePublisher<Msg> publisher;
+    std::shared_ptr<PipeSubscriber<Msg>> client(publisher.NewClient(2));
+
+    publisher.Publish({"Message 1"});
+    publisher.Publish({"Mesasge 2"});
+
+    bool thrown = false;
+    try {
+        publisher.Publish({"Hello World!"});
+    } catch (...) {
+        thrown = true;
+    }
+
+    if (!thrown) {
+        log << "Expected the default policy to throw!" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int FullQueueBlock(testLogger& log) {
+    PipePublisher<Msg> publisher;
+    std::shared_ptr<PipeSubscriber<Msg>> client(
+        publisher.NewClient(2, PipeSubscriber<Msg>::BLOCK));
+
+    std::vector<Msg> toSend;
+    for (size_t i = 0; i < 100; ++i) {
+        toSend.push_back({std::to_string(i)});
+    }
+
+    std::vector<Msg> got;
+    std::thread reader([&] () -> void {
+        // Make sure the publisher has to wait for us...
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+        Msg recvMsg;
+        while(got.size() < toSend.size()) {
+            if (client->GetNextMessage(recvMsg)) {
+                got.push_back(recvMsg);
+            }
+        }
+    });
+
+    for (auto& msg : toSend ) {
+        publisher.Publish(msg);
+    }
+
+    reader.join();
+
+    if (!MessagesMatch(log,toSend,got)) {
+        return 1;
+    }
+
+    if (client->BlockedMessages() == 0) {
+        log << "Publisher was never blocked!" << endl;
+        return 1;
+    }
+
+    if (client->DroppedMessages() != 0) {
+        log << "Messages were dropped: " << client->DroppedMessages() << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int FullQueueBlockDropped(testLogger& log) {
+    PipePublisher<Msg> publisher;
+    std::shared_ptr<PipeSubscriber<Msg>> client(
+        publisher.NewClient(2, PipeSubscriber<Msg>::BLOCK));
+    PipeSubscriber<Msg>* raw = client.get();
+
+    std::atomic<bool> published(false);
+    std::thread publishThread([&] () -> void {
+        for (size_t i = 0; i < 10; ++i) {
+            publisher.Publish({std::to_string(i)});
+        }
+        published = true;
+    });
+
+    while (client->BlockedMessages() == 0) {
+        std::this_thread::yield();
+    }
+
+    // The normal way to unsubscribe: the publisher holds the last references
+    client.reset();
+
+    for (size_t i = 0; i < 1000 && !published; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    if (!published) {
+        log << "Publisher still blocked on a dropped client" << endl;
+        raw->Abort();
+        publishThread.join();
+        return 1;
+    }
+
+    publishThread.join();
+
+    if (publisher.NumClients() != 0) {
+        log << "Dropped client was not released" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int FullQueueBlockBatch(testLogger& log) {
+    PipePublisher<Msg> publisher;
+    std::shared_ptr<PipeSubscriber<Msg>> client(
+        publisher.NewClient(2, PipeSubscriber<Msg>::BLOCK));
+
+    std::vector<Msg> toSend;
+    for (size_t i = 0; i < 100; ++i) {
+        toSend.push_back({std::to_string(i)});
+    }
+
+    /**
+     * The reader must be able to re-register for notifications whilst the
+     * publisher is blocked part way through the batch.
+     */
+    std::vector<Msg> got;
+    std::atomic<bool> ready(false);
+    std::thread reader([&] () -> void {
+        Msg recvMsg;
+        while(got.size() < toSend.size()) {
+            if (client->GetNextMessage(recvMsg)) {
+                got.push_back(recvMsg);
+            } else {
+                ready = false;
+                client->OnNextMessage([&] () -> void { ready = true; });
+                while (!ready) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    });
+
+    publisher.StartBatch();
+    for (auto& msg : toSend ) {
+        publisher.Publish(msg);
+    }
+    publisher.EndBatch();
+
+    reader.join();
+
+    if (!MessagesMatch(log,toSend,got)) {
+        return 1;
+    }
+
+    return 0;
+}
+
+int FullQueueDropNewest(testLogger& log) {
+    PipePublisher<Msg> publisher;
+    std::shared_ptr<PipeSubscriber<Msg>> client(
+        publisher.NewClient(2, PipeSubscriber<Msg>::DROP_NEWEST));
+
+    std::vector<Msg> toSend = {
+        {"Message 1"},
+        {"Mesasge 2"},
+        {"Hello World!"}
+    };
+
+    for (auto& msg : toSend ) {
+        publisher.Publish(msg);
+    }
+
+    std::vector<Msg> expected = {
+        {"Message 1"},
+        {"Mesasge 2"}
+    };
+
+    std::vector<Msg> got = Drain(*client);
+    if (!MessagesMatch(log,expected,got)) {
+        return 1;
+    }
+
+    if (client->DroppedMessages() != 1) {
+        log << "Invalid drop count: " << client->DroppedMessages() << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int FullQueueDropOldest(testLogger& log) {
+    PipePublisher<Msg> publisher;
+    std::shared_ptr<PipeSubscriber<Msg>> client(
+        publisher.NewClient(2, PipeSubscriber<Msg>::DROP_OLDEST));
+
+    std::vector<Msg> toSend = {
+        {"Message 1"},
+        {"Mesasge 2"},
+        {"Hello World!"}
+    };
+
+    for (auto& msg : toSend ) {
+        publisher.Publish(msg);
+    }
+
+    std::vector<Msg> expected = {
+        {"Mesasge 2"},
+        {"Hello World!"}
+    };
+
+    std::vector<Msg> got = Drain(*client);
+    if (!MessagesMatch(log,expected,got)) {
+        return 1;
+    }
+
+    if (client->DroppedMessages() != 1) {
+        log << "Invalid drop count: " << client->DroppedMessages() << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int FullQueueDropOldestBatch(testLogger& log) {
+    PipePublisher<Msg> publisher;
+    std::shared_ptr<PipeSubscriber<Msg>> client(
+        publisher.NewClient(2, PipeSubscriber<Msg>::DROP_OLDEST));
+
+    Msg got[10];
+
+    publisher.Publish({"0"});
+    publisher.StartBatch();
+    for (size_t i = 1; i <= 5; ++i) {
+        publisher.Publish({std::to_string(i)});
+    }
+
+    // The batch has pushed out the committed message, and its own start
+    if (client->CommittedMessages() != 0) {
+        log << "Invalid committed count: " << client->CommittedMessages() << endl;
+        return 1;
+    }
+
+    if (client->GetCommittedMessages(got, 10) != 0) {
+        log << "Read from an incomplete batch" << endl;
+        return 1;
+    }
+
+    publisher.EndBatch();
+
+    if (client->CommittedMessages() != 2) {
+        log << "Invalid committed count after the batch: "
+            << client->CommittedMessages() << endl;
+        return 1;
+    }
+
+    if (client->GetCommittedMessages(got, 10) != 2 ||
+        got[0].message != "4" ||
+        got[1].message != "5")
+    {
+        log << "Did not read the end of the batch" << endl;
+        return 1;
+    }
+
+    if (client->CommittedMessages() != 0) {
+        log << "Messages left after the read: "
+            << client->CommittedMessages() << endl;
+        return 1;
+    }
+
+    if (client->DroppedMessages() != 4) {
+        log << "Invalid drop count: " << client->DroppedMessages() << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int FullQueueDisconnect(testLogger& log) {
+    PipePublisher<Msg> publisher;
+    std::shared_ptr<PipeSubscriber<Msg>> client(
+        publisher.NewClient(2, PipeSubscriber<Msg>::DISCONNECT));
+
+    std::vector<Msg> toSend = {
+        {"Message 1"},
+        {"Mesasge 2"},
+        {"Hello World!"},
+        {"This should not be published"}
+    };
+
+    for (auto& msg : toSend ) {
+        publisher.Publish(msg);
+    }
+
+    if (!client->Disconnected()) {
+        log << "Client was not disconnected!" << endl;
+        return 1;
+    }
+
+    std::vector<Msg> expected = {
+        {"Message 1"},
+        {"Mesasge 2"}
+    };
+
+    std::vector<Msg> got = Drain(*client);
+    if (!MessagesMatch(log,expected,got)) {
+        return 1;
+    }
+
+    if (client->DroppedMessages() != 1) {
+        log << "Invalid drop count: " << client->DroppedMessages() << endl;
+        return 1;
+    }
+
+    if (publisher.NumClients() != 0) {
+        log << "Client was not released: " << publisher.NumClients() << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int WaitForMessages(testLogger& log, const WaitStrategy& strategy) {
+    PipePublisher<Msg> publisher;
+    std::shared_ptr<PipeSubscriber<Msg>> client(publisher.NewClient(1000));
+    const size_t toSend = 500;
+
+    std::vector<Msg> sent;
+    for (size_t i = 0; i < toSend; ++i) {
+        sent.push_back({std::to_string(i)});
+    }
+
+    std::vector<Msg> got;
+    std::thread reader([&] () -> void {
+        Msg m;
+        while (got.size() < toSend && client->WaitForMessage(m, strategy)) {
+            got.push_back(m);
+        }
+    });
+
+    for (size_t i = 0; i < toSend; ++i) {
+        publisher.Publish(sent[i]);
+        if (i % 50 == 0) {
+            // Give the reader a chance to park...
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+
+    reader.join();
+
+    if (!MessagesMatch(log,sent,got)) {
+        return 1;
+    }
+
+    return 0;
+}
+
+int WaitBlocking(testLogger& log) {
+    return WaitForMessages(log, WaitStrategy::Blocking());
+}
+
+int WaitSpinThenPark(testLogger& log) {
+    return WaitForMessages(log, WaitStrategy::SpinThenPark(1000));
+}
+
+int WaitBusyPoll(testLogger& log) {
+    return WaitForMessages(log, WaitStrategy::BusyPoll());
+}
+
+int WaitEndOfSubscription(testLogger& log) {
+    PipePublisher<Msg> publisher;
+    std::shared_ptr<PipeSubscriber<Msg>> client(publisher.NewClient(1000));
+    Msg last = {"Final message"};
+
+    std::vector<Msg> got;
+    std::thread reader([&] () -> void {
+        Msg m;
+        while (client->WaitForMessage(m)) {
+            got.push_back(m);
+        }
+    });
+
+    publisher.Publish(last);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    // Ending the subscription must release the reader
+    client->Abort();
+    reader.join();
+
+    std::vector<Msg> expected = {last};
+    if (!MessagesMatch(log,expected,got)) {
+        return 1;
+    }
+
+    return 0;
+}
+
+int SubscriberStats(testLogger& log) {
+    PipePublisher<Msg> publisher;
+    publisher.EnableStats();
+    std::shared_ptr<PipeSubscriber<Msg>> client(
+        publisher.NewClient(4, PipeSubscriber<Msg>::DROP_NEWEST));
+
+    Msg msg = {"Hello World!"};
+    for (size_t i = 0; i < 3; ++i) {
+        publisher.Publish(msg);
+    }
+
+    Msg recvd;
+    client->GetNextMessage(recvd);
+    client->GetNextMessage(recvd);
+
+    publisher.StartBatch();
+    for (size_t i = 0; i < 4; ++i) {
+        publisher.Publish(msg);
+    }
+    publisher.EndBatch();
+
+    std::vector<PipeSubscriberStats> stats = publisher.Stats();
+    if (stats.size() != 1) {
+        log << "Invalid number of stats: " << stats.size() << endl;
+        return 1;
+    }
+
+    const PipeSubscriberStats& s = stats[0];
+    log << "Pushed: " << s.pushed << ", consumed: " << s.consumed
+        << ", depth: " << s.queueDepth << ", hwm: " << s.highWaterMark
+        << ", dropped: " << s.dropped << ", batches: " << s.batches
+        << ", batched: " << s.batchedMessages
+        << ", largest: " << s.largestBatch << endl;
+
+    if (s.pushed != 6 || s.consumed != 2 || s.dropped != 1) {
+        log << "Invalid message counts" << endl;
+        return 1;
+    }
+
+    if (s.queueDepth != 4 || s.highWaterMark != 4) {
+        log << "Invalid queue depth" << endl;
+        return 1;
+    }
+
+    if (s.batches != 1 || s.batchedMessages != 3 || s.largestBatch != 3) {
+        log << "Invalid batch counts" << endl;
+        return 1;
+    }
+
+    std::vector<Msg> got = Drain(*client);
+    if (got.size() != 4 || client->Stats().consumed != 6 ||
+        client->Stats().queueDepth != 0)
+    {
+        log << "Drain was not counted" << endl;
+        return 1;
+    }
+
+    // Forwarded messages are consumed as they are pushed
+    std::vector<Msg> forwarded;
+    client->OnNewMessage([&] (const Msg& m) -> void {
+        forwarded.push_back(m);
+    });
+    publisher.Publish(msg);
+
+    PipeSubscriberStats final = client->Stats();
+    if (forwarded.size() != 1 || final.pushed != 7 || final.consumed != 7) {
+        log << "Forwarded message was not counted" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int SubscriberStatsDisabled(testLogger& log) {
+    PipePublisher<Msg> publisher;
+    std::shared_ptr<PipeSubscriber<Msg>> client(publisher.NewClient(1024));
+
+    Msg msg = {"Hello World!"};
+    publisher.Publish(msg);
+    publisher.Publish(msg);
+
+    PipeSubscriberStats stats = client->Stats();
+    if (stats.pushed != 0 || stats.highWaterMark != 0) {
+        log << "Stats were kept whilst disabled" << endl;
+        return 1;
+    }
+
+    // The depth is always available
+    if (stats.queueDepth != 2) {
+        log << "Invalid queue depth: " << stats.queueDepth << endl;
+        return 1;
+    }
+
+    // Enabling applies to existing clients
+    publisher.EnableStats();
+    publisher.Publish(msg);
+
+    stats = publisher.Stats()[0];
+    if (stats.pushed != 1 || stats.highWaterMark != 3) {
+        log << "Stats were not enabled: " << stats.pushed << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int CommittedRead(testLogger& log) {
+    PipePublisher<Msg> publisher;
+    std::shared_ptr<PipeSubscriber<Msg>> client(publisher.NewClient(100));
+    std::shared_ptr<PipeSubscriber<Msg>> dropping(
+        publisher.NewClient(2, PipeSubscriber<Msg>::DROP_OLDEST));
+
+    Msg got[10];
+
+    publisher.Publish({"0"});
+    publisher.StartBatch();
+    publisher.Publish({"1"});
+    publisher.Publish({"2"});
+
+    // Only the message from outside the batch is available
+    if (client->CommittedMessages() != 1) {
+        log << "Invalid committed count: " << client->CommittedMessages() << endl;
+        return 1;
+    }
+
+    if (client->GetCommittedMessages(got, 10) != 1 || got[0].message != "0") {
+        log << "Did not read the un-batched message" << endl;
+        return 1;
+    }
+
+    if (client->GetCommittedMessages(got, 10) != 0) {
+        log << "Read from an incomplete batch" << endl;
+        return 1;
+    }
+
+    publisher.EndBatch();
+
+    if (client->GetCommittedMessages(got, 10) != 2 ||
+        got[0].message != "1" ||
+        got[1].message != "2")
+    {
+        log << "Did not read the completed batch" << endl;
+        return 1;
+    }
+
+    // The oldest message was dropped, and must not be counted
+    if (dropping->CommittedMessages() != 2) {
+        log << "Invalid committed count after drop: "
+            << dropping->CommittedMessages() << endl;
+        return 1;
+    }
+
+    if (dropping->GetCommittedMessages(got, 10) != 2 ||
+        got[0].message != "1" ||
+        got[1].message != "2")
+    {
+        log << "Invalid messages after drop" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int AutoBatchSize(testLogger& log) {
+    PipePublisher<Msg> publisher;
+    publisher.EnableStats();
+    publisher.EnableAutoBatching(10, std::chrono::seconds(10));
+    std::shared_ptr<PipeSubscriber<Msg>> client(publisher.NewClient(100));
+
+    std::vector<Msg> toSend;
+    for (size_t i = 0; i < 25; ++i) {
+        toSend.push_back({std::to_string(i)});
+        publisher.Publish(toSend.back());
+    }
+
+    // The final 5 are still being held
+    std::vector<Msg> got = Drain(*client);
+    if (got.size() != 20) {
+        log << "Invalid number of messages released: " << got.size() << endl;
+        return 1;
+    }
+
+    publisher.Flush();
+    std::vector<Msg> rest = Drain(*client);
+    got.insert(got.end(), rest.begin(), rest.end());
+
+    if (!MessagesMatch(log,toSend,got)) {
+        return 1;
+    }
+
+    PipeSubscriberStats stats = client->Stats();
+    if (stats.batches != 3 || stats.largestBatch != 10) {
+        log << "Invalid batches: " << stats.batches << " / "
+            << stats.largestBatch << endl;
+        return 1;
+    }
+
+    // Nothing is held once disabled
+    publisher.DisableAutoBatching();
+    publisher.Publish({"Hello World!"});
+    if (Drain(*client).size() != 1) {
+        log << "Message was held after disabling" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int AutoBatchDelay(testLogger& log) {
+    PipePublisher<Msg> publisher;
+    publisher.EnableAutoBatching(1000, std::chrono::milliseconds(5));
+    std::shared_ptr<PipeSubscriber<Msg>> client(publisher.NewClient(100));
+
+    publisher.Publish({"0"});
+    publisher.FlushIfDue();
+    if (Drain(*client).size() != 0) {
+        log << "Message was released before it was due" << endl;
+        return 1;
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    // The next publication releases the overdue batch
+    publisher.Publish({"1"});
+    if (Drain(*client).size() != 2) {
+        log << "Overdue batch was not released on publish" << endl;
+        return 1;
+    }
+
+    publisher.Publish({"2"});
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    publisher.FlushIfDue();
+    if (Drain(*client).size() != 1) {
+        log << "Overdue message was not released by FlushIfDue" << endl;
+        return 1;
+    }
+
+    // An explicit batch follows anything being held
+    publisher.Publish({"3"});
+    publisher.StartBatch();
+    publisher.Publish({"4"});
+    publisher.EndBatch();
+
+    std::vector<Msg> got = Drain(*client);
+    if (got.size() != 2 || got[0].message != "3" || got[1].message != "4") {
+        log << "Explicit batch was not ordered after the held message" << endl;
+        return 1;
+    }
+
+    // As does the end of the subscription
+    publisher.Publish({"5"});
+    publisher.Done();
+    if (Drain(*client).size() != 1) {
+        log << "Held message was not released by Done" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int AutoBatchBlock(testLogger& log) {
+    PipePublisher<Msg> publisher;
+    publisher.EnableAutoBatching(100, std::chrono::milliseconds(1));
+    std::shared_ptr<PipeSubscriber<Msg>> client(
+        publisher.NewClient(4, PipeSubscriber<Msg>::BLOCK));
+
+    std::vector<Msg> toSend;
+    for (size_t i = 0; i < 10000; ++i) {
+        toSend.push_back({std::to_string(i)});
+    }
+
+    /**
+     * The reader re-registers for notifications whilst the publisher is
+     * blocked part way through a batch.
+     */
+    std::vector<Msg> got;
+    std::atomic<bool> ready(false);
+    std::thread reader([&] () -> void {
+        Msg recvMsg;
+        while(got.size() < toSend.size()) {
+            if (client->GetNextMessage(recvMsg)) {
+                got.push_back(recvMsg);
+            } else {
+                ready = false;
+                client->OnNextMessage([&] () -> void { ready = true; });
+                while (!ready) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+    });
+
+    for (auto& msg : toSend ) {
+        publisher.Publish(msg);
+    }
+    publisher.Flush();
+
+    reader.join();
+
+    if (!MessagesMatch(log,toSend,got)) {
+        return 1;
+    }
+
+    return 0;
+}
+
+int FanOutOrder(testLogger& log) {
+    PipePublisher<Msg> publisher;
+    publisher.EnableFanOut(3, 1);
+
+    std::vector<std::shared_ptr<PipeSubscriber<Msg>>> clients;
+    for (size_t i = 0; i < 200; ++i) {
+        clients.push_back(publisher.NewClient(1000));
+    }
+
+    std::vector<Msg> toSend;
+    for (size_t i = 0; i < 500; ++i) {
+        toSend.push_back({std::to_string(i)});
+    }
+
+    for (size_t i = 0; i < 200; ++i) {
+        publisher.Publish(toSend[i]);
+    }
+
+    publisher.StartBatch();
+    for (size_t i = 200; i < 400; ++i) {
+        publisher.Publish(toSend[i]);
+    }
+    publisher.EndBatch();
+
+    for (size_t i = 400; i < toSend.size(); ++i) {
+        publisher.Publish(toSend[i]);
+    }
+
+    for (auto& client: clients) {
+        std::vector<Msg> got = Drain(*client);
+        if (!MessagesMatch(log,toSend,got)) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int FanOutReap(testLogger& log) {
+    PipePublisher<Msg> publisher;
+    publisher.EnableFanOut(2, 1);
+
+    std::vector<std::shared_ptr<PipeSubscriber<Msg>>> clients;
+    for (size_t i = 0; i < 100; ++i) {
+        clients.push_back(publisher.NewClient(1000));
+    }
+
+    publisher.Publish({"0"});
+
+    // Drop every other client, in every shard
+    for (size_t i = 0; i < clients.size(); i += 2) {
+        clients[i].reset();
+    }
+
+    publisher.Publish({"1"});
+    publisher.Publish({"2"});
+
+    if (publisher.NumClients() != 50) {
+        log << "Dead clients were not reaped: " << publisher.NumClients() << endl;
+        return 1;
+    }
+
+    std::vector<Msg> toSend = {{"0"}, {"1"}, {"2"}};
+    for (size_t i = 1; i < clients.size(); i += 2) {
+        std::vector<Msg> got = Drain(*clients[i]);
+        if (!MessagesMatch(log,toSend,got)) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int FanOutBatchReap(testLogger& log) {
+    PipePublisher<Msg> publisher;
+    publisher.EnableFanOut(2, 1);
+
+    class Handler: public IPipeConsumer<Msg> {
+    public:
+        Handler() : startBatchCalls(0), endBatchCalls(0) { }
+        virtual void PushMessage(const Msg& m) { }
+
+        void StartBatch() {
+            startBatchCalls++;
+            startThread = std::this_thread::get_id();
+        }
+
+        void EndBatch() {
+            endBatchCalls++;
+            endThread = std::this_thread::get_id();
+        }
+
+        size_t            startBatchCalls;
+        size_t            endBatchCalls;
+        std::thread::id   startThread;
+        std::thread::id   endThread;
+    };
+
+    std::vector<std::shared_ptr<Handler>> clients;
+    for (size_t i = 0; i < 100; ++i) {
+        clients.emplace_back(new Handler);
+        publisher.InstallClient(clients.back());
+    }
+
+    publisher.StartBatch();
+    publisher.Publish({"0"});
+
+    // Abort every other client, in every shard
+    for (size_t i = 0; i < clients.size(); i += 2) {
+        clients[i]->Abort();
+    }
+
+    publisher.Publish({"1"});
+    publisher.EndBatch();
+
+    for (size_t i = 0; i < clients.size(); ++i) {
+        const Handler& client = *clients[i];
+        if (client.startBatchCalls != 1 || client.endBatchCalls != 1) {
+            log << "Client " << i << " batch calls: " << client.startBatchCalls
+                << " / " << client.endBatchCalls << endl;
+            return 1;
+        }
+
+        if (client.startThread != client.endThread) {
+            log << "Client " << i << " ended the batch on another thread" << endl;
+            return 1;
+        }
+    }
+
+    publisher.Publish({"2"});
+    if (publisher.NumClients() != 50) {
+        log << "Dead clients were not reaped: " << publisher.NumClients() << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int FanOutThrow(testLogger& log) {
+    PipePublisher<Msg> publisher;
+    publisher.EnableFanOut(3, 1);
+
+    std::vector<std::shared_ptr<PipeSubscriber<Msg>>> clients;
+    for (size_t i = 0; i < 99; ++i) {
+        clients.push_back(publisher.NewClient(1000));
+    }
+
+    // The last client is pushed to by a helper thread
+    clients.push_back(publisher.NewClient(1));
+
+    publisher.Publish({"Message 1"});
+
+    bool thrown = false;
+    try {
+        publisher.Publish({"Message 2"});
+    } catch (...) {
+        thrown = true;
+    }
+
+    if (!thrown) {
+        log << "Exception was not passed back to the publisher" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int FanOutConsumers(testLogger& log) {
+    PipePublisher<Msg> publisher;
+    publisher.EnableFanOut(2, 1, WaitStrategy::Blocking());
+    publisher.EnableAutoBatching(50, std::chrono::milliseconds(1));
+
+    const size_t toSend = 2000;
+    const size_t numClients = 100;
+    std::atomic<size_t> received(0);
+    std::atomic<size_t> outOfOrder(0);
+
+    WorkerThread workers[2];
+    workers[0].Start();
+    workers[1].Start();
+
+    std::vector<size_t> next(numClients, 0);
+    for (size_t i = 0; i < numClients; ++i) {
+        size_t& expected = next[i];
+        std::function<void (Msg&)> task = [&, i] (Msg& m) -> void {
+            if (m.message != std::to_string(expected)) {
+                ++outOfOrder;
+            }
+            ++expected;
+            ++received;
+        };
+
+        workers[i%2].ConsumeUpdates<PipeSubscriber<Msg>>(
+            publisher, task, 100, 4, PipeSubscriber<Msg>::BLOCK);
+    }
+
+    for (size_t i = 0; i < toSend; ++i) {
+        publisher.Publish({std::to_string(i)});
+    }
+    publisher.Flush();
+
+    for (size_t i = 0; i < 10000 && received < toSend * numClients; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    workers[0].Abort();
+    workers[1].Abort();
+    workers[0].Join();
+    workers[1].Join();
+
+    if (received != toSend * numClients || outOfOrder != 0) {
+        log << "Received " << received << " / " << toSend * numClients
+            << " (" << outOfOrder << " out of order)" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * True if fd becomes readable within timeoutMs
+ */
+bool Readable(int fd, int timeoutMs) {
+    int epfd = epoll_create1(0);
+    epoll_event ev = {};
+    ev.events = EPOLLIN;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+
+    epoll_event ready;
+    const int count = epoll_wait(epfd, &ready, 1, timeoutMs);
+    close(epfd);
+
+    return count == 1;
+}
+
+int ReadyFdEpoll(testLogger& log) {
+    PipePublisher<Msg> publisher;
+    const size_t numClients = 5;
+    const size_t toSend = 5000;
+
+    std::vector<std::shared_ptr<PipeSubscriber<Msg>>> clients;
+    int epfd = epoll_create1(0);
+    for (size_t i = 0; i < numClients; ++i) {
+        clients.push_back(publisher.NewClient(toSend));
+
+        epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.u64 = i;
+        epoll_ctl(epfd, EPOLL_CTL_ADD, clients[i]->ReadyFd(), &ev);
+    }
+
+    std::thread publishThread([&] () -> void {
+        for (size_t i = 0; i < toSend; ++i) {
+            publisher.Publish({std::to_string(i)});
+            if (i % 100 == 0) {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        }
+    });
+
+    std::vector<size_t> next(numClients, 0);
+    size_t received = 0;
+    size_t outOfOrder = 0;
+    size_t timeouts = 0;
+    while (received < toSend * numClients && timeouts < 10) {
+        epoll_event events[numClients];
+        const int count = epoll_wait(epfd, events, numClients, 1000);
+        if (count <= 0) {
+            ++timeouts;
+        }
+
+        for (int e = 0; e < count; ++e) {
+            const size_t i = events[e].data.u64;
+            clients[i]->ClearReady();
+
+            Msg msg;
+            while (clients[i]->GetNextMessage(msg)) {
+                if (msg.message != std::to_string(next[i])) {
+                    ++outOfOrder;
+                }
+                ++next[i];
+                ++received;
+            }
+        }
+    }
+
+    publishThread.join();
+    close(epfd);
+
+    if (received != toSend * numClients || outOfOrder != 0) {
+        log << "Received " << received << " / " << toSend * numClients
+            << " (" << outOfOrder << " out of order)" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int ReadyFdBatch(testLogger& log) {
+    PipePublisher<Msg> publisher;
+    auto client = publisher.NewClient(100);
+    const int fd = client->ReadyFd();
+
+    if (Readable(fd, 0)) {
+        log << "Empty queue was signalled" << endl;
+        return 1;
+    }
+
+    publisher.StartBatch();
+    publisher.Publish({"Message 1"});
+    publisher.Publish({"Message 2"});
+
+    if (Readable(fd, 0)) {
+        log << "Incomplete batch was signalled" << endl;
+        publisher.EndBatch();
+        return 1;
+    }
+
+    publisher.EndBatch();
+
+    if (!Readable(fd, 0)) {
+        log << "Completed batch was not signalled" << endl;
+        return 1;
+    }
+
+    client->ClearReady();
+    Msg msgs[10];
+    if (client->GetCommittedMessages(msgs, 10) != 2) {
+        log << "Batch was not read" << endl;
+        return 1;
+    }
+
+    if (Readable(fd, 0)) {
+        log << "Drained queue is still signalled" << endl;
+        return 1;
+    }
+
+    publisher.Publish({"Message 3"});
+    publisher.Publish({"Message 4"});
+
+    if (!Readable(fd, 0)) {
+        log << "Re-armed queue was not signalled" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int ReadyFdEnd(testLogger& log) {
+    std::shared_ptr<PipeSubscriber<Msg>> client;
+    int fd = -1;
+    {
+        PipePublisher<Msg> publisher;
+        client = publisher.NewClient(100);
+        fd = client->ReadyFd();
+        publisher.Publish({"Message 1"});
+        publisher.Done();
+    }
+
+    if (!Readable(fd, 0)) {
+        log << "Final message was not signalled" << endl;
+        return 1;
+    }
+
+    client->ClearReady();
+    Msg msg;
+    if (!client->GetNextMessage(msg) || msg.message != "Message 1") {
+        log << "Final message was not read" << endl;
+        return 1;
+    }
+
+    // Nothing left to read, but the descriptor stays readable
+    client->ClearReady();
+    client->GetNextMessage(msg);
+    if (!Readable(fd, 0) || !client->Ended()) {
+        log << "End of subscription was not signalled" << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,292 @@
+#include "tester.h"
+#include <WorkerThreadPool.h>
+#include <set>
+
+using namespace std;
+
+int PostTasks(testLogger& log);
+int DoTaskResult(testLogger& log);
+int StealWork(testLogger& log);
+int StrandOrder(testLogger& log);
+int AbortCancels(testLogger& log);
+int ConsumeInOrder(testLogger& log);
+
+int main(int argc, const char *argv[])
+{
+    Test("Posting tasks to the pool",PostTasks).RunTest();
+    Test("Posting a task synchronously",DoTaskResult).RunTest();
+    Test("Idle threads steal work",StealWork).RunTest();
+    Test("Strand tasks are run in order",StrandOrder).RunTest();
+    Test("Abort cancels queued tasks",AbortCancels).RunTest();
+    Test("Consume updates from two clients",ConsumeInOrder).RunTest();
+    return 0;
+}
+
+int PostTasks(testLogger& log) {
+    WorkerThreadPool pool(4);
+    const size_t toPost = 1000;
+    std::atomic<size_t> done(0);
+    std::mutex comms_mutex;
+    std::condition_variable wait_for_complete;
+
+    pool.Start();
+
+    for (size_t i = 0; i < toPost; ++i) {
+        pool.PostTask([&] () -> void {
+            if (++done == toPost) {
+                std::unique_lock<std::mutex> lock(comms_mutex);
+                wait_for_complete.notify_all();
+            }
+        });
+    }
+
+    std::unique_lock<std::mutex> lock(comms_mutex);
+    while (done != toPost) {
+        wait_for_complete.wait(lock);
+    }
+
+    if (pool.Size() != 4) {
+        log << "Invalid pool size: " << pool.Size() << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int DoTaskResult(testLogger& log) {
+    WorkerThreadPool pool(2);
+    pool.Start();
+
+    std::thread::id this_thread = std::this_thread::get_id();
+    std::thread::id write_id = this_thread;
+    size_t target = 0;
+
+    bool ok = pool.DoTask([&] () -> void {
+        target = 1;
+        write_id = std::this_thread::get_id();
+    });
+
+    if (!ok) {
+        log << "Task was not executed" << endl;
+        return 1;
+    }
+
+    if (target != 1) {
+        log << "Failed to set target!" << endl;
+        return 1;
+    }
+
+    if (write_id == this_thread) {
+        log << "Task was executed on the wrong thread" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int StealWork(testLogger& log) {
+    const size_t threads = 4;
+    WorkerThreadPool pool(threads);
+    std::mutex barrier_mutex;
+    std::condition_variable barrier;
+    size_t waiting = 0;
+    std::set<std::thread::id> ids;
+
+    /**
+     * Each task blocks until all threads are busy, which is only possible if
+     * the tasks, all posted to the same thread, are stolen by its neighbours.
+     */
+    auto task = [&] () -> void {
+        std::unique_lock<std::mutex> lock(barrier_mutex);
+        ids.insert(std::this_thread::get_id());
+        ++waiting;
+        barrier.notify_all();
+        while (waiting < threads) {
+            barrier.wait(lock);
+        }
+    };
+
+    pool.Start();
+    bool ok = pool.DoTask([&] () -> void {
+        for (size_t i = 0; i < threads; ++i) {
+            pool.PostTask(task);
+        }
+    });
+
+    if (!ok) {
+        log << "Task was not executed" << endl;
+        return 1;
+    }
+
+    std::unique_lock<std::mutex> lock(barrier_mutex);
+    while (waiting < threads) {
+        barrier.wait(lock);
+    }
+
+    if (ids.size() != threads) {
+        log << "Tasks were not distributed: " << ids.size() << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int StrandOrder(testLogger& log) {
+    WorkerThreadPool pool(4);
+    const size_t toPost = 1000;
+    const size_t numStrands = 3;
+    std::vector<std::vector<size_t>> results(numStrands);
+    std::vector<WorkerThreadPool::StrandKey> keys;
+    std::atomic<size_t> running(0);
+    std::atomic<bool> concurrent(false);
+
+    for (size_t s = 0; s < numStrands; ++s) {
+        keys.push_back(pool.NewStrand());
+    }
+
+    pool.Start();
+
+    for (size_t i = 0; i < toPost; ++i) {
+        for (size_t s = 0; s < numStrands; ++s) {
+            std::vector<size_t>& result = results[s];
+            pool.PostTask([&result, i] () -> void {
+                result.push_back(i);
+            }, keys[s]);
+        }
+    }
+
+    // The strand can also be used directly as an IPostable...
+    IPostable& strand = pool.Strand(keys[0]);
+    for (size_t i = 0; i < 100; ++i) {
+        strand.PostTask([&] () -> void {
+            if (++running > 1) {
+                concurrent = true;
+            }
+            std::this_thread::yield();
+            --running;
+        });
+    }
+
+    for (size_t s = 0; s < numStrands; ++s) {
+        pool.DoTask([] () -> void { }, keys[s]);
+    }
+
+    for (size_t s = 0; s < numStrands; ++s) {
+        std::vector<size_t>& result = results[s];
+        if (result.size() != toPost) {
+            log << "Invalid number of tasks: " << result.size() << endl;
+            return 1;
+        }
+
+        for (size_t i = 0; i < toPost; ++i) {
+            if (result[i] != i) {
+                log << "Task out of order: " << i << " : " << result[i] << endl;
+                return 1;
+            }
+        }
+    }
+
+    if (concurrent) {
+        log << "Strand tasks were run concurrently" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int AbortCancels(testLogger& log) {
+    WorkerThreadPool pool(1);
+    std::mutex block_mutex;
+    std::unique_lock<std::mutex> block(block_mutex);
+    std::atomic<bool> started(false);
+    bool cancelledRan = false;
+
+    pool.Start();
+
+    pool.PostTask([&] () -> void {
+        started = true;
+        std::unique_lock<std::mutex> lock(block_mutex);
+    });
+
+    while (!started) {
+        std::this_thread::yield();
+    }
+
+    bool result = true;
+    std::thread waiter([&] () -> void {
+        result = pool.DoTask([&] () -> void { cancelledRan = true; });
+    });
+
+    // Give the waiter a chance to post its task...
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    pool.Abort();
+    block.unlock();
+    waiter.join();
+    pool.Join();
+
+    if (result) {
+        log << "Cancelled task reported success" << endl;
+        return 1;
+    }
+
+    if (cancelledRan) {
+        log << "Cancelled task was executed" << endl;
+        return 1;
+    }
+
+    if (pool.DoTask([] () -> void { })) {
+        log << "Task executed after Abort" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+struct Msg {
+    size_t id;
+};
+
+int ConsumeInOrder(testLogger& log) {
+    PipePublisher<Msg> publisher;
+    WorkerThreadPool pool(4);
+    const size_t toSend = 1000;
+    std::vector<size_t> got1, got2;
+    std::mutex comms_mutex;
+    std::condition_variable wait_for_complete;
+    size_t complete = 0;
+
+    auto make_task = [&] (std::vector<size_t>& got) -> std::function<void (Msg&)> {
+        return [&] (Msg& m) -> void {
+            got.push_back(m.id);
+            if (got.size() == toSend) {
+                std::unique_lock<std::mutex> lock(comms_mutex);
+                ++complete;
+                wait_for_complete.notify_all();
+            }
+        };
+    };
+
+    pool.Start();
+    pool.ConsumeUpdates(publisher, make_task(got1), 10000, 7);
+    pool.ConsumeUpdates(publisher, make_task(got2), 10000, 7);
+
+    for (size_t i = 0; i < toSend; ++i) {
+        Msg m = {i};
+        publisher.Publish(m);
+    }
+
+    std::unique_lock<std::mutex> lock(comms_mutex);
+    while (complete < 2) {
+        wait_for_complete.wait(lock);
+    }
+
+    for (size_t i = 0; i < toSend; ++i) {
+        if (got1[i] != i || got2[i] != i) {
+            log << "Update out of order: " << i << endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,482 @@
+#include "tester.h"
+#include <RingPublisher.h>
+#include <thread>
+#include <IPostable.h>
+
+
+using namespace std;
+
+int PublishSingleConsumer(testLogger& log);
+int PublishDoubleConsumer(testLogger& log);
+int PublishNotify(testLogger& log);
+int BatchNotify(testLogger& log);
+int PublishForEachData(testLogger& log);
+int PublishForEachDataUnread(testLogger& log);
+int RingWrap(testLogger& log);
+int GateOnSlowestClient(testLogger& log);
+int SubscribeMidBatch(testLogger& log);
+int Abort(testLogger& log);
+int AbortHandleDestruction(testLogger& log);
+
+int main(int argc, const char *argv[])
+{
+    Test("Publish to a single consumer",PublishSingleConsumer).RunTest();
+    Test("Publish to two consumers",PublishDoubleConsumer).RunTest();
+    Test("On Next Message Callback",PublishNotify).RunTest();
+    Test("On Next Message Callback, batched",BatchNotify).RunTest();
+    Test("On data callback",PublishForEachData).RunTest();
+    Test("On data callback, unread data",PublishForEachDataUnread).RunTest();
+    Test("Ring wraps once data has been read",RingWrap).RunTest();
+    Test("Publisher waits for the slowest client",GateOnSlowestClient).RunTest();
+    Test("Publisher waits for a client subscribed mid-batch",SubscribeMidBatch).RunTest();
+    Test("Abort prevents further publication",Abort).RunTest();
+    Test("Destruction of final handle releases the ring",AbortHandleDestruction).RunTest();
+
+    return 0;
+}
+
+struct Msg {
+    std::string   message;
+};
+
+bool MessagesMatch(testLogger& log,
+                   const std::vector<Msg>& sent,
+                   const std::vector<Msg>& got)
+{
+    bool match = true;
+    if (sent.size() != got.size()) {
+        log << "Invalid number of messages received: " << endl;
+        log << "Expected: " << sent.size() << endl;
+        log << "Got: " << got.size() << endl;
+        match = false;
+    }
+
+    if ( match ) {
+        for (size_t i = 0; match && i < sent.size(); ++i) {
+            const Msg& msg = sent[i];
+            const Msg& recvd = got[i];
+
+            if ( msg.message != recvd.message ) {
+                log << "Missmatch on message: " << i;
+                log.ReportStringDiff(msg.message,recvd.message);
+                match = false;
+            }
+        }
+    }
+
+    return match;
+}
+
+std::vector<Msg> Drain(RingSubscriber<Msg>& client) {
+    std::vector<Msg> got;
+    Msg recvMsg;
+    while(client.GetNextMessage(recvMsg)) {
+        got.push_back(recvMsg);
+    }
+    return got;
+}
+
+int PublishSingleConsumer(testLogger& log) {
+    RingPublisher<Msg> publisher(1024);
+    std::shared_ptr<RingSubscriber<Msg>> client(publisher.NewClient());
+    std::vector<Msg> toSend = {
+        {"Message 1"},
+        {"Mesasge 2"},
+        {"Hello World!"}
+    };
+
+    for (auto& msg : toSend ) {
+        publisher.Publish(msg);
+    }
+
+    std::vector<Msg> got;
+    std::thread worker([&] () -> void { got = Drain(*client); });
+    worker.join();
+
+    if (!MessagesMatch(log,toSend,got)) {
+        return 1;
+    }
+
+    return 0;
+}
+
+int PublishDoubleConsumer(testLogger& log) {
+    RingPublisher<Msg> publisher(1024);
+    std::shared_ptr<RingSubscriber<Msg>> client(publisher.NewClient());
+    std::vector<Msg> toSend = {
+        {"Message 1"},
+        {"Mesasge 2"}
+    };
+
+    for (auto& msg : toSend ) {
+        publisher.Publish(msg);
+    }
+
+    std::shared_ptr<RingSubscriber<Msg>> client2(publisher.NewClient());
+    std::vector<Msg> toSend2 = {
+        {"Hello World!"}
+    };
+
+    for (auto& msg : toSend2 ) {
+        publisher.Publish(msg);
+    }
+
+    std::vector<Msg> expected = {
+        {"Message 1"},
+        {"Mesasge 2"},
+        {"Hello World!"}
+    };
+
+    if (!MessagesMatch(log,expected,Drain(*client))) {
+        return 1;
+    }
+
+    if (!MessagesMatch(log,toSend2,Drain(*client2))) {
+        return 1;
+    }
+
+    if (publisher.NumClients() != 2) {
+        log << "Invalid number of clients: " << publisher.NumClients() << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int PublishNotify(testLogger& log) {
+    RingPublisher<Msg> publisher(1024);
+    std::shared_ptr<RingSubscriber<Msg>> client(publisher.NewClient());
+    std::vector<Msg> toSend = {
+        {"Message 1"},
+        {"Mesasge 2"},
+        {"Hello World!"}
+    };
+
+    std::vector<Msg> got;
+    auto f = [&] () -> void {
+        Msg recvMsg;
+        while(client->GetNextMessage(recvMsg)) {
+            got.push_back(recvMsg);
+        }
+    };
+
+    client->OnNextMessage(f);
+
+    for (auto& msg : toSend ) {
+        publisher.Publish(msg);
+    }
+
+    std::vector<Msg> expected = {
+        {"Message 1"}
+    };
+
+    if (!MessagesMatch(log,expected,got)) {
+        return 1;
+    }
+
+    client->OnNextMessage(f);
+
+    if (!MessagesMatch(log,toSend,got)) {
+        return 1;
+    }
+
+    return 0;
+}
+
+int BatchNotify(testLogger& log) {
+    RingPublisher<Msg> publisher(1024);
+    std::shared_ptr<RingSubscriber<Msg>> client(publisher.NewClient());
+    std::vector<Msg> toSend = {
+        {"Message 1"},
+        {"Mesasge 2"},
+        {"Hello World!"}
+    };
+
+    std::vector<Msg> got;
+    auto f = [&] () -> void {
+        Msg recvMsg;
+        while(client->GetNextMessage(recvMsg)) {
+            got.push_back(recvMsg);
+        }
+    };
+
+    client->OnNextMessage(f);
+
+    publisher.StartBatch();
+
+    for (auto& msg : toSend ) {
+        publisher.Publish(msg);
+    }
+
+    if (!MessagesMatch(log,{},got)) {
+        return 1;
+    }
+
+    publisher.EndBatch();
+
+    if (!MessagesMatch(log,toSend,got)) {
+        return 1;
+    }
+
+    return 0;
+}
+
+int PublishForEachData(testLogger& log) {
+    RingPublisher<Msg> publisher(1024);
+    std::shared_ptr<RingSubscriber<Msg>> client(publisher.NewClient());
+    std::vector<Msg> toSend = {
+        {"Message 1"},
+        {"Mesasge 2"},
+        {"Hello World!"}
+    };
+
+    std::vector<Msg> got;
+    client->OnNewMessage([&] (const Msg& newMsg) -> void {
+        got.push_back(newMsg);
+    });
+
+    for (auto& msg : toSend ) {
+        publisher.Publish(msg);
+    }
+
+    if (!MessagesMatch(log,toSend,got)) {
+        return 1;
+    }
+
+    return 0;
+}
+
+int PublishForEachDataUnread(testLogger& log) {
+    RingPublisher<Msg> publisher(1024);
+    std::shared_ptr<RingSubscriber<Msg>> client(publisher.NewClient());
+    std::vector<Msg> toSend = {
+        {"Message 1"},
+        {"Mesasge 2"}
+    };
+
+    std::vector<Msg> toSend2 = {
+        {"Hello World!"}
+    };
+
+    std::vector<Msg> end_result = {
+        {"Message 1"},
+        {"Mesasge 2"},
+        {"Hello World!"}
+    };
+
+    for (auto& msg : toSend ) {
+        publisher.Publish(msg);
+    }
+
+    std::vector<Msg> got;
+    client->OnNewMessage([&] (const Msg& newMsg) -> void {
+        got.push_back(newMsg);
+    });
+
+    if (!MessagesMatch(log,toSend,got)) {
+        return 1;
+    }
+
+    for (auto& msg : toSend2 ) {
+        publisher.Publish(msg);
+    }
+
+    if (!MessagesMatch(log,end_result,got)) {
+        return 1;
+    }
+
+    return 0;
+}
+
+int RingWrap(testLogger& log) {
+    RingPublisher<Msg> publisher(4);
+    std::shared_ptr<RingSubscriber<Msg>> client(publisher.NewClient());
+
+    if (publisher.Size() != 4) {
+        log << "Invalid ring size: " << publisher.Size() << endl;
+        return 1;
+    }
+
+    std::vector<Msg> sent;
+    std::vector<Msg> got;
+    for (size_t i = 0; i < 10; ++i) {
+        Msg m = {std::to_string(i)};
+        publisher.Publish(m);
+        sent.push_back(m);
+
+        Msg recvMsg;
+        while(client->GetNextMessage(recvMsg)) {
+            got.push_back(recvMsg);
+        }
+    }
+
+    if (!MessagesMatch(log,sent,got)) {
+        return 1;
+    }
+
+    return 0;
+}
+
+int GateOnSlowestClient(testLogger& log) {
+    RingPublisher<Msg> publisher(8);
+    std::shared_ptr<RingSubscriber<Msg>> fast(publisher.NewClient());
+    std::shared_ptr<RingSubscriber<Msg>> slow(publisher.NewClient());
+    const size_t toSend = 1000;
+
+    std::vector<Msg> sent;
+    for (size_t i = 0; i < toSend; ++i) {
+        sent.push_back({std::to_string(i)});
+    }
+
+    std::vector<Msg> gotFast;
+    std::vector<Msg> gotSlow;
+
+    std::thread fastReader([&] () -> void {
+        Msg m;
+        while (gotFast.size() < toSend) {
+            if (fast->GetNextMessage(m)) {
+                gotFast.push_back(m);
+            }
+        }
+    });
+
+    std::thread slowReader([&] () -> void {
+        Msg m;
+        while (gotSlow.size() < toSend) {
+            if (slow->GetNextMessage(m)) {
+                gotSlow.push_back(m);
+            }
+            std::this_thread::yield();
+        }
+    });
+
+    for (Msg& m: sent) {
+        publisher.Publish(m);
+    }
+
+    fastReader.join();
+    slowReader.join();
+
+    if (!MessagesMatch(log,sent,gotFast)) {
+        return 1;
+    }
+
+    if (!MessagesMatch(log,sent,gotSlow)) {
+        return 1;
+    }
+
+    return 0;
+}
+
+int SubscribeMidBatch(testLogger& log) {
+    RingPublisher<Msg> publisher(8);
+    std::shared_ptr<RingSubscriber<Msg>> client(publisher.NewClient());
+    const size_t toSend = 20;
+
+    std::vector<Msg> sent;
+    for (size_t i = 0; i < toSend; ++i) {
+        sent.push_back({std::to_string(i)});
+    }
+
+    publisher.StartBatch();
+    std::shared_ptr<RingSubscriber<Msg>> late(publisher.NewClient());
+
+    std::vector<Msg> got;
+    std::vector<Msg> gotLate;
+
+    std::thread reader([&] () -> void {
+        Msg m;
+        while (got.size() < toSend) {
+            if (client->GetNextMessage(m)) {
+                got.push_back(m);
+            }
+        }
+    });
+
+    // Give the publisher every chance to wrap over the late client
+    std::thread lateReader([&] () -> void {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        Msg m;
+        while (gotLate.size() < toSend) {
+            if (late->GetNextMessage(m)) {
+                gotLate.push_back(m);
+            }
+        }
+    });
+
+    for (Msg& m: sent) {
+        publisher.Publish(m);
+    }
+    publisher.EndBatch();
+
+    reader.join();
+    lateReader.join();
+
+    if (!MessagesMatch(log,sent,got)) {
+        return 1;
+    }
+
+    if (!MessagesMatch(log,sent,gotLate)) {
+        return 1;
+    }
+
+    return 0;
+}
+
+int Abort(testLogger& log) {
+    RingPublisher<Msg> publisher(2);
+    std::shared_ptr<RingSubscriber<Msg>> client(publisher.NewClient());
+    std::vector<Msg> toSend = {
+        {"Message 1"},
+        {"Mesasge 2"}
+    };
+
+    for (auto& msg : toSend ) {
+        publisher.Publish(msg);
+    }
+
+    client->Abort();
+
+    // The ring is full, but we should not be waiting on an aborted client
+    Msg finalMessage = {"This should not be published"};
+    publisher.Publish(finalMessage);
+
+    if (publisher.NumClients() != 0) {
+        log << "Aborted client was not released" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int AbortHandleDestruction(testLogger& log) {
+    RingPublisher<Msg> publisher(2);
+    std::shared_ptr<RingSubscriber<Msg>> client(publisher.NewClient());
+    std::vector<Msg> toSend = {
+        {"Message 1"},
+        {"Mesasge 2"},
+        {"Hello World!"}
+    };
+
+    std::vector<Msg> expected = {
+        {"Message 1"}
+    };
+
+    std::vector<Msg> got;
+    auto f = [&] (const Msg& newMsg) -> void {
+        got.push_back(newMsg);
+        client.reset();
+    };
+
+    client->OnNewMessage(f);
+
+    for (auto& msg : toSend ) {
+        publisher.Publish(msg);
+    }
+
+    if (!MessagesMatch(log,expected,got)) {
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,298 @@
+#include "tester.h"
+#include <PipeRouter.h>
+#include <thread>
+#include <atomic>
+
+
+using namespace std;
+
+int RouteToKey(testLogger& log);
+int Wildcard(testLogger& log);
+int UnsubscribedKey(testLogger& log);
+int DropClient(testLogger& log);
+int Batched(testLogger& log);
+int SubscribeWhilstPublishing(testLogger& log);
+int ManyKeys(testLogger& log);
+
+int main(int argc, const char *argv[])
+{
+    Test("Messages are routed to the key's clients",RouteToKey).RunTest();
+    Test("Wildcard clients receive every key",Wildcard).RunTest();
+    Test("Publishing to a key with no clients",UnsubscribedKey).RunTest();
+    Test("Dropped clients are released",DropClient).RunTest();
+    Test("Batched publication",Batched).RunTest();
+    Test("Subscribing whilst publishing",SubscribeWhilstPublishing).RunTest();
+    Test("100k keys",ManyKeys).RunTest();
+
+    return 0;
+}
+
+struct Msg {
+    std::string   key;
+    size_t        seq;
+};
+
+typedef PipeRouter<Msg, std::string> Router;
+typedef std::shared_ptr<PipeSubscriber<Msg>> Client;
+
+std::vector<Msg> Drain(PipeSubscriber<Msg>& client) {
+    std::vector<Msg> got;
+    Msg recvMsg;
+    while(client.GetNextMessage(recvMsg)) {
+        got.push_back(recvMsg);
+    }
+    return got;
+}
+
+bool CheckKey(testLogger& log,
+              const std::vector<Msg>& got,
+              const std::string& key,
+              size_t expected)
+{
+    if (got.size() != expected) {
+        log << "Invalid number of messages for " << key << ": " << got.size()
+            << ", expected: " << expected << endl;
+        return false;
+    }
+
+    for (const Msg& msg: got) {
+        if (msg.key != key) {
+            log << "Got message for " << msg.key << ", expected: " << key << endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int RouteToKey(testLogger& log) {
+    Router router;
+    Client a(router.NewClient("A", 1024));
+    Client a2(router.NewClient("A", 1024));
+    Client b(router.NewClient("B", 1024));
+
+    if (router.NumKeys() != 2 || router.NumClients("A") != 2) {
+        log << "Invalid subscriptions: " << router.NumKeys()
+            << " / " << router.NumClients("A") << endl;
+        return 1;
+    }
+
+    for (size_t i = 0; i < 10; ++i) {
+        router.Publish("A", Msg{"A", i});
+        router.Publish("B", Msg{"B", i});
+        router.Publish("B", Msg{"B", i});
+    }
+
+    if (!CheckKey(log, Drain(*a), "A", 10) ||
+        !CheckKey(log, Drain(*a2), "A", 10) ||
+        !CheckKey(log, Drain(*b), "B", 20))
+    {
+        return 1;
+    }
+
+    return 0;
+}
+
+int Wildcard(testLogger& log) {
+    Router router;
+    Client a(router.NewClient("A", 1024));
+    Client all(router.NewWildcardClient(1024));
+
+    router.Publish("A", Msg{"A", 0});
+    router.Publish("B", Msg{"B", 1});
+    router.Publish("C", Msg{"C", 2});
+
+    if (!CheckKey(log, Drain(*a), "A", 1)) {
+        return 1;
+    }
+
+    std::vector<Msg> got = Drain(*all);
+    if (got.size() != 3) {
+        log << "Wildcard received " << got.size() << " messages" << endl;
+        return 1;
+    }
+
+    for (size_t i = 0; i < got.size(); ++i) {
+        if (got[i].seq != i) {
+            log << "Wildcard messages out of order" << endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int UnsubscribedKey(testLogger& log) {
+    Router router;
+    Client a(router.NewClient("A", 1024));
+
+    router.Publish("B", Msg{"B", 0});
+
+    if (!CheckKey(log, Drain(*a), "A", 0)) {
+        return 1;
+    }
+
+    if (router.NumKeys() != 1) {
+        log << "Publishing created a key: " << router.NumKeys() << endl;
+        return 1;
+    }
+
+    // Subscribing to the key enables publication
+    Client b(router.NewClient("B", 1024));
+    router.Publish("B", Msg{"B", 1});
+
+    if (!CheckKey(log, Drain(*b), "B", 1)) {
+        return 1;
+    }
+
+    return 0;
+}
+
+int DropClient(testLogger& log) {
+    Router router;
+    Client a(router.NewClient("A", 1024));
+    Client a2(router.NewClient("A", 1024));
+
+    router.Publish("A", Msg{"A", 0});
+    a2.reset();
+    router.Publish("A", Msg{"A", 1});
+
+    if (router.NumClients("A") != 1) {
+        log << "Client was not released: " << router.NumClients("A") << endl;
+        return 1;
+    }
+
+    a->Abort();
+    router.Publish("A", Msg{"A", 2});
+
+    if (router.NumClients("A") != 0) {
+        log << "Aborted client was not released: " << router.NumClients("A") << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int Batched(testLogger& log) {
+    Router router;
+    Client a(router.NewClient("A", 1024));
+    Client b(router.NewClient("B", 1024));
+    Client all(router.NewWildcardClient(1024));
+
+    std::atomic<size_t> aNotified(0);
+    std::atomic<size_t> allNotified(0);
+    a->OnNextMessage([&] () -> void { ++aNotified; });
+    all->OnNextMessage([&] () -> void { ++allNotified; });
+
+    router.StartBatch();
+    router.Publish("A", Msg{"A", 0});
+    router.Publish("A", Msg{"A", 1});
+    router.Publish("B", Msg{"B", 2});
+
+    if (aNotified != 0 || allNotified != 0) {
+        log << "Notified before the end of the batch" << endl;
+        return 1;
+    }
+
+    router.EndBatch();
+
+    if (aNotified != 1 || allNotified != 1) {
+        log << "Invalid notifications: " << aNotified << " / " << allNotified << endl;
+        return 1;
+    }
+
+    if (!CheckKey(log, Drain(*a), "A", 2) ||
+        !CheckKey(log, Drain(*b), "B", 1))
+    {
+        return 1;
+    }
+
+    // A new batch must restart the topics
+    router.StartBatch();
+    router.Publish("A", Msg{"A", 3});
+    router.EndBatch();
+
+    if (!CheckKey(log, Drain(*a), "A", 1)) {
+        return 1;
+    }
+
+    return 0;
+}
+
+int SubscribeWhilstPublishing(testLogger& log) {
+    Router router;
+    const size_t keys = 1000;
+    std::atomic<size_t> subscribed(0);
+    std::vector<Client> clients(keys);
+
+    std::thread subscriber([&] () -> void {
+        for (size_t i = 0; i < keys; ++i) {
+            clients[i] = router.NewClient(std::to_string(i), 1024);
+            ++subscribed;
+        }
+    });
+
+    // Keep publishing to every key until they have all been subscribed to
+    size_t rounds = 0;
+    while (subscribed < keys) {
+        for (size_t i = 0; i < keys; ++i) {
+            const std::string key = std::to_string(i);
+            router.Publish(key, Msg{key, rounds});
+        }
+        ++rounds;
+    }
+
+    subscriber.join();
+
+    // Every client is now live
+    for (size_t i = 0; i < keys; ++i) {
+        const std::string key = std::to_string(i);
+        router.Publish(key, Msg{key, rounds});
+    }
+
+    for (size_t i = 0; i < keys; ++i) {
+        std::vector<Msg> got = Drain(*clients[i]);
+        if (got.empty() || got.back().seq != rounds) {
+            log << "Client " << i << " missed the final message" << endl;
+            return 1;
+        }
+
+        if (!CheckKey(log, got, std::to_string(i), got.size())) {
+            return 1;
+        }
+    }
+
+    log << "Published " << rounds << " rounds whilst subscribing" << endl;
+
+    return 0;
+}
+
+int ManyKeys(testLogger& log) {
+    const size_t keys = 100000;
+    PipeRouter<size_t, size_t> router(keys);
+    std::vector<std::shared_ptr<PipeSubscriber<size_t>>> clients;
+    clients.reserve(keys);
+
+    for (size_t i = 0; i < keys; ++i) {
+        clients.push_back(router.NewClient(i, 4));
+    }
+
+    for (size_t i = 0; i < keys; ++i) {
+        router.Publish(i, i);
+    }
+
+    for (size_t i = 0; i < keys; ++i) {
+        size_t msg = 0;
+        if (!clients[i]->GetNextMessage(msg) || msg != i) {
+            log << "Client " << i << " did not receive its message" << endl;
+            return 1;
+        }
+
+        if (clients[i]->GetNextMessage(msg)) {
+            log << "Client " << i << " received another key's message" << endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
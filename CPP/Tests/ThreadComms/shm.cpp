@@ -0,0 +1,409 @@
+#include "tester.h"
+#include <ShmPublisher.h>
+#include <ShmConnection.h>
+#include <util_time.h>
+#include <thread>
+#include <atomic>
+#include <sstream>
+#include <unistd.h>
+#include <sys/wait.h>
+
+
+using namespace std;
+
+int PublishSingleConsumer(testLogger& log);
+int PublishNotify(testLogger& log);
+int RingWrap(testLogger& log);
+int CrossProcess(testLogger& log);
+int CrashedReader(testLogger& log);
+int CrashedWriter(testLogger& log);
+int SecondWriter(testLogger& log);
+int WrongMessageType(testLogger& log);
+
+int main(int argc, const char *argv[])
+{
+    Test("Publish to a single consumer",PublishSingleConsumer).RunTest();
+    Test("On Next Message Callback",PublishNotify).RunTest();
+    Test("Ring wraps once data has been read",RingWrap).RunTest();
+    Test("Publish to another process",CrossProcess).RunTest();
+    Test("Crashed reader is reclaimed",CrashedReader).RunTest();
+    Test("Crashed writer is detected",CrashedWriter).RunTest();
+    Test("Only one live writer per ring",SecondWriter).RunTest();
+    Test("Attaching with the wrong message type",WrongMessageType).RunTest();
+
+    return 0;
+}
+
+struct Msg {
+    uint64_t seq;
+    double   value;
+    char     tag[16];
+};
+
+std::string RingName(const std::string& test) {
+    std::stringstream name;
+    name << "/dev_tools_test_" << test << "_" << getpid();
+    return name.str();
+}
+
+Msg MakeMsg(uint64_t seq) {
+    Msg m = {seq, seq * 0.5, "message"};
+    return m;
+}
+
+bool CheckMessages(testLogger& log, const std::vector<Msg>& got, size_t expected) {
+    if (got.size() != expected) {
+        log << "Invalid number of messages received: " << got.size()
+            << ", expected: " << expected << endl;
+        return false;
+    }
+
+    for (size_t i = 0; i < got.size(); ++i) {
+        if (got[i].seq != i || got[i].value != i * 0.5 ||
+            std::string(got[i].tag) != "message")
+        {
+            log << "Missmatch on message: " << i << ", got: " << got[i].seq << endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Wait (with a timeout) for the condition to become true
+ */
+template <class Condition>
+bool WaitFor(const Condition& cond) {
+    Time start;
+    while (!cond() && Time().DiffUSecs(start) < 5000000) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return cond();
+}
+
+int PublishSingleConsumer(testLogger& log) {
+    ShmPublisher<Msg> publisher(RingName("single"), 1024);
+    ShmConnection<Msg> connection(RingName("single"));
+    std::shared_ptr<ShmSubscriber<Msg>> client(connection.NewClient());
+
+    if (publisher.NumClients() != 1) {
+        log << "Invalid number of clients: " << publisher.NumClients() << endl;
+        return 1;
+    }
+
+    for (size_t i = 0; i < 100; ++i) {
+        publisher.Publish(MakeMsg(i));
+    }
+
+    std::vector<Msg> got;
+    Msg m;
+    while (client->GetNextMessage(m)) {
+        got.push_back(m);
+    }
+
+    if (!CheckMessages(log, got, 100)) {
+        return 1;
+    }
+
+    client.reset();
+    if (publisher.NumClients() != 0) {
+        log << "Client was not released: " << publisher.NumClients() << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int PublishNotify(testLogger& log) {
+    ShmPublisher<Msg> publisher(RingName("notify"), 1024);
+    ShmConnection<Msg> connection(RingName("notify"));
+    std::shared_ptr<ShmSubscriber<Msg>> client(connection.NewClient());
+
+    std::atomic<size_t> notifications(0);
+    client->OnNextMessage([&] () -> void { ++notifications; });
+
+    // Allow the dispatch thread to go to sleep on the ring
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    if (notifications != 0) {
+        log << "Notified before publication!" << endl;
+        return 1;
+    }
+
+    publisher.Publish(MakeMsg(0));
+    publisher.Publish(MakeMsg(1));
+
+    if (!WaitFor([&] () -> bool { return notifications > 0; })) {
+        log << "Notification was never triggered" << endl;
+        return 1;
+    }
+
+    // Once only...
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    if (notifications != 1) {
+        log << "Invalid number of notifications: " << notifications << endl;
+        return 1;
+    }
+
+    // Unread data: triggered immediately
+    client->OnNextMessage([&] () -> void { ++notifications; });
+    if (notifications != 2) {
+        log << "Unread data did not trigger notification" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int RingWrap(testLogger& log) {
+    ShmPublisher<Msg> publisher(RingName("wrap"), 16);
+    ShmConnection<Msg> connection(RingName("wrap"));
+    std::shared_ptr<ShmSubscriber<Msg>> client(connection.NewClient());
+    const size_t toSend = 1000;
+
+    std::vector<Msg> got;
+    std::thread reader([&] () -> void {
+        Msg m;
+        while (got.size() < toSend) {
+            if (client->GetNextMessage(m)) {
+                got.push_back(m);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    for (size_t i = 0; i < toSend; ++i) {
+        publisher.Publish(MakeMsg(i));
+    }
+
+    reader.join();
+
+    if (!CheckMessages(log, got, toSend)) {
+        return 1;
+    }
+
+    return 0;
+}
+
+int CrossProcess(testLogger& log) {
+    const std::string name = RingName("cross");
+    const size_t toSend = 10000;
+    std::unique_ptr<ShmPublisher<Msg>> publisher(new ShmPublisher<Msg>(name, 64));
+
+    const pid_t child = fork();
+    if (child == 0) {
+        // Reader process: exit code reports the result
+        int result = 1;
+        {
+            ShmConnection<Msg> connection(name);
+            std::shared_ptr<ShmSubscriber<Msg>> client(connection.NewClient());
+
+            std::vector<Msg> got;
+            Msg m;
+            while (!client->Finished()) {
+                if (client->GetNextMessage(m)) {
+                    got.push_back(m);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+
+            result = (got.size() == toSend) ? 0 : 2;
+            for (size_t i = 0; result == 0 && i < got.size(); ++i) {
+                if (got[i].seq != i) {
+                    result = 3;
+                }
+            }
+        }
+        _exit(result);
+    }
+
+    if (!WaitFor([&] () -> bool { return publisher->NumClients() == 1; })) {
+        log << "Reader process never attached" << endl;
+        return 1;
+    }
+
+    for (size_t i = 0; i < toSend; ++i) {
+        publisher->Publish(MakeMsg(i));
+    }
+
+    // Closing the ring ends the reader's stream
+    publisher.reset();
+
+    int status = 0;
+    waitpid(child, &status, 0);
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        log << "Reader process failed: " << status << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int CrashedReader(testLogger& log) {
+    const std::string name = RingName("crashedReader");
+    ShmPublisher<Msg> publisher(name, 16);
+
+    const pid_t child = fork();
+    if (child == 0) {
+        ShmConnection<Msg> connection(name);
+        std::shared_ptr<ShmSubscriber<Msg>> client(connection.NewClient());
+
+        // Exit without releasing the reader slot
+        _exit(0);
+    }
+
+    int status = 0;
+    waitpid(child, &status, 0);
+
+    if (publisher.NumClients() != 1) {
+        log << "Crashed reader's slot is not held: " << publisher.NumClients() << endl;
+        return 1;
+    }
+
+    // Would block forever if the crashed reader wasn't reclaimed
+    for (size_t i = 0; i < 100; ++i) {
+        publisher.Publish(MakeMsg(i));
+    }
+
+    if (publisher.NumClients() != 0) {
+        log << "Crashed reader was not reclaimed" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int CrashedWriter(testLogger& log) {
+    const std::string name = RingName("crashedWriter");
+    int ready[2];
+    int go[2];
+    if (pipe(ready) != 0 || pipe(go) != 0) {
+        log << "Failed to create pipes" << endl;
+        return 1;
+    }
+
+    const pid_t child = fork();
+    if (child == 0) {
+        ShmPublisher<Msg> publisher(name, 16);
+        char c = 'r';
+        if (write(ready[1], &c, 1) != 1 || read(go[0], &c, 1) != 1) {
+            _exit(1);
+        }
+
+        for (size_t i = 0; i < 5; ++i) {
+            publisher.Publish(MakeMsg(i));
+        }
+
+        // Crash, without closing the ring
+        _exit(0);
+    }
+
+    char c = 0;
+    if (read(ready[0], &c, 1) != 1) {
+        log << "Writer process failed to start" << endl;
+        return 1;
+    }
+
+    ShmConnection<Msg> connection(name);
+    std::shared_ptr<ShmSubscriber<Msg>> client(connection.NewClient());
+
+    if (!connection.PublisherAlive()) {
+        log << "Publisher should be alive!" << endl;
+        return 1;
+    }
+
+    std::atomic<bool> notified(false);
+    client->OnNextMessage([&] () -> void { notified = true; });
+
+    if (write(go[1], &c, 1) != 1) {
+        log << "Failed to release the writer" << endl;
+        return 1;
+    }
+
+    int status = 0;
+    waitpid(child, &status, 0);
+
+    std::vector<Msg> got;
+    Msg m;
+    if (!WaitFor([&] () -> bool {
+            while (client->GetNextMessage(m)) {
+                got.push_back(m);
+            }
+            return client->Finished();
+        }))
+    {
+        log << "Crashed writer was not detected" << endl;
+        return 1;
+    }
+
+    if (!notified) {
+        log << "Client was not notified" << endl;
+        return 1;
+    }
+
+    if (connection.PublisherAlive()) {
+        log << "Publisher should be dead!" << endl;
+        return 1;
+    }
+
+    if (!CheckMessages(log, got, 5)) {
+        return 1;
+    }
+
+    // The ring can now be taken over by a new writer
+    try {
+        ShmPublisher<Msg> replacement(name, 16);
+    } catch (ShmRing::ShmRingException& e) {
+        log << "Failed to replace crashed writer: " << e.msg << endl;
+        return 1;
+    }
+
+    close(ready[0]);
+    close(ready[1]);
+    close(go[0]);
+    close(go[1]);
+
+    return 0;
+}
+
+int SecondWriter(testLogger& log) {
+    const std::string name = RingName("secondWriter");
+    ShmPublisher<Msg> publisher(name, 16);
+
+    try {
+        ShmPublisher<Msg> second(name, 16);
+        log << "Second writer was allowed!" << endl;
+        return 1;
+    } catch (ShmRing::ShmRingException& e) {
+        log << "Rejected: " << e.msg << endl;
+    }
+
+    return 0;
+}
+
+int WrongMessageType(testLogger& log) {
+    const std::string name = RingName("wrongType");
+    ShmPublisher<Msg> publisher(name, 16);
+
+    try {
+        ShmConnection<uint64_t> connection(name);
+        log << "Connected to the wrong message type!" << endl;
+        return 1;
+    } catch (ShmRing::ShmRingException& e) {
+        log << "Rejected: " << e.msg << endl;
+    }
+
+    try {
+        ShmConnection<Msg> connection(RingName("noSuchRing"));
+        log << "Connected to a missing ring!" << endl;
+        return 1;
+    } catch (ShmRing::ShmRingException& e) {
+        log << "Rejected: " << e.msg << endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,209 @@
+#include "tester.h"
+#include <PipeStage.h>
+#include <util_time.h>
+#include <thread>
+#include <atomic>
+
+
+using namespace std;
+
+int TwoStages(testLogger& log);
+int ParallelStage(testLogger& log);
+int BackPressure(testLogger& log);
+int Report(testLogger& log);
+
+int main(int argc, const char *argv[])
+{
+    Test("Two stage pipeline",TwoStages).RunTest();
+    Test("Parallel stage preserves order",ParallelStage).RunTest();
+    Test("Small queues apply back-pressure",BackPressure).RunTest();
+    Test("Pipeline report",Report).RunTest();
+
+    return 0;
+}
+
+typedef std::shared_ptr<PipeSubscriber<std::string>> Sink;
+
+/**
+ * Read toRead messages from the sink, giving up after a few seconds
+ */
+template <class Msg>
+std::vector<Msg> Drain(PipeSubscriber<Msg>& sink, size_t toRead) {
+    std::vector<Msg> got;
+    Time start;
+    Msg msg;
+    while (got.size() < toRead && Time().DiffUSecs(start) < 10000000) {
+        if (sink.GetNextMessage(msg)) {
+            got.push_back(msg);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    return got;
+}
+
+/**
+ * Burn some CPU, so that a stage has something to measure.
+ */
+size_t Spin(size_t n) {
+    volatile size_t total = 0;
+    for (size_t i = 0; i < n; ++i) {
+        total = total + i;
+    }
+    return total;
+}
+
+int TwoStages(testLogger& log) {
+    PipePublisher<size_t> source;
+    PipeStage<size_t, size_t> square("square", source, [] (const size_t& i) -> size_t {
+        return i * i;
+    });
+    PipeStage<size_t, std::string> format("format", square.Output(), [] (const size_t& i) -> std::string {
+        return std::to_string(i);
+    });
+    Sink sink(format.Output().NewClient(1024));
+
+    const size_t toSend = 1000;
+    for (size_t i = 0; i < toSend; ++i) {
+        source.Publish(i);
+    }
+
+    std::vector<std::string> got = Drain(*sink, toSend);
+    if (got.size() != toSend) {
+        log << "Only received " << got.size() << " messages" << endl;
+        return 1;
+    }
+
+    for (size_t i = 0; i < toSend; ++i) {
+        if (got[i] != std::to_string(i*i)) {
+            log << "Invalid message " << i << ": " << got[i] << endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int ParallelStage(testLogger& log) {
+    PipePublisher<size_t> source;
+
+    // Uneven costs, so that the workers finish out of order
+    PipeStage<size_t, size_t> work("work", source, [] (const size_t& i) -> size_t {
+        Spin((i % 7) * 1000);
+        return i;
+    }, 4, 16);
+    std::shared_ptr<PipeSubscriber<size_t>> sink(work.Output().NewClient(100000));
+
+    const size_t toSend = 20000;
+    for (size_t i = 0; i < toSend; ++i) {
+        source.Publish(i);
+    }
+
+    std::vector<size_t> got = Drain(*sink, toSend);
+    if (got.size() != toSend) {
+        log << "Only received " << got.size() << " messages" << endl;
+        return 1;
+    }
+
+    for (size_t i = 0; i < toSend; ++i) {
+        if (got[i] != i) {
+            log << "Message " << i << " out of order: " << got[i] << endl;
+            return 1;
+        }
+    }
+
+    PipeStageStats stats = work.Stats();
+    if (stats.workers != 4 || stats.processed != toSend) {
+        log << "Invalid stats: " << stats.workers << " / " << stats.processed << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int BackPressure(testLogger& log) {
+    PipePublisher<size_t> source;
+    PipeStage<size_t, size_t> first("first", source, [] (const size_t& i) -> size_t {
+        return i;
+    }, 1, 4);
+    PipeStage<size_t, size_t> second("second", first.Output(), [] (const size_t& i) -> size_t {
+        Spin(100);
+        return i;
+    }, 2, 4);
+    std::shared_ptr<PipeSubscriber<size_t>> sink(
+        second.Output().NewClient(4, PipeSubscriber<size_t>::BLOCK));
+
+    const size_t toSend = 10000;
+    std::thread publisher([&] () -> void {
+        for (size_t i = 0; i < toSend; ++i) {
+            source.Publish(i);
+        }
+    });
+
+    std::vector<size_t> got = Drain(*sink, toSend);
+    publisher.join();
+
+    if (got.size() != toSend) {
+        log << "Only received " << got.size() << " messages" << endl;
+        return 1;
+    }
+
+    for (size_t i = 0; i < toSend; ++i) {
+        if (got[i] != i) {
+            log << "Message " << i << " out of order: " << got[i] << endl;
+            return 1;
+        }
+    }
+
+    if (first.Stats().highWaterMark > 4 || second.Stats().highWaterMark > 4) {
+        log << "Queue grew beyond its bound" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int Report(testLogger& log) {
+    PipePublisher<size_t> source;
+    PipeStage<size_t, size_t> fast("fast", source, [] (const size_t& i) -> size_t {
+        return i;
+    });
+    PipeStage<size_t, size_t> slow("slow", fast.Output(), [] (const size_t& i) -> size_t {
+        Spin(20000);
+        return i;
+    });
+    std::shared_ptr<PipeSubscriber<size_t>> sink(slow.Output().NewClient(1024));
+
+    const size_t toSend = 500;
+    for (size_t i = 0; i < toSend; ++i) {
+        source.Publish(i);
+    }
+
+    if (Drain(*sink, toSend).size() != toSend) {
+        log << "Pipeline did not complete" << endl;
+        return 1;
+    }
+
+    const std::string report = PipeStageReport({&fast, &slow});
+    log << report;
+
+    if (report.find("slow") == std::string::npos ||
+        report.find("fast") == std::string::npos)
+    {
+        log << "Stages missing from the report" << endl;
+        return 1;
+    }
+
+    if (report.find("<- bottleneck") < report.find("slow")) {
+        log << "Wrong stage marked as the bottleneck" << endl;
+        return 1;
+    }
+
+    PipeStageStats stats = slow.Stats();
+    if (stats.processed != toSend || stats.p50 == 0 || stats.busy <= 0) {
+        log << "Invalid stats for the slow stage" << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -3,6 +3,9 @@
 #include <atomic>
 #include <mutex>
 #include <util_time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <cstdlib>
 
 #include <iostream>
 
@@ -13,6 +16,25 @@ int InternalAbort(testLogger& log);
 int WaitForTask(testLogger& log);
 int SingleClient(testLogger& log);
 int TwoClients(testLogger& log); int SliceSize(testLogger& log);
+int BulkClient(testLogger& log);
+int BatchClient(testLogger& log);
+int OverflowQueue(testLogger& log);
+int ManyProducers(testLogger& log);
+int CancelWaitingTask(testLogger& log);
+int TaskAfter(testLogger& log);
+int LongTaskAfter(testLogger& log);
+int CancelTimer(testLogger& log);
+int CancelTimerReleased(testLogger& log);
+int PeriodicTask(testLogger& log);
+int ManyTimers(testLogger& log);
+int SpinThenPark(testLogger& log);
+int BusyPoll(testLogger& log);
+int ConfigFromEnv(testLogger& log);
+int ConfiguredWorker(testLogger& log);
+int TaskAccounting(testLogger& log);
+int TaskAccountingQueueLength(testLogger& log);
+int TaskAccountingSampled(testLogger& log);
+int SlowTaskHook(testLogger& log);
 
 int main(int argc, const char *argv[])
 {
@@ -24,6 +46,25 @@ int main(int argc, const char *argv[])
     Test("Consume updates from a single client",SingleClient).RunTest();
     Test("Consume updates from two clients",TwoClients).RunTest();
     Test("Slice Size is respected",SliceSize).RunTest();
+    Test("Consume updates in bulk",BulkClient).RunTest();
+    Test("Consume updates a batch at a time",BatchClient).RunTest();
+    Test("Tasks are run in order when the queue overflows",OverflowQueue).RunTest();
+    Test("Posting from many threads",ManyProducers).RunTest();
+    Test("Waiting task is cancelled by Abort",CancelWaitingTask).RunTest();
+    Test("Posting a delayed task",TaskAfter).RunTest();
+    Test("Delays beyond the first wheel level, idle worker",LongTaskAfter).RunTest();
+    Test("Cancelling a delayed task",CancelTimer).RunTest();
+    Test("Cancelled timers are removed from the wheel",CancelTimerReleased).RunTest();
+    Test("Posting a periodic task",PeriodicTask).RunTest();
+    Test("Scheduling 100k timers",ManyTimers).RunTest();
+    Test("Spin then park wait strategy",SpinThenPark).RunTest();
+    Test("Busy poll wait strategy",BusyPoll).RunTest();
+    Test("Thread configuration from the environment",ConfigFromEnv).RunTest();
+    Test("Pinned and named worker",ConfiguredWorker).RunTest();
+    Test("Task accounting: wait and run times",TaskAccounting).RunTest();
+    Test("Task accounting: queue length",TaskAccountingQueueLength).RunTest();
+    Test("Task accounting: posts are sampled",TaskAccountingSampled).RunTest();
+    Test("Task accounting: slow task hook",SlowTaskHook).RunTest();
     return 0;
 }
 
@@ -493,3 +534,782 @@ int SliceSize(testLogger& log ) {
 
     return 0;
 }
+
+int BulkClient(testLogger& log ) {
+    PipePublisher<Msg> publisher;
+    WorkerThread worker;
+    std::vector<Msg> messages;
+    std::vector<size_t> slices;
+    std::mutex  comms_mutex;
+    std::condition_variable wait_for_complete;
+
+    std::vector<Msg> toSend {
+        {Time(), "Hello"},
+        {Time(), "World!"},
+        {Time(), "Another String"},
+        {Time(), "And Another"},
+        {Time(), "And a final one"}
+    };
+
+    std::function<void (Msg*, size_t)> push = [&] (Msg* msgs, size_t count) -> void {
+        std::unique_lock<std::mutex> lock(comms_mutex);
+        slices.push_back(count);
+        messages.insert(messages.end(), msgs, msgs + count);
+        if ( messages.size() == toSend.size()) {
+            wait_for_complete.notify_all();
+        }
+    };
+
+    worker.Start();
+
+    std::unique_lock<std::mutex> lock(comms_mutex);
+
+    worker.ConsumeUpdates(publisher,push,1000,2);
+
+    for (Msg& m: toSend) {
+        publisher.Publish(m);
+    }
+
+    while (messages.size() != toSend.size()) {
+        wait_for_complete.wait(lock);
+    }
+
+    if (!MessagesMatch(log,toSend,messages)) {
+        return 1;
+    }
+
+    for (size_t count: slices) {
+        if (count == 0 || count > 2) {
+            log << "Invalid slice size: " << count << endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int OverflowQueue(testLogger& log) {
+    WorkerThread worker(4);
+    const size_t toPost = 100;
+    std::vector<size_t> order;
+
+    for (size_t i = 0; i < toPost; ++i) {
+        worker.PostTask([&order, i] () -> void { order.push_back(i); });
+    }
+
+    worker.Start();
+
+    // Now keep posting whilst the thread is still draining the overflow
+    for (size_t i = toPost; i < 2*toPost; ++i) {
+        worker.PostTask([&order, i] () -> void { order.push_back(i); });
+    }
+
+    if (!worker.DoTask([] () -> void { })) {
+        log << "Do task failed!" << endl;
+        return 1;
+    }
+
+    if (order.size() != 2*toPost) {
+        log << "Invalid number of tasks run: " << order.size() << endl;
+        return 1;
+    }
+
+    for (size_t i = 0; i < order.size(); ++i) {
+        if (order[i] != i) {
+            log << "Task out of order: " << i << " : " << order[i] << endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int ManyProducers(testLogger& log) {
+    WorkerThread worker(16);
+    const size_t producers = 4;
+    const size_t toPost = 10000;
+    std::vector<std::vector<size_t>> results(producers);
+    std::vector<std::thread> threads;
+
+    worker.Start();
+
+    for (size_t p = 0; p < producers; ++p) {
+        std::vector<size_t>& result = results[p];
+        threads.emplace_back([&worker, &result, toPost] () -> void {
+            for (size_t i = 0; i < toPost; ++i) {
+                worker.PostTask([&result, i] () -> void {
+                    result.push_back(i);
+                });
+            }
+        });
+    }
+
+    for (std::thread& t: threads) {
+        t.join();
+    }
+
+    if (!worker.DoTask([] () -> void { })) {
+        log << "Do task failed!" << endl;
+        return 1;
+    }
+
+    // Tasks from each producer must be run in the order they were posted
+    for (std::vector<size_t>& result: results) {
+        if (result.size() != toPost) {
+            log << "Invalid number of tasks run: " << result.size() << endl;
+            return 1;
+        }
+
+        for (size_t i = 0; i < toPost; ++i) {
+            if (result[i] != i) {
+                log << "Task out of order: " << i << " : " << result[i] << endl;
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+int CancelTimerReleased(testLogger& log) {
+    WorkerThread worker;
+    worker.Start();
+
+    std::shared_ptr<int> token(new int(0));
+
+    WorkerThread::TimerHandle handle = worker.PostTaskAfter([token] () -> void {
+        ++*token;
+    }, std::chrono::seconds(30));
+
+    // Make sure the timer is in the wheel before we cancel it
+    worker.DoTask([] () -> void { });
+    handle.Cancel();
+
+    // The task (and its capture) should be dropped as soon as the worker
+    // next advances the wheel, not when the timer would have expired
+    Time start;
+    while (token.use_count() != 1 && Time().DiffUSecs(start) < 1000000) {
+        worker.DoTask([] () -> void { });
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    if (token.use_count() != 1) {
+        log << "Cancelled timer is still held: " << token.use_count() << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int CancelWaitingTask(testLogger& log) {
+    WorkerThread worker;
+    std::atomic<bool> ran(false);
+    std::atomic<bool> result(true);
+
+    // The worker is never started, so the task can't complete until aborted
+    std::thread waiter([&] () -> void {
+        result = worker.DoTask([&] () -> void { ran = true; });
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    worker.Abort();
+    waiter.join();
+
+    if (result) {
+        log << "Cancelled task reported success" << endl;
+        return 1;
+    }
+
+    if (ran) {
+        log << "Cancelled task was executed" << endl;
+        return 1;
+    }
+
+    if (worker.DoTask([] () -> void { })) {
+        log << "Task executed after Abort" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int TaskAfter(testLogger& log) {
+    WorkerThread worker;
+    worker.Start();
+
+    std::thread::id this_thread = std::this_thread::get_id();
+    std::thread::id write_id = this_thread;
+    std::atomic<bool> done(false);
+    WorkerThread::Clock::time_point fired;
+
+    const WorkerThread::Clock::time_point posted = WorkerThread::Clock::now();
+    worker.PostTaskAfter([&] () -> void {
+        fired = WorkerThread::Clock::now();
+        write_id = std::this_thread::get_id();
+        done = true;
+    }, std::chrono::milliseconds(20));
+
+    while (!done) {
+        std::this_thread::yield();
+    }
+
+    if (fired - posted < std::chrono::milliseconds(20)) {
+        log << "Task was triggered early" << endl;
+        return 1;
+    }
+
+    if (write_id == this_thread) {
+        log << "target written from the current thread!" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int LongTaskAfter(testLogger& log) {
+    WorkerThread worker;
+    worker.Start();
+
+    /**
+     * Both are cascaded down from the second level of the wheel: an idle
+     * worker must wake for the cascade, not the tick before it.
+     */
+    const std::vector<std::chrono::milliseconds> delays = {
+        std::chrono::milliseconds(300),
+        std::chrono::milliseconds(400)
+    };
+    std::vector<WorkerThread::Clock::time_point> fired(delays.size());
+    std::atomic<size_t> done(0);
+
+    const WorkerThread::Clock::time_point posted = WorkerThread::Clock::now();
+    for (size_t i = 0; i < delays.size(); ++i) {
+        worker.PostTaskAfter([&, i] () -> void {
+            fired[i] = WorkerThread::Clock::now();
+            ++done;
+        }, delays[i]);
+    }
+
+    while (done < delays.size()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    for (size_t i = 0; i < delays.size(); ++i) {
+        const auto late = std::chrono::duration_cast<std::chrono::milliseconds>(
+            fired[i] - posted - delays[i]);
+
+        if (late.count() < 0) {
+            log << "Task " << i << " was triggered early" << endl;
+            return 1;
+        }
+
+        if (late > std::chrono::milliseconds(50)) {
+            log << "Task " << i << " was " << late.count() << "ms late" << endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int CancelTimer(testLogger& log) {
+    WorkerThread worker;
+    worker.Start();
+
+    std::atomic<bool> cancelledRan(false);
+    std::atomic<bool> done(false);
+
+    WorkerThread::TimerHandle handle = worker.PostTaskAfter([&] () -> void {
+        cancelledRan = true;
+    }, std::chrono::milliseconds(10));
+
+    handle.Cancel();
+
+    worker.PostTaskAfter([&] () -> void {
+        done = true;
+    }, std::chrono::milliseconds(20));
+
+    while (!done) {
+        std::this_thread::yield();
+    }
+
+    if (cancelledRan) {
+        log << "Cancelled timer was triggered" << endl;
+        return 1;
+    }
+
+    if (!handle.Cancelled()) {
+        log << "Handle does not report cancellation" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int PeriodicTask(testLogger& log) {
+    WorkerThread worker;
+    worker.Start();
+
+    std::atomic<size_t> count(0);
+    WorkerThread::TimerHandle handle;
+
+    handle = worker.PostTaskEvery([&] () -> void {
+        if (++count == 5) {
+            handle.Cancel();
+        }
+    }, std::chrono::milliseconds(2));
+
+    while (count < 5) {
+        std::this_thread::yield();
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    if (count != 5) {
+        log << "Periodic task triggered after cancellation: " << count << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int ManyTimers(testLogger& log) {
+    WorkerThread worker;
+    const size_t toPost = 100000;
+    std::atomic<size_t> fired(0);
+    std::atomic<size_t> early(0);
+    std::atomic<size_t> cancelledRan(0);
+    std::vector<WorkerThread::TimerHandle> handles;
+    handles.reserve(toPost);
+
+    // Hold the worker, so the timers can be cancelled before they are due...
+    std::mutex block_mutex;
+    std::unique_lock<std::mutex> block(block_mutex);
+    worker.PostTask([&] () -> void {
+        std::unique_lock<std::mutex> lock(block_mutex);
+    });
+
+    worker.Start();
+
+    const WorkerThread::Clock::time_point start = WorkerThread::Clock::now();
+
+    for (size_t i = 0; i < toPost; ++i) {
+        const WorkerThread::Clock::time_point due =
+            start + std::chrono::microseconds((i * 7919) % 600000);
+        const bool cancelled = (i % 2 == 1);
+
+        handles.push_back(worker.PostTaskAt([&, due, cancelled] () -> void {
+            if (WorkerThread::Clock::now() < due) {
+                ++early;
+            }
+            if (cancelled) {
+                ++cancelledRan;
+            }
+            ++fired;
+        }, due));
+
+        if (cancelled) {
+            handles.back().Cancel();
+        }
+    }
+
+    block.unlock();
+
+    while (fired < toPost / 2 &&
+           WorkerThread::Clock::now() - start < std::chrono::seconds(10))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    worker.DoTask([] () -> void { });
+
+    if (fired != toPost / 2) {
+        log << "Invalid number of timers triggered: " << fired << endl;
+        return 1;
+    }
+
+    if (early != 0 || cancelledRan != 0) {
+        log << "Early: " << early << ", Cancelled: " << cancelledRan << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int RunWithStrategy(testLogger& log, const WaitStrategy& strategy) {
+    WorkerThread worker(1024, strategy);
+    const size_t toPost = 1000;
+    std::vector<size_t> result;
+
+    worker.Start();
+
+    for (size_t i = 0; i < toPost; ++i) {
+        worker.PostTask([&result, i] () -> void {
+            result.push_back(i);
+        });
+
+        if (i % 100 == 0) {
+            // Let the worker go idle...
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+
+    if (!worker.DoTask([] () -> void { })) {
+        log << "Do task failed!" << endl;
+        return 1;
+    }
+
+    if (result.size() != toPost) {
+        log << "Invalid number of tasks run: " << result.size() << endl;
+        return 1;
+    }
+
+    for (size_t i = 0; i < toPost; ++i) {
+        if (result[i] != i) {
+            log << "Task out of order: " << i << " : " << result[i] << endl;
+            return 1;
+        }
+    }
+
+    // An idle worker must still pick up timers
+    std::atomic<bool> fired(false);
+    worker.PostTaskAfter([&fired] () -> void { fired = true; },
+                         std::chrono::milliseconds(5));
+
+    Time start;
+    while (!fired && Time().DiffUSecs(start) < 1000000) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    if (!fired) {
+        log << "Timer did not fire" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int SpinThenPark(testLogger& log) {
+    return RunWithStrategy(log, WaitStrategy::SpinThenPark(1000));
+}
+
+int BusyPoll(testLogger& log) {
+    return RunWithStrategy(log, WaitStrategy::BusyPoll());
+}
+
+int ConfigFromEnv(testLogger& log) {
+    setenv("WORKER_TEST_CPUS", "0,2-4,junk,7", 1);
+    setenv("WORKER_TEST_NAME", "envWorker", 1);
+    setenv("WORKER_TEST_FIFO_PRIORITY", "10", 1);
+    setenv("WORKER_TEST_NUMA_LOCAL", "", 1);
+
+    ThreadConfig defaults;
+    defaults.name = "default";
+    ThreadConfig config = ThreadConfig::FromEnv("WORKER_TEST", defaults);
+
+    const std::vector<int> expected = {0, 2, 3, 4, 7};
+    if (config.cpus != expected) {
+        log << "Unexpected CPU list, size: " << config.cpus.size() << endl;
+        return 1;
+    }
+
+    if (config.name != "envWorker") {
+        log << "Unexpected name: " << config.name << endl;
+        return 1;
+    }
+
+    if (config.fifoPriority != 10) {
+        log << "Unexpected priority: " << config.fifoPriority << endl;
+        return 1;
+    }
+
+    if (!config.numaLocal) {
+        log << "NUMA local allocation was not enabled" << endl;
+        return 1;
+    }
+
+    // Unset variables leave the defaults alone
+    ThreadConfig unset = ThreadConfig::FromEnv("WORKER_TEST_UNSET", defaults);
+    if (unset.name != "default" || !unset.cpus.empty() ||
+        unset.fifoPriority != 0 || unset.numaLocal)
+    {
+        log << "Defaults were not preserved" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int ConfiguredWorker(testLogger& log) {
+    ThreadConfig config;
+    config.cpus = {0};
+    config.name = "pinnedWorker";
+    config.numaLocal = true;
+
+    WorkerThread worker(1024, WaitStrategy::Blocking(), config);
+    worker.Start();
+
+    int cpu = -1;
+    char name[16] = {0};
+    cpu_set_t affinity;
+    CPU_ZERO(&affinity);
+
+    worker.DoTask([&] () -> void {
+        cpu = sched_getcpu();
+        pthread_getname_np(pthread_self(), name, sizeof(name));
+        pthread_getaffinity_np(pthread_self(), sizeof(affinity), &affinity);
+    });
+
+    if (cpu != 0 || CPU_COUNT(&affinity) != 1 || !CPU_ISSET(0, &affinity)) {
+        log << "Worker is not pinned to CPU 0, running on: " << cpu << endl;
+        return 1;
+    }
+
+    if (std::string(name) != "pinnedWorker") {
+        log << "Unexpected thread name: " << name << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int BatchClient(testLogger& log) {
+    PipePublisher<size_t> publisher;
+    WorkerThread worker;
+
+    class Handler: public IBatchHandler<size_t> {
+    public:
+        Handler() : batches(0), inBatch(false), error(false) { }
+
+        virtual void OnBatchStart() {
+            error = error || inBatch;
+            inBatch = true;
+            current.clear();
+        }
+
+        virtual void OnUpdates(size_t* msgs, size_t count) {
+            error = error || !inBatch || count > 100;
+            current.insert(current.end(), msgs, msgs + count);
+        }
+
+        virtual void OnBatchEnd() {
+            error = error || !inBatch;
+            inBatch = false;
+            std::unique_lock<std::mutex> lock(batchesMutex);
+            sizes.push_back(current.size());
+            ++batches;
+        }
+
+        std::atomic<size_t> batches;
+        std::mutex          batchesMutex;
+        std::vector<size_t> sizes;
+        std::vector<size_t> current;
+        bool                inBatch;
+        bool                error;
+    } handler;
+
+    worker.Start();
+    worker.ConsumeUpdates(publisher,handler,1000,100);
+
+    auto waitForBatches = [&] (size_t count) -> bool {
+        Time start;
+        while (handler.batches < count && Time().DiffUSecs(start) < 5000000) {
+            std::this_thread::yield();
+        }
+        return (handler.batches == count);
+    };
+
+    const size_t batchSize = 250;
+    for (size_t batch = 0; batch < 2; ++batch) {
+        publisher.StartBatch();
+        for (size_t i = 0; i < batchSize; ++i) {
+            publisher.Publish(i);
+        }
+
+        // Give the worker a chance to (incorrectly) wake mid-batch
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        if (handler.batches != batch) {
+            log << "Batch handled before it was complete" << endl;
+            return 1;
+        }
+
+        publisher.EndBatch();
+
+        if (!waitForBatches(batch + 1)) {
+            log << "Batch was not handled" << endl;
+            return 1;
+        }
+    }
+
+    // Un-batched updates are delivered as they arrive
+    publisher.Publish(0);
+    if (!waitForBatches(3)) {
+        log << "Un-batched update was not handled" << endl;
+        return 1;
+    }
+
+    worker.DoTask([] () -> void { });
+
+    if (handler.error) {
+        log << "Invalid callback sequence" << endl;
+        return 1;
+    }
+
+    std::unique_lock<std::mutex> lock(handler.batchesMutex);
+    if (handler.sizes != std::vector<size_t>({batchSize, batchSize, 1})) {
+        log << "Invalid batch sizes" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int TaskAccounting(testLogger& log) {
+    WorkerThread worker;
+    worker.EnableStats();
+    worker.Start();
+
+    const auto sleep = std::chrono::milliseconds(20);
+    const uint64_t sleepNs = 20 * 1000 * 1000;
+
+    // The second task waits for the first to complete
+    worker.PostTask([&] () -> void { std::this_thread::sleep_for(sleep); });
+    worker.DoTask([] () -> void { });
+
+    const WorkerThreadStats stats = worker.Stats();
+
+    if (stats.tasks != 2) {
+        log << "Invalid number of tasks accounted: " << stats.tasks << endl;
+        return 1;
+    }
+
+    if (worker.RunTimes().Count() != 2 || worker.RunTimes().Max() < sleepNs) {
+        log << "Invalid run times: " << worker.RunTimes().Count()
+            << " / " << worker.RunTimes().Max() << endl;
+        return 1;
+    }
+
+    if (worker.QueueWaitTimes().Count() != 2 ||
+        worker.QueueWaitTimes().Max() < sleepNs)
+    {
+        log << "Invalid wait times: " << worker.QueueWaitTimes().Count()
+            << " / " << worker.QueueWaitTimes().Max() << endl;
+        return 1;
+    }
+
+    if (stats.busyNs < sleepNs || stats.elapsedNs < stats.busyNs ||
+        stats.BusyPercentage() <= 0 || stats.BusyPercentage() > 100)
+    {
+        log << "Invalid busy time: " << stats.busyNs << " / "
+            << stats.elapsedNs << endl;
+        return 1;
+    }
+
+    // Nothing is accounted once disabled
+    worker.EnableStats(false);
+    worker.DoTask([] () -> void { });
+
+    if (worker.Stats().tasks != 2 || worker.RunTimes().Count() != 2) {
+        log << "Task accounted whilst stats were disabled" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int TaskAccountingQueueLength(testLogger& log) {
+    WorkerThread worker(8);
+    worker.EnableStats();
+    worker.Start();
+
+    std::atomic<bool> release(false);
+    worker.PostTask([&] () -> void {
+        while (!release) {
+            std::this_thread::yield();
+        }
+    });
+
+    // Enough to spill onto the overflow queue
+    for (size_t i = 0; i < 20; ++i) {
+        worker.PostTask([] () -> void { });
+    }
+
+    const size_t queued = worker.Stats().queueLength;
+    release = true;
+    worker.DoTask([] () -> void { });
+
+    // The blocking task may not have been started yet
+    if (queued != 20 && queued != 21) {
+        log << "Invalid queue length: " << queued << endl;
+        return 1;
+    }
+
+    if (worker.Stats().queueLength != 0) {
+        log << "Queue was not drained: " << worker.Stats().queueLength << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int TaskAccountingSampled(testLogger& log) {
+    const size_t samples = 10;
+    const size_t toPost = samples * WorkerThread::STATS_SAMPLE_INTERVAL;
+
+    WorkerThread worker(2 * toPost);
+    worker.EnableStats();
+    worker.Start();
+
+    for (size_t i = 0; i < toPost; ++i) {
+        worker.PostTask([] () -> void { });
+    }
+    worker.DoTask([] () -> void { });
+
+    if (worker.Stats().tasks != toPost + 1) {
+        log << "Invalid number of tasks accounted: " << worker.Stats().tasks
+            << endl;
+        return 1;
+    }
+
+    // ...but only the samples (and the DoTask) are timed
+    if (worker.QueueWaitTimes().Count() != samples + 1 ||
+        worker.RunTimes().Count() != samples + 1)
+    {
+        log << "Invalid number of samples: "
+            << worker.QueueWaitTimes().Count() << " / "
+            << worker.RunTimes().Count() << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int SlowTaskHook(testLogger& log) {
+    WorkerThread worker;
+    worker.EnableStats();
+    worker.Start();
+
+    std::vector<WorkerThread::Clock::duration> slow;
+    worker.OnSlowTask(std::chrono::milliseconds(5),
+        [&] (const WorkerThread::Clock::duration& runTime) -> void {
+            slow.push_back(runTime);
+        });
+
+    for (size_t i = 0; i < 10; ++i) {
+        worker.PostTask([] () -> void { });
+    }
+    worker.PostTask([] () -> void {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    });
+    worker.DoTask([] () -> void { });
+
+    if (slow.size() != 1 || slow[0] < std::chrono::milliseconds(10)) {
+        log << "Invalid slow tasks reported: " << slow.size() << endl;
+        return 1;
+    }
+
+    if (worker.Stats().slowTasks != 1) {
+        log << "Invalid slow task count: " << worker.Stats().slowTasks << endl;
+        return 1;
+    }
+
+    return 0;
+}
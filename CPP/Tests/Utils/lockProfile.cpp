@@ -0,0 +1,179 @@
+#include <tester.h>
+#include <ProfiledMutex.h>
+#include <logger.h>
+#include <thread>
+#include <atomic>
+#include <sstream>
+#include <vector>
+
+int Uncontended(testLogger& log);
+int Contended(testLogger& log);
+int Recursive(testLogger& log);
+int SharedName(testLogger& log);
+int ReportLocks(testLogger& log);
+int BuildSwitch(testLogger& log);
+
+int main( int argc, char**argv) {
+    Test("Uncontended locks are counted",Uncontended).RunTest();
+    Test("Contended locks are counted",Contended).RunTest();
+    Test("Recursive locks are held until the last unlock",Recursive).RunTest();
+    Test("Locks with the same name share a profile",SharedName).RunTest();
+    Test("Report lists each lock",ReportLocks).RunTest();
+    Test("ProfiledMutex is only profiled when compiled in",BuildSwitch).RunTest();
+    return 0;
+}
+
+LockProfile::Snapshot Snap(const std::string& name) {
+    return LockProfile::Get(name).Snap();
+}
+
+int Uncontended(testLogger& log) {
+    ProfilingMutex<> mutex("Test::Uncontended");
+
+    for (size_t i = 0; i < 10; ++i) {
+        std::unique_lock<ProfilingMutex<>> lock(mutex);
+    }
+
+    if (!mutex.try_lock()) {
+        log << "Failed to take a free lock" << endl;
+        return 1;
+    }
+    mutex.unlock();
+
+    LockProfile::Snapshot snap = Snap("Test::Uncontended");
+
+    if (snap.acquisitions != 11) {
+        log << "Invalid acquisitions: " << snap.acquisitions << endl;
+        return 1;
+    }
+
+    if (snap.contended != 0 || snap.waitNs != 0) {
+        log << "Uncontended lock reported contention" << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int Contended(testLogger& log) {
+    ProfilingMutex<> mutex("Test::Contended");
+    std::atomic<bool> started(false);
+
+    mutex.lock();
+    std::thread waiter([&] () -> void {
+        started = true;
+        std::unique_lock<ProfilingMutex<>> lock(mutex);
+    });
+
+    while (!started) {
+        std::this_thread::yield();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    mutex.unlock();
+    waiter.join();
+
+    LockProfile::Snapshot snap = Snap("Test::Contended");
+
+    if (snap.acquisitions != 2 || snap.contended != 1) {
+        log << "Invalid counts: " << snap.acquisitions
+            << " / " << snap.contended << endl;
+        return 1;
+    }
+
+    if (snap.waitNs < 10 * 1000 * 1000) {
+        log << "Wait was not recorded: " << snap.waitNs << endl;
+        return 1;
+    }
+
+    if (snap.maxHoldNs < snap.waitNs) {
+        log << "Hold was not recorded: " << snap.maxHoldNs << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int Recursive(testLogger& log) {
+    ProfilingMutex<std::recursive_mutex> mutex("Test::Recursive");
+
+    mutex.lock();
+    mutex.lock();
+    mutex.unlock();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    mutex.unlock();
+
+    LockProfile::Snapshot snap = Snap("Test::Recursive");
+
+    if (snap.acquisitions != 2 || snap.contended != 0) {
+        log << "Invalid counts: " << snap.acquisitions
+            << " / " << snap.contended << endl;
+        return 1;
+    }
+
+    if (snap.maxHoldNs < 10 * 1000 * 1000) {
+        log << "Hold ended at the inner unlock: " << snap.maxHoldNs << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int SharedName(testLogger& log) {
+    ProfilingMutex<> first("Test::SharedName");
+    ProfilingMutex<> second("Test::SharedName");
+
+    first.lock();
+    second.lock();
+    second.unlock();
+    first.unlock();
+
+    LockProfile::Snapshot snap = Snap("Test::SharedName");
+
+    if (snap.acquisitions != 2 || snap.contended != 0) {
+        log << "Invalid counts: " << snap.acquisitions
+            << " / " << snap.contended << endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+int ReportLocks(testLogger& log) {
+    // Using the logger registers its lock
+    Logger::Instance();
+
+    std::stringstream report;
+    LockProfile::Report(report);
+    log << report.str();
+
+    std::vector<const char*> names = {"Test::Contended"};
+    if (LockProfile::Enabled()) {
+        names.push_back("Logger::loggingMutex");
+    }
+
+    for (const char* name: names) {
+        if (report.str().find(name) == std::string::npos) {
+            log << "Missing lock: " << name << endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int BuildSwitch(testLogger& log) {
+    ProfiledMutex<> mutex("Test::BuildSwitch");
+
+    mutex.lock();
+    mutex.unlock();
+
+    LockProfile::Snapshot snap = Snap("Test::BuildSwitch");
+    const size_t expected = LockProfile::Enabled() ? 1 : 0;
+
+    if (snap.acquisitions != expected) {
+        log << "Invalid acquisitions: " << snap.acquisitions << endl;
+        return 1;
+    }
+
+    return 0;
+}